@@ -32,6 +32,7 @@
 #include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #ifndef UA_sleep_ms
 # define UA_sleep_ms(X) usleep(X * 1000)
@@ -41,6 +42,14 @@ E.g. see unit tests. */
 void UA_sleep_ms(size_t ms);
 #endif
 
+/* Precise sleep until an absolute deadline of the monotonic clock. Not
+ * available on OS X. */
+#include <time.h>
+#if !defined(__APPLE__) && !defined(__MACH__)
+# define UA_clock_gettime clock_gettime
+# define UA_clock_nanosleep clock_nanosleep
+#endif
+
 #define OPTVAL_TYPE int
 
 #include <fcntl.h>
@@ -89,6 +98,7 @@ void UA_sleep_ms(size_t ms);
 
 #define UA_getnameinfo getnameinfo
 #define UA_send send
+#define UA_sendmsg sendmsg
 #define UA_recv recv
 #define UA_sendto sendto
 #define UA_recvfrom recvfrom
@@ -15,6 +15,14 @@
 
 #include <string.h> // memset
 
+#ifdef UA_ENABLE_EPOLL
+# include <sys/epoll.h>
+#endif
+
+#ifdef UA_ENABLE_MULTITHREADING
+# include <pthread.h>
+#endif
+
 #ifndef MSG_NOSIGNAL
 #define MSG_NOSIGNAL 0
 #endif
@@ -46,7 +54,7 @@ connection_releaserecvbuffer(UA_Connection *connection,
 static UA_StatusCode
 connection_write(UA_Connection *connection, UA_ByteString *buf) {
     if(connection->state == UA_CONNECTION_CLOSED) {
-        UA_ByteString_deleteMembers(buf);
+        connection->releaseSendBuffer(connection, buf);
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
     }
 
@@ -65,7 +73,7 @@ connection_write(UA_Connection *connection, UA_ByteString *buf) {
                      bytes_to_send, flags);
             if(n < 0 && UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_AGAIN) {
                 connection->close(connection);
-                UA_ByteString_deleteMembers(buf);
+                connection->releaseSendBuffer(connection, buf);
                 return UA_STATUSCODE_BADCONNECTIONCLOSED;
             }
         } while(n < 0);
@@ -73,64 +81,59 @@ connection_write(UA_Connection *connection, UA_ByteString *buf) {
     } while(nWritten < buf->length);
 
     /* Free the buffer */
-    UA_ByteString_deleteMembers(buf);
+    connection->releaseSendBuffer(connection, buf);
     return UA_STATUSCODE_GOOD;
 }
 
+/* Listen on the socket for the given timeout until a message arrives */
 static UA_StatusCode
-connection_recv(UA_Connection *connection, UA_ByteString *response,
-                UA_UInt32 timeout) {
-    if(connection->state == UA_CONNECTION_CLOSED)
-        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-
-    /* Listen on the socket for the given timeout until a message arrives */
-    if(timeout > 0) {
-        fd_set fdset;
-        FD_ZERO(&fdset);
-        UA_fd_set(connection->sockfd, &fdset);
-        UA_UInt32 timeout_usec = timeout * 1000;
-        struct timeval tmptv = {(long int)(timeout_usec / 1000000),
-                                (long int)(timeout_usec % 1000000)};
-        int resultsize = UA_select(connection->sockfd+1, &fdset, NULL,
-                                NULL, &tmptv);
-
-        /* No result */
-        if(resultsize == 0)
+connection_wait(UA_Connection *connection, UA_UInt32 timeout) {
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(connection->sockfd, &fdset);
+    UA_UInt32 timeout_usec = timeout * 1000;
+    struct timeval tmptv = {(long int)(timeout_usec / 1000000),
+                            (long int)(timeout_usec % 1000000)};
+    int resultsize = UA_select(connection->sockfd+1, &fdset, NULL,
+                            NULL, &tmptv);
+
+    /* No result */
+    if(resultsize == 0)
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+
+    if(resultsize == -1) {
+        /* The call to select was interrupted manually. Act as if it timed
+         * out */
+        if(errno == EINTR)
             return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
 
-        if(resultsize == -1) {
-            /* The call to select was interrupted manually. Act as if it timed
-             * out */
-            if(errno == EINTR)
-                return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
-
-            /* The error cannot be recovered. Close the connection. */
-            connection->close(connection);
-            return UA_STATUSCODE_BADCONNECTIONCLOSED;
-        }
-    }
-
-    response->data = (UA_Byte*)
-        UA_malloc(connection->localConf.recvBufferSize);
-    if(!response->data) {
-        response->length = 0;
-        return UA_STATUSCODE_BADOUTOFMEMORY; /* not enough memory retry */
+        /* The error cannot be recovered. Close the connection. */
+        connection->close(connection);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
     }
+    return UA_STATUSCODE_GOOD;
+}
 
+/* Receive into the allocated buffer. The buffer length is set to the number of
+ * received bytes. A length of zero means that no data was available. The
+ * buffer is not freed by this function. */
+static UA_StatusCode
+connection_recvBuffer(UA_Connection *connection, UA_ByteString *buf,
+                      UA_UInt32 timeout) {
     /* Get the received packet(s) */
-    ssize_t ret = UA_recv(connection->sockfd, (char*)response->data,
-                       connection->localConf.recvBufferSize, 0);
+    ssize_t ret = UA_recv(connection->sockfd, (char*)buf->data,
+                       buf->length, 0);
 
     /* The remote side closed the connection */
     if(ret == 0) {
-        UA_ByteString_deleteMembers(response);
+        buf->length = 0;
         connection->close(connection);
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
     }
 
     /* Error case */
     if(ret < 0) {
-        UA_ByteString_deleteMembers(response);
+        buf->length = 0;
         if(UA_ERRNO == UA_INTERRUPTED || (timeout > 0) ?
            false : (UA_ERRNO == UA_EAGAIN || UA_ERRNO == UA_WOULDBLOCK))
             return UA_STATUSCODE_GOOD; /* statuscode_good but no data -> retry */
@@ -139,10 +142,95 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
     }
 
     /* Set the length of the received buffer */
-    response->length = (size_t)ret;
+    buf->length = (size_t)ret;
     return UA_STATUSCODE_GOOD;
 }
 
+#if defined(UA_sendmsg)
+
+#define MAXSENDIOVECS 16 /* buffers handed to a single call of sendmsg */
+
+/* Send all buffers with scatter-gather I/O. Partially sent buffers are
+ * continued in the next call. */
+static UA_StatusCode
+connection_writeBatch(UA_Connection *connection, UA_ByteString *bufs,
+                      size_t bufsSize) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(connection->state == UA_CONNECTION_CLOSED) {
+        retval = UA_STATUSCODE_BADCONNECTIONCLOSED;
+        goto cleanup;
+    }
+
+    size_t current = 0; /* The first buffer that is not completely sent */
+    size_t offset = 0;  /* Bytes already sent from the current buffer */
+    while(current < bufsSize) {
+        struct iovec iov[MAXSENDIOVECS];
+        size_t iovSize = 0;
+        for(size_t i = current; i < bufsSize && iovSize < MAXSENDIOVECS; i++) {
+            size_t skip = (i == current) ? offset : 0;
+            iov[iovSize].iov_base = (void*)&bufs[i].data[skip];
+            iov[iovSize].iov_len = bufs[i].length - skip;
+            iovSize++;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(struct msghdr));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovSize;
+
+        /* Prevent OS signals when sending to a closed socket */
+        ssize_t n = UA_sendmsg(connection->sockfd, &msg, MSG_NOSIGNAL);
+        if(n < 0) {
+            if(UA_ERRNO == UA_INTERRUPTED || UA_ERRNO == UA_AGAIN)
+                continue;
+            connection->close(connection);
+            retval = UA_STATUSCODE_BADCONNECTIONCLOSED;
+            break;
+        }
+
+        /* Forward to the first buffer with unsent data */
+        size_t sent = (size_t)n;
+        while(current < bufsSize && sent >= bufs[current].length - offset) {
+            sent -= bufs[current].length - offset;
+            offset = 0;
+            current++;
+        }
+        offset += sent;
+    }
+
+ cleanup:
+    for(size_t i = 0; i < bufsSize; i++)
+        connection->releaseSendBuffer(connection, &bufs[i]);
+    return retval;
+}
+
+#endif
+
+static UA_StatusCode
+connection_recv(UA_Connection *connection, UA_ByteString *response,
+                UA_UInt32 timeout) {
+    if(connection->state == UA_CONNECTION_CLOSED)
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    if(timeout > 0) {
+        UA_StatusCode retval = connection_wait(connection, timeout);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+
+    response->data = (UA_Byte*)
+        UA_malloc(connection->localConf.recvBufferSize);
+    if(!response->data) {
+        response->length = 0;
+        return UA_STATUSCODE_BADOUTOFMEMORY; /* not enough memory retry */
+    }
+    response->length = connection->localConf.recvBufferSize;
+
+    UA_StatusCode retval = connection_recvBuffer(connection, response, timeout);
+    if(retval != UA_STATUSCODE_GOOD || response->length == 0)
+        UA_ByteString_deleteMembers(response);
+    return retval;
+}
 
 /***************************/
 /* Server NetworkLayer TCP */
@@ -151,10 +239,131 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
 #define MAXBACKLOG     100
 #define NOHELLOTIMEOUT 120000 /* timeout in ms before close the connection
                                * if server does not receive Hello Message */
+#define MAXEPOLLEVENTS 64 /* events fetched with a single call to epoll_wait */
+#define MAXPOOLEDBUFFERS 32 /* idle buffers kept in the buffer pool */
+
+/* Buffer Pool
+ * -----------
+ * Send and receive buffers of the server connections are taken from a pool of
+ * fixed-size slabs. The slab size is the maximum of the send and receive buffer
+ * size of the network layer configuration. The negotiated buffer sizes of a
+ * connection can only be smaller. Every buffer is prefixed with a header, so
+ * that buffers allocated outside of the pool (e.g. because they are larger than
+ * a slab) can be recognized when they are released. */
+
+typedef struct PooledBuffer {
+    SLIST_ENTRY(PooledBuffer) next; /* Only used while in the pool */
+    UA_Boolean isSlab; /* Can be returned to the pool */
+} PooledBuffer;
+
+/* Keep the buffer data aligned */
+#define POOLEDBUFFER_HEADERSIZE ((sizeof(PooledBuffer) + 15) & ~(size_t)15)
+
+typedef struct {
+    SLIST_HEAD(, PooledBuffer) buffers;
+    size_t slabSize;
+    size_t buffersSize; /* Number of idle buffers in the pool */
+    UA_BufferPoolStatistics stats;
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_t mutex;
+#endif
+} BufferPool;
+
+#ifdef UA_ENABLE_MULTITHREADING
+#define BEGIN_CRITSECT(POOL) pthread_mutex_lock(&(POOL)->mutex)
+#define END_CRITSECT(POOL) pthread_mutex_unlock(&(POOL)->mutex)
+#else
+#define BEGIN_CRITSECT(POOL)
+#define END_CRITSECT(POOL)
+#endif
+
+static void
+BufferPool_init(BufferPool *pool, const UA_ConnectionConfig *conf) {
+    SLIST_INIT(&pool->buffers);
+    pool->slabSize = conf->sendBufferSize;
+    if(conf->recvBufferSize > pool->slabSize)
+        pool->slabSize = conf->recvBufferSize;
+    pool->buffersSize = 0;
+    memset(&pool->stats, 0, sizeof(UA_BufferPoolStatistics));
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_init(&pool->mutex, NULL);
+#endif
+}
+
+static void
+BufferPool_deleteMembers(BufferPool *pool) {
+    PooledBuffer *b;
+    while((b = SLIST_FIRST(&pool->buffers))) {
+        SLIST_REMOVE_HEAD(&pool->buffers, next);
+        UA_free(b);
+    }
+    pool->buffersSize = 0;
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_destroy(&pool->mutex);
+#endif
+}
+
+static UA_StatusCode
+BufferPool_get(BufferPool *pool, size_t length, UA_ByteString *buf) {
+    PooledBuffer *b = NULL;
+    UA_Boolean isSlab = (length <= pool->slabSize);
+    BEGIN_CRITSECT(pool);
+    if(isSlab) {
+        b = SLIST_FIRST(&pool->buffers);
+        if(b) {
+            SLIST_REMOVE_HEAD(&pool->buffers, next);
+            pool->buffersSize--;
+            pool->stats.hits++;
+        }
+    }
+    if(!b)
+        pool->stats.misses++;
+    END_CRITSECT(pool);
+
+    if(!b) {
+        size_t allocSize = isSlab ? pool->slabSize : length;
+        b = (PooledBuffer*)UA_malloc(POOLEDBUFFER_HEADERSIZE + allocSize);
+        if(!b) {
+            *buf = UA_BYTESTRING_NULL;
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        b->isSlab = isSlab;
+    }
+
+    buf->data = (UA_Byte*)b + POOLEDBUFFER_HEADERSIZE;
+    buf->length = length;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+BufferPool_release(BufferPool *pool, UA_ByteString *buf) {
+    if(!buf->data)
+        return;
+    PooledBuffer *b = (PooledBuffer*)(buf->data - POOLEDBUFFER_HEADERSIZE);
+    *buf = UA_BYTESTRING_NULL;
+    if(b->isSlab) {
+        BEGIN_CRITSECT(pool);
+        if(pool->buffersSize < MAXPOOLEDBUFFERS) {
+            SLIST_INSERT_HEAD(&pool->buffers, b, next);
+            pool->buffersSize++;
+            b = NULL;
+        }
+        END_CRITSECT(pool);
+    }
+    UA_free(b);
+}
 
 typedef struct ConnectionEntry {
     UA_Connection connection;
     LIST_ENTRY(ConnectionEntry) pointers;
+#ifdef UA_ENABLE_EPOLL
+    /* Readiness tracking for the edge-triggered epoll layer. A connection stays
+     * in the ready list until recv reports that the socket is drained. */
+    TAILQ_ENTRY(ConnectionEntry) readyPointers;
+    TAILQ_ENTRY(ConnectionEntry) openingPointers;
+    UA_Boolean ready;
+    UA_Boolean opening;
+#endif
 } ConnectionEntry;
 
 typedef struct {
@@ -164,8 +373,68 @@ typedef struct {
     UA_SOCKET serverSockets[FD_SETSIZE];
     UA_UInt16 serverSocketsSize;
     LIST_HEAD(, ConnectionEntry) connections;
+    BufferPool bufferPool;
+#ifdef UA_ENABLE_EPOLL
+    int epollfd; /* -1 for the select-based network layer */
+    TAILQ_HEAD(, ConnectionEntry) readyConnections;
+    /* Connections waiting for the Hello message in the order of their
+     * creation. Only the head needs to be checked for the timeout. */
+    TAILQ_HEAD(, ConnectionEntry) openingConnections;
+#endif
 } ServerNetworkLayerTCP;
 
+#ifdef UA_ENABLE_EPOLL
+static void
+setConnectionReady(ServerNetworkLayerTCP *layer, ConnectionEntry *e) {
+    if(e->ready)
+        return;
+    TAILQ_INSERT_TAIL(&layer->readyConnections, e, readyPointers);
+    e->ready = true;
+}
+#endif
+
+static UA_StatusCode
+ServerNetworkLayerTCP_getSendBuffer(UA_Connection *connection,
+                                    size_t length, UA_ByteString *buf) {
+    if(length > connection->remoteConf.recvBufferSize)
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    return BufferPool_get(&layer->bufferPool, length, buf);
+}
+
+static void
+ServerNetworkLayerTCP_releaseBuffer(UA_Connection *connection,
+                                    UA_ByteString *buf) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    BufferPool_release(&layer->bufferPool, buf);
+}
+
+/* Same as connection_recv without waiting. But the buffer is taken from the
+ * pool of the network layer. */
+static UA_StatusCode
+ServerNetworkLayerTCP_recv(ServerNetworkLayerTCP *layer, UA_Connection *connection,
+                           UA_ByteString *buf, UA_Boolean *drained) {
+    if(connection->state == UA_CONNECTION_CLOSED)
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    UA_StatusCode retval = BufferPool_get(&layer->bufferPool,
+                                          connection->localConf.recvBufferSize, buf);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    retval = connection_recvBuffer(connection, buf, 0);
+
+    /* No data is returned for EINTR as well. Only EAGAIN means that all
+     * pending data was read. Check before the errno can change. */
+    if(drained)
+        *drained = (retval == UA_STATUSCODE_GOOD && buf->length == 0 &&
+                    (UA_ERRNO == UA_AGAIN || UA_ERRNO == UA_WOULDBLOCK));
+
+    if(retval != UA_STATUSCODE_GOOD || buf->length == 0)
+        BufferPool_release(&layer->bufferPool, buf);
+    return retval;
+}
+
 static void
 ServerNetworkLayerTCP_freeConnection(UA_Connection *connection) {
     UA_Connection_deleteMembers(connection);
@@ -180,6 +449,13 @@ ServerNetworkLayerTCP_close(UA_Connection *connection) {
         return;
     UA_shutdown((UA_SOCKET)connection->sockfd, 2);
     connection->state = UA_CONNECTION_CLOSED;
+#ifdef UA_ENABLE_EPOLL
+    /* An edge-triggered event for the shutdown might have been consumed
+     * already. Schedule the connection to be picked up by the next listen. */
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    if(layer->epollfd >= 0)
+        setConnectionReady(layer, (ConnectionEntry*)connection);
+#endif
 }
 
 static UA_StatusCode
@@ -235,19 +511,61 @@ ServerNetworkLayerTCP_add(ServerNetworkLayerTCP *layer, UA_Int32 newsockfd,
     c->localConf = layer->conf;
     c->remoteConf = layer->conf;
     c->send = connection_write;
+#if defined(UA_sendmsg)
+    c->sendBatch = connection_writeBatch;
+#endif
     c->close = ServerNetworkLayerTCP_close;
     c->free = ServerNetworkLayerTCP_freeConnection;
-    c->getSendBuffer = connection_getsendbuffer;
-    c->releaseSendBuffer = connection_releasesendbuffer;
-    c->releaseRecvBuffer = connection_releaserecvbuffer;
+    c->getSendBuffer = ServerNetworkLayerTCP_getSendBuffer;
+    c->releaseSendBuffer = ServerNetworkLayerTCP_releaseBuffer;
+    c->releaseRecvBuffer = ServerNetworkLayerTCP_releaseBuffer;
     c->state = UA_CONNECTION_OPENING;
     c->openingDate = UA_DateTime_nowMonotonic();
 
+#ifdef UA_ENABLE_EPOLL
+    if(layer->epollfd >= 0) {
+        e->ready = false;
+        e->opening = true;
+        struct epoll_event event;
+        memset(&event, 0, sizeof(struct epoll_event));
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = e;
+        if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, newsockfd, &event) != 0) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK,
+                             "Connection %i | Cannot add the socket to epoll. "
+                             "Error: %s", (int)newsockfd, errno_str));
+            UA_close(newsockfd);
+            UA_free(e);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        TAILQ_INSERT_TAIL(&layer->openingConnections, e, openingPointers);
+    }
+#endif
+
     /* Add to the linked list */
     LIST_INSERT_HEAD(&layer->connections, e, pointers);
     return UA_STATUSCODE_GOOD;
 }
 
+/* Returns false if no pending connection could be accepted */
+static UA_Boolean
+ServerNetworkLayerTCP_accept(ServerNetworkLayerTCP *layer, UA_SOCKET serverSocket) {
+    struct sockaddr_storage remote;
+    socklen_t remote_size = sizeof(remote);
+    UA_SOCKET newsockfd = UA_accept(serverSocket,
+                                    (struct sockaddr*)&remote, &remote_size);
+    if(newsockfd == UA_INVALID_SOCKET)
+        return false;
+
+    UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
+                 "Connection %i | New TCP connection on server socket %i",
+                 (int)newsockfd, serverSocket);
+
+    ServerNetworkLayerTCP_add(layer, (UA_Int32)newsockfd, &remote);
+    return true;
+}
+
 static void
 addServerSocket(ServerNetworkLayerTCP *layer, struct addrinfo *ai) {
     /* Create the server socket */
@@ -320,8 +638,8 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
 
     /* Get the discovery url from the hostname */
     UA_String du = UA_STRING_NULL;
+    char discoveryUrl[256];
     if (customHostname->length) {
-        char discoveryUrl[256];
         du.length = (size_t)UA_snprintf(discoveryUrl, 255, "opc.tcp://%.*s:%d/",
                                      (int)customHostname->length,
                                      customHostname->data,
@@ -330,7 +648,6 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
     }else{
         char hostname[256];
         if(UA_gethostname(hostname, 255) == 0) {
-            char discoveryUrl[256];
             du.length = (size_t)UA_snprintf(discoveryUrl, 255, "opc.tcp://%s:%d/",
                                          hostname, layer->port);
             du.data = (UA_Byte*)discoveryUrl;
@@ -338,6 +655,8 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
             UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK, "Could not get the hostname");
         }
     }
+    /* The url of a previous start is replaced */
+    UA_String_deleteMembers(&nl->discoveryUrl);
     UA_String_copy(&du, &nl->discoveryUrl);
 
     /* Get addrinfo of the server and create server sockets */
@@ -361,6 +680,26 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
         addServerSocket(layer, ai);
     UA_freeaddrinfo(res);
 
+#ifdef UA_ENABLE_EPOLL
+    /* Server sockets are registered without a connection pointer. An event
+     * with a NULL pointer accepts on all server sockets. */
+    if(layer->epollfd >= 0) {
+        for(UA_UInt16 i = 0; i < layer->serverSocketsSize; i++) {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(struct epoll_event));
+            event.events = EPOLLIN | EPOLLET;
+            event.data.ptr = NULL;
+            if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD,
+                         layer->serverSockets[i], &event) != 0) {
+                UA_LOG_SOCKET_ERRNO_WRAP(
+                    UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
+                                   "Cannot add the server socket to epoll. "
+                                   "Error: %s", errno_str));
+            }
+        }
+    }
+#endif
+
     UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
                 "TCP network layer listening on %.*s",
                 (int)nl->discoveryUrl.length, nl->discoveryUrl.data);
@@ -414,19 +753,7 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
     for(UA_UInt16 i = 0; i < layer->serverSocketsSize; i++) {
         if(!UA_fd_isset(layer->serverSockets[i], &fdset))
             continue;
-
-        struct sockaddr_storage remote;
-        socklen_t remote_size = sizeof(remote);
-        UA_SOCKET newsockfd = UA_accept((UA_SOCKET)layer->serverSockets[i],
-                                  (struct sockaddr*)&remote, &remote_size);
-        if(newsockfd == UA_INVALID_SOCKET)
-            continue;
-
-        UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
-                    "Connection %i | New TCP connection on server socket %i",
-                    (int)newsockfd, layer->serverSockets[i]);
-
-        ServerNetworkLayerTCP_add(layer, (UA_Int32)newsockfd, &remote);
+        ServerNetworkLayerTCP_accept(layer, layer->serverSockets[i]);
     }
 
     /* Read from established sockets */
@@ -453,12 +780,12 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
                     e->connection.sockfd);
 
         UA_ByteString buf = UA_BYTESTRING_NULL;
-        UA_StatusCode retval = connection_recv(&e->connection, &buf, 0);
+        UA_StatusCode retval = ServerNetworkLayerTCP_recv(layer, &e->connection, &buf, NULL);
 
         if(retval == UA_STATUSCODE_GOOD) {
             /* Process packets */
             UA_Server_processBinaryMessage(server, &e->connection, &buf);
-            connection_releaserecvbuffer(&e->connection, &buf);
+            ServerNetworkLayerTCP_releaseBuffer(&e->connection, &buf);
         } else if(retval == UA_STATUSCODE_BADCONNECTIONCLOSED) {
             /* The socket is shutdown but not closed */
             UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
@@ -472,6 +799,114 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
     return UA_STATUSCODE_GOOD;
 }
 
+#ifdef UA_ENABLE_EPOLL
+
+static void
+ServerNetworkLayerTCP_removeEpoll(ServerNetworkLayerTCP *layer, UA_Server *server,
+                                  ConnectionEntry *e) {
+    LIST_REMOVE(e, pointers);
+    if(e->ready)
+        TAILQ_REMOVE(&layer->readyConnections, e, readyPointers);
+    if(e->opening)
+        TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+    /* Closing the socket also removes it from the epoll set */
+    UA_close(e->connection.sockfd);
+    UA_Server_removeConnection(server, &e->connection);
+}
+
+/* Only the sockets reported by epoll and those that were not drained in a
+ * previous iteration are touched. Every ready connection is read once per
+ * iteration, so that a busy connection cannot starve the others. */
+static UA_StatusCode
+ServerNetworkLayerTCP_listenEpoll(UA_ServerNetworkLayer *nl, UA_Server *server,
+                                  UA_UInt16 timeout) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+
+    /* Don't wait if some connections still have pending data */
+    int epollTimeout = (int)timeout;
+    if(!TAILQ_EMPTY(&layer->readyConnections))
+        epollTimeout = 0;
+
+    struct epoll_event events[MAXEPOLLEVENTS];
+    int nfds = epoll_wait(layer->epollfd, events, MAXEPOLLEVENTS, epollTimeout);
+    if(nfds < 0) {
+        if(UA_ERRNO != UA_INTERRUPTED) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
+                               "Socket epoll_wait failed with %s", errno_str));
+        }
+        /* we will retry, so do not return bad */
+        nfds = 0;
+    }
+
+    for(int i = 0; i < nfds; i++) {
+        ConnectionEntry *e = (ConnectionEntry*)events[i].data.ptr;
+        if(e) {
+            setConnectionReady(layer, e);
+            continue;
+        }
+
+        /* Accept new connections via the server sockets. The events are
+         * edge-triggered. So all pending connections need to be accepted. */
+        for(UA_UInt16 j = 0; j < layer->serverSocketsSize; j++) {
+            while(ServerNetworkLayerTCP_accept(layer, layer->serverSockets[j])) {}
+        }
+    }
+
+    /* Close connections that did not send a Hello message in time */
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    ConnectionEntry *e, *e_tmp;
+    while((e = TAILQ_FIRST(&layer->openingConnections))) {
+        if(e->connection.state == UA_CONNECTION_OPENING &&
+           now <= e->connection.openingDate + (NOHELLOTIMEOUT * UA_DATETIME_MSEC))
+            break;
+        TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+        e->opening = false;
+        if(e->connection.state != UA_CONNECTION_OPENING)
+            continue;
+        UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
+                    "Connection %i | Closed by the server (no Hello Message)",
+                    e->connection.sockfd);
+        ServerNetworkLayerTCP_removeEpoll(layer, server, e);
+    }
+
+    /* Read from the ready sockets */
+    TAILQ_FOREACH_SAFE(e, &layer->readyConnections, readyPointers, e_tmp) {
+        UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
+                     "Connection %i | Activity on the socket",
+                     e->connection.sockfd);
+
+        UA_ByteString buf = UA_BYTESTRING_NULL;
+        UA_Boolean drained = false;
+        UA_StatusCode retval = ServerNetworkLayerTCP_recv(layer, &e->connection,
+                                                          &buf, &drained);
+
+        if(retval == UA_STATUSCODE_GOOD) {
+            if(drained) {
+                /* The socket is drained. Wait for the next edge. */
+                TAILQ_REMOVE(&layer->readyConnections, e, readyPointers);
+                e->ready = false;
+                continue;
+            }
+            /* Interrupted. Retry in the next iteration. */
+            if(buf.length == 0)
+                continue;
+            /* Process packets */
+            UA_Server_processBinaryMessage(server, &e->connection, &buf);
+            ServerNetworkLayerTCP_releaseBuffer(&e->connection, &buf);
+        } else if(retval == UA_STATUSCODE_BADCONNECTIONCLOSED) {
+            /* The socket is shutdown but not closed */
+            UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
+                        "Connection %i | Closed",
+                        e->connection.sockfd);
+            ServerNetworkLayerTCP_removeEpoll(layer, server, e);
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* UA_ENABLE_EPOLL */
+
 static void
 ServerNetworkLayerTCP_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
     ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
@@ -492,7 +927,7 @@ ServerNetworkLayerTCP_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
 
     /* Run recv on client sockets. This picks up the closed sockets and frees
      * the connection. */
-    ServerNetworkLayerTCP_listen(nl, server, 0);
+    nl->listen(nl, server, 0);
 
     UA_deinitialize_architecture_network();
 }
@@ -512,6 +947,13 @@ ServerNetworkLayerTCP_deleteMembers(UA_ServerNetworkLayer *nl) {
         UA_free(e);
     }
 
+#ifdef UA_ENABLE_EPOLL
+    if(layer->epollfd >= 0)
+        UA_close(layer->epollfd);
+#endif
+
+    BufferPool_deleteMembers(&layer->bufferPool);
+
     /* Free the layer */
     UA_free(layer);
 }
@@ -528,6 +970,12 @@ UA_ServerNetworkLayerTCP(UA_ConnectionConfig conf, UA_UInt16 port, UA_Logger log
     layer->logger = (logger != NULL ? logger : UA_Log_Stdout);
     layer->conf = conf;
     layer->port = port;
+    BufferPool_init(&layer->bufferPool, &conf);
+#ifdef UA_ENABLE_EPOLL
+    layer->epollfd = -1;
+    TAILQ_INIT(&layer->readyConnections);
+    TAILQ_INIT(&layer->openingConnections);
+#endif
 
     nl.handle = layer;
     nl.start = ServerNetworkLayerTCP_start;
@@ -537,6 +985,40 @@ UA_ServerNetworkLayerTCP(UA_ConnectionConfig conf, UA_UInt16 port, UA_Logger log
     return nl;
 }
 
+void
+UA_ServerNetworkLayerTCP_getBufferPoolStatistics(UA_ServerNetworkLayer *nl,
+                                                 UA_BufferPoolStatistics *stats) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    BEGIN_CRITSECT(&layer->bufferPool);
+    *stats = layer->bufferPool.stats;
+    stats->pooled = layer->bufferPool.buffersSize;
+    END_CRITSECT(&layer->bufferPool);
+}
+
+#ifdef UA_ENABLE_EPOLL
+UA_ServerNetworkLayer
+UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig conf, UA_UInt16 port, UA_Logger logger) {
+    UA_ServerNetworkLayer nl = UA_ServerNetworkLayerTCP(conf, port, logger);
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)nl.handle;
+    if(!layer)
+        return nl;
+
+    layer->epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(layer->epollfd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK,
+                         "Cannot create the epoll instance. Error: %s", errno_str));
+        BufferPool_deleteMembers(&layer->bufferPool);
+        UA_free(layer);
+        memset(&nl, 0, sizeof(UA_ServerNetworkLayer));
+        return nl;
+    }
+
+    nl.listen = ServerNetworkLayerTCP_listenEpoll;
+    return nl;
+}
+#endif
+
 typedef struct TCPClientConnection {
 	struct addrinfo hints, *server;
 	UA_DateTime connStart;
@@ -732,6 +1214,9 @@ UA_Connection UA_ClientConnectionTCP_init(UA_ConnectionConfig conf,
     connection.localConf = conf;
     connection.remoteConf = conf;
     connection.send = connection_write;
+#if defined(UA_sendmsg)
+    connection.sendBatch = connection_writeBatch;
+#endif
     connection.recv = connection_recv;
     connection.close = ClientNetworkLayerTCP_close;
     connection.free = ClientNetworkLayerTCP_free;
@@ -798,6 +1283,9 @@ UA_ClientConnectionTCP(UA_ConnectionConfig conf,
     connection.localConf = conf;
     connection.remoteConf = conf;
     connection.send = connection_write;
+#if defined(UA_sendmsg)
+    connection.sendBatch = connection_writeBatch;
+#endif
     connection.recv = connection_recv;
     connection.close = ClientNetworkLayerTCP_close;
     connection.free = ClientNetworkLayerTCP_free;
@@ -18,6 +18,28 @@ extern "C" {
 UA_ServerNetworkLayer UA_EXPORT
 UA_ServerNetworkLayerTCP(UA_ConnectionConfig conf, UA_UInt16 port, UA_Logger logger);
 
+/* The send and receive buffers of the server connections are taken from a
+ * per-network-layer pool of fixed-size slabs. */
+typedef struct {
+    size_t hits;   /* Buffers taken from the pool */
+    size_t misses; /* Buffers that had to be allocated */
+    size_t pooled; /* Idle buffers currently held in the pool */
+} UA_BufferPoolStatistics;
+
+/* Only for network layers created with UA_ServerNetworkLayerTCP or
+ * UA_ServerNetworkLayerTCPEpoll */
+void UA_EXPORT
+UA_ServerNetworkLayerTCP_getBufferPoolStatistics(UA_ServerNetworkLayer *nl,
+                                                 UA_BufferPoolStatistics *stats);
+
+#ifdef UA_ENABLE_EPOLL
+/* Same as UA_ServerNetworkLayerTCP, but uses edge-triggered epoll instead of
+ * select. Only the sockets with activity are touched in every iteration and
+ * the number of connections is not limited by FD_SETSIZE. */
+UA_ServerNetworkLayer UA_EXPORT
+UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig conf, UA_UInt16 port, UA_Logger logger);
+#endif
+
 UA_Connection UA_EXPORT
 UA_ClientConnectionTCP(UA_ConnectionConfig conf, const char *endpointUrl, const UA_UInt32 timeout,
                        UA_Logger logger);
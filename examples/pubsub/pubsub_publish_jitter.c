@@ -0,0 +1,160 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measures the jitter of the PubSub publish cycle. A WriterGroup publishes one
+ * field over UDP multicast. The field is a DataSource variable that records the
+ * (monotonic) time when it is sampled during the publish callback. After the
+ * given number of cycles, the deviations from the publishing interval are
+ * printed.
+ *
+ * Usage: pubsub_publish_jitter [interval in ms (default 0.25)] [cycles (default 10000)] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "open62541.h"
+
+static UA_Duration publishingInterval = 0.25;
+static size_t cycles = 10000;
+
+static size_t samples = 0;
+static UA_DateTime lastSample = 0;
+static UA_Double minDeviation = 0.0, maxDeviation = 0.0;
+static UA_Double sumDeviation = 0.0, sumSquaredDeviation = 0.0;
+
+static UA_StatusCode
+readSampleTime(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+               const UA_NodeId *nodeId, void *nodeContext, UA_Boolean sourceTimeStamp,
+               const UA_NumericRange *range, UA_DataValue *value) {
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if(lastSample != 0) {
+        /* Deviation from the publishing interval in microseconds */
+        UA_Double deviation = ((UA_Double)(now - lastSample) / UA_DATETIME_USEC) -
+            (publishingInterval * 1000.0);
+        if(samples == 0 || deviation < minDeviation)
+            minDeviation = deviation;
+        if(samples == 0 || deviation > maxDeviation)
+            maxDeviation = deviation;
+        sumDeviation += deviation;
+        sumSquaredDeviation += deviation * deviation;
+        samples++;
+    }
+    lastSample = now;
+
+    UA_Variant_setScalarCopy(&value->value, &now, &UA_TYPES[UA_TYPES_DATETIME]);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addSampleTimeVariable(UA_Server *server, UA_NodeId *nodeId) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "sample time");
+    attr.dataType = UA_TYPES[UA_TYPES_DATETIME].typeId;
+    UA_DataSource dataSource;
+    dataSource.read = readSampleTime;
+    dataSource.write = NULL;
+    UA_Server_addDataSourceVariableNode(server, UA_NODEID_NUMERIC(1, 1000),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                        UA_QUALIFIEDNAME(1, "sample time"),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                        attr, dataSource, NULL, nodeId);
+}
+
+static UA_StatusCode
+addPublisher(UA_Server *server, const UA_NodeId *variable) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherId.numeric = UA_UInt32_random();
+    UA_NodeId connectionIdent;
+    UA_StatusCode retval = UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdent);
+
+    UA_PublishedDataSetConfig publishedDataSetConfig;
+    memset(&publishedDataSetConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    publishedDataSetConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    publishedDataSetConfig.name = UA_STRING("Jitter PDS");
+    UA_NodeId publishedDataSetIdent;
+    retval |= UA_Server_addPublishedDataSet(server, &publishedDataSetConfig,
+                                            &publishedDataSetIdent).addResult;
+
+    UA_DataSetFieldConfig dataSetFieldConfig;
+    memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("sample time");
+    dataSetFieldConfig.field.variable.publishParameters.publishedVariable = *variable;
+    dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_NodeId dataSetFieldIdent;
+    retval |= UA_Server_addDataSetField(server, publishedDataSetIdent, &dataSetFieldConfig,
+                                        &dataSetFieldIdent).result;
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Jitter WriterGroup");
+    writerGroupConfig.publishingInterval = publishingInterval;
+    writerGroupConfig.enabled = UA_FALSE;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_NodeId writerGroupIdent;
+    retval |= UA_Server_addWriterGroup(server, connectionIdent, &writerGroupConfig,
+                                       &writerGroupIdent);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Jitter DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    dataSetWriterConfig.keyFrameCount = 10;
+    UA_NodeId dataSetWriterIdent;
+    retval |= UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                         &dataSetWriterConfig, &dataSetWriterIdent);
+    return retval;
+}
+
+int main(int argc, char **argv) {
+    if(argc > 1)
+        publishingInterval = atof(argv[1]);
+    if(argc > 2)
+        cycles = (size_t)atol(argv[2]);
+
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    config->pubsubTransportLayers = (UA_PubSubTransportLayer *)
+        UA_malloc(sizeof(UA_PubSubTransportLayer));
+    if(!config->pubsubTransportLayers) {
+        UA_ServerConfig_delete(config);
+        return EXIT_FAILURE;
+    }
+    config->pubsubTransportLayers[0] = UA_PubSubTransportLayerUDPMP();
+    config->pubsubTransportLayersSize++;
+    UA_Server *server = UA_Server_new(config);
+
+    UA_NodeId variable;
+    addSampleTimeVariable(server, &variable);
+    UA_StatusCode retval = addPublisher(server, &variable);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND,
+                     "Could not set up the publisher: %s", UA_StatusCode_name(retval));
+    } else {
+        UA_Server_run_startup(server);
+        while(samples < cycles)
+            UA_Server_run_iterate(server, true);
+        UA_Server_run_shutdown(server);
+
+        UA_Double mean = sumDeviation / (UA_Double)samples;
+        UA_Double stddev = sqrt(sumSquaredDeviation / (UA_Double)samples - mean * mean);
+        printf("interval %.3f ms, %lu cycles\n", publishingInterval, (unsigned long)samples);
+        printf("deviation [us]: min %.1f, max %.1f, mean %.1f, stddev %.1f\n",
+               minDeviation, maxDeviation, mean, stddev);
+    }
+
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+    return retval == UA_STATUSCODE_GOOD ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Starts a server from a snapshot of its address space. The snapshot file is
+ * memory-mapped. So namespace zero (and the nodesets contained in the
+ * snapshot) are not created at startup. Nodes are only decoded from the
+ * snapshot when they are first used.
+ *
+ * Usage: server_snapshot write <file>  Write the snapshot of a fresh server
+ *        server_snapshot <file>        Run the server from the snapshot */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "open62541.h"
+
+UA_Boolean running = true;
+static void stopHandler(int sig) {
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "received ctrl-c");
+    running = false;
+}
+
+/* Add the nodesets here. E.g. call the functions generated by the nodeset
+ * compiler. */
+static UA_StatusCode
+writeSnapshot(const char *path) {
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    UA_Server *server = UA_Server_new(config);
+    UA_ByteString snapshot;
+    UA_StatusCode retval = UA_Nodestore_snapshot_encode(&config->nodestore, &snapshot);
+    if(retval == UA_STATUSCODE_GOOD) {
+        FILE *f = fopen(path, "wb");
+        if(!f || fwrite(snapshot.data, 1, snapshot.length, f) != snapshot.length)
+            retval = UA_STATUSCODE_BADINTERNALERROR;
+        if(f)
+            fclose(f);
+        UA_ByteString_deleteMembers(&snapshot);
+    }
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+    return retval;
+}
+
+static UA_StatusCode
+runFromSnapshot(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return UA_STATUSCODE_BADNOTFOUND;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    UA_ByteString snapshot;
+    snapshot.length = (size_t)st.st_size;
+    snapshot.data = (UA_Byte*)mmap(NULL, snapshot.length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(snapshot.data == MAP_FAILED)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Nodes added or edited at runtime are kept in the default nodestore */
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    UA_Nodestore overlay = config->nodestore;
+    UA_StatusCode retval = UA_Nodestore_snapshot_new(&config->nodestore, &snapshot, &overlay);
+    if(retval == UA_STATUSCODE_GOOD) {
+        UA_Server *server = UA_Server_new(config);
+        if(server) {
+            retval = UA_Server_run(server, &running);
+            UA_Server_delete(server);
+        } else {
+            retval = UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+    UA_ServerConfig_delete(config);
+    munmap(snapshot.data, snapshot.length);
+    return retval;
+}
+
+int main(int argc, char **argv) {
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+
+    UA_StatusCode retval;
+    if(argc == 3 && strcmp(argv[1], "write") == 0) {
+        retval = writeSnapshot(argv[2]);
+    } else if(argc == 2) {
+        retval = runFromSnapshot(argv[1]);
+    } else {
+        printf("Usage: %s [write] <snapshot file>\n", argv[0]);
+        return 1;
+    }
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND,
+                     "Failed with %s", UA_StatusCode_name(retval));
+    return (int)retval;
+}
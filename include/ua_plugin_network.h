@@ -89,6 +89,18 @@ struct UA_Connection {
      * @return Returns an error code or UA_STATUSCODE_GOOD. */
     UA_StatusCode (*send)(UA_Connection *connection, UA_ByteString *buf);
 
+    /* Sends several message buffers in order with as few system calls as
+     * possible (e.g. with a single writev). All buffers are always freed, even
+     * if sending fails. This is optional and can be NULL. Then the buffers are
+     * sent one by one with the send function.
+     *
+     * @param connection The connection
+     * @param bufs The array of message buffers
+     * @param bufsSize The number of message buffers
+     * @return Returns an error code or UA_STATUSCODE_GOOD. */
+    UA_StatusCode (*sendBatch)(UA_Connection *connection, UA_ByteString *bufs,
+                               size_t bufsSize);
+
     /* Receive a message from the remote connection
      *
      * @param connection The connection
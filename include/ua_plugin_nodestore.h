@@ -68,12 +68,21 @@ struct UA_MonitoredItem;
  * not known or not important. The ``nodeClass`` attribute is used to ensure the
  * correctness of casting from ``UA_Node`` to a specific node type. */
 
-/* List of reference targets with the same reference type and direction */
+/* List of reference targets with the same reference type and direction. Long
+ * lists of targets get a hash index over the target NodeIds. The index is
+ * maintained by the UA_Node_addReference/deleteReference methods. Edit the
+ * targets only through these methods. */
 typedef struct {
     UA_NodeId referenceTypeId;
     UA_Boolean isInverse;
     size_t targetIdsSize;
     UA_ExpandedNodeId *targetIds;
+
+    /* Members specific to open62541 */
+    size_t targetIdsCapacity;  /* Allocated length of targetIds. Can be smaller
+                                * than targetIdsSize if unknown. */
+    size_t targetIdsIndexSize; /* Zero or a power of two */
+    UA_UInt32 *targetIdsIndex; /* Position in targetIds + 1. Zero if empty. */
 } UA_NodeReferenceKind;
 
 #define UA_NODE_BASEATTRIBUTES                  \
@@ -179,6 +188,8 @@ typedef enum {
         struct {                                                        \
             UA_DataValue value;                                         \
             UA_ValueCallback callback;                                  \
+            /* Scalars of small pointer-free types point in here */     \
+            UA_UInt64 inlineValue[2];                                   \
         } data;                                                         \
         UA_DataSource dataSource;                                       \
     } value;
@@ -466,6 +477,14 @@ typedef struct {
 
     void (*releaseNode)(void *nodestoreContext, const UA_Node *node);
 
+    /* Optional. Gets the node again without a lookup, while the caller still
+     * holds it. Returns NULL if the node was replaced or removed in the
+     * meantime. Nodes obtained this way can be held across requests and
+     * released from any thread. The server uses this to keep the nodes of
+     * registered NodeIds (see the RegisterNodes service). Set to NULL if the
+     * nodestore does not support this. */
+    const UA_Node * (*retainNode)(void *nodestoreContext, const UA_Node *node);
+
     /* Returns an editable copy of a node (needs to be deleted with the
      * deleteNode function or inserted / replaced into the nodestore). */
     UA_StatusCode (*getNodeCopy)(void *nodestoreContext, const UA_NodeId *nodeId,
@@ -521,10 +540,24 @@ UA_Node_addReference(UA_Node *node, const UA_AddReferencesItem *item);
 UA_StatusCode UA_EXPORT
 UA_Node_deleteReference(UA_Node *node, const UA_DeleteReferencesItem *item);
 
+/* Returns the target with the NodeId or NULL. Uses the index of the reference
+ * targets if present. */
+UA_EXPORT const UA_ExpandedNodeId *
+UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
+                                const UA_NodeId *targetId);
+
 /* Delete all references of the node */
 void UA_EXPORT
 UA_Node_deleteReferences(UA_Node *node);
 
+/* Move a scalar value of a small pointer-free type (e.g. numbers, DateTime,
+ * Guid) from the heap into the inline storage of the node. The variant then
+ * points into the node with storageType UA_VARIANT_DATA_NODELETE. Other values
+ * are left untouched. Nodestores call this after setting the value of a node
+ * directly. */
+void UA_EXPORT
+UA_VariableNode_inlineValue(UA_VariableNode *node);
+
 /* Remove all malloc'ed members of the node */
 void UA_EXPORT
 UA_Node_deleteMembers(UA_Node *node);
@@ -441,6 +441,13 @@ UA_Server_browseSimplifiedBrowsePath(UA_Server *server, const UA_NodeId origin,
                                      size_t browsePathSize,
                                      const UA_QualifiedName *browsePath);
 
+/* The results of TranslateBrowsePathsToNodeIds are cached in the server (see
+ * ``browsePathCacheSize`` in the server configuration). Returns the number of
+ * lookups that were answered from the cache and the number of lookups that had
+ * to walk the address space since the server was created. */
+void UA_EXPORT
+UA_Server_getPathCacheStatistics(UA_Server *server, size_t *hits, size_t *misses);
+
 #ifndef HAVE_NODEITER_CALLBACK
 #define HAVE_NODEITER_CALLBACK
 /* Iterate over all nodes referenced by parentNodeId by calling the callback
@@ -1171,6 +1178,30 @@ UA_Server_addMethodNode_finish(UA_Server *server, const UA_NodeId nodeId,
 
 #endif
 
+/**
+ * UA_Server_addNodes_bulk adds many nodes at once. For example the nodes of a
+ * generated nodeset. Every node gets the references to its parent and
+ * TypeDefinition directly. The inverse references are added afterwards in a
+ * single pass, where every existing node is edited only once. Then the nodes
+ * are instantiated (mandatory children) and the constructors are called in
+ * reverse order. So the items must be ordered such that the parents and
+ * TypeDefinitions of a node are added before the node itself (or exist
+ * already).
+ *
+ * For ``trusted`` sources the checks of the parent references, the
+ * TypeDefinitions and the type-checking of variables are skipped. Items that
+ * refer to missing nodes still fail. The nodes are added without node
+ * context. If a node fails, its children in the batch fail with
+ * BadParentNodeIdInvalid and are removed as well.
+ *
+ * The optional ``results`` array has ``itemsSize`` entries. The members of the
+ * results have to be freed by the caller. Returns the first bad status code of
+ * the items. */
+UA_StatusCode UA_EXPORT
+UA_Server_addNodes_bulk(UA_Server *server, size_t itemsSize,
+                        const UA_AddNodesItem *items, UA_Boolean trusted,
+                        UA_AddNodesResult *results);
+
 /* Deletes a node and optionally all references leading to the node. */
 UA_StatusCode UA_EXPORT
 UA_Server_deleteNode(UA_Server *server, const UA_NodeId nodeId,
@@ -61,6 +61,14 @@ typedef struct {
 
 struct UA_ServerConfig {
     UA_UInt16 nThreads; /* only if multithreading is enabled */
+
+    /* Only if multithreading is enabled. The operations of Read, Write and
+     * Call requests with at least this many operations are processed in
+     * parallel by the worker threads. The order in which the operations of a
+     * request are executed is then undefined. 0 disables the parallel
+     * processing. */
+    UA_UInt32 parallelOperationsThreshold;
+
     UA_Logger logger;
 
     /* Server Description */
@@ -137,6 +145,16 @@ struct UA_ServerConfig {
     /* Limits for Requests */
     UA_UInt32 maxReferencesPerNode;
 
+    /* Number of NodeIds a session can register with RegisterNodes at the same
+     * time (at most 65536). Registered nodes are returned as handles that are
+     * only valid within the session. When the limit is reached, the NodeIds are
+     * returned unchanged. 0 -> no handles */
+    UA_UInt32 maxRegisteredNodes;
+
+    /* Number of cached results of TranslateBrowsePathsToNodeIds. The cache is
+     * outdated when references, BrowseNames or nodes change. 0 -> no cache */
+    UA_UInt32 browsePathCacheSize;
+
     /* Limits for Subscriptions */
     UA_UInt32 maxSubscriptionsPerSession;
     UA_DurationRange publishingIntervalLimits;
@@ -797,6 +797,11 @@ typedef struct {
                                      members from the same namespace or
                                      namespace zero only.*/
     UA_Boolean isArray       : 1; /* The member is an array */
+    UA_Byte overlayableRun;       /* Number of members starting here that are
+                                     overlayable and follow each other without
+                                     padding. If larger than one, they are en-
+                                     and decoded with a single memcpy. Zero if
+                                     unknown. */
 } UA_DataTypeMember;
 
 struct UA_DataType {
@@ -882,6 +887,17 @@ void UA_EXPORT UA_deleteMembers(void *p, const UA_DataType *type);
  * @param type The datatype description of the variable */
 void UA_EXPORT UA_delete(void *p, const UA_DataType *type);
 
+/* Compares two variables of the same type structurally. Arrays of types
+ * without pointers and padding are compared with memcmp. No memory is
+ * allocated.
+ *
+ * @param p1 The memory location of the first variable
+ * @param p2 The memory location of the second variable
+ * @param type The datatype description of the variables
+ * @return Returns true if the variables have the same content */
+UA_Boolean UA_EXPORT
+UA_equal(const void *p1, const void *p2, const UA_DataType *type);
+
 /**
  * .. _array-handling:
  *
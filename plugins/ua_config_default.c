@@ -263,6 +263,12 @@ createDefaultConfig(void) {
     conf->maxSessions = 100;
     conf->maxSessionTimeout = 60.0 * 60.0 * 1000.0; /* 1h */
 
+    /* Handles for registered nodes */
+    conf->maxRegisteredNodes = 1024;
+
+    /* Cached results of TranslateBrowsePathsToNodeIds */
+    conf->browsePathCacheSize = 256;
+
     /* Limits for Subscriptions */
     conf->publishingIntervalLimits = UA_DURATIONRANGE(100.0, 3600.0 * 1000.0);
     conf->lifeTimeCountLimits = UA_UINT32RANGE(3, 15000);
@@ -322,8 +328,13 @@ addDefaultNetworkLayers(UA_ServerConfig *conf, UA_UInt16 portNumber, UA_UInt32 s
     if (recvBufferSize > 0)
         config.recvBufferSize = recvBufferSize;
 
+#ifdef UA_ENABLE_EPOLL
+    conf->networkLayers[0] =
+        UA_ServerNetworkLayerTCPEpoll(config, portNumber, conf->logger);
+#else
     conf->networkLayers[0] =
         UA_ServerNetworkLayerTCP(config, portNumber, conf->logger);
+#endif
     conf->networkLayersSize = 1;
 
     return UA_STATUSCODE_GOOD;
@@ -8,7 +8,7 @@
 
 #include "ua_nodestore_default.h"
 
-#include "../src/ua_util_internal.h" /* TOOO: Move atomic operations to arch definitions */
+#include "../src/ua_util_internal.h" /* TODO: Move atomic operations to arch definitions */
 
 /* container_of */
 #define container_of(ptr, type, member) \
@@ -30,6 +30,24 @@
  * - Matching NodeId: Return the entry
  * - NULL: Abort the search
  *
+ * Every slot of the hash-map stores a key next to the entry pointer. For
+ * numeric NodeIds, the key contains the namespace index and the identifier.
+ * Then the NodeId is matched without touching the entry. For other NodeIds, the
+ * key contains the hash. So the NodeId of an entry is only compared when the
+ * hash matches. The hash of an entry is not recomputed during a resize.
+ *
+ * The hash-map is resized incrementally. The entries are moved from the old to
+ * the new table in small steps during the following insert and remove
+ * operations. Until the move is complete, lookups search both tables.
+ *
+ * The nodestore can be split into shards by the namespace index. Every shard
+ * is a hash-map with its own mutex.
+ *
+ * With UA_ENABLE_NODESTORE_SLABS, the entries are allocated from slabs with
+ * many entries of the same node class. Freed entries are reused for new nodes
+ * of the same node class. The slabs are only freed when the nodestore is
+ * deleted.
+ *
  * The nodestore uses atomic operations to set entries of the hash-map. If
  * UA_ENABLE_IMMUTABLE_NODES is configured, the nodestore allows read-access
  * from an interrupt without seeing corrupted nodes. For true multi-threaded
@@ -40,24 +58,71 @@
 
 typedef struct UA_NodeMapEntry {
     struct UA_NodeMapEntry *orig; /* the version this is a copy from (or NULL) */
-    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_UInt32 refCount; /* How many consumers have a reference to the node? */
     UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
     UA_Node node;
 } UA_NodeMapEntry;
 
 #define UA_NODEMAP_MINSIZE 64
 #define UA_NODEMAP_TOMBSTONE ((UA_NodeMapEntry*)0x01)
+#define UA_NODEMAP_MIGRATESTEPS 64 /* Slots moved per operation during a resize */
+
+/* Keys of non-numeric NodeIds contain the hash and have the highest bit set */
+#define UA_NODEMAP_KEY_HASHED (((UA_UInt64)1) << 63)
 
 typedef struct {
-    UA_NodeMapEntry **entries;
+    UA_NodeMapEntry *entry;
+    UA_UInt64 key;
+} UA_NodeMapSlot;
+
+typedef struct {
+    UA_NodeMapSlot *slots;
     UA_UInt32 size;
+} UA_NodeMapTable;
+
+typedef struct {
+    UA_NodeMapTable table;
+    UA_NodeMapTable old; /* The entries are moved to the new table during a
+                          * resize. slots == NULL otherwise. */
+    UA_UInt32 migrated;  /* Position of the move in the old table */
     UA_UInt32 count;
-    UA_UInt32 sizePrimeIndex;
 #ifdef UA_ENABLE_MULTITHREADING
     pthread_mutex_t mutex; /* Protect access */
 #endif
+} UA_NodeMapShard;
+
+#ifdef UA_ENABLE_NODESTORE_SLABS
+#define UA_NODEMAP_SLABCLASSES 8   /* One per node class */
+#define UA_NODEMAP_SLABENTRIES 256 /* Entries per slab */
+
+/* Entries are handed out from the newest slab. Freed entries are reused. */
+typedef struct UA_NodeMapSlab {
+    struct UA_NodeMapSlab *next;
+    size_t used;
+} UA_NodeMapSlab;
+
+typedef struct {
+    UA_NodeMapSlab *slabs;
+    UA_NodeMapEntry *freeEntries; /* Linked via the orig pointer */
+} UA_NodeMapSlabClass;
+#endif
+
+typedef struct {
+    UA_UInt16 shardsSize;
+    UA_NodeMapShard *shards;
+#ifdef UA_ENABLE_NODESTORE_SLABS
+    UA_NodeMapSlabClass slabClasses[UA_NODEMAP_SLABCLASSES];
+# ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_t slabMutex; /* Protect the slabs */
+# endif
+#endif
 } UA_NodeMap;
 
+static UA_NodeMapShard *
+getShard(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
+    return &ns->shards[nodeid->namespaceIndex % ns->shardsSize];
+}
+
 /*********************/
 /* HashMap Utilities */
 /*********************/
@@ -89,72 +154,168 @@ higher_prime_index(UA_UInt32 n) {
     return low;
 }
 
+static UA_UInt64
+nodeIdKey(const UA_NodeId *nodeid) {
+    if(nodeid->identifierType == UA_NODEIDTYPE_NUMERIC)
+        return ((UA_UInt64)nodeid->namespaceIndex << 32) | nodeid->identifier.numeric;
+    return UA_NODEMAP_KEY_HASHED | ((UA_UInt64)nodeid->identifierType << 48) |
+        ((UA_UInt64)nodeid->namespaceIndex << 32) | UA_NodeId_hash(nodeid);
+}
+
+static UA_UInt32
+keyHash(UA_UInt64 key) {
+    if(key & UA_NODEMAP_KEY_HASHED)
+        return (UA_UInt32)key;
+    UA_NodeId id = UA_NODEID_NUMERIC((UA_UInt16)(key >> 32), (UA_UInt32)key);
+    return UA_NodeId_hash(&id);
+}
+
+/* Numeric keys are unique. Otherwise compare the NodeId. */
+static UA_Boolean
+slotMatches(const UA_NodeMapSlot *slot, UA_UInt64 key, const UA_NodeId *nodeid) {
+    UA_NodeMapEntry *entry = slot->entry;
+    if(entry <= UA_NODEMAP_TOMBSTONE || slot->key != key)
+        return false;
+    return !(key & UA_NODEMAP_KEY_HASHED) ||
+        UA_NodeId_equal(&entry->node.nodeId, nodeid);
+}
+
+static UA_NodeMapSlot *
+findOccupiedTableSlot(const UA_NodeMapTable *table, UA_UInt64 key,
+                      UA_UInt32 h, const UA_NodeId *nodeid) {
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_NodeMapSlot *slot;
+
+    do {
+        slot = &table->slots[(UA_UInt32)idx];
+        if(slotMatches(slot, key, nodeid))
+            return slot;
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx && slot->entry);
+
+    /* NULL is returned if there is no free slot (idx == startIdx)
+     * and the node id is not found or if the end of the used slots (!entry)
+     * is reached. */
+    return NULL;
+}
+
+static UA_NodeMapSlot *
+findOccupiedSlot(const UA_NodeMapShard *shard, const UA_NodeId *nodeid) {
+    UA_UInt64 key = nodeIdKey(nodeid);
+    UA_UInt32 h = keyHash(key);
+    UA_NodeMapSlot *slot = findOccupiedTableSlot(&shard->table, key, h, nodeid);
+    if(!slot && shard->old.slots)
+        slot = findOccupiedTableSlot(&shard->old, key, h, nodeid);
+    return slot;
+}
+
 /* returns an empty slot or null if the nodeid exists or if no empty slot is found. */
-static UA_NodeMapEntry **
-findFreeSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
-    UA_NodeMapEntry **retval = NULL;
-    UA_UInt32 h = UA_NodeId_hash(nodeid);
-    UA_UInt32 size = ns->size;
+static UA_NodeMapSlot *
+findFreeSlot(const UA_NodeMapShard *shard, const UA_NodeId *nodeid) {
+    UA_UInt64 key = nodeIdKey(nodeid);
+    UA_UInt32 h = keyHash(key);
+    if(shard->old.slots && findOccupiedTableSlot(&shard->old, key, h, nodeid))
+        return NULL;
+
+    UA_NodeMapSlot *retval = NULL;
+    UA_UInt32 size = shard->table.size;
     UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
     UA_UInt32 startIdx = (UA_UInt32)idx;
     UA_UInt32 hash2 = mod2(h, size);
-    UA_NodeMapEntry *entry = NULL;
+    UA_NodeMapSlot *slot;
 
     do {
-        entry = ns->entries[(UA_UInt32)idx];
-        if(entry > UA_NODEMAP_TOMBSTONE &&
-           UA_NodeId_equal(&entry->node.nodeId, nodeid))
+        slot = &shard->table.slots[(UA_UInt32)idx];
+        if(slotMatches(slot, key, nodeid))
             return NULL;
-        if(!retval && entry <= UA_NODEMAP_TOMBSTONE)
-            retval = &ns->entries[(UA_UInt32)idx];
+        if(!retval && slot->entry <= UA_NODEMAP_TOMBSTONE)
+            retval = slot;
         idx += hash2;
         if(idx >= size)
             idx -= size;
-    } while((UA_UInt32)idx != startIdx && entry);
+    } while((UA_UInt32)idx != startIdx && slot->entry);
 
     /* NULL is returned if there is no free slot (idx == startIdx).
      * Otherwise the first free slot is returned after we are sure,
      * that the node id cannot be found in the used hashmap (!entry). */
+    if(retval)
+        retval->key = key;
     return retval;
 }
 
-/* The occupancy of the table after the call will be about 50% */
+/* Move entries from the old to the new table. The key of the entries is unique.
+ * So the first empty slot can be used without searching for the NodeId. */
+static void
+migrate(UA_NodeMapShard *shard, UA_UInt32 steps) {
+    UA_NodeMapTable *old = &shard->old;
+    if(!old->slots)
+        return;
+    UA_UInt32 end = old->size;
+    if(steps < end - shard->migrated)
+        end = shard->migrated + steps;
+
+    UA_UInt32 size = shard->table.size;
+    for(UA_UInt32 i = shard->migrated; i < end; ++i) {
+        UA_NodeMapEntry *entry = old->slots[i].entry;
+        if(entry <= UA_NODEMAP_TOMBSTONE)
+            continue;
+        UA_UInt64 key = old->slots[i].key;
+        UA_UInt32 h = keyHash(key);
+        UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
+        UA_UInt32 hash2 = mod2(h, size);
+        while(shard->table.slots[(UA_UInt32)idx].entry > UA_NODEMAP_TOMBSTONE) {
+            idx += hash2;
+            if(idx >= size)
+                idx -= size;
+        }
+        UA_NodeMapSlot *slot = &shard->table.slots[(UA_UInt32)idx];
+        slot->key = key;
+        UA_atomic_xchg((void**)&slot->entry, entry);
+        UA_atomic_xchg((void**)&old->slots[i].entry, UA_NODEMAP_TOMBSTONE);
+    }
+
+    shard->migrated = end;
+    if(end < old->size)
+        return;
+    UA_free(old->slots);
+    old->slots = NULL;
+    old->size = 0;
+}
+
+/* The occupancy of the table after the call will be about 50%. The entries are
+ * moved to the new table with the following operations. */
 static UA_StatusCode
-expand(UA_NodeMap *ns) {
-    UA_UInt32 osize = ns->size;
-    UA_UInt32 count = ns->count;
+expand(UA_NodeMapShard *shard) {
+    UA_UInt32 osize = shard->table.size;
+    UA_UInt32 count = shard->count;
     /* Resize only when table after removal of unused elements is either too
        full or too empty */
     if(count * 2 < osize && (count * 8 > osize || osize <= UA_NODEMAP_MINSIZE))
         return UA_STATUSCODE_GOOD;
 
-    UA_NodeMapEntry **oentries = ns->entries;
-    UA_UInt32 nindex = higher_prime_index(count * 2);
-    UA_UInt32 nsize = primes[nindex];
-    UA_NodeMapEntry **nentries = (UA_NodeMapEntry **)UA_calloc(nsize, sizeof(UA_NodeMapEntry*));
-    if(!nentries)
+    UA_UInt32 nsize = primes[higher_prime_index(count * 2)];
+    UA_NodeMapSlot *nslots = (UA_NodeMapSlot*)UA_calloc(nsize, sizeof(UA_NodeMapSlot));
+    if(!nslots)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    ns->entries = nentries;
-    ns->size = nsize;
-    ns->sizePrimeIndex = nindex;
-
-    /* recompute the position of every entry and insert the pointer */
-    for(size_t i = 0, j = 0; i < osize && j < count; ++i) {
-        if(oentries[i] <= UA_NODEMAP_TOMBSTONE)
-            continue;
-        UA_NodeMapEntry **e = findFreeSlot(ns, &oentries[i]->node.nodeId);
-        UA_assert(e);
-        *e = oentries[i];
-        ++j;
-    }
+    /* Complete an ongoing resize first */
+    migrate(shard, UA_UINT32_MAX);
 
-    UA_free(oentries);
+    shard->old = shard->table;
+    shard->table.slots = nslots;
+    shard->table.size = nsize;
+    shard->migrated = 0;
+    migrate(shard, UA_NODEMAP_MIGRATESTEPS);
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_NodeMapEntry *
-newEntry(UA_NodeClass nodeClass) {
+static size_t
+entrySize(UA_NodeClass nodeClass) {
     size_t size = sizeof(UA_NodeMapEntry) - sizeof(UA_Node);
     switch(nodeClass) {
     case UA_NODECLASS_OBJECT:
@@ -182,134 +343,208 @@ newEntry(UA_NodeClass nodeClass) {
         size += sizeof(UA_ViewNode);
         break;
     default:
-        return NULL;
+        return 0;
+    }
+    return size;
+}
+
+#ifdef UA_ENABLE_NODESTORE_SLABS
+
+/* The node classes are single bits */
+static UA_NodeMapSlabClass *
+getSlabClass(UA_NodeMap *ns, UA_NodeClass nodeClass) {
+    size_t i = 0;
+    while(i < UA_NODEMAP_SLABCLASSES - 1 && (UA_UInt32)nodeClass != (1u << i))
+        ++i;
+    return &ns->slabClasses[i];
+}
+
+static UA_NodeMapEntry *
+slabAlloc(UA_NodeMap *ns, UA_NodeClass nodeClass, size_t size) {
+    UA_NodeMapSlabClass *sc = getSlabClass(ns, nodeClass);
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_lock(&ns->slabMutex);
+#endif
+    UA_NodeMapEntry *entry = sc->freeEntries;
+    if(entry) {
+        sc->freeEntries = entry->orig;
+    } else {
+        UA_NodeMapSlab *slab = sc->slabs;
+        if(!slab || slab->used == UA_NODEMAP_SLABENTRIES) {
+            slab = (UA_NodeMapSlab*)
+                UA_malloc(sizeof(UA_NodeMapSlab) + (size * UA_NODEMAP_SLABENTRIES));
+            if(slab) {
+                slab->next = sc->slabs;
+                slab->used = 0;
+                sc->slabs = slab;
+            }
+        }
+        if(slab)
+            entry = (UA_NodeMapEntry*)((uintptr_t)&slab[1] + (size * slab->used++));
     }
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_unlock(&ns->slabMutex);
+#endif
+    return entry;
+}
+
+static void
+slabFree(UA_NodeMap *ns, UA_NodeClass nodeClass, UA_NodeMapEntry *entry) {
+    UA_NodeMapSlabClass *sc = getSlabClass(ns, nodeClass);
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_lock(&ns->slabMutex);
+#endif
+    entry->orig = sc->freeEntries;
+    sc->freeEntries = entry;
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_unlock(&ns->slabMutex);
+#endif
+}
+
+#endif /* UA_ENABLE_NODESTORE_SLABS */
+
+static UA_NodeMapEntry *
+newEntry(UA_NodeMap *ns, UA_NodeClass nodeClass) {
+    size_t size = entrySize(nodeClass);
+    if(size == 0)
+        return NULL;
+#ifdef UA_ENABLE_NODESTORE_SLABS
+    /* Round up to keep the entries in the slab aligned */
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    UA_NodeMapEntry *entry = slabAlloc(ns, nodeClass, size);
+    if(!entry)
+        return NULL;
+    memset(entry, 0, size);
+#else
     UA_NodeMapEntry *entry = (UA_NodeMapEntry*)UA_calloc(1, size);
     if(!entry)
         return NULL;
+#endif
     entry->node.nodeClass = nodeClass;
     return entry;
 }
 
 static void
-deleteEntry(UA_NodeMapEntry *entry) {
+deleteEntry(UA_NodeMap *ns, UA_NodeMapEntry *entry) {
+#ifdef UA_ENABLE_NODESTORE_SLABS
+    UA_NodeClass nodeClass = entry->node.nodeClass;
+    UA_Node_deleteMembers(&entry->node);
+    slabFree(ns, nodeClass, entry);
+#else
     UA_Node_deleteMembers(&entry->node);
     UA_free(entry);
+#endif
 }
 
 static void
-cleanupEntry(UA_NodeMapEntry *entry) {
+cleanupEntry(UA_NodeMap *ns, UA_NodeMapEntry *entry) {
     if(entry->deleted && entry->refCount == 0)
-        deleteEntry(entry);
+        deleteEntry(ns, entry);
 }
 
 static UA_StatusCode
-clearSlot(UA_NodeMap *ns, UA_NodeMapEntry **slot) {
-    UA_NodeMapEntry *entry = *slot;
-    if(UA_atomic_cmpxchg((void**)slot, entry, UA_NODEMAP_TOMBSTONE) != entry)
+clearSlot(UA_NodeMap *ns, UA_NodeMapShard *shard, UA_NodeMapSlot *slot) {
+    UA_NodeMapEntry *entry = slot->entry;
+    if(UA_atomic_cmpxchg((void**)&slot->entry, entry, UA_NODEMAP_TOMBSTONE) != entry)
         return UA_STATUSCODE_BADINTERNALERROR;
     entry->deleted = true;
-    cleanupEntry(entry);
-    --ns->count;
+    cleanupEntry(ns, entry);
+    --shard->count;
     /* Downsize the hashmap if it is very empty */
-    if(ns->count * 8 < ns->size && ns->size > 32)
-        expand(ns); /* Can fail. Just continue with the bigger hashmap. */
+    if(shard->count * 8 < shard->table.size && shard->table.size > 32)
+        expand(shard); /* Can fail. Just continue with the bigger hashmap. */
+    else
+        migrate(shard, UA_NODEMAP_MIGRATESTEPS);
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_NodeMapEntry **
-findOccupiedSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
-    UA_UInt32 h = UA_NodeId_hash(nodeid);
-    UA_UInt32 size = ns->size;
-    UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
-    UA_UInt32 hash2 = mod2(h, size);
-    UA_UInt32 startIdx = (UA_UInt32)idx;
-    UA_NodeMapEntry *entry = NULL;
-
-    do {
-        entry = ns->entries[(UA_UInt32)idx];
-        if(entry > UA_NODEMAP_TOMBSTONE &&
-           UA_NodeId_equal(&entry->node.nodeId, nodeid))
-            return &ns->entries[(UA_UInt32)idx];
-        idx += hash2;
-        if(idx >= size)
-            idx -= size;
-    } while((UA_UInt32)idx != startIdx && entry);
-
-    /* NULL is returned if there is no free slot (idx == startIdx)
-     * and the node id is not found or if the end of the used slots (!entry)
-     * is reached. */
-    return NULL;
-}
-
 /***********************/
 /* Interface functions */
 /***********************/
 
 static UA_Node *
 UA_NodeMap_newNode(void *context, UA_NodeClass nodeClass) {
-    UA_NodeMapEntry *entry = newEntry(nodeClass);
+    UA_NodeMapEntry *entry = newEntry((UA_NodeMap*)context, nodeClass);
     if(!entry)
         return NULL;
     return &entry->node;
 }
 
+/* The node is not in the nodestore. No need to lock. */
 static void
 UA_NodeMap_deleteNode(void *context, UA_Node *node) {
-#ifdef UA_ENABLE_MULTITHREADING
-    UA_NodeMap *ns = (UA_NodeMap*)context;
-#endif
-    BEGIN_CRITSECT(ns);
     UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
     UA_assert(&entry->node == node);
-    deleteEntry(entry);
-    END_CRITSECT(ns);
+    deleteEntry((UA_NodeMap*)context, entry);
 }
 
 static const UA_Node *
 UA_NodeMap_getNode(void *context, const UA_NodeId *nodeid) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    BEGIN_CRITSECT(ns);
-    UA_NodeMapEntry **entry = findOccupiedSlot(ns, nodeid);
-    if(!entry) {
-        END_CRITSECT(ns);
+    UA_NodeMapShard *shard = getShard(ns, nodeid);
+    BEGIN_CRITSECT(shard);
+    UA_NodeMapSlot *slot = findOccupiedSlot(shard, nodeid);
+    if(!slot) {
+        END_CRITSECT(shard);
         return NULL;
     }
-    ++(*entry)->refCount;
-    END_CRITSECT(ns);
-    return (const UA_Node*)&(*entry)->node;
+    UA_NodeMapEntry *entry = slot->entry;
+    ++entry->refCount;
+    END_CRITSECT(shard);
+    return (const UA_Node*)&entry->node;
 }
 
 static void
 UA_NodeMap_releaseNode(void *context, const UA_Node *node) {
     if (!node)
         return;
-#ifdef UA_ENABLE_MULTITHREADING
     UA_NodeMap *ns = (UA_NodeMap*)context;
+#ifdef UA_ENABLE_MULTITHREADING
+    UA_NodeMapShard *shard = getShard(ns, &node->nodeId);
 #endif
-    BEGIN_CRITSECT(ns);
+    BEGIN_CRITSECT(shard);
     UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
     UA_assert(&entry->node == node);
     UA_assert(entry->refCount > 0);
     --entry->refCount;
-    cleanupEntry(entry);
-    END_CRITSECT(ns);
+    cleanupEntry(ns, entry);
+    END_CRITSECT(shard);
+}
+
+/* The entry is marked as deleted when it is replaced or removed */
+static const UA_Node *
+UA_NodeMap_retainNode(void *context, const UA_Node *node) {
+#ifdef UA_ENABLE_MULTITHREADING
+    UA_NodeMapShard *shard = getShard((UA_NodeMap*)context, &node->nodeId);
+#endif
+    BEGIN_CRITSECT(shard);
+    UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
+    UA_assert(&entry->node == node);
+    UA_assert(entry->refCount > 0);
+    if(entry->deleted) {
+        END_CRITSECT(shard);
+        return NULL;
+    }
+    ++entry->refCount;
+    END_CRITSECT(shard);
+    return node;
 }
 
 static UA_StatusCode
 UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
                        UA_Node **outNode) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    BEGIN_CRITSECT(ns);
-    UA_NodeMapEntry **slot = findOccupiedSlot(ns, nodeid);
+    UA_NodeMapShard *shard = getShard(ns, nodeid);
+    BEGIN_CRITSECT(shard);
+    UA_NodeMapSlot *slot = findOccupiedSlot(shard, nodeid);
     if(!slot) {
-        END_CRITSECT(ns);
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
     }
-    UA_NodeMapEntry *entry = *slot;
-    UA_NodeMapEntry *newItem = newEntry(entry->node.nodeClass);
+    UA_NodeMapEntry *entry = slot->entry;
+    UA_NodeMapEntry *newItem = newEntry(ns, entry->node.nodeClass);
     if(!newItem) {
-        END_CRITSECT(ns);
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
     UA_StatusCode retval = UA_Node_copy(&entry->node, &newItem->node);
@@ -317,23 +552,24 @@ UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
         newItem->orig = entry; // store the pointer to the original
         *outNode = &newItem->node;
     } else {
-        deleteEntry(newItem);
+        deleteEntry(ns, newItem);
     }
-    END_CRITSECT(ns);
+    END_CRITSECT(shard);
     return retval;
 }
 
 static UA_StatusCode
 UA_NodeMap_removeNode(void *context, const UA_NodeId *nodeid) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    BEGIN_CRITSECT(ns);
-    UA_NodeMapEntry **slot = findOccupiedSlot(ns, nodeid);
+    UA_NodeMapShard *shard = getShard(ns, nodeid);
+    BEGIN_CRITSECT(shard);
+    UA_NodeMapSlot *slot = findOccupiedSlot(shard, nodeid);
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(slot)
-        retval = clearSlot(ns, slot);
+        retval = clearSlot(ns, shard, slot);
     else
         retval = UA_STATUSCODE_BADNODEIDUNKNOWN;
-    END_CRITSECT(ns);
+    END_CRITSECT(shard);
     return retval;
 }
 
@@ -341,15 +577,18 @@ static UA_StatusCode
 UA_NodeMap_insertNode(void *context, UA_Node *node,
                       UA_NodeId *addedNodeId) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    BEGIN_CRITSECT(ns);
-    if(ns->size * 3 <= ns->count * 4) {
-        if(expand(ns) != UA_STATUSCODE_GOOD) {
-            END_CRITSECT(ns);
+    UA_NodeMapShard *shard = getShard(ns, &node->nodeId);
+    BEGIN_CRITSECT(shard);
+    if(shard->table.size * 3 <= shard->count * 4) {
+        if(expand(shard) != UA_STATUSCODE_GOOD) {
+            END_CRITSECT(shard);
             return UA_STATUSCODE_BADINTERNALERROR;
         }
+    } else {
+        migrate(shard, UA_NODEMAP_MIGRATESTEPS);
     }
 
-    UA_NodeMapEntry **slot;
+    UA_NodeMapSlot *slot;
     if(node->nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
             node->nodeId.identifier.numeric == 0) {
         /* create a random nodeid */
@@ -358,14 +597,14 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
         /* since the size is prime and we don't change the increase val, we will reach the starting id again */
         /* E.g. adding a nodeset will create children while there are still other nodes which need to be created */
         /* Thus the node ids may collide */
-        UA_UInt32 size = ns->size;
+        UA_UInt32 size = shard->table.size;
         UA_UInt64 identifier = mod(50000 + size+1, UA_UINT32_MAX); // start value, use 64 bit container to avoid overflow
-        UA_UInt32 increase = mod2(ns->count+1, size);
+        UA_UInt32 increase = mod2(shard->count+1, size);
         UA_UInt32 startId = (UA_UInt32)identifier; // mod ensures us that the id is a valid 32 bit
 
         do {
             node->nodeId.identifier.numeric = (UA_UInt32)identifier;
-            slot = findFreeSlot(ns, &node->nodeId);
+            slot = findFreeSlot(shard, &node->nodeId);
             if(slot)
                 break;
             identifier += increase;
@@ -373,12 +612,12 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
                 identifier -= size;
         } while((UA_UInt32)identifier != startId);
     } else {
-        slot = findFreeSlot(ns, &node->nodeId);
+        slot = findFreeSlot(shard, &node->nodeId);
     }
 
     if(!slot) {
-        deleteEntry(container_of(node, UA_NodeMapEntry, node));
-        END_CRITSECT(ns);
+        deleteEntry(ns, container_of(node, UA_NodeMapEntry, node));
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADNODEIDEXISTS;
     }
 
@@ -387,118 +626,169 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
     if(addedNodeId) {
         retval = UA_NodeId_copy(&node->nodeId, addedNodeId);
         if(retval != UA_STATUSCODE_GOOD) {
-            deleteEntry(container_of(node, UA_NodeMapEntry, node));
-            END_CRITSECT(ns);
+            deleteEntry(ns, container_of(node, UA_NodeMapEntry, node));
+            END_CRITSECT(shard);
             return retval;
         }
     }
 
     /* Insert the node */
-    UA_NodeMapEntry *oldEntry = *slot;
+    UA_NodeMapEntry *oldEntry = slot->entry;
     UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
     if(oldEntry > UA_NODEMAP_TOMBSTONE ||
-       UA_atomic_cmpxchg((void**)slot, oldEntry,
+       UA_atomic_cmpxchg((void**)&slot->entry, oldEntry,
                          newEntry) != oldEntry) {
-        deleteEntry(container_of(node, UA_NodeMapEntry, node));
-        END_CRITSECT(ns);
+        deleteEntry(ns, container_of(node, UA_NodeMapEntry, node));
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADNODEIDEXISTS;
     }
-    ++ns->count;
-    END_CRITSECT(ns);
+    ++shard->count;
+    END_CRITSECT(shard);
     return retval;
 }
 
 static UA_StatusCode
 UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    BEGIN_CRITSECT(ns);
+    UA_NodeMapShard *shard = getShard(ns, &node->nodeId);
+    BEGIN_CRITSECT(shard);
 
     /* Find the node */
-    UA_NodeMapEntry **slot = findOccupiedSlot(ns, &node->nodeId);
+    UA_NodeMapSlot *slot = findOccupiedSlot(shard, &node->nodeId);
     if(!slot) {
-        END_CRITSECT(ns);
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
     }
     UA_NodeMapEntry *newEntryContainer = container_of(node, UA_NodeMapEntry, node);
-    UA_NodeMapEntry *oldEntryContainer = *slot;
+    UA_NodeMapEntry *oldEntryContainer = slot->entry;
 
     /* The node was already updated since the copy was made? */
     if(oldEntryContainer != newEntryContainer->orig) {
-        deleteEntry(newEntryContainer);
-        END_CRITSECT(ns);
+        deleteEntry(ns, newEntryContainer);
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
     /* Replace the entry with an atomic operation */
-    if(UA_atomic_cmpxchg((void**)slot, oldEntryContainer,
+    if(UA_atomic_cmpxchg((void**)&slot->entry, oldEntryContainer,
                          newEntryContainer) != oldEntryContainer) {
-        deleteEntry(newEntryContainer);
-        END_CRITSECT(ns);
+        deleteEntry(ns, newEntryContainer);
+        END_CRITSECT(shard);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
     oldEntryContainer->deleted = true;
-    cleanupEntry(oldEntryContainer);
-    END_CRITSECT(ns);
+    cleanupEntry(ns, oldEntryContainer);
+    END_CRITSECT(shard);
     return UA_STATUSCODE_GOOD;
 }
 
+/* The entries are checked out during the visit. So the visitor can use the
+ * nodestore. */
 static void
 UA_NodeMap_iterate(void *context, void *visitorContext,
                    UA_NodestoreVisitor visitor) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    BEGIN_CRITSECT(ns);
-    for(UA_UInt32 i = 0; i < ns->size; ++i) {
-        if(ns->entries[i] > UA_NODEMAP_TOMBSTONE) {
-            END_CRITSECT(ns);
-            UA_NodeMapEntry *entry = ns->entries[i];
+    for(UA_UInt16 s = 0; s < ns->shardsSize; ++s) {
+        UA_NodeMapShard *shard = &ns->shards[s];
+        BEGIN_CRITSECT(shard);
+        /* Complete an ongoing resize. Otherwise the entries moved during the
+         * visit could be visited twice. */
+        migrate(shard, UA_UINT32_MAX);
+        for(UA_UInt32 i = 0; i < shard->table.size; ++i) {
+            UA_NodeMapEntry *entry = shard->table.slots[i].entry;
+            if(entry <= UA_NODEMAP_TOMBSTONE)
+                continue;
             entry->refCount++;
+            END_CRITSECT(shard);
             visitor(visitorContext, &entry->node);
+            BEGIN_CRITSECT(shard);
             entry->refCount--;
-            cleanupEntry(entry);
-            BEGIN_CRITSECT(ns);
+            cleanupEntry(ns, entry);
         }
+        END_CRITSECT(shard);
     }
-    END_CRITSECT(ns);
+}
+
+static void
+deleteTable(UA_NodeMap *ns, UA_NodeMapTable *table) {
+    for(UA_UInt32 i = 0; i < table->size; ++i) {
+        UA_NodeMapEntry *entry = table->slots[i].entry;
+        if(entry > UA_NODEMAP_TOMBSTONE) {
+            /* On debugging builds, check that all nodes were release */
+            UA_assert(entry->refCount == 0);
+            /* Delete the node */
+            deleteEntry(ns, entry);
+        }
+    }
+    UA_free(table->slots);
 }
 
 static void
 UA_NodeMap_delete(void *context) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
+    for(UA_UInt16 s = 0; s < ns->shardsSize; ++s) {
+        UA_NodeMapShard *shard = &ns->shards[s];
 #ifdef UA_ENABLE_MULTITHREADING
-    pthread_mutex_destroy(&ns->mutex);
+        pthread_mutex_destroy(&shard->mutex);
 #endif
-    UA_UInt32 size = ns->size;
-    UA_NodeMapEntry **entries = ns->entries;
-    for(UA_UInt32 i = 0; i < size; ++i) {
-        if(entries[i] > UA_NODEMAP_TOMBSTONE) {
-            /* On debugging builds, check that all nodes were release */
-            UA_assert(entries[i]->refCount == 0);
-            /* Delete the node */
-            deleteEntry(entries[i]);
+        deleteTable(ns, &shard->table);
+        if(shard->old.slots)
+            deleteTable(ns, &shard->old);
+    }
+    UA_free(ns->shards);
+#ifdef UA_ENABLE_NODESTORE_SLABS
+    /* The members of the nodes are deleted. Free the slabs en bloc. */
+    for(size_t i = 0; i < UA_NODEMAP_SLABCLASSES; ++i) {
+        UA_NodeMapSlab *slab = ns->slabClasses[i].slabs;
+        while(slab) {
+            UA_NodeMapSlab *next = slab->next;
+            UA_free(slab);
+            slab = next;
         }
     }
-    UA_free(ns->entries);
+# ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_destroy(&ns->slabMutex);
+# endif
+#endif
     UA_free(ns);
 }
 
 UA_StatusCode
-UA_Nodestore_default_new(UA_Nodestore *ns) {
+UA_Nodestore_default_newSharded(UA_Nodestore *ns, UA_UInt16 shardsSize) {
+    if(shardsSize == 0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
     /* Allocate and initialize the nodemap */
-    UA_NodeMap *nodemap = (UA_NodeMap*)UA_malloc(sizeof(UA_NodeMap));
+    UA_NodeMap *nodemap = (UA_NodeMap*)UA_calloc(1, sizeof(UA_NodeMap));
     if(!nodemap)
         return UA_STATUSCODE_BADOUTOFMEMORY;
-    nodemap->sizePrimeIndex = higher_prime_index(UA_NODEMAP_MINSIZE);
-    nodemap->size = primes[nodemap->sizePrimeIndex];
-    nodemap->count = 0;
-    nodemap->entries = (UA_NodeMapEntry**)
-        UA_calloc(nodemap->size, sizeof(UA_NodeMapEntry*));
-    if(!nodemap->entries) {
+    nodemap->shards = (UA_NodeMapShard*)
+        UA_calloc(shardsSize, sizeof(UA_NodeMapShard));
+    if(!nodemap->shards) {
         UA_free(nodemap);
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
+    nodemap->shardsSize = shardsSize;
+    UA_UInt32 size = primes[higher_prime_index(UA_NODEMAP_MINSIZE)];
+    for(UA_UInt16 s = 0; s < shardsSize; ++s) {
+        UA_NodeMapShard *shard = &nodemap->shards[s];
+        shard->table.size = size;
+        shard->table.slots = (UA_NodeMapSlot*)UA_calloc(size, sizeof(UA_NodeMapSlot));
+        if(!shard->table.slots) {
+            for(UA_UInt16 t = 0; t < s; ++t)
+                UA_free(nodemap->shards[t].table.slots);
+            UA_free(nodemap->shards);
+            UA_free(nodemap);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
 #ifdef UA_ENABLE_MULTITHREADING
-    pthread_mutex_init(&nodemap->mutex, NULL);
+    for(UA_UInt16 s = 0; s < shardsSize; ++s)
+        pthread_mutex_init(&nodemap->shards[s].mutex, NULL);
+# ifdef UA_ENABLE_NODESTORE_SLABS
+    pthread_mutex_init(&nodemap->slabMutex, NULL);
+# endif
 #endif
 
     /* Populate the nodestore */
@@ -509,6 +799,7 @@ UA_Nodestore_default_new(UA_Nodestore *ns) {
     ns->deleteNode = UA_NodeMap_deleteNode;
     ns->getNode = UA_NodeMap_getNode;
     ns->releaseNode = UA_NodeMap_releaseNode;
+    ns->retainNode = UA_NodeMap_retainNode;
     ns->getNodeCopy = UA_NodeMap_getNodeCopy;
     ns->insertNode = UA_NodeMap_insertNode;
     ns->replaceNode = UA_NodeMap_replaceNode;
@@ -517,3 +808,8 @@ UA_Nodestore_default_new(UA_Nodestore *ns) {
 
     return UA_STATUSCODE_GOOD;
 }
+
+UA_StatusCode
+UA_Nodestore_default_new(UA_Nodestore *ns) {
+    return UA_Nodestore_default_newSharded(ns, 1);
+}
@@ -19,6 +19,12 @@ extern "C" {
 UA_StatusCode UA_EXPORT
 UA_Nodestore_default_new(UA_Nodestore *ns);
 
+/* Same as above. But the nodes are distributed over shards by the namespace
+ * index of their NodeId. Every shard is a hash-map with its own lock. So
+ * threads accessing different namespaces do not contend. */
+UA_StatusCode UA_EXPORT
+UA_Nodestore_default_newSharded(UA_Nodestore *ns, UA_UInt16 shardsSize);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
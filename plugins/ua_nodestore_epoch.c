@@ -0,0 +1,683 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#include "ua_nodestore_epoch.h"
+
+#include "../src/ua_util_internal.h" /* TODO: Move atomic operations to arch definitions */
+
+/* container_of */
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+
+#ifdef UA_ENABLE_MULTITHREADING
+#include <pthread.h>
+#define BEGIN_WRITE(EPOCHMAP) pthread_mutex_lock(&(EPOCHMAP)->writeMutex)
+#define END_WRITE(EPOCHMAP) pthread_mutex_unlock(&(EPOCHMAP)->writeMutex)
+#else
+#define BEGIN_WRITE(EPOCHMAP)
+#define END_WRITE(EPOCHMAP)
+#endif
+
+/* The epoch nodestore is a hash-map from NodeIds to Nodes (with the same
+ * probing as the default nodestore). Readers never lock and do not count
+ * references. Writers are serialized with a mutex. They never edit a node that
+ * is visible to readers, but swap the slot of the hash-map to an edited copy
+ * with an atomic operation. The same is done for the entire hash-map when it
+ * is resized.
+ *
+ * Memory is reclaimed with epochs. Every thread that gets a node marks itself
+ * active in the current global epoch until all its nodes are released.
+ * Unlinked entries (and hash-maps) are retired with the epoch of their
+ * removal. The global epoch advances only when all active readers are in the
+ * current epoch. So retired memory can be freed when the global epoch has
+ * advanced twice after the removal. Writers advance the epoch and reclaim
+ * memory. Readers never wait for writers and vice versa. */
+
+typedef struct UA_EpochEntry {
+    struct UA_EpochEntry *orig;        /* The version this is a copy from (or NULL) */
+    struct UA_EpochEntry *retiredNext; /* Waiting for the grace period */
+    size_t retiredEpoch;
+    UA_Node node;
+} UA_EpochEntry;
+
+#define UA_EPOCHMAP_MINSIZE 64
+#define UA_EPOCHMAP_TOMBSTONE ((UA_EpochEntry*)0x01)
+
+typedef struct UA_EpochTable {
+    struct UA_EpochTable *retiredNext;
+    size_t retiredEpoch;
+    UA_UInt32 size;
+    UA_EpochEntry * volatile *entries;
+} UA_EpochTable;
+
+/* Every reading thread has a record. The records are never removed from the
+ * list but reused after a thread terminates. */
+typedef struct UA_EpochReader {
+    struct UA_EpochReader *next;
+    volatile size_t state;   /* (epoch << 1) | 1 while nodes are checked out */
+    size_t nesting;          /* Nodes currently checked out by the thread */
+    volatile size_t inUse;   /* The record belongs to a thread */
+} UA_EpochReader;
+
+typedef struct {
+    UA_EpochTable * volatile table;
+    volatile size_t epoch;
+    UA_EpochReader * volatile readers;
+
+    /* Protected by the write mutex */
+    UA_UInt32 count;
+    UA_EpochEntry *retiredEntries; /* Newest first */
+    UA_EpochTable *retiredTables;  /* Newest first */
+
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_t writeMutex;
+    pthread_key_t readerKey; /* Points to the UA_EpochReader of the thread */
+#else
+    UA_EpochReader reader;
+#endif
+} UA_EpochMap;
+
+/*********************/
+/* HashMap Utilities */
+/*********************/
+
+/* The size of the hash-map is always a prime number. They are chosen to be
+ * close to the next power of 2. So the size ca. doubles with each prime. */
+static UA_UInt32 const primes[] = {
+    7,         13,         31,         61,         127,         251,
+    509,       1021,       2039,       4093,       8191,        16381,
+    32749,     65521,      131071,     262139,     524287,      1048573,
+    2097143,   4194301,    8388593,    16777213,   33554393,    67108859,
+    134217689, 268435399,  536870909,  1073741789, 2147483647,  4294967291
+};
+
+static UA_UInt32 mod(UA_UInt32 h, UA_UInt32 size) { return h % size; }
+static UA_UInt32 mod2(UA_UInt32 h, UA_UInt32 size) { return 1 + (h % (size - 2)); }
+
+static UA_UInt16
+higher_prime_index(UA_UInt32 n) {
+    UA_UInt16 low  = 0;
+    UA_UInt16 high = (UA_UInt16)(sizeof(primes) / sizeof(UA_UInt32));
+    while(low != high) {
+        UA_UInt16 mid = (UA_UInt16)(low + ((high - low) / 2));
+        if(n > primes[mid])
+            low = (UA_UInt16)(mid + 1);
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static UA_EpochTable *
+newTable(UA_UInt32 minSize) {
+    UA_UInt32 size = primes[higher_prime_index(minSize)];
+    UA_EpochTable *table = (UA_EpochTable*)
+        UA_calloc(1, sizeof(UA_EpochTable) + (size * sizeof(UA_EpochEntry*)));
+    if(!table)
+        return NULL;
+    table->size = size;
+    table->entries = (UA_EpochEntry * volatile *)(uintptr_t)&table[1];
+    return table;
+}
+
+/* Returns the slot with the NodeId or NULL. For writers. */
+static UA_EpochEntry * volatile *
+findOccupiedSlot(const UA_EpochTable *table, const UA_NodeId *nodeid) {
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_EpochEntry *entry = NULL;
+
+    do {
+        entry = table->entries[(UA_UInt32)idx];
+        if(entry > UA_EPOCHMAP_TOMBSTONE &&
+           UA_NodeId_equal(&entry->node.nodeId, nodeid))
+            return &table->entries[(UA_UInt32)idx];
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx && entry);
+    return NULL;
+}
+
+/* Same as above for readers. The slot is loaded only once, since it may be
+ * swapped concurrently. */
+static UA_EpochEntry *
+findEntry(const UA_EpochTable *table, const UA_NodeId *nodeid) {
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_EpochEntry *entry = NULL;
+
+    do {
+        entry = table->entries[(UA_UInt32)idx];
+        if(entry > UA_EPOCHMAP_TOMBSTONE &&
+           UA_NodeId_equal(&entry->node.nodeId, nodeid))
+            return entry;
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx && entry);
+    return NULL;
+}
+
+/* Returns an empty slot or NULL if the NodeId exists or if no empty slot is
+ * found */
+static UA_EpochEntry * volatile *
+findFreeSlot(const UA_EpochTable *table, const UA_NodeId *nodeid) {
+    UA_EpochEntry * volatile *retval = NULL;
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); // use 64 bit container to avoid overflow
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_EpochEntry *entry = NULL;
+
+    do {
+        entry = table->entries[(UA_UInt32)idx];
+        if(entry > UA_EPOCHMAP_TOMBSTONE &&
+           UA_NodeId_equal(&entry->node.nodeId, nodeid))
+            return NULL;
+        if(!retval && entry <= UA_EPOCHMAP_TOMBSTONE)
+            retval = &table->entries[(UA_UInt32)idx];
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx && entry);
+    return retval;
+}
+
+static UA_EpochEntry *
+newEntry(UA_NodeClass nodeClass) {
+    size_t size = sizeof(UA_EpochEntry) - sizeof(UA_Node);
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT:
+        size += sizeof(UA_ObjectNode);
+        break;
+    case UA_NODECLASS_VARIABLE:
+        size += sizeof(UA_VariableNode);
+        break;
+    case UA_NODECLASS_METHOD:
+        size += sizeof(UA_MethodNode);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        size += sizeof(UA_ObjectTypeNode);
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        size += sizeof(UA_VariableTypeNode);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        size += sizeof(UA_ReferenceTypeNode);
+        break;
+    case UA_NODECLASS_DATATYPE:
+        size += sizeof(UA_DataTypeNode);
+        break;
+    case UA_NODECLASS_VIEW:
+        size += sizeof(UA_ViewNode);
+        break;
+    default:
+        return NULL;
+    }
+    UA_EpochEntry *entry = (UA_EpochEntry*)UA_calloc(1, size);
+    if(!entry)
+        return NULL;
+    entry->node.nodeClass = nodeClass;
+    return entry;
+}
+
+static void
+deleteEntry(UA_EpochEntry *entry) {
+    UA_Node_deleteMembers(&entry->node);
+    UA_free(entry);
+}
+
+/**********/
+/* Epochs */
+/**********/
+
+#ifdef UA_ENABLE_MULTITHREADING
+static void
+releaseReader(void *data) {
+    UA_EpochReader *reader = (UA_EpochReader*)data;
+    reader->nesting = 0;
+    reader->state = 0;
+    UA_atomic_sync();
+    reader->inUse = 0;
+}
+#endif
+
+static UA_EpochReader *
+getReader(UA_EpochMap *ns) {
+#ifndef UA_ENABLE_MULTITHREADING
+    return &ns->reader;
+#else
+    UA_EpochReader *reader = (UA_EpochReader*)pthread_getspecific(ns->readerKey);
+    if(reader)
+        return reader;
+
+    /* Reuse the record of a terminated thread */
+    for(reader = ns->readers; reader; reader = reader->next) {
+        if(reader->inUse == 0 && UA_atomic_cmpxchgSize(&reader->inUse, 0, 1) == 0)
+            break;
+    }
+
+    /* Add a new record */
+    if(!reader) {
+        reader = (UA_EpochReader*)UA_calloc(1, sizeof(UA_EpochReader));
+        if(!reader)
+            return NULL;
+        reader->inUse = 1;
+        UA_EpochReader *next;
+        do {
+            next = ns->readers;
+            reader->next = next;
+        } while(UA_atomic_cmpxchg((void * volatile *)&ns->readers, next, reader) != next);
+    }
+
+    pthread_setspecific(ns->readerKey, reader);
+    return reader;
+#endif
+}
+
+/* Mark the thread as active in the current epoch. The shared memory is only
+ * read after the state is visible to the writers. */
+static UA_EpochReader *
+enterEpoch(UA_EpochMap *ns) {
+    UA_EpochReader *reader = getReader(ns);
+    if(!reader)
+        return NULL;
+    if(reader->nesting++ == 0) {
+        reader->state = (ns->epoch << 1) | 1;
+        UA_atomic_sync();
+    }
+    return reader;
+}
+
+static void
+leaveEpoch(UA_EpochReader *reader) {
+    UA_assert(reader->nesting > 0);
+    if(--reader->nesting == 0) {
+        UA_atomic_sync();
+        reader->state = 0;
+    }
+}
+
+/* Call with the write mutex. Memory is retired after it was unlinked. */
+static void
+retireEntry(UA_EpochMap *ns, UA_EpochEntry *entry) {
+    UA_atomic_sync();
+    entry->retiredEpoch = ns->epoch;
+    entry->retiredNext = ns->retiredEntries;
+    ns->retiredEntries = entry;
+}
+
+static void
+retireTable(UA_EpochMap *ns, UA_EpochTable *table) {
+    UA_atomic_sync();
+    table->retiredEpoch = ns->epoch;
+    table->retiredNext = ns->retiredTables;
+    ns->retiredTables = table;
+}
+
+/* Call with the write mutex. Advance the epoch if all active readers have
+ * seen the current epoch. Free the memory retired two epochs ago. */
+static void
+reclaim(UA_EpochMap *ns) {
+    size_t epoch = ns->epoch;
+    UA_atomic_sync();
+    UA_Boolean advance = true;
+    for(UA_EpochReader *reader = ns->readers; reader; reader = reader->next) {
+        size_t state = reader->state;
+        if((state & 1) && (state >> 1) != epoch) {
+            advance = false;
+            break;
+        }
+    }
+    if(advance) {
+        epoch++;
+        ns->epoch = epoch;
+        UA_atomic_sync();
+    }
+    if(epoch < 2)
+        return;
+
+    /* The lists are sorted by the retirement epoch. Cut off the old part. */
+    UA_EpochEntry **nextEntry = &ns->retiredEntries;
+    while(*nextEntry && (*nextEntry)->retiredEpoch > epoch - 2)
+        nextEntry = &(*nextEntry)->retiredNext;
+    UA_EpochEntry *entry = *nextEntry;
+    *nextEntry = NULL;
+    while(entry) {
+        UA_EpochEntry *next = entry->retiredNext;
+        deleteEntry(entry);
+        entry = next;
+    }
+
+    UA_EpochTable **nextTable = &ns->retiredTables;
+    while(*nextTable && (*nextTable)->retiredEpoch > epoch - 2)
+        nextTable = &(*nextTable)->retiredNext;
+    UA_EpochTable *table = *nextTable;
+    *nextTable = NULL;
+    while(table) {
+        UA_EpochTable *next = table->retiredNext;
+        UA_free(table);
+        table = next;
+    }
+}
+
+/* Call with the write mutex. The occupancy of the new table is about 50%. The
+ * readers continue to use the old table until it is replaced. */
+static UA_StatusCode
+resize(UA_EpochMap *ns) {
+    UA_EpochTable *otable = ns->table;
+    UA_UInt32 count = ns->count;
+    /* Resize only when table after removal of unused elements is either too
+       full or too empty */
+    if(count * 2 < otable->size &&
+       (count * 8 > otable->size || otable->size <= UA_EPOCHMAP_MINSIZE))
+        return UA_STATUSCODE_GOOD;
+
+    UA_EpochTable *ntable = newTable(count * 2);
+    if(!ntable)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0, j = 0; i < otable->size && j < count; ++i) {
+        UA_EpochEntry *entry = otable->entries[i];
+        if(entry <= UA_EPOCHMAP_TOMBSTONE)
+            continue;
+        UA_EpochEntry * volatile *slot = findFreeSlot(ntable, &entry->node.nodeId);
+        UA_assert(slot);
+        *slot = entry;
+        ++j;
+    }
+
+    UA_atomic_xchg((void * volatile *)&ns->table, ntable);
+    retireTable(ns, otable);
+    return UA_STATUSCODE_GOOD;
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+static UA_Node *
+UA_EpochMap_newNode(void *context, UA_NodeClass nodeClass) {
+    UA_EpochEntry *entry = newEntry(nodeClass);
+    if(!entry)
+        return NULL;
+    return &entry->node;
+}
+
+/* Only for nodes that were never visible to readers */
+static void
+UA_EpochMap_deleteNode(void *context, UA_Node *node) {
+    deleteEntry(container_of(node, UA_EpochEntry, node));
+}
+
+static const UA_Node *
+UA_EpochMap_getNode(void *context, const UA_NodeId *nodeid) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+    UA_EpochReader *reader = enterEpoch(ns);
+    if(!reader)
+        return NULL;
+    UA_EpochEntry *entry = findEntry(ns->table, nodeid);
+    if(!entry) {
+        leaveEpoch(reader);
+        return NULL;
+    }
+    return (const UA_Node*)&entry->node;
+}
+
+static void
+UA_EpochMap_releaseNode(void *context, const UA_Node *node) {
+    if(!node)
+        return;
+    UA_EpochReader *reader = getReader((UA_EpochMap*)context);
+    if(reader)
+        leaveEpoch(reader);
+}
+
+static UA_StatusCode
+UA_EpochMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
+                        UA_Node **outNode) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+    UA_EpochReader *reader = enterEpoch(ns);
+    if(!reader)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_EpochEntry *entry = findEntry(ns->table, nodeid);
+    if(!entry) {
+        leaveEpoch(reader);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+    UA_EpochEntry *newItem = newEntry(entry->node.nodeClass);
+    if(!newItem) {
+        leaveEpoch(reader);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_StatusCode retval = UA_Node_copy(&entry->node, &newItem->node);
+    if(retval == UA_STATUSCODE_GOOD) {
+        newItem->orig = entry; // store the pointer to the original
+        *outNode = &newItem->node;
+    } else {
+        deleteEntry(newItem);
+    }
+    leaveEpoch(reader);
+    return retval;
+}
+
+static UA_StatusCode
+UA_EpochMap_removeNode(void *context, const UA_NodeId *nodeid) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+    BEGIN_WRITE(ns);
+    UA_EpochEntry * volatile *slot = findOccupiedSlot(ns->table, nodeid);
+    if(!slot) {
+        END_WRITE(ns);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+    UA_EpochEntry *entry = (UA_EpochEntry*)
+        UA_atomic_xchg((void * volatile *)slot, UA_EPOCHMAP_TOMBSTONE);
+    retireEntry(ns, entry);
+    --ns->count;
+    /* Downsize the hashmap if it is very empty */
+    if(ns->count * 8 < ns->table->size && ns->table->size > 32)
+        resize(ns); /* Can fail. Just continue with the bigger hashmap. */
+    reclaim(ns);
+    END_WRITE(ns);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_EpochMap_insertNode(void *context, UA_Node *node,
+                       UA_NodeId *addedNodeId) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+    UA_EpochEntry *entry = container_of(node, UA_EpochEntry, node);
+    BEGIN_WRITE(ns);
+    if(ns->table->size * 3 <= ns->count * 4) {
+        if(resize(ns) != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            END_WRITE(ns);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+
+    UA_EpochTable *table = ns->table;
+    UA_EpochEntry * volatile *slot;
+    if(node->nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+            node->nodeId.identifier.numeric == 0) {
+        /* Create a random nodeid. Start at least with 50,000 to make sure we
+         * don not conflict with nodes from the spec. If we find a conflict, we
+         * just try another identifier until we have tried all possible
+         * identifiers. Since the size is prime and we don't change the
+         * increase val, we will reach the starting id again. */
+        UA_UInt32 size = table->size;
+        UA_UInt64 identifier = mod(50000 + size+1, UA_UINT32_MAX); // start value, use 64 bit container to avoid overflow
+        UA_UInt32 increase = mod2(ns->count+1, size);
+        UA_UInt32 startId = (UA_UInt32)identifier; // mod ensures us that the id is a valid 32 bit
+
+        do {
+            node->nodeId.identifier.numeric = (UA_UInt32)identifier;
+            slot = findFreeSlot(table, &node->nodeId);
+            if(slot)
+                break;
+            identifier += increase;
+            if(identifier >= size)
+                identifier -= size;
+        } while((UA_UInt32)identifier != startId);
+    } else {
+        slot = findFreeSlot(table, &node->nodeId);
+    }
+
+    if(!slot) {
+        deleteEntry(entry);
+        END_WRITE(ns);
+        return UA_STATUSCODE_BADNODEIDEXISTS;
+    }
+
+    /* Copy the NodeId */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            END_WRITE(ns);
+            return retval;
+        }
+    }
+
+    /* Publish the node. The atomic operation orders the writes to the node
+     * before the write to the slot. */
+    UA_atomic_xchg((void * volatile *)slot, entry);
+    ++ns->count;
+    reclaim(ns);
+    END_WRITE(ns);
+    return retval;
+}
+
+static UA_StatusCode
+UA_EpochMap_replaceNode(void *context, UA_Node *node) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+    UA_EpochEntry *newEntryContainer = container_of(node, UA_EpochEntry, node);
+    BEGIN_WRITE(ns);
+
+    /* Find the node */
+    UA_EpochEntry * volatile *slot = findOccupiedSlot(ns->table, &node->nodeId);
+    if(!slot) {
+        deleteEntry(newEntryContainer);
+        END_WRITE(ns);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* The node was already updated since the copy was made? */
+    UA_EpochEntry *oldEntryContainer = *slot;
+    if(oldEntryContainer != newEntryContainer->orig) {
+        deleteEntry(newEntryContainer);
+        END_WRITE(ns);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Swap the entry and retire the old version */
+    newEntryContainer->orig = NULL;
+    UA_atomic_xchg((void * volatile *)slot, newEntryContainer);
+    retireEntry(ns, oldEntryContainer);
+    reclaim(ns);
+    END_WRITE(ns);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_EpochMap_iterate(void *context, void *visitorContext,
+                    UA_NodestoreVisitor visitor) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+    UA_EpochReader *reader = enterEpoch(ns);
+    if(!reader)
+        return;
+    UA_EpochTable *table = ns->table;
+    for(UA_UInt32 i = 0; i < table->size; ++i) {
+        UA_EpochEntry *entry = table->entries[i];
+        if(entry > UA_EPOCHMAP_TOMBSTONE)
+            visitor(visitorContext, &entry->node);
+    }
+    leaveEpoch(reader);
+}
+
+static void
+UA_EpochMap_delete(void *context) {
+    UA_EpochMap *ns = (UA_EpochMap*)context;
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_key_delete(ns->readerKey);
+    pthread_mutex_destroy(&ns->writeMutex);
+    UA_EpochReader *reader = ns->readers;
+    while(reader) {
+        UA_EpochReader *next = reader->next;
+        UA_free(reader);
+        reader = next;
+    }
+#endif
+
+    /* Delete the retired memory */
+    UA_EpochEntry *entry = ns->retiredEntries;
+    while(entry) {
+        UA_EpochEntry *next = entry->retiredNext;
+        deleteEntry(entry);
+        entry = next;
+    }
+    UA_EpochTable *table = ns->retiredTables;
+    while(table) {
+        UA_EpochTable *next = table->retiredNext;
+        UA_free(table);
+        table = next;
+    }
+
+    /* Delete the nodes */
+    table = ns->table;
+    for(UA_UInt32 i = 0; i < table->size; ++i) {
+        if(table->entries[i] > UA_EPOCHMAP_TOMBSTONE)
+            deleteEntry(table->entries[i]);
+    }
+    UA_free(table);
+    UA_free(ns);
+}
+
+UA_StatusCode
+UA_Nodestore_epoch_new(UA_Nodestore *ns) {
+    /* Allocate and initialize the nodemap */
+    UA_EpochMap *epochmap = (UA_EpochMap*)UA_calloc(1, sizeof(UA_EpochMap));
+    if(!epochmap)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    epochmap->table = newTable(UA_EPOCHMAP_MINSIZE);
+    if(!epochmap->table) {
+        UA_free(epochmap);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+#ifdef UA_ENABLE_MULTITHREADING
+    if(pthread_key_create(&epochmap->readerKey, releaseReader) != 0) {
+        UA_free(epochmap->table);
+        UA_free(epochmap);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    pthread_mutex_init(&epochmap->writeMutex, NULL);
+#else
+    epochmap->readers = &epochmap->reader;
+#endif
+
+    /* Populate the nodestore */
+    ns->context = epochmap;
+    ns->deleteNodestore = UA_EpochMap_delete;
+    ns->inPlaceEditAllowed = false;
+    ns->newNode = UA_EpochMap_newNode;
+    ns->deleteNode = UA_EpochMap_deleteNode;
+    ns->getNode = UA_EpochMap_getNode;
+    ns->releaseNode = UA_EpochMap_releaseNode;
+    ns->retainNode = NULL; /* Readers cannot hold nodes across epochs */
+    ns->getNodeCopy = UA_EpochMap_getNodeCopy;
+    ns->insertNode = UA_EpochMap_insertNode;
+    ns->replaceNode = UA_EpochMap_replaceNode;
+    ns->removeNode = UA_EpochMap_removeNode;
+    ns->iterate = UA_EpochMap_iterate;
+
+    return UA_STATUSCODE_GOOD;
+}
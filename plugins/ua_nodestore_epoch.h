@@ -0,0 +1,32 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#ifndef UA_NODESTORE_EPOCH_H_
+#define UA_NODESTORE_EPOCH_H_
+
+#include "ua_plugin_nodestore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Initializes a nodestore where reading threads never lock. Nodes are edited
+ * by copy and replace. Replaced and removed nodes are freed when all threads
+ * that could still read them have released their nodes (epoch-based
+ * reclamation). Intended for servers with UA_ENABLE_MULTITHREADING. To use it,
+ * replace the default nodestore in the server configuration:
+ *
+ *   config->nodestore.deleteNodestore(config->nodestore.context);
+ *   UA_Nodestore_epoch_new(&config->nodestore);
+ *
+ * A thread must release all nodes it got from the nodestore before it returns
+ * to an idle state. Otherwise memory is not reclaimed. */
+UA_StatusCode UA_EXPORT
+UA_Nodestore_epoch_new(UA_Nodestore *ns);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* UA_NODESTORE_EPOCH_H_ */
@@ -0,0 +1,673 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#include "ua_nodestore_snapshot.h"
+
+#include "../src/ua_types_encoding_binary.h"
+
+#ifdef UA_ENABLE_MULTITHREADING
+#include <pthread.h>
+#define LOCK_STORE(STORE) pthread_mutex_lock(&(STORE)->mutex)
+#define UNLOCK_STORE(STORE) pthread_mutex_unlock(&(STORE)->mutex)
+#else
+#define LOCK_STORE(STORE)
+#define UNLOCK_STORE(STORE)
+#endif
+
+/* Layout of a snapshot. All integers are little-endian.
+ *
+ * Header: magic, version, number of nodes, number of index slots (UInt32 each)
+ * Index: slots of (NodeId hash, record offset). The offset is zero for empty
+ *        slots. Linear probing from the hash modulo the number of slots.
+ * Records: the nodes in the binary encoding of their attributes. Every record
+ *          begins with the NodeId and the NodeClass. */
+
+#define UA_SNAPSHOT_MAGIC 0x4e534155 /* "UASN" */
+#define UA_SNAPSHOT_VERSION 1
+#define UA_SNAPSHOT_HEADERSIZE 16
+#define UA_SNAPSHOT_SLOTSIZE 8
+#define UA_SNAPSHOT_MININDEXSIZE 16
+
+static UA_UInt32
+readUInt32(const UA_Byte *pos) {
+    return (UA_UInt32)pos[0] | ((UA_UInt32)pos[1] << 8) |
+        ((UA_UInt32)pos[2] << 16) | ((UA_UInt32)pos[3] << 24);
+}
+
+static void
+writeUInt32(UA_Byte *pos, UA_UInt32 value) {
+    pos[0] = (UA_Byte)value;
+    pos[1] = (UA_Byte)(value >> 8);
+    pos[2] = (UA_Byte)(value >> 16);
+    pos[3] = (UA_Byte)(value >> 24);
+}
+
+/************/
+/* Encoding */
+/************/
+
+typedef struct {
+    UA_ByteString buf;
+    size_t length; /* Bytes used in the buffer */
+    UA_StatusCode retval;
+} SnapshotWriter;
+
+static void
+writeValue(SnapshotWriter *w, const void *src, const UA_DataType *type) {
+    if(w->retval != UA_STATUSCODE_GOOD)
+        return;
+
+    /* Grow the buffer */
+    size_t size = UA_calcSizeBinary(src, type);
+    if(w->length + size > w->buf.length) {
+        size_t newLength = w->buf.length * 2;
+        if(newLength < w->length + size)
+            newLength = w->length + size + 1024;
+        UA_Byte *data = (UA_Byte*)UA_realloc(w->buf.data, newLength);
+        if(!data) {
+            w->retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        w->buf.data = data;
+        w->buf.length = newLength;
+    }
+
+    UA_Byte *pos = &w->buf.data[w->length];
+    const UA_Byte *end = &w->buf.data[w->buf.length];
+    w->retval = UA_encodeBinary(src, type, &pos, &end, NULL, NULL);
+    w->length = (size_t)(pos - w->buf.data);
+}
+
+static void
+writeSize(SnapshotWriter *w, size_t size) {
+    if(size > UA_UINT32_MAX) {
+        w->retval = UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+        return;
+    }
+    UA_UInt32 size32 = (UA_UInt32)size;
+    writeValue(w, &size32, &UA_TYPES[UA_TYPES_UINT32]);
+}
+
+/* VariableNodes and VariableTypeNodes have the same layout up to the value */
+static void
+writeVariableAttributes(SnapshotWriter *w, const UA_VariableNode *node) {
+    writeValue(w, &node->dataType, &UA_TYPES[UA_TYPES_NODEID]);
+    writeValue(w, &node->valueRank, &UA_TYPES[UA_TYPES_INT32]);
+    writeSize(w, node->arrayDimensionsSize);
+    for(size_t i = 0; i < node->arrayDimensionsSize; ++i)
+        writeValue(w, &node->arrayDimensions[i], &UA_TYPES[UA_TYPES_UINT32]);
+
+    /* DataSources are set up again at runtime */
+    UA_DataValue empty;
+    UA_DataValue_init(&empty);
+    const UA_DataValue *value = &empty;
+    if(node->valueSource == UA_VALUESOURCE_DATA)
+        value = &node->value.data.value;
+    writeValue(w, value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+static void
+writeNode(SnapshotWriter *w, const UA_Node *node) {
+    writeValue(w, &node->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    writeValue(w, &node->nodeClass, &UA_TYPES[UA_TYPES_NODECLASS]);
+    writeValue(w, &node->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    writeValue(w, &node->displayName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    writeValue(w, &node->description, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    writeValue(w, &node->writeMask, &UA_TYPES[UA_TYPES_UINT32]);
+
+    writeSize(w, node->referencesSize);
+    for(size_t i = 0; i < node->referencesSize; ++i) {
+        const UA_NodeReferenceKind *rk = &node->references[i];
+        writeValue(w, &rk->referenceTypeId, &UA_TYPES[UA_TYPES_NODEID]);
+        writeValue(w, &rk->isInverse, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeSize(w, rk->targetIdsSize);
+        for(size_t j = 0; j < rk->targetIdsSize; ++j)
+            writeValue(w, &rk->targetIds[j], &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    }
+
+    switch(node->nodeClass) {
+    case UA_NODECLASS_OBJECT: {
+        const UA_ObjectNode *on = (const UA_ObjectNode*)node;
+        writeValue(w, &on->eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        break;
+    }
+    case UA_NODECLASS_VARIABLE: {
+        const UA_VariableNode *vn = (const UA_VariableNode*)node;
+        writeVariableAttributes(w, vn);
+        writeValue(w, &vn->accessLevel, &UA_TYPES[UA_TYPES_BYTE]);
+        writeValue(w, &vn->minimumSamplingInterval, &UA_TYPES[UA_TYPES_DOUBLE]);
+        writeValue(w, &vn->historizing, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_METHOD: {
+        const UA_MethodNode *mn = (const UA_MethodNode*)node;
+        writeValue(w, &mn->executable, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_OBJECTTYPE: {
+        const UA_ObjectTypeNode *otn = (const UA_ObjectTypeNode*)node;
+        writeValue(w, &otn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_VARIABLETYPE: {
+        const UA_VariableTypeNode *vtn = (const UA_VariableTypeNode*)node;
+        writeVariableAttributes(w, (const UA_VariableNode*)node);
+        writeValue(w, &vtn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_REFERENCETYPE: {
+        const UA_ReferenceTypeNode *rtn = (const UA_ReferenceTypeNode*)node;
+        writeValue(w, &rtn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeValue(w, &rtn->symmetric, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeValue(w, &rtn->inverseName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        break;
+    }
+    case UA_NODECLASS_DATATYPE: {
+        const UA_DataTypeNode *dtn = (const UA_DataTypeNode*)node;
+        writeValue(w, &dtn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_VIEW: {
+        const UA_ViewNode *vn = (const UA_ViewNode*)node;
+        writeValue(w, &vn->eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        writeValue(w, &vn->containsNoLoops, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    default:
+        w->retval = UA_STATUSCODE_BADINTERNALERROR;
+        break;
+    }
+}
+
+typedef struct {
+    UA_UInt32 hash;
+    size_t offset; /* In the records */
+} SnapshotIndexEntry;
+
+typedef struct {
+    SnapshotWriter records;
+    size_t entriesSize;
+    size_t entriesCapacity;
+    SnapshotIndexEntry *entries;
+} SnapshotEncodeContext;
+
+static void
+encodeVisitor(void *visitorContext, const UA_Node *node) {
+    SnapshotEncodeContext *ctx = (SnapshotEncodeContext*)visitorContext;
+    if(ctx->records.retval != UA_STATUSCODE_GOOD)
+        return;
+
+    if(ctx->entriesSize == ctx->entriesCapacity) {
+        size_t capacity = ctx->entriesCapacity * 2;
+        if(capacity == 0)
+            capacity = 1024;
+        SnapshotIndexEntry *entries = (SnapshotIndexEntry*)
+            UA_realloc(ctx->entries, capacity * sizeof(SnapshotIndexEntry));
+        if(!entries) {
+            ctx->records.retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        ctx->entries = entries;
+        ctx->entriesCapacity = capacity;
+    }
+
+    SnapshotIndexEntry *entry = &ctx->entries[ctx->entriesSize++];
+    entry->hash = UA_NodeId_hash(&node->nodeId);
+    entry->offset = ctx->records.length;
+    writeNode(&ctx->records, node);
+}
+
+UA_StatusCode
+UA_Nodestore_snapshot_encode(UA_Nodestore *ns, UA_ByteString *snapshot) {
+    /* Encode the records */
+    SnapshotEncodeContext ctx;
+    memset(&ctx, 0, sizeof(SnapshotEncodeContext));
+    ns->iterate(ns->context, &ctx, encodeVisitor);
+    UA_StatusCode retval = ctx.records.retval;
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    /* Keep the index at most half full */
+    size_t indexSize = UA_SNAPSHOT_MININDEXSIZE;
+    while(indexSize < ctx.entriesSize * 2)
+        indexSize *= 2;
+    size_t recordsStart = UA_SNAPSHOT_HEADERSIZE + (indexSize * UA_SNAPSHOT_SLOTSIZE);
+    if(indexSize > UA_UINT32_MAX || recordsStart + ctx.records.length > UA_UINT32_MAX) {
+        retval = UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+        goto cleanup;
+    }
+
+    retval = UA_ByteString_allocBuffer(snapshot, recordsStart + ctx.records.length);
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    /* Header */
+    writeUInt32(&snapshot->data[0], UA_SNAPSHOT_MAGIC);
+    writeUInt32(&snapshot->data[4], UA_SNAPSHOT_VERSION);
+    writeUInt32(&snapshot->data[8], (UA_UInt32)ctx.entriesSize);
+    writeUInt32(&snapshot->data[12], (UA_UInt32)indexSize);
+
+    /* Index */
+    UA_Byte *index = &snapshot->data[UA_SNAPSHOT_HEADERSIZE];
+    memset(index, 0, indexSize * UA_SNAPSHOT_SLOTSIZE);
+    size_t mask = indexSize - 1;
+    for(size_t i = 0; i < ctx.entriesSize; ++i) {
+        size_t slot = ctx.entries[i].hash & mask;
+        while(readUInt32(&index[(slot * UA_SNAPSHOT_SLOTSIZE) + 4]) != 0)
+            slot = (slot + 1) & mask;
+        writeUInt32(&index[slot * UA_SNAPSHOT_SLOTSIZE], ctx.entries[i].hash);
+        writeUInt32(&index[(slot * UA_SNAPSHOT_SLOTSIZE) + 4],
+                    (UA_UInt32)(recordsStart + ctx.entries[i].offset));
+    }
+
+    /* Records */
+    if(ctx.records.length > 0)
+        memcpy(&snapshot->data[recordsStart], ctx.records.buf.data, ctx.records.length);
+
+ cleanup:
+    UA_free(ctx.records.buf.data);
+    UA_free(ctx.entries);
+    return retval;
+}
+
+/************/
+/* Decoding */
+/************/
+
+typedef struct {
+    const UA_ByteString *snapshot;
+    size_t offset;
+    UA_StatusCode retval;
+} SnapshotReader;
+
+static void
+readValue(SnapshotReader *r, void *dst, const UA_DataType *type) {
+    if(r->retval != UA_STATUSCODE_GOOD) {
+        memset(dst, 0, type->memSize);
+        return;
+    }
+    r->retval = UA_decodeBinary(r->snapshot, &r->offset, dst, type, 0, NULL);
+}
+
+static UA_UInt32
+readSize(SnapshotReader *r) {
+    UA_UInt32 size;
+    readValue(r, &size, &UA_TYPES[UA_TYPES_UINT32]);
+    return size;
+}
+
+static void
+readVariableAttributes(SnapshotReader *r, UA_VariableNode *node) {
+    readValue(r, &node->dataType, &UA_TYPES[UA_TYPES_NODEID]);
+    readValue(r, &node->valueRank, &UA_TYPES[UA_TYPES_INT32]);
+    UA_UInt32 dimsSize = readSize(r);
+    if(dimsSize > 0 && r->retval == UA_STATUSCODE_GOOD) {
+        /* Every dimension takes four bytes */
+        if(dimsSize > (r->snapshot->length - r->offset) / 4) {
+            r->retval = UA_STATUSCODE_BADDECODINGERROR;
+            return;
+        }
+        node->arrayDimensions = (UA_UInt32*)
+            UA_Array_new(dimsSize, &UA_TYPES[UA_TYPES_UINT32]);
+        if(!node->arrayDimensions) {
+            r->retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        node->arrayDimensionsSize = dimsSize;
+        for(size_t i = 0; i < dimsSize; ++i)
+            readValue(r, &node->arrayDimensions[i], &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    node->valueSource = UA_VALUESOURCE_DATA;
+    readValue(r, &node->value.data.value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_VariableNode_inlineValue(node);
+}
+
+static void
+readReferences(SnapshotReader *r, UA_Node *node) {
+    UA_UInt32 refsSize = readSize(r);
+    for(size_t i = 0; i < refsSize && r->retval == UA_STATUSCODE_GOOD; ++i) {
+        UA_AddReferencesItem item;
+        UA_AddReferencesItem_init(&item);
+        UA_Boolean isInverse;
+        readValue(r, &item.referenceTypeId, &UA_TYPES[UA_TYPES_NODEID]);
+        readValue(r, &isInverse, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        item.isForward = !isInverse;
+        UA_UInt32 targetsSize = readSize(r);
+        for(size_t j = 0; j < targetsSize && r->retval == UA_STATUSCODE_GOOD; ++j) {
+            readValue(r, &item.targetNodeId, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+            if(r->retval == UA_STATUSCODE_GOOD)
+                r->retval = UA_Node_addReference(node, &item);
+            UA_ExpandedNodeId_deleteMembers(&item.targetNodeId);
+        }
+        UA_NodeId_deleteMembers(&item.referenceTypeId);
+    }
+}
+
+/* Creates the node in the overlay nodestore (not yet inserted) */
+static UA_StatusCode
+readNode(const UA_ByteString *snapshot, size_t offset,
+         UA_Nodestore *overlay, UA_Node **outNode) {
+    SnapshotReader r = {snapshot, offset, UA_STATUSCODE_GOOD};
+    UA_NodeId nodeId;
+    UA_NodeClass nodeClass;
+    readValue(&r, &nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    readValue(&r, &nodeClass, &UA_TYPES[UA_TYPES_NODECLASS]);
+    if(r.retval != UA_STATUSCODE_GOOD) {
+        UA_NodeId_deleteMembers(&nodeId);
+        return r.retval;
+    }
+
+    UA_Node *node = overlay->newNode(overlay->context, nodeClass);
+    if(!node) {
+        UA_NodeId_deleteMembers(&nodeId);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    node->nodeId = nodeId;
+    readValue(&r, &node->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    readValue(&r, &node->displayName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    readValue(&r, &node->description, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    readValue(&r, &node->writeMask, &UA_TYPES[UA_TYPES_UINT32]);
+    readReferences(&r, node);
+
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT: {
+        UA_ObjectNode *on = (UA_ObjectNode*)node;
+        readValue(&r, &on->eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        break;
+    }
+    case UA_NODECLASS_VARIABLE: {
+        UA_VariableNode *vn = (UA_VariableNode*)node;
+        readVariableAttributes(&r, vn);
+        readValue(&r, &vn->accessLevel, &UA_TYPES[UA_TYPES_BYTE]);
+        readValue(&r, &vn->minimumSamplingInterval, &UA_TYPES[UA_TYPES_DOUBLE]);
+        readValue(&r, &vn->historizing, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_METHOD: {
+        UA_MethodNode *mn = (UA_MethodNode*)node;
+        readValue(&r, &mn->executable, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_OBJECTTYPE: {
+        UA_ObjectTypeNode *otn = (UA_ObjectTypeNode*)node;
+        readValue(&r, &otn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_VARIABLETYPE: {
+        UA_VariableTypeNode *vtn = (UA_VariableTypeNode*)node;
+        readVariableAttributes(&r, (UA_VariableNode*)node);
+        readValue(&r, &vtn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_REFERENCETYPE: {
+        UA_ReferenceTypeNode *rtn = (UA_ReferenceTypeNode*)node;
+        readValue(&r, &rtn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        readValue(&r, &rtn->symmetric, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        readValue(&r, &rtn->inverseName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        break;
+    }
+    case UA_NODECLASS_DATATYPE: {
+        UA_DataTypeNode *dtn = (UA_DataTypeNode*)node;
+        readValue(&r, &dtn->isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    case UA_NODECLASS_VIEW: {
+        UA_ViewNode *vn = (UA_ViewNode*)node;
+        readValue(&r, &vn->eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        readValue(&r, &vn->containsNoLoops, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    }
+    default:
+        r.retval = UA_STATUSCODE_BADDECODINGERROR;
+        break;
+    }
+
+    if(r.retval != UA_STATUSCODE_GOOD) {
+        overlay->deleteNode(overlay->context, node);
+        return r.retval;
+    }
+    *outNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+/**********************/
+/* Snapshot Nodestore */
+/**********************/
+
+/* The nodes of the snapshot are decoded into the overlay when they are first
+ * accessed. From then on, the overlay is authoritative for the NodeId. So a
+ * removed node is not found in the snapshot again. */
+typedef struct {
+    UA_ByteString snapshot; /* Not owned */
+    UA_UInt32 indexSize;
+    UA_Boolean *materialized; /* For every index slot */
+    UA_UInt32 nextId; /* Candidate for fresh numeric NodeIds */
+    UA_Nodestore overlay;
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_t mutex; /* Protects the materialized flags */
+#endif
+} UA_SnapshotStore;
+
+static const UA_Byte *
+indexSlot(const UA_SnapshotStore *store, UA_UInt32 slot) {
+    return &store->snapshot.data[UA_SNAPSHOT_HEADERSIZE +
+                                 ((size_t)slot * UA_SNAPSHOT_SLOTSIZE)];
+}
+
+/* Returns the index slot of the node or indexSize if not found */
+static UA_UInt32
+findSlot(const UA_SnapshotStore *store, const UA_NodeId *nodeId) {
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    UA_UInt32 mask = store->indexSize - 1;
+    UA_UInt32 slot = hash & mask;
+    for(UA_UInt32 probes = 0; probes < store->indexSize; ++probes) {
+        const UA_Byte *entry = indexSlot(store, slot);
+        UA_UInt32 offset = readUInt32(&entry[4]);
+        if(offset == 0)
+            break;
+        if(readUInt32(entry) == hash) {
+            size_t pos = offset;
+            UA_NodeId id;
+            if(UA_decodeBinary(&store->snapshot, &pos, &id,
+                               &UA_TYPES[UA_TYPES_NODEID], 0, NULL) == UA_STATUSCODE_GOOD) {
+                UA_Boolean match = UA_NodeId_equal(&id, nodeId);
+                UA_NodeId_deleteMembers(&id);
+                if(match)
+                    return slot;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+    return store->indexSize;
+}
+
+/* Returns whether the overlay is authoritative for the node of the slot. Call
+ * only with the lock held. */
+static UA_Boolean
+materializeSlot(UA_SnapshotStore *store, UA_UInt32 slot) {
+    if(store->materialized[slot])
+        return true;
+    UA_Node *node = NULL;
+    UA_StatusCode retval = readNode(&store->snapshot, readUInt32(&indexSlot(store, slot)[4]),
+                                    &store->overlay, &node);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = store->overlay.insertNode(store->overlay.context, node, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        return false;
+    store->materialized[slot] = true;
+    return true;
+}
+
+/* Returns whether the node is (or was) in the snapshot and has been decoded
+ * into the overlay */
+static UA_Boolean
+materialize(UA_SnapshotStore *store, const UA_NodeId *nodeId) {
+    LOCK_STORE(store);
+    UA_Boolean decoded = false;
+    UA_UInt32 slot = findSlot(store, nodeId);
+    if(slot < store->indexSize)
+        decoded = materializeSlot(store, slot);
+    UNLOCK_STORE(store);
+    return decoded;
+}
+
+static UA_Node *
+UA_SnapshotStore_newNode(void *context, UA_NodeClass nodeClass) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    return store->overlay.newNode(store->overlay.context, nodeClass);
+}
+
+static void
+UA_SnapshotStore_deleteNode(void *context, UA_Node *node) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    store->overlay.deleteNode(store->overlay.context, node);
+}
+
+static const UA_Node *
+UA_SnapshotStore_getNode(void *context, const UA_NodeId *nodeId) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    const UA_Node *node = store->overlay.getNode(store->overlay.context, nodeId);
+    if(node || !materialize(store, nodeId))
+        return node;
+    return store->overlay.getNode(store->overlay.context, nodeId);
+}
+
+static void
+UA_SnapshotStore_releaseNode(void *context, const UA_Node *node) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    store->overlay.releaseNode(store->overlay.context, node);
+}
+
+static const UA_Node *
+UA_SnapshotStore_retainNode(void *context, const UA_Node *node) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    return store->overlay.retainNode(store->overlay.context, node);
+}
+
+static UA_StatusCode
+UA_SnapshotStore_getNodeCopy(void *context, const UA_NodeId *nodeId,
+                             UA_Node **outNode) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    materialize(store, nodeId);
+    return store->overlay.getNodeCopy(store->overlay.context, nodeId, outNode);
+}
+
+static UA_StatusCode
+UA_SnapshotStore_insertNode(void *context, UA_Node *node, UA_NodeId *addedNodeId) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    LOCK_STORE(store);
+    if(node->nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+       node->nodeId.identifier.numeric == 0) {
+        /* Create a fresh NodeId that is unknown to the overlay and to the
+         * snapshot. Start with 50,000 to not conflict with nodes from the
+         * spec. */
+        while(true) {
+            if(store->nextId < 50000)
+                store->nextId = 50000;
+            node->nodeId.identifier.numeric = store->nextId++;
+            if(findSlot(store, &node->nodeId) < store->indexSize)
+                continue;
+            const UA_Node *other =
+                store->overlay.getNode(store->overlay.context, &node->nodeId);
+            if(!other)
+                break;
+            store->overlay.releaseNode(store->overlay.context, other);
+        }
+    } else {
+        /* The snapshot contains the node */
+        UA_UInt32 slot = findSlot(store, &node->nodeId);
+        if(slot < store->indexSize && !store->materialized[slot]) {
+            UNLOCK_STORE(store);
+            store->overlay.deleteNode(store->overlay.context, node);
+            return UA_STATUSCODE_BADNODEIDEXISTS;
+        }
+    }
+    UA_StatusCode retval =
+        store->overlay.insertNode(store->overlay.context, node, addedNodeId);
+    UNLOCK_STORE(store);
+    return retval;
+}
+
+static UA_StatusCode
+UA_SnapshotStore_replaceNode(void *context, UA_Node *node) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    materialize(store, &node->nodeId);
+    return store->overlay.replaceNode(store->overlay.context, node);
+}
+
+static UA_StatusCode
+UA_SnapshotStore_removeNode(void *context, const UA_NodeId *nodeId) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    materialize(store, nodeId);
+    return store->overlay.removeNode(store->overlay.context, nodeId);
+}
+
+static void
+UA_SnapshotStore_iterate(void *context, void *visitorContext,
+                         UA_NodestoreVisitor visitor) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    LOCK_STORE(store);
+    for(UA_UInt32 slot = 0; slot < store->indexSize; ++slot) {
+        if(readUInt32(&indexSlot(store, slot)[4]) != 0)
+            materializeSlot(store, slot);
+    }
+    UNLOCK_STORE(store);
+    store->overlay.iterate(store->overlay.context, visitorContext, visitor);
+}
+
+static void
+UA_SnapshotStore_delete(void *context) {
+    UA_SnapshotStore *store = (UA_SnapshotStore*)context;
+    store->overlay.deleteNodestore(store->overlay.context);
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_destroy(&store->mutex);
+#endif
+    UA_free(store->materialized);
+    UA_free(store);
+}
+
+UA_StatusCode
+UA_Nodestore_snapshot_new(UA_Nodestore *ns, const UA_ByteString *snapshot,
+                          UA_Nodestore *overlay) {
+    /* Check the header */
+    if(snapshot->length < UA_SNAPSHOT_HEADERSIZE ||
+       readUInt32(&snapshot->data[0]) != UA_SNAPSHOT_MAGIC ||
+       readUInt32(&snapshot->data[4]) != UA_SNAPSHOT_VERSION)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    UA_UInt32 indexSize = readUInt32(&snapshot->data[12]);
+    if(indexSize == 0 || (indexSize & (indexSize - 1)) != 0 ||
+       indexSize > (snapshot->length - UA_SNAPSHOT_HEADERSIZE) / UA_SNAPSHOT_SLOTSIZE)
+        return UA_STATUSCODE_BADDECODINGERROR;
+
+    UA_SnapshotStore *store = (UA_SnapshotStore*)UA_calloc(1, sizeof(UA_SnapshotStore));
+    if(!store)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    store->materialized = (UA_Boolean*)UA_calloc(indexSize, sizeof(UA_Boolean));
+    if(!store->materialized) {
+        UA_free(store);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    store->snapshot = *snapshot;
+    store->indexSize = indexSize;
+    store->overlay = *overlay;
+#ifdef UA_ENABLE_MULTITHREADING
+    pthread_mutex_init(&store->mutex, NULL);
+#endif
+
+    /* Populate the nodestore */
+    ns->context = store;
+    ns->deleteNodestore = UA_SnapshotStore_delete;
+    ns->inPlaceEditAllowed = overlay->inPlaceEditAllowed;
+    ns->newNode = UA_SnapshotStore_newNode;
+    ns->deleteNode = UA_SnapshotStore_deleteNode;
+    ns->getNode = UA_SnapshotStore_getNode;
+    ns->releaseNode = UA_SnapshotStore_releaseNode;
+    ns->retainNode = overlay->retainNode ? UA_SnapshotStore_retainNode : NULL;
+    ns->getNodeCopy = UA_SnapshotStore_getNodeCopy;
+    ns->insertNode = UA_SnapshotStore_insertNode;
+    ns->replaceNode = UA_SnapshotStore_replaceNode;
+    ns->removeNode = UA_SnapshotStore_removeNode;
+    ns->iterate = UA_SnapshotStore_iterate;
+    return UA_STATUSCODE_GOOD;
+}
@@ -0,0 +1,50 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#ifndef UA_NODESTORE_SNAPSHOT_H_
+#define UA_NODESTORE_SNAPSHOT_H_
+
+#include "ua_plugin_nodestore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A snapshot is a read-only binary image of an address space. It contains a
+ * hash index over the NodeIds, so that nodes are found without parsing the
+ * entire snapshot. Function pointers and context pointers of the nodes
+ * (DataSources, value and method callbacks, lifecycles) are not part of the
+ * snapshot. Variables with a DataSource are stored with an empty value. The
+ * snapshot can only be used on machines with the same byte order for Guid
+ * NodeIds.
+ *
+ * Encodes all nodes of the nodestore into a snapshot. The snapshot buffer is
+ * allocated and has to be freed with UA_ByteString_deleteMembers. */
+UA_StatusCode UA_EXPORT
+UA_Nodestore_snapshot_encode(UA_Nodestore *ns, UA_ByteString *snapshot);
+
+/* Initializes a nodestore that serves the nodes of a snapshot. The snapshot is
+ * not copied and must remain valid (and unchanged) until the nodestore is
+ * deleted. For example, the snapshot can be a memory-mapped file or a constant
+ * array in flash memory. Nodes are decoded from the snapshot when they are
+ * first accessed and then kept in the overlay nodestore. The overlay also
+ * contains all nodes added at runtime. The overlay is taken over and deleted
+ * together with the snapshot nodestore.
+ *
+ * Values with datatypes that are not in UA_TYPES remain encoded in an
+ * ExtensionObject.
+ *
+ * If the snapshot contains namespace zero, the server does not create it
+ * again. It only sets up the DataSources and callbacks of namespace zero. For
+ * nodes in namespaces other than zero and one, the namespaces have to be added
+ * to the server in the same order as when the snapshot was created. */
+UA_StatusCode UA_EXPORT
+UA_Nodestore_snapshot_new(UA_Nodestore *ns, const UA_ByteString *snapshot,
+                          UA_Nodestore *overlay);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* UA_NODESTORE_SNAPSHOT_H_ */
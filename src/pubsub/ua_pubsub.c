@@ -1196,10 +1196,13 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         //fieldNamesPerWriter
         if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON){
             UA_ByteString buf;
-            size_t msgSize = 2000; //WIP, TODO: get Json buffer size!
+            size_t msgSize = UA_NetworkMessage_calcSizeJson(&nmStore[i], UA_TRUE, fieldNamesPerWriter, indexKeyArrayField);
+            if(msgSize == 0) {
+                UA_LOG_ERROR(server->config.logger, UA_LOGCATEGORY_SERVER, "Publish failed. JSON NetworkMessage cannot be encoded.");
+                return;
+            }
             if(UA_ByteString_allocBuffer(&buf, msgSize) == UA_STATUSCODE_GOOD) {
                 UA_Byte *bufPos = buf.data;
-                memset(bufPos, 0, msgSize);
                 const UA_Byte *bufEnd = &(buf.data[buf.length]);
                 if(UA_NetworkMessage_encodeJson(&nmStore[i], &bufPos, bufEnd, UA_TRUE, fieldNamesPerWriter, indexKeyArrayField) != UA_STATUSCODE_GOOD){
                     UA_ByteString_deleteMembers(&buf);
@@ -1221,11 +1224,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
                  *  ]
                  * }
                  */
-                
-                //TODO: How can we calculate the size?
-                size_t len = strlen((char*)buf.data);
-                buf.length = len;
-                
+                buf.length = (size_t)(bufPos - buf.data);
                 connection->channel->send(connection->channel, &writerGroup->config.transportSettings, &buf);
             }
             UA_ByteString_deleteMembers(&buf);
@@ -1262,13 +1261,13 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
 /*
  * Add new publishCallback. The first execution is triggered directly after creation.
- * @Warning - The duration (double) is currently casted to int. -> intervals smaller 1ms are not possible.
+ * Intervals below one millisecond are possible (see UA_TIMER_MININTERVAL_NSEC).
  */
 UA_StatusCode
 UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     UA_StatusCode retval =
             UA_PubSubManager_addRepeatedCallback(server, (UA_ServerCallback) UA_WriterGroup_publishCallback,
-                                                 writerGroup, (UA_UInt32) writerGroup->config.publishingInterval,
+                                                 writerGroup, writerGroup->config.publishingInterval,
                                                  &writerGroup->publishCallbackId);
     if(retval == UA_STATUSCODE_GOOD)
         writerGroup->publishCallbackIsRegistered = true;
@@ -291,17 +291,34 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
 /***********************************/
 /*      PubSub Jobs abstraction    */
 /***********************************/
+/* Convert the interval from milliseconds to nanoseconds */
+static UA_StatusCode
+intervalToNsec(UA_Duration interval, UA_UInt64 *nsec) {
+    if(!(interval > 0.0) || interval > (UA_Duration)UA_UINT32_MAX)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    *nsec = (UA_UInt64)(interval * 1000000.0 + 0.5);
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_PubSubManager_addRepeatedCallback(UA_Server *server, UA_ServerCallback callback,
-                                     void *data, UA_UInt32 interval, UA_UInt64 *callbackId) {
-    return UA_Timer_addRepeatedCallback(&server->timer, (UA_TimerCallback)callback,
-                                        data, interval, callbackId);
+                                     void *data, UA_Duration interval, UA_UInt64 *callbackId) {
+    UA_UInt64 nsec;
+    UA_StatusCode retval = intervalToNsec(interval, &nsec);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return UA_Timer_addRepeatedCallbackNsec(&server->timer, (UA_TimerCallback)callback,
+                                            data, nsec, callbackId);
 }
 
 UA_StatusCode
 UA_PubSubManager_changeRepeatedCallbackInterval(UA_Server *server, UA_UInt64 callbackId,
-                                                UA_UInt32 interval) {
-    return UA_Timer_changeRepeatedCallbackInterval(&server->timer, callbackId, interval);
+                                                UA_Duration interval) {
+    UA_UInt64 nsec;
+    UA_StatusCode retval = intervalToNsec(interval, &nsec);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return UA_Timer_changeRepeatedCallbackIntervalNsec(&server->timer, callbackId, nsec);
 }
 
 UA_StatusCode
@@ -37,12 +37,14 @@ UA_PubSubConfigurationVersionTimeDifference(void);
 /***********************************/
 /*      PubSub Jobs abstraction    */
 /***********************************/
+/* The interval is given in milliseconds. Fractions of a millisecond down to
+ * UA_TIMER_MININTERVAL_NSEC are possible. */
 UA_StatusCode
 UA_PubSubManager_addRepeatedCallback(UA_Server *server, UA_ServerCallback callback,
-                                     void *data, UA_UInt32 interval, UA_UInt64 *callbackId);
+                                     void *data, UA_Duration interval, UA_UInt64 *callbackId);
 UA_StatusCode
 UA_PubSubManager_changeRepeatedCallbackInterval(UA_Server *server, UA_UInt64 callbackId,
-                                                UA_UInt32 interval);
+                                                UA_Duration interval);
 UA_StatusCode
 UA_PubSubManager_removeRepeatedPubSubCallback(UA_Server *server, UA_UInt64 callbackId);
 
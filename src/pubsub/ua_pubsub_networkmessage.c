@@ -160,15 +160,84 @@ UA_DataSetMessage_encodeJson(const UA_DataSetMessage* src, UA_UInt16 dataSetWrit
             }
         }
     }
-    encodingJsonEndObject(&ctx); //Payload
+    if(encodingJsonEndObject(&ctx) != UA_STATUSCODE_GOOD) //Payload
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     
-    encodingJsonEndObject(&ctx); //DataSetMessage
+    if(encodingJsonEndObject(&ctx) != UA_STATUSCODE_GOOD) //DataSetMessage
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     
     *bufPos = ctx.pos;
     bufEnd = ctx.end;
     return rv;
 }
 
+/* Mirrors UA_DataSetMessage_encodeJson and adds the number of bytes to
+ * ctx->pos. */
+static status
+UA_DataSetMessage_calcSizeJsonInternal(const UA_DataSetMessage* src, UA_UInt16 dataSetWriterId,
+                                       CtxJson *ctx, UA_Boolean useReversible,
+                                       UA_String **dataSetMessageFieldNames) {
+    status rv = encodingCalcJsonStartObject(ctx);
+
+    rv |= calcWriteKey(ctx, "DataSetWriterId", UA_FALSE);
+    ctx->pos += UA_calcSizeJson(&dataSetWriterId, &UA_TYPES[UA_TYPES_UINT16], NULL, 0, NULL, 0, useReversible);
+
+    if(src->header.dataSetMessageSequenceNrEnabled) {
+        rv |= calcWriteKey(ctx, "SequenceNumber", UA_TRUE);
+        ctx->pos += UA_calcSizeJson(&src->header.dataSetMessageSequenceNr, &UA_TYPES[UA_TYPES_UINT16], NULL, 0, NULL, 0, useReversible);
+    }
+
+    if(src->header.configVersionMajorVersionEnabled || src->header.configVersionMinorVersionEnabled) {
+        rv |= calcWriteKey(ctx, "MetaDataVersion", UA_TRUE);
+        UA_ConfigurationVersionDataType cvd;
+        cvd.majorVersion = src->header.configVersionMajorVersion;
+        cvd.minorVersion = src->header.configVersionMinorVersion;
+        ctx->pos += UA_calcSizeJson(&cvd, &UA_TYPES[UA_TYPES_CONFIGURATIONVERSIONDATATYPE], NULL, 0, NULL, 0, useReversible);
+    }
+
+    if(src->header.timestampEnabled) {
+        rv |= calcWriteKey(ctx, "Timestamp", UA_TRUE);
+        ctx->pos += UA_calcSizeJson(&src->header.timestamp, &UA_TYPES[UA_TYPES_DATETIME], NULL, 0, NULL, 0, useReversible);
+    }
+
+    if(src->header.statusEnabled) {
+        rv |= calcWriteKey(ctx, "Status", UA_TRUE);
+        ctx->pos += UA_calcSizeJson(&src->header.status, &UA_TYPES[UA_TYPES_STATUSCODE], NULL, 0, NULL, 0, useReversible);
+    }
+
+    rv |= calcWriteKey(ctx, "Payload", UA_TRUE);
+    rv |= encodingCalcJsonStartObject(ctx);
+
+    UA_Boolean keyFrame = (src->header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME);
+    UA_Boolean deltaFrame = (src->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME);
+    if((keyFrame || deltaFrame) && src->header.fieldEncoding == UA_FIELDENCODING_RAWDATA)
+        return UA_STATUSCODE_BADNOTIMPLEMENTED;
+
+    UA_UInt16 fieldCount = 0;
+    if(keyFrame)
+        fieldCount = src->data.keyFrameData.fieldCount;
+    else if(deltaFrame)
+        fieldCount = src->data.deltaFrameData.fieldCount;
+
+    for(UA_UInt16 i = 0; i < fieldCount; i++) {
+        const UA_DataValue *field = keyFrame ? &src->data.keyFrameData.dataSetFields[i] :
+            &src->data.deltaFrameData.deltaFrameFields[i].fieldValue;
+        rv |= calcWriteKey_UA_String(ctx, dataSetMessageFieldNames[i], i == 0 ? UA_FALSE : UA_TRUE);
+        size_t fieldSize;
+        if(src->header.fieldEncoding == UA_FIELDENCODING_VARIANT)
+            fieldSize = UA_calcSizeJson(&field->value, &UA_TYPES[UA_TYPES_VARIANT], NULL, 0, NULL, 0, useReversible);
+        else
+            fieldSize = UA_calcSizeJson(field, &UA_TYPES[UA_TYPES_DATAVALUE], NULL, 0, NULL, 0, useReversible);
+        if(fieldSize == 0)
+            return UA_STATUSCODE_BADENCODINGERROR;
+        ctx->pos += fieldSize;
+    }
+
+    encodingCalcJsonEndObject(ctx); /* Payload */
+    encodingCalcJsonEndObject(ctx); /* DataSetMessage */
+    return rv;
+}
+
 
 static status MetaDataVersion_decodeJsonInternal(void* cvd, const UA_DataType *type, CtxJson *ctx, ParseCtx *parseCtx, UA_Boolean moveToken){
     return decodeJsonInternal(cvd, &UA_TYPES[UA_TYPES_CONFIGURATIONVERSIONDATATYPE], ctx, parseCtx, UA_TRUE);
@@ -653,11 +722,13 @@ UA_NetworkMessage_encodeJson(const UA_NetworkMessage* src, UA_Byte **bufPos,
                     return rv;
             }
 
-            encodingJsonEndArray(&ctx);
+            if(encodingJsonEndArray(&ctx) != UA_STATUSCODE_GOOD)
+                return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
         }
    
-        encodingJsonEndObject(&ctx);
+        if(encodingJsonEndObject(&ctx) != UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
         *bufPos = ctx.pos;
         bufEnd = ctx.end;
     
@@ -667,6 +738,76 @@ UA_NetworkMessage_encodeJson(const UA_NetworkMessage* src, UA_Byte **bufPos,
     return rv;
 }
 
+size_t
+UA_NetworkMessage_calcSizeJson(const UA_NetworkMessage* src, UA_Boolean useReversible,
+                               UA_String*** dataSetMessageFieldNames, UA_UInt16 indexKeyArrayField) {
+    if(src->networkMessageType != UA_NETWORKMESSAGE_DATASET)
+        return 0;
+
+    /* ctx.pos counts the bytes */
+    CtxJson ctx;
+    memset(&ctx, 0, sizeof(CtxJson));
+    status rv = encodingCalcJsonStartObject(&ctx);
+
+    /* MessageId. All Guids have the same length. */
+    rv |= calcWriteKey(&ctx, "MessageId", UA_FALSE);
+    ctx.pos += UA_calcSizeJson(&UA_GUID_NULL, &UA_TYPES[UA_TYPES_GUID], NULL, 0, NULL, 0, useReversible);
+
+    rv |= calcWriteKey(&ctx, "MessageType", UA_TRUE);
+    UA_String s = UA_STRING("ua-data");
+    ctx.pos += UA_calcSizeJson(&s, &UA_TYPES[UA_TYPES_STRING], NULL, 0, NULL, 0, useReversible);
+
+    if(src->publisherIdEnabled) {
+        rv |= calcWriteKey(&ctx, "PublisherId", UA_TRUE);
+        switch (src->publisherIdType) {
+        case UA_PUBLISHERDATATYPE_BYTE:
+            ctx.pos += UA_calcSizeJson(&src->publisherId.publisherIdByte, &UA_TYPES[UA_TYPES_BYTE], NULL, 0, NULL, 0, useReversible);
+            break;
+        case UA_PUBLISHERDATATYPE_UINT16:
+            ctx.pos += UA_calcSizeJson(&src->publisherId.publisherIdUInt16, &UA_TYPES[UA_TYPES_UINT16], NULL, 0, NULL, 0, useReversible);
+            break;
+        case UA_PUBLISHERDATATYPE_UINT32:
+            ctx.pos += UA_calcSizeJson(&src->publisherId.publisherIdUInt32, &UA_TYPES[UA_TYPES_UINT32], NULL, 0, NULL, 0, useReversible);
+            break;
+        case UA_PUBLISHERDATATYPE_UINT64:
+            ctx.pos += UA_calcSizeJson(&src->publisherId.publisherIdUInt64, &UA_TYPES[UA_TYPES_UINT64], NULL, 0, NULL, 0, useReversible);
+            break;
+        case UA_PUBLISHERDATATYPE_STRING:
+            ctx.pos += UA_calcSizeJson(&src->publisherId.publisherIdString, &UA_TYPES[UA_TYPES_STRING], NULL, 0, NULL, 0, useReversible);
+            break;
+        default:
+            return 0;
+        }
+    }
+
+    if(src->dataSetClassIdEnabled) {
+        rv |= calcWriteKey(&ctx, "DataSetClassId", UA_TRUE);
+        ctx.pos += UA_calcSizeJson(&src->dataSetClassId, &UA_TYPES[UA_TYPES_GUID], NULL, 0, NULL, 0, useReversible);
+    }
+
+    UA_Byte count = src->payloadHeader.dataSetPayloadHeader.count;
+    if(count > 0) {
+        /* Without dataSetWriterIds, the encoding writes zeros */
+        const UA_UInt16 *dataSetWriterIds = src->payloadHeader.dataSetPayloadHeader.dataSetWriterIds;
+        rv |= calcWriteKey(&ctx, "Messages", UA_TRUE);
+        rv |= encodingCalcJsonStartArray(&ctx);
+        for(UA_UInt16 i = indexKeyArrayField; i < (indexKeyArrayField + count); i++) {
+            rv |= calcWriteComma(&ctx, i != indexKeyArrayField);
+            rv |= UA_DataSetMessage_calcSizeJsonInternal(&src->payload.dataSetPayload.dataSetMessages[i],
+                                                         dataSetWriterIds ? dataSetWriterIds[i] : 0,
+                                                         &ctx, useReversible, dataSetMessageFieldNames[i]);
+            if(rv != UA_STATUSCODE_GOOD)
+                return 0;
+        }
+        encodingCalcJsonEndArray(&ctx);
+    }
+
+    encodingCalcJsonEndObject(&ctx);
+    if(rv != UA_STATUSCODE_GOOD)
+        return 0;
+    return (size_t)ctx.pos;
+}
+
 UA_StatusCode
 UA_NetworkMessage_encodeBinary(const UA_NetworkMessage* src, UA_Byte **bufPos,
                                const UA_Byte *bufEnd) {
@@ -211,6 +211,9 @@ UA_StatusCode
 UA_NetworkMessage_encodeBinary(const UA_NetworkMessage* src,
                                UA_Byte **bufPos, const UA_Byte *bufEnd);
 
+/* The members of dst are allocated on the heap and released with
+ * UA_NetworkMessage_deleteMembers. Unlike service requests, NetworkMessages are
+ * not decoded into an arena and do not alias the buffer. */
 UA_StatusCode
 UA_NetworkMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
                                UA_NetworkMessage* dst);
@@ -229,6 +232,12 @@ UA_StatusCode
 UA_NetworkMessage_encodeJson(const UA_NetworkMessage* src,
                                UA_Byte **bufPos, const UA_Byte *bufEnd, UA_Boolean useReversible, UA_String*** dataSetMessageFieldNames, UA_UInt16 indexKeyArrayField);
 
+/* Returns the exact length of the JSON encoding or zero if the message cannot
+ * be encoded. The arguments are the same as for UA_NetworkMessage_encodeJson. */
+size_t
+UA_NetworkMessage_calcSizeJson(const UA_NetworkMessage* src, UA_Boolean useReversible,
+                               UA_String*** dataSetMessageFieldNames, UA_UInt16 indexKeyArrayField);
+
 UA_StatusCode UA_NetworkMessage_decodeJson(UA_NetworkMessage *dst, UA_ByteString *src);
 
 #ifdef __cplusplus
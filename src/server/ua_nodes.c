@@ -61,6 +61,45 @@ void UA_Node_deleteMembers(UA_Node *node) {
     }
 }
 
+/* Small scalars are stored inside the node. This saves a heap allocation per
+ * value and keeps the value next to the node metadata. */
+static UA_Boolean
+fitsInline(const UA_Variant *v) {
+    return v->type && v->type->pointerFree && v->arrayLength == 0 &&
+        v->data > UA_EMPTY_ARRAY_SENTINEL && v->arrayDimensionsSize == 0 &&
+        v->type->memSize <= sizeof(((UA_VariableNode*)0)->value.data.inlineValue);
+}
+
+static void
+storeInline(UA_VariableNode *node, const void *data) {
+    UA_Variant *v = &node->value.data.value.value;
+    memmove(node->value.data.inlineValue, data, v->type->memSize);
+    v->data = node->value.data.inlineValue;
+    v->storageType = UA_VARIANT_DATA_NODELETE;
+}
+
+void
+UA_VariableNode_inlineValue(UA_VariableNode *node) {
+    if(node->valueSource != UA_VALUESOURCE_DATA)
+        return;
+    UA_Variant *v = &node->value.data.value.value;
+    if(v->storageType != UA_VARIANT_DATA || !fitsInline(v))
+        return;
+    void *heapData = v->data;
+    storeInline(node, heapData);
+    UA_free(heapData); /* Pointer-free, no members to delete */
+}
+
+UA_Boolean
+UA_VariableNode_setInlineValue(UA_VariableNode *node, const UA_DataValue *value) {
+    if(!fitsInline(&value->value))
+        return false;
+    UA_DataValue_deleteMembers(&node->value.data.value);
+    node->value.data.value = *value; /* No other members are malloc'ed */
+    storeInline(node, value->value.data);
+    return true;
+}
+
 static UA_StatusCode
 UA_ObjectNode_copy(const UA_ObjectNode *src, UA_ObjectNode *dst) {
     dst->eventNotifier = src->eventNotifier;
@@ -80,8 +119,14 @@ UA_CommonVariableNode_copy(const UA_VariableNode *src, UA_VariableNode *dst) {
     dst->valueRank = src->valueRank;
     dst->valueSource = src->valueSource;
     if(src->valueSource == UA_VALUESOURCE_DATA) {
-        retval |= UA_DataValue_copy(&src->value.data.value,
-                                    &dst->value.data.value);
+        const UA_DataValue *value = &src->value.data.value;
+        if(value->value.data == src->value.data.inlineValue) {
+            /* Point to the inline storage of dst */
+            dst->value.data.value = *value;
+            storeInline(dst, value->value.data);
+        } else {
+            retval |= UA_DataValue_copy(value, &dst->value.data.value);
+        }
         dst->value.data.callback = src->value.data.callback;
     } else
         dst->value.dataSource = src->value.dataSource;
@@ -184,6 +229,18 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
             if(retval != UA_STATUSCODE_GOOD)
                 break;
             drefs->targetIdsSize = srefs->targetIdsSize;
+            drefs->targetIdsCapacity = srefs->targetIdsSize;
+
+            /* Copy the index. The positions are the same. */
+            if(srefs->targetIdsIndex) {
+                drefs->targetIdsIndex = (UA_UInt32*)
+                    UA_malloc(srefs->targetIdsIndexSize * sizeof(UA_UInt32));
+                if(drefs->targetIdsIndex) {
+                    memcpy(drefs->targetIdsIndex, srefs->targetIdsIndex,
+                           srefs->targetIdsIndexSize * sizeof(UA_UInt32));
+                    drefs->targetIdsIndexSize = srefs->targetIdsIndexSize;
+                }
+            }
         }
         if(retval != UA_STATUSCODE_GOOD) {
             UA_Node_deleteMembers(dst);
@@ -344,6 +401,7 @@ copyCommonVariableAttributes(UA_VariableNode *node,
         retval |= UA_Variant_copy(&attr->value, &node->value.data.value.value);
 
     node->value.data.value.hasValue = true;
+    UA_VariableNode_inlineValue(node);
 
     return retval;
 }
@@ -476,26 +534,145 @@ UA_Node_setAttributes(UA_Node *node, const void *attributes,
 /* Manage References */
 /*********************/
 
+/* Reference kinds with at least this many targets get an index. The index
+ * has open addressing with linear probing. The occupancy is at most 50%. */
+#define UA_REFERENCEINDEX_MINTARGETS 16
+
+static UA_UInt32
+targetIndexHash(const UA_NodeReferenceKind *rk, UA_UInt32 pos) {
+    return UA_NodeId_hash(&rk->targetIds[pos - 1].nodeId);
+}
+
+static void
+targetIndexInsert(UA_NodeReferenceKind *rk, UA_UInt32 pos) {
+    size_t mask = rk->targetIdsIndexSize - 1;
+    size_t i = targetIndexHash(rk, pos) & mask;
+    while(rk->targetIdsIndex[i] != 0)
+        i = (i + 1) & mask;
+    rk->targetIdsIndex[i] = pos;
+}
+
+/* Returns the index slot of the target position */
+static size_t
+targetIndexSlot(const UA_NodeReferenceKind *rk, UA_UInt32 pos) {
+    size_t mask = rk->targetIdsIndexSize - 1;
+    size_t i = targetIndexHash(rk, pos) & mask;
+    while(rk->targetIdsIndex[i] != pos)
+        i = (i + 1) & mask;
+    return i;
+}
+
+/* Remove the slot and move up the following entries of the cluster so that
+ * no probing sequence is interrupted */
+static void
+targetIndexRemove(UA_NodeReferenceKind *rk, size_t i) {
+    size_t mask = rk->targetIdsIndexSize - 1;
+    size_t j = i;
+    while(true) {
+        rk->targetIdsIndex[i] = 0;
+        while(true) {
+            j = (j + 1) & mask;
+            if(rk->targetIdsIndex[j] == 0)
+                return;
+            size_t k = targetIndexHash(rk, rk->targetIdsIndex[j]) & mask;
+            /* Can the entry at j be moved to i? (k is cyclically not in (i,j]) */
+            if(i <= j ? (i < k && k <= j) : (i < k || k <= j))
+                continue;
+            break;
+        }
+        rk->targetIdsIndex[i] = rk->targetIdsIndex[j];
+        i = j;
+    }
+}
+
+/* (Re)build the index for the current targets. Without memory, the targets
+ * are searched linearly. */
+static void
+targetIndexBuild(UA_NodeReferenceKind *rk, size_t minTargets) {
+    UA_free(rk->targetIdsIndex);
+    rk->targetIdsIndex = NULL;
+    rk->targetIdsIndexSize = 0;
+    if(minTargets < UA_REFERENCEINDEX_MINTARGETS || minTargets >= UA_UINT32_MAX)
+        return;
+    size_t size = UA_REFERENCEINDEX_MINTARGETS * 2;
+    while(size < minTargets * 2)
+        size *= 2;
+    rk->targetIdsIndex = (UA_UInt32*)UA_calloc(size, sizeof(UA_UInt32));
+    if(!rk->targetIdsIndex)
+        return;
+    rk->targetIdsIndexSize = size;
+    for(size_t pos = 1; pos <= rk->targetIdsSize; ++pos)
+        targetIndexInsert(rk, (UA_UInt32)pos);
+}
+
+/* Returns the position of the target or targetIdsSize. If exactTarget is set,
+ * the complete ExpandedNodeId must match. */
+static size_t
+findTargetPosition(const UA_NodeReferenceKind *rk, const UA_NodeId *targetId,
+                   const UA_ExpandedNodeId *exactTarget) {
+    if(!rk->targetIdsIndex) {
+        for(size_t i = 0; i < rk->targetIdsSize; ++i) {
+            if(exactTarget ? UA_ExpandedNodeId_equal(&rk->targetIds[i], exactTarget) :
+               UA_NodeId_equal(&rk->targetIds[i].nodeId, targetId))
+                return i;
+        }
+        return rk->targetIdsSize;
+    }
+
+    size_t mask = rk->targetIdsIndexSize - 1;
+    for(size_t i = UA_NodeId_hash(targetId) & mask; rk->targetIdsIndex[i] != 0;
+        i = (i + 1) & mask) {
+        const UA_ExpandedNodeId *target = &rk->targetIds[rk->targetIdsIndex[i] - 1];
+        if(exactTarget ? UA_ExpandedNodeId_equal(target, exactTarget) :
+           UA_NodeId_equal(&target->nodeId, targetId))
+            return rk->targetIdsIndex[i] - 1;
+    }
+    return rk->targetIdsSize;
+}
+
+const UA_ExpandedNodeId *
+UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
+                                const UA_NodeId *targetId) {
+    size_t pos = findTargetPosition(rk, targetId, NULL);
+    if(pos == rk->targetIdsSize)
+        return NULL;
+    return &rk->targetIds[pos];
+}
+
+/* The array of targets grows exponentially. So appending is amortized O(1). */
 static UA_StatusCode
 addReferenceTarget(UA_NodeReferenceKind *refs, const UA_ExpandedNodeId *target) {
-    UA_ExpandedNodeId *targets =
-        (UA_ExpandedNodeId*) UA_realloc(refs->targetIds,
-                                        sizeof(UA_ExpandedNodeId) * (refs->targetIdsSize+1));
-    if(!targets)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(refs->targetIdsSize >= refs->targetIdsCapacity) {
+        size_t capacity = refs->targetIdsSize * 2;
+        if(capacity < 4)
+            capacity = 4;
+        UA_ExpandedNodeId *targets = (UA_ExpandedNodeId*)
+            UA_realloc(refs->targetIds, sizeof(UA_ExpandedNodeId) * capacity);
+        if(!targets)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        refs->targetIds = targets;
+        refs->targetIdsCapacity = capacity;
+    }
 
-    refs->targetIds = targets;
     UA_StatusCode retval =
         UA_ExpandedNodeId_copy(target, &refs->targetIds[refs->targetIdsSize]);
-
-    if(retval == UA_STATUSCODE_GOOD) {
-        refs->targetIdsSize++;
-    } else if(refs->targetIdsSize == 0) {
-        /* We had zero references before (realloc was a malloc) */
-        UA_free(refs->targetIds);
-        refs->targetIds = NULL;
+    if(retval != UA_STATUSCODE_GOOD) {
+        if(refs->targetIdsSize == 0) {
+            /* We had zero references before (realloc was a malloc) */
+            UA_free(refs->targetIds);
+            refs->targetIds = NULL;
+            refs->targetIdsCapacity = 0;
+        }
+        return retval;
     }
-    return retval;
+    refs->targetIdsSize++;
+
+    /* Update the index. Grow it to keep the occupancy at 50%. */
+    if(refs->targetIdsSize * 2 > refs->targetIdsIndexSize)
+        targetIndexBuild(refs, refs->targetIdsSize);
+    else
+        targetIndexInsert(refs, (UA_UInt32)refs->targetIdsSize);
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
@@ -537,12 +714,9 @@ UA_Node_addReference(UA_Node *node, const UA_AddReferencesItem *item) {
         }
     }
     if(existingRefs != NULL) {
-        for(size_t i = 0; i < existingRefs->targetIdsSize; i++) {
-            if(UA_ExpandedNodeId_equal(&existingRefs->targetIds[i],
-                                       &item->targetNodeId)) {
-                return UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED;
-            }
-        }
+        if(findTargetPosition(existingRefs, &item->targetNodeId.nodeId,
+                              &item->targetNodeId) < existingRefs->targetIdsSize)
+            return UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED;
         return addReferenceTarget(existingRefs, &item->targetNodeId);
     }
     return addReferenceKind(node, item);
@@ -557,40 +731,48 @@ UA_Node_deleteReference(UA_Node *node, const UA_DeleteReferencesItem *item) {
         if(!UA_NodeId_equal(&item->referenceTypeId, &refs->referenceTypeId))
             continue;
 
-        for(size_t j = refs->targetIdsSize; j > 0; --j) {
-            if(!UA_NodeId_equal(&item->targetNodeId.nodeId, &refs->targetIds[j-1].nodeId))
-                continue;
-
-            /* Ok, delete the reference */
-            UA_ExpandedNodeId_deleteMembers(&refs->targetIds[j-1]);
-            refs->targetIdsSize--;
-
-            /* One matching target remaining */
-            if(refs->targetIdsSize > 0) {
-                if(j-1 != refs->targetIdsSize) // avoid valgrind error: Source
-                                               // and destination overlap in
-                                               // memcpy
-                    refs->targetIds[j-1] = refs->targetIds[refs->targetIdsSize];
-                return UA_STATUSCODE_GOOD;
-            }
+        size_t j = findTargetPosition(refs, &item->targetNodeId.nodeId, NULL);
+        if(j == refs->targetIdsSize)
+            continue;
 
-            /* Remove refs */
-            UA_free(refs->targetIds);
-            UA_NodeId_deleteMembers(&refs->referenceTypeId);
-            node->referencesSize--;
-            if(node->referencesSize > 0) {
-                if(i-1 != node->referencesSize) // avoid valgrind error: Source
-                                                // and destination overlap in
-                                                // memcpy
-                    node->references[i-1] = node->references[node->referencesSize];
-                return UA_STATUSCODE_GOOD;
-            }
+        /* Ok, delete the reference. Update the index before the last target is
+         * moved into the gap. */
+        size_t last = refs->targetIdsSize - 1;
+        if(refs->targetIdsIndex) {
+            targetIndexRemove(refs, targetIndexSlot(refs, (UA_UInt32)(j + 1)));
+            if(j != last)
+                refs->targetIdsIndex[targetIndexSlot(refs, (UA_UInt32)(last + 1))] =
+                    (UA_UInt32)(j + 1);
+        }
+        UA_ExpandedNodeId_deleteMembers(&refs->targetIds[j]);
+        refs->targetIdsSize--;
+
+        /* One matching target remaining */
+        if(refs->targetIdsSize > 0) {
+            if(j != last) // avoid valgrind error: Source
+                          // and destination overlap in
+                          // memcpy
+                refs->targetIds[j] = refs->targetIds[last];
+            return UA_STATUSCODE_GOOD;
+        }
 
-            /* Remove the node references */
-            UA_free(node->references);
-            node->references = NULL;
+        /* Remove refs */
+        UA_free(refs->targetIds);
+        UA_free(refs->targetIdsIndex);
+        UA_NodeId_deleteMembers(&refs->referenceTypeId);
+        node->referencesSize--;
+        if(node->referencesSize > 0) {
+            if(i-1 != node->referencesSize) // avoid valgrind error: Source
+                                            // and destination overlap in
+                                            // memcpy
+                node->references[i-1] = node->references[node->referencesSize];
             return UA_STATUSCODE_GOOD;
         }
+
+        /* Remove the node references */
+        UA_free(node->references);
+        node->references = NULL;
+        return UA_STATUSCODE_GOOD;
     }
     return UA_STATUSCODE_UNCERTAINREFERENCENOTDELETED;
 }
@@ -599,6 +781,7 @@ void UA_Node_deleteReferences(UA_Node *node) {
     for(size_t i = 0; i < node->referencesSize; ++i) {
         UA_NodeReferenceKind *refs = &node->references[i];
         UA_Array_delete(refs->targetIds, refs->targetIdsSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+        UA_free(refs->targetIdsIndex);
         UA_NodeId_deleteMembers(&refs->referenceTypeId);
     }
     if(node->references)
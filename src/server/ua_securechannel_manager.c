@@ -17,10 +17,18 @@
 
 #define STARTCHANNELID 1
 #define STARTTOKENID 1
+#define MININDEXSIZE 16
+
+/* container_of */
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
 
 UA_StatusCode
 UA_SecureChannelManager_init(UA_SecureChannelManager *cm, UA_Server *server) {
     TAILQ_INIT(&cm->channels);
+    cm->idIndex = NULL;
+    cm->indexSize = 0;
+    cm->indexCount = 0;
     // TODO: use an ID that is likely to be unique after a restart
     cm->lastChannelId = STARTCHANNELID;
     cm->lastTokenId = STARTTOKENID;
@@ -37,6 +45,59 @@ UA_SecureChannelManager_deleteMembers(UA_SecureChannelManager *cm) {
         UA_SecureChannel_deleteMembersCleanup(&entry->channel);
         UA_free(entry);
     }
+    UA_free(cm->idIndex);
+    cm->idIndex = NULL;
+    cm->indexSize = 0;
+    cm->indexCount = 0;
+}
+
+/* Channels have no ChannelId until they are opened */
+static UA_Boolean
+isIndexed(const channel_entry *entry) {
+    return entry->channel.securityToken.channelId != 0;
+}
+
+/* Allocate the buckets for at least the given number of channels and rehash
+ * the opened channels. The current index is kept if the allocation fails. */
+static UA_StatusCode
+resizeIndex(UA_SecureChannelManager *cm, size_t minSize) {
+    size_t newSize = MININDEXSIZE;
+    while(newSize < minSize)
+        newSize <<= 1;
+    if(newSize <= cm->indexSize)
+        return UA_STATUSCODE_GOOD;
+
+    struct channel_list *idIndex = (struct channel_list*)
+        UA_malloc(sizeof(struct channel_list) * newSize);
+    if(!idIndex)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < newSize; i++)
+        LIST_INIT(&idIndex[i]);
+
+    UA_free(cm->idIndex);
+    cm->idIndex = idIndex;
+    cm->indexSize = newSize;
+
+    channel_entry *entry;
+    TAILQ_FOREACH(entry, &cm->channels, pointers) {
+        if(!isIndexed(entry))
+            continue;
+        UA_UInt32 channelId = entry->channel.securityToken.channelId;
+        LIST_INSERT_HEAD(&idIndex[channelId & (newSize - 1)], entry, idPointers);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static channel_entry *
+findChannel(UA_SecureChannelManager *cm, UA_UInt32 channelId) {
+    if(channelId == 0 || cm->indexSize == 0)
+        return NULL;
+    channel_entry *entry;
+    LIST_FOREACH(entry, &cm->idIndex[channelId & (cm->indexSize - 1)], idPointers) {
+        if(entry->channel.securityToken.channelId == channelId)
+            return entry;
+    }
+    return NULL;
 }
 
 static void
@@ -60,6 +121,10 @@ removeSecureChannel(UA_SecureChannelManager *cm, channel_entry *entry) {
 
     /* Detach the channel and make the capacity available */
     TAILQ_REMOVE(&cm->channels, entry, pointers);
+    if(isIndexed(entry)) {
+        LIST_REMOVE(entry, idPointers);
+        cm->indexCount--;
+    }
     UA_atomic_subUInt32(&cm->currentChannelCount, 1);
     return UA_STATUSCODE_GOOD;
 }
@@ -155,9 +220,22 @@ UA_SecureChannelManager_open(UA_SecureChannelManager *cm, UA_SecureChannel *chan
         return UA_STATUSCODE_BADSECURITYMODEREJECTED;
     }
 
+    /* Make room in the index before the channel gets its ChannelId */
+    if(cm->indexCount >= cm->indexSize &&
+       resizeIndex(cm, cm->indexCount + 1) != UA_STATUSCODE_GOOD &&
+       cm->indexSize == 0)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     channel->securityMode = request->securityMode;
     channel->securityToken.createdAt = UA_DateTime_nowMonotonic();
     channel->securityToken.channelId = cm->lastChannelId++;
+    if(cm->lastChannelId == 0)
+        cm->lastChannelId = STARTCHANNELID; /* Zero marks channels that are not open */
+
+    channel_entry *entry = container_of(channel, channel_entry, channel);
+    LIST_INSERT_HEAD(&cm->idIndex[channel->securityToken.channelId & (cm->indexSize - 1)],
+                     entry, idPointers);
+    cm->indexCount++;
     channel->securityToken.createdAt = UA_DateTime_now();
 
     /* Set the lifetime. Lifetime 0 -> set the maximum possible */
@@ -231,21 +309,15 @@ UA_SecureChannelManager_renew(UA_SecureChannelManager *cm, UA_SecureChannel *cha
 
 UA_SecureChannel *
 UA_SecureChannelManager_get(UA_SecureChannelManager *cm, UA_UInt32 channelId) {
-    channel_entry *entry;
-    TAILQ_FOREACH(entry, &cm->channels, pointers) {
-        if(entry->channel.securityToken.channelId == channelId)
-            return &entry->channel;
-    }
-    return NULL;
+    channel_entry *entry = findChannel(cm, channelId);
+    if(!entry)
+        return NULL;
+    return &entry->channel;
 }
 
 UA_StatusCode
 UA_SecureChannelManager_close(UA_SecureChannelManager *cm, UA_UInt32 channelId) {
-    channel_entry *entry;
-    TAILQ_FOREACH(entry, &cm->channels, pointers) {
-        if(entry->channel.securityToken.channelId == channelId)
-            break;
-    }
+    channel_entry *entry = findChannel(cm, channelId);
     if(!entry)
         return UA_STATUSCODE_BADINTERNALERROR;
     return removeSecureChannel(cm, entry);
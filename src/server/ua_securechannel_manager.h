@@ -23,10 +23,20 @@ extern "C" {
 typedef struct channel_entry {
     UA_SecureChannel channel;
     TAILQ_ENTRY(channel_entry) pointers;
+    LIST_ENTRY(channel_entry) idPointers; /* In the channelId hash bucket */
 } channel_entry;
 
+LIST_HEAD(channel_list, channel_entry);
+
 typedef struct {
     TAILQ_HEAD(, channel_entry) channels; // doubly-linked list of channels
+
+    /* Hash index over the ChannelId of opened channels. The number of buckets
+     * is a power of two and doubles when the channels outnumber the buckets. */
+    struct channel_list *idIndex;
+    size_t indexSize;
+    size_t indexCount;
+
     UA_UInt32 currentChannelCount;
     UA_UInt32 lastChannelId;
     UA_UInt32 lastTokenId;
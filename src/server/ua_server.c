@@ -177,12 +177,14 @@ void UA_Server_delete(UA_Server *server) {
 
 #endif
 
+    /* Schedule the cached type hierarchies for deletion */
+    UA_Server_invalidateTypeCache(server);
+    UA_Server_deletePathCache(server);
+
 #ifdef UA_ENABLE_MULTITHREADING
     /* Process new delayed callbacks from the cleanup */
     UA_Server_cleanupDispatchQueue(server);
-    pthread_mutex_destroy(&server->dispatchQueue_accessMutex);
-    pthread_cond_destroy(&server->dispatchQueue_condition);
-    pthread_mutex_destroy(&server->dispatchQueue_conditionMutex);
+    UA_Server_deleteDispatchQueue(server);
 #else
     /* Process new delayed callbacks from the cleanup */
     UA_Server_cleanupDelayedCallbacks(server);
@@ -250,7 +252,11 @@ UA_Server_new(const UA_ServerConfig *config) {
 
     /* Initialized the dispatch queue for worker threads */
 #ifdef UA_ENABLE_MULTITHREADING
-    SIMPLEQ_INIT(&server->dispatchQueue);
+    if(UA_Server_initDispatchQueue(server) != UA_STATUSCODE_GOOD) {
+        UA_Timer_deleteMembers(&server->timer);
+        UA_free(server);
+        return NULL;
+    }
 #endif
 
     /* Create Namespaces 0 and 1 */
@@ -259,6 +265,18 @@ UA_Server_new(const UA_ServerConfig *config) {
     UA_String_copy(&server->config.applicationDescription.applicationUri, &server->namespaces[1]);
     server->namespacesSize = 2;
 
+    /* Allocate the cache for TranslateBrowsePath. Without memory, the paths
+     * are not cached. */
+    if(server->config.browsePathCacheSize > 0) {
+        size_t cacheSize = 1;
+        while(cacheSize < server->config.browsePathCacheSize)
+            cacheSize <<= 1;
+        server->pathCache = (struct UA_PathCacheEntry * volatile *)
+            UA_calloc(cacheSize, sizeof(struct UA_PathCacheEntry*));
+        if(server->pathCache)
+            server->pathCacheSize = cacheSize;
+    }
+
     /* Initialized SecureChannel and Session managers */
     UA_SecureChannelManager_init(&server->secureChannelManager, server);
     UA_SessionManager_init(&server->sessionManager, server);
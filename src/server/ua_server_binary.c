@@ -382,6 +382,10 @@ processOPN(UA_Server *server, UA_SecureChannel *channel,
     return retval;
 }
 
+/* Upper limit for the first block of the decoding arena. Large requests are
+ * decoded into additional blocks of doubling size. */
+#define UA_DECODEARENA_MAXFIRSTBLOCK 65536
+
 static UA_StatusCode
 processMSG(UA_Server *server, UA_SecureChannel *channel,
            UA_UInt32 requestId, const UA_ByteString *msg) {
@@ -424,13 +428,25 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     }
     UA_assert(responseType);
 
-    /* Decode the request */
+    /* Decode the request. All members are allocated in an arena that is
+     * released at once when the request has been processed. Strings and
+     * ByteStrings point into the message, which remains valid until the
+     * request has been processed. The first block has the size of the
+     * message. The arena grows by doubling if the in-memory representation is
+     * larger. */
     UA_STACKARRAY(UA_Byte, request, requestType->memSize);
     UA_RequestHeader *requestHeader = (UA_RequestHeader*)request;
-    retval = UA_decodeBinary(msg, &offset, request, requestType,
-                             server->config.customDataTypesSize,
-                             server->config.customDataTypes);
+    size_t arenaBlockSize = msg->length;
+    if(arenaBlockSize > UA_DECODEARENA_MAXFIRSTBLOCK)
+        arenaBlockSize = UA_DECODEARENA_MAXFIRSTBLOCK;
+    UA_DecodeArena arena;
+    UA_DecodeArena_init(&arena, arenaBlockSize);
+    arena.aliasBuffer = true;
+    retval = UA_decodeBinaryArena(msg, &offset, request, requestType,
+                                  server->config.customDataTypesSize,
+                                  server->config.customDataTypes, &arena);
     if(retval != UA_STATUSCODE_GOOD) {
+        UA_DecodeArena_clear(&arena);
         UA_LOG_DEBUG_CHANNEL(server->config.logger, channel,
                              "Could not decode the request");
         return sendServiceFault(channel, msg, requestPos, responseType, requestId, retval);
@@ -458,9 +474,9 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 
     #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
     // set the authenticationToken from the create session request to help fuzzing cover more lines
-    UA_NodeId_deleteMembers(&requestHeader->authenticationToken);
+    /* The token in the request lives in the arena. Alias the stored token. */
     if(!UA_NodeId_isNull(&unsafe_fuzz_authenticationToken))
-        UA_NodeId_copy(&unsafe_fuzz_authenticationToken, &requestHeader->authenticationToken);
+        requestHeader->authenticationToken = unsafe_fuzz_authenticationToken;
     #endif
 
     /* Find the matching session */
@@ -474,7 +490,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
             UA_LOG_DEBUG_CHANNEL(server->config.logger, channel,
                                  "Trying to activate a session that is " \
                                  "not known in the server");
-            UA_deleteMembers(request, requestType);
+            UA_DecodeArena_clear(&arena);
             return sendServiceFault(channel, msg, requestPos, responseType,
                                     requestId, UA_STATUSCODE_BADSESSIONIDINVALID);
         }
@@ -491,7 +507,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
             UA_LOG_WARNING_CHANNEL(server->config.logger, channel,
                                    "Service request %i without a valid session",
                                    requestType->binaryEncodingId);
-            UA_deleteMembers(request, requestType);
+            UA_DecodeArena_clear(&arena);
             return sendServiceFault(channel, msg, requestPos, responseType,
                                     requestId, UA_STATUSCODE_BADSESSIONIDINVALID);
         }
@@ -509,7 +525,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                requestType->binaryEncodingId);
         UA_SessionManager_removeSession(&server->sessionManager,
                                         &session->header.authenticationToken);
-        UA_deleteMembers(request, requestType);
+        UA_DecodeArena_clear(&arena);
         return sendServiceFault(channel, msg, requestPos, responseType,
                                 requestId, UA_STATUSCODE_BADSESSIONNOTACTIVATED);
     }
@@ -519,7 +535,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
         UA_LOG_WARNING_CHANNEL(server->config.logger, channel,
                                "Client tries to use a Session that is not "
                                "bound to this SecureChannel");
-        UA_deleteMembers(request, requestType);
+        UA_DecodeArena_clear(&arena);
         return sendServiceFault(channel, msg, requestPos, responseType,
                                 requestId, UA_STATUSCODE_BADSECURECHANNELIDINVALID);
     }
@@ -527,12 +543,15 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     /* Update the session lifetime */
     UA_Session_updateLifetime(session);
 
+    /* Replace the handles of registered nodes with their NodeId */
+    UA_Server_resolveRegisteredNodes(server, session, requestType, request);
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* The publish request is not answered immediately */
     if(requestType == &UA_TYPES[UA_TYPES_PUBLISHREQUEST]) {
         Service_Publish(server, session,
             (const UA_PublishRequest*)request, requestId);
-        UA_deleteMembers(request, requestType);
+        UA_DecodeArena_clear(&arena);
         return UA_STATUSCODE_GOOD;
     }
 #endif
@@ -588,7 +607,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                             "Could not send the message over the SecureChannel "
                             "with StatusCode %s", UA_StatusCode_name(retval));
     /* Clean up */
-    UA_deleteMembers(request, requestType);
+    UA_DecodeArena_clear(&arena);
     UA_deleteMembers(response, responseType);
     return retval;
 }
@@ -44,6 +44,9 @@ typedef struct {
 
 #endif
 
+struct UA_TypeCache;
+typedef struct UA_TypeCache UA_TypeCache;
+
 #ifdef UA_ENABLE_MULTITHREADING
 
 #include <pthread.h>
@@ -54,9 +57,6 @@ typedef struct UA_Worker UA_Worker;
 struct UA_WorkerCallback;
 typedef struct UA_WorkerCallback UA_WorkerCallback;
 
-SIMPLEQ_HEAD(UA_DispatchQueue, UA_WorkerCallback);
-typedef struct UA_DispatchQueue UA_DispatchQueue;
-
 #endif /* UA_ENABLE_MULTITHREADING */
 
 #ifdef UA_ENABLE_DISCOVERY
@@ -139,22 +139,53 @@ struct UA_Server {
     /* Callbacks with a repetition interval */
     UA_Timer timer;
 
+    /* Worker threads */
+#ifndef UA_ENABLE_MULTITHREADING
     /* Delayed callbacks */
     SLIST_HEAD(DelayedCallbacksList, UA_DelayedCallback) delayedCallbacks;
-
-    /* Worker threads */
-#ifdef UA_ENABLE_MULTITHREADING
-    UA_Worker *workers; /* there are nThread workers in a running server */
-    UA_DispatchQueue dispatchQueue; /* Dispatch queue for the worker threads */
-    pthread_mutex_t dispatchQueue_accessMutex; /* mutex for access to queue */
-    pthread_cond_t dispatchQueue_condition; /* so the workers don't spin if the queue is empty */
-    pthread_mutex_t dispatchQueue_conditionMutex; /* mutex for access to condition variable */
+#else
+    UA_Worker *workers; /* Workers with their dispatch deques. The threads run
+                         * between startup and shutdown. */
+    size_t workersSize;
+    pthread_key_t workerKey; /* Points to the UA_Worker of the current thread */
+
+    /* Dispatch from outside the workers. Protected by the dispatch mutex. */
+    pthread_mutex_t dispatchMutex;
+    size_t dispatchNext;                /* Round-robin over the worker inboxes */
+    UA_WorkerCallback *dispatchFree;    /* Callback nodes cached for dispatch */
+    UA_Boolean dispatchBatching;        /* Wake up workers at the batch end */
+    size_t dispatchBatched;
+
+    /* Lock-free lists */
+    UA_WorkerCallback * volatile dispatchFreeShared; /* Returned callback nodes */
+    UA_WorkerCallback * volatile delayedCallbacks;
+
+    /* Delayed callbacks wait until the callbacks of their epoch are done */
+    volatile size_t dispatchEpoch;
+    volatile size_t dispatchActive[2];
+
+    /* Idle workers sleep on the condition */
+    volatile size_t dispatchSleeping;
+    pthread_cond_t dispatchQueue_condition;
+    pthread_mutex_t dispatchQueue_conditionMutex;
 #endif
 
     /* For bootstrapping, omit some consistency checks, creating a reference to
      * the parent and member instantiation */
     UA_Boolean bootstrapNS0;
 
+    /* Cached subtype closure of the type hierarchies */
+    UA_TypeCache * volatile typeCache;
+    volatile size_t typeCacheGeneration;
+    volatile size_t typeCacheMisses;
+
+    /* Cached results of TranslateBrowsePath. See ua_services_view.c. */
+    struct UA_PathCacheEntry * volatile *pathCache;
+    size_t pathCacheSize; /* Power of two */
+    volatile size_t pathCacheGeneration;
+    volatile size_t pathCacheHits;
+    volatile size_t pathCacheMisses;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* To be cast to UA_LocalMonitoredItem to get the callback and context */
     LIST_HEAD(LocalMonitoredItems, UA_MonitoredItem) localMonitoredItems;
@@ -186,14 +217,34 @@ struct UA_Server {
 #define UA_Nodestore_getCopy(SERVER, NODEID, OUTNODE)                   \
     (SERVER)->config.nodestore.getNodeCopy((SERVER)->config.nodestore.context, NODEID, OUTNODE)
 
-#define UA_Nodestore_insert(SERVER, NODE, OUTNODEID)                    \
-    (SERVER)->config.nodestore.insertNode((SERVER)->config.nodestore.context, NODE, OUTNODEID)
-
 #define UA_Nodestore_delete(SERVER, NODE)                               \
     (SERVER)->config.nodestore.deleteNode((SERVER)->config.nodestore.context, NODE)
 
-#define UA_Nodestore_remove(SERVER, NODEID)                             \
-    (SERVER)->config.nodestore.removeNode((SERVER)->config.nodestore.context, NODEID)
+/* Outdate the cached results of TranslateBrowsePath after references,
+ * BrowseNames or nodes changed. Call this only once the change is visible in
+ * the nodestore. Otherwise a concurrent lookup can cache the old result under
+ * the new generation. */
+void UA_Server_invalidatePathCache(UA_Server *server);
+void UA_Server_deletePathCache(UA_Server *server);
+
+/* Inserting and removing nodes outdates the cached browse paths */
+static UA_INLINE UA_StatusCode
+UA_Nodestore_insert(UA_Server *server, UA_Node *node, UA_NodeId *outNodeId) {
+    UA_StatusCode retval = server->config.nodestore.
+        insertNode(server->config.nodestore.context, node, outNodeId);
+    if(retval == UA_STATUSCODE_GOOD)
+        UA_Server_invalidatePathCache(server);
+    return retval;
+}
+
+static UA_INLINE UA_StatusCode
+UA_Nodestore_remove(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_StatusCode retval = server->config.nodestore.
+        removeNode(server->config.nodestore.context, nodeId);
+    if(retval == UA_STATUSCODE_GOOD)
+        UA_Server_invalidatePathCache(server);
+    return retval;
+}
 
 /* Calls the callback with the node retrieved from the nodestore on top of the
  * stack. Either a copy or the original node for in-situ editing. Depends on
@@ -222,7 +273,13 @@ UA_Server_delayedFree(UA_Server *server, void *data);
  * finished previous work */
 void UA_Server_cleanupDelayedCallbacks(UA_Server *server);
 #else
+UA_StatusCode UA_Server_initDispatchQueue(UA_Server *server);
+
+/* Execute the remaining (delayed) callbacks. The worker threads must be
+ * stopped. */
 void UA_Server_cleanupDispatchQueue(UA_Server *server);
+
+void UA_Server_deleteDispatchQueue(UA_Server *server);
 #endif
 
 /* Callback is executed in the same thread or, if possible, dispatched to one of
@@ -230,6 +287,17 @@ void UA_Server_cleanupDispatchQueue(UA_Server *server);
 void
 UA_Server_workerCallback(UA_Server *server, UA_ServerCallback callback, void *data);
 
+/* Process the items [begin, end) of a batch */
+typedef void (*UA_ParallelCallback)(UA_Server *server, void *context,
+                                    size_t begin, size_t end);
+
+/* Process a batch of count items. When called from a worker thread, the batch
+ * is split into chunks that are stolen by the other workers. Returns when all
+ * items are processed. */
+void
+UA_Server_processParallel(UA_Server *server, size_t count,
+                          UA_ParallelCallback callback, void *context);
+
 /*********************/
 /* Utility Functions */
 /*********************/
@@ -243,12 +311,52 @@ UA_UInt16 addNamespace(UA_Server *server, const UA_String name);
 UA_Boolean
 UA_Node_hasSubTypeOrInstances(const UA_Node *node);
 
+/* Replace the value of the node with a shallow copy of the DataValue if the
+ * value fits into the inline storage of the node. Returns false otherwise. */
+UA_Boolean
+UA_VariableNode_setInlineValue(UA_VariableNode *node, const UA_DataValue *value);
+
 /* Recursively searches "upwards" in the tree following specific reference types */
 UA_Boolean
 isNodeInTree(UA_Nodestore *ns, const UA_NodeId *leafNode,
              const UA_NodeId *nodeToFind, const UA_NodeId *referenceTypeIds,
              size_t referenceTypeIdsSize);
 
+/* Tests whether subType is equal to or a subtype of superType (following
+ * HasSubtype references). The subtype closure of the type hierarchies is
+ * cached in the server. */
+UA_Boolean
+isSubtypeOf(UA_Server *server, const UA_NodeId *subType, const UA_NodeId *superType);
+
+/* Drop the cached type hierarchies after HasSubtype references changed */
+void UA_Server_invalidateTypeCache(UA_Server *server);
+
+/* Gets the node like UA_Nodestore_get. Handles of nodes the session registered
+ * with RegisterNodes are resolved. Their held node is taken without a lookup
+ * in the nodestore. Release the node with UA_Nodestore_release. The session
+ * can be NULL. */
+const UA_Node *
+UA_Server_getNodeWithSession(UA_Server *server, UA_Session *session,
+                             const UA_NodeId *nodeId);
+
+/* Returns the registered NodeId if the NodeId is a handle of the session.
+ * Otherwise the NodeId itself. The session can be NULL. */
+const UA_NodeId *
+UA_Server_getRegisteredNodeId(UA_Server *server, UA_Session *session,
+                              const UA_NodeId *nodeId);
+
+/* Release the registered nodes of a deleted session */
+void UA_Server_deleteRegisteredNodes(UA_Server *server, UA_Session *session);
+
+/* Replace the handles of nodes the session registered with RegisterNodes by
+ * the registered NodeIds. The NodeIds in the request become shallow copies of
+ * the entries. So the request must not be freed member-wise. Other NodeIds are
+ * left unchanged. Read and Write requests are skipped. They resolve the
+ * handles with UA_Server_getNodeWithSession. */
+void
+UA_Server_resolveRegisteredNodes(UA_Server *server, UA_Session *session,
+                                 const UA_DataType *requestType, void *request);
+
 /* Returns an array with the hierarchy of type nodes. The returned array starts
  * at the leaf and continues "upwards" in the hierarchy based on the
  * ``hasSubType`` references. Since multiple-inheritance is possible in general,
@@ -284,6 +392,19 @@ UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
                                    const UA_DataType *responseOperationsType)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Same as above. But large batches of operations are processed in parallel
+ * (see parallelOperationsThreshold in the server config). Only for operations
+ * that can be executed concurrently. */
+UA_StatusCode
+UA_Server_processServiceOperationsParallel(UA_Server *server, UA_Session *session,
+                                           UA_ServiceOperation operationCallback,
+                                           void *context,
+                                           const size_t *requestOperations,
+                                           const UA_DataType *requestOperationsType,
+                                           size_t *responseOperations,
+                                           const UA_DataType *responseOperationsType)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 /***************************************/
 /* Check Information Model Consistency */
 /***************************************/
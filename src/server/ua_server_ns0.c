@@ -552,25 +552,36 @@ UA_Server_minimalServerObject(UA_Server *server) {
 
 /* Initialize the nodeset 0 by using the generated code of the nodeset compiler.
  * This also initialized the data sources for various variables, such as for
- * example server time. */
+ * example server time. If the nodestore already contains nodeset 0, only the
+ * data sources and callbacks are initialized. */
 UA_StatusCode
 UA_Server_initNS0(UA_Server *server) {
-
-    /* Initialize base nodes which are always required an cannot be created
-     * through the NS compiler */
-    server->bootstrapNS0 = true;
-    UA_StatusCode retVal = UA_Server_createNS0_base(server);
-    server->bootstrapNS0 = false;
-    if(retVal != UA_STATUSCODE_GOOD)
-        return retVal;
+    /* The nodestore already contains namespace 0 (e.g. from a snapshot). Only
+     * set up the DataSources, callbacks and configured values. */
+    UA_NodeId serverNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+    const UA_Node *serverNode = UA_Nodestore_get(server, &serverNodeId);
+    UA_Boolean preloaded = (serverNode != NULL);
+    if(serverNode)
+        UA_Nodestore_release(server, serverNode);
+
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    if(!preloaded) {
+        /* Initialize base nodes which are always required an cannot be
+         * created through the NS compiler */
+        server->bootstrapNS0 = true;
+        retVal = UA_Server_createNS0_base(server);
+        server->bootstrapNS0 = false;
+        if(retVal != UA_STATUSCODE_GOOD)
+            return retVal;
 
 #ifdef UA_GENERATED_NAMESPACE_ZERO
-    /* Load nodes and references generated from the XML ns0 definition */
-    retVal = ua_namespace0(server);
+        /* Load nodes and references generated from the XML ns0 definition */
+        retVal = ua_namespace0(server);
 #else
-    /* Create a minimal server object */
-    UA_Server_minimalServerObject(server);
+        /* Create a minimal server object */
+        UA_Server_minimalServerObject(server);
 #endif
+    }
 
     /* NamespaceArray */
     UA_DataSource namespaceDataSource = {readNamespaces, writeNamespaces};
@@ -818,14 +829,16 @@ UA_Server_initNS0(UA_Server *server) {
      * directly, but need to create a subtype. This is already posted on the OPC Foundation bug tracker under the
      * following link for clarification: https://opcfoundation-onlineapplications.org/mantis/view.php?id=4206 */
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
-    UA_ObjectTypeAttributes overflowAttr = UA_ObjectTypeAttributes_default;
-    overflowAttr.description = UA_LOCALIZEDTEXT("en-US", "A simple event for indicating a queue overflow.");
-    overflowAttr.displayName = UA_LOCALIZEDTEXT("en-US", "SimpleOverflowEventType");
-    UA_Server_addObjectTypeNode(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SIMPLEOVERFLOWEVENTTYPE),
-                                UA_NODEID_NUMERIC(0, UA_NS0ID_EVENTQUEUEOVERFLOWEVENTTYPE),
-                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
-                                UA_QUALIFIEDNAME(0, "SimpleOverflowEventType"),
-                                overflowAttr, NULL, NULL);
+    if(!preloaded) {
+        UA_ObjectTypeAttributes overflowAttr = UA_ObjectTypeAttributes_default;
+        overflowAttr.description = UA_LOCALIZEDTEXT("en-US", "A simple event for indicating a queue overflow.");
+        overflowAttr.displayName = UA_LOCALIZEDTEXT("en-US", "SimpleOverflowEventType");
+        UA_Server_addObjectTypeNode(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SIMPLEOVERFLOWEVENTTYPE),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_EVENTQUEUEOVERFLOWEVENTTYPE),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(0, "SimpleOverflowEventType"),
+                                    overflowAttr, NULL, NULL);
+    }
 #endif
 
     if(retVal != UA_STATUSCODE_GOOD)
@@ -100,6 +100,392 @@ isNodeInTree(UA_Nodestore *ns, const UA_NodeId *leafNode, const UA_NodeId *nodeT
     return isNodeInTreeNoCircular(ns, leafNode, nodeToFind, &visitedRefs, referenceTypeIds, referenceTypeIdsSize);
 }
 
+/************************/
+/* Type Hierarchy Cache */
+/************************/
+
+/* The subtype closure of the type hierarchies (ReferenceTypes, DataTypes,
+ * ObjectTypes and VariableTypes) is cached as one bitset per type node. Bit i
+ * is set if the type is equal to or a subtype of the type with index i of the
+ * same node class. The cache is dropped when HasSubtype references change and
+ * rebuilt after a number of uncached lookups. So it is not rebuilt over and
+ * over while a nodeset is loaded. */
+
+#define UA_TYPECACHE_CLASSES 4
+#define UA_TYPECACHE_REBUILD 16 /* Uncached lookups before a rebuild */
+#define UA_TYPECACHE_WORDBITS (sizeof(size_t) * 8)
+
+typedef struct {
+    UA_NodeId nodeId;
+    size_t *bits;
+    u32 index;            /* Index within the node class */
+    u8 typeClass;
+
+    /* Only used during the build */
+    size_t parentsSize;
+    UA_NodeId *parents;
+    u32 *parentEntries;
+} UA_TypeCacheEntry;
+
+struct UA_TypeCache {
+    size_t generation;
+    size_t entriesSize;
+    UA_TypeCacheEntry *entries;
+    size_t slotsSize;     /* Power of two */
+    u32 *slots;           /* Open addressing with the entry index + 1 */
+    size_t *bits;
+};
+
+static int
+typeCacheClass(UA_NodeClass nodeClass) {
+    switch(nodeClass) {
+    case UA_NODECLASS_REFERENCETYPE: return 0;
+    case UA_NODECLASS_DATATYPE: return 1;
+    case UA_NODECLASS_OBJECTTYPE: return 2;
+    case UA_NODECLASS_VARIABLETYPE: return 3;
+    default: return -1;
+    }
+}
+
+static void
+deleteTypeCacheEntries(UA_TypeCacheEntry *entries, size_t entriesSize) {
+    for(size_t i = 0; i < entriesSize; ++i) {
+        UA_NodeId_deleteMembers(&entries[i].nodeId);
+        UA_Array_delete(entries[i].parents, entries[i].parentsSize,
+                        &UA_TYPES[UA_TYPES_NODEID]);
+        UA_free(entries[i].parentEntries);
+    }
+    UA_free(entries);
+}
+
+static void
+deleteTypeCache(UA_Server *server, UA_TypeCache *tc) {
+    deleteTypeCacheEntries(tc->entries, tc->entriesSize);
+    UA_free(tc->slots);
+    UA_free(tc->bits);
+    UA_free(tc);
+}
+
+static const UA_TypeCacheEntry *
+findTypeCacheEntry(const UA_TypeCache *tc, const UA_NodeId *nodeId) {
+    size_t mask = tc->slotsSize - 1;
+    for(size_t i = UA_NodeId_hash(nodeId) & mask; ; i = (i + 1) & mask) {
+        u32 slot = tc->slots[i];
+        if(slot == 0)
+            return NULL;
+        if(UA_NodeId_equal(&tc->entries[slot - 1].nodeId, nodeId))
+            return &tc->entries[slot - 1];
+    }
+}
+
+/* The type hierarchies are collected by following the HasSubtype references
+ * from their roots in namespace zero. So only the type nodes are accessed.
+ * Nodestores that load nodes lazily do not need to load the entire address
+ * space. Types outside of these hierarchies are not cached. */
+static const UA_NodeId typeCacheRoots[UA_TYPECACHE_CLASSES] = {
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_REFERENCES}},
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEDATATYPE}},
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEOBJECTTYPE}},
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEVARIABLETYPE}}};
+
+#define UA_TYPECACHE_NOCLASS 0xff /* Not (yet) known to be a type node */
+
+typedef struct {
+    UA_TypeCacheEntry *entries;
+    size_t entriesSize;
+    size_t entriesCapacity;
+    size_t slotsSize;     /* Power of two */
+    u32 *slots;           /* Open addressing with the entry index + 1 */
+} TypeCacheCollect;
+
+static UA_StatusCode
+growTypeCacheCollect(TypeCacheCollect *tcc) {
+    if(tcc->entriesSize >= tcc->entriesCapacity) {
+        size_t newCapacity = tcc->entriesCapacity * 2;
+        UA_TypeCacheEntry *newEntries = (UA_TypeCacheEntry*)
+            UA_realloc(tcc->entries, newCapacity * sizeof(UA_TypeCacheEntry));
+        if(!newEntries)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        tcc->entries = newEntries;
+        tcc->entriesCapacity = newCapacity;
+    }
+
+    if((tcc->entriesSize + 1) * 2 <= tcc->slotsSize)
+        return UA_STATUSCODE_GOOD;
+    size_t newSlotsSize = tcc->slotsSize * 2;
+    u32 *newSlots = (u32*)UA_calloc(newSlotsSize, sizeof(u32));
+    if(!newSlots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    size_t mask = newSlotsSize - 1;
+    for(size_t i = 0; i < tcc->entriesSize; ++i) {
+        size_t slot = UA_NodeId_hash(&tcc->entries[i].nodeId) & mask;
+        while(newSlots[slot] != 0)
+            slot = (slot + 1) & mask;
+        newSlots[slot] = (u32)(i + 1);
+    }
+    UA_free(tcc->slots);
+    tcc->slots = newSlots;
+    tcc->slotsSize = newSlotsSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Adds an entry for the NodeId unless it was added before. The node is
+ * visited later. */
+static UA_StatusCode
+addTypeCacheCandidate(TypeCacheCollect *tcc, const UA_NodeId *nodeId) {
+    UA_StatusCode retval = growTypeCacheCollect(tcc);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    size_t mask = tcc->slotsSize - 1;
+    size_t slot = UA_NodeId_hash(nodeId) & mask;
+    for(; tcc->slots[slot] != 0; slot = (slot + 1) & mask) {
+        if(UA_NodeId_equal(&tcc->entries[tcc->slots[slot] - 1].nodeId, nodeId))
+            return UA_STATUSCODE_GOOD;
+    }
+    UA_TypeCacheEntry *entry = &tcc->entries[tcc->entriesSize];
+    memset(entry, 0, sizeof(UA_TypeCacheEntry));
+    entry->typeClass = UA_TYPECACHE_NOCLASS;
+    retval = UA_NodeId_copy(nodeId, &entry->nodeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    tcc->slots[slot] = (u32)(tcc->entriesSize + 1);
+    tcc->entriesSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Copies the supertypes of the type node and adds its subtypes as
+ * candidates */
+static UA_StatusCode
+visitTypeCacheCandidate(TypeCacheCollect *tcc, size_t index, const UA_Node *node) {
+    int typeClass = typeCacheClass(node->nodeClass);
+    if(typeClass < 0)
+        return UA_STATUSCODE_GOOD;
+    tcc->entries[index].typeClass = (u8)typeClass;
+
+    /* Copy the targets of the inverse HasSubtype references */
+    size_t parentsSize = 0;
+    for(size_t i = 0; i < node->referencesSize; ++i) {
+        const UA_NodeReferenceKind *rk = &node->references[i];
+        if(rk->isInverse && UA_NodeId_equal(&rk->referenceTypeId, &subtypeId))
+            parentsSize += rk->targetIdsSize;
+    }
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(parentsSize > 0) {
+        UA_TypeCacheEntry *entry = &tcc->entries[index];
+        entry->parents = (UA_NodeId*)UA_Array_new(parentsSize, &UA_TYPES[UA_TYPES_NODEID]);
+        if(!entry->parents)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        entry->parentsSize = parentsSize;
+        size_t p = 0;
+        for(size_t i = 0; i < node->referencesSize; ++i) {
+            const UA_NodeReferenceKind *rk = &node->references[i];
+            if(!rk->isInverse || !UA_NodeId_equal(&rk->referenceTypeId, &subtypeId))
+                continue;
+            for(size_t j = 0; j < rk->targetIdsSize; ++j)
+                retval |= UA_NodeId_copy(&rk->targetIds[j].nodeId, &entry->parents[p++]);
+        }
+    }
+
+    /* The targets of the forward HasSubtype references are visited later */
+    for(size_t i = 0; i < node->referencesSize && retval == UA_STATUSCODE_GOOD; ++i) {
+        const UA_NodeReferenceKind *rk = &node->references[i];
+        if(rk->isInverse || !UA_NodeId_equal(&rk->referenceTypeId, &subtypeId))
+            continue;
+        for(size_t j = 0; j < rk->targetIdsSize && retval == UA_STATUSCODE_GOOD; ++j)
+            retval = addTypeCacheCandidate(tcc, &rk->targetIds[j].nodeId);
+    }
+    return retval;
+}
+
+static UA_TypeCache *
+buildTypeCache(UA_Server *server, size_t generation) {
+    UA_TypeCache *tc = (UA_TypeCache*)UA_calloc(1, sizeof(UA_TypeCache));
+    if(!tc)
+        return NULL;
+    tc->generation = generation;
+
+    /* Collect the type nodes breadth-first from the roots */
+    TypeCacheCollect tcc;
+    memset(&tcc, 0, sizeof(TypeCacheCollect));
+    tcc.entriesCapacity = 64;
+    tcc.entries = (UA_TypeCacheEntry*)
+        UA_malloc(tcc.entriesCapacity * sizeof(UA_TypeCacheEntry));
+    tcc.slotsSize = 128;
+    tcc.slots = (u32*)UA_calloc(tcc.slotsSize, sizeof(u32));
+    UA_StatusCode retval = UA_STATUSCODE_BADOUTOFMEMORY;
+    if(tcc.entries && tcc.slots)
+        retval = UA_STATUSCODE_GOOD;
+    for(size_t c = 0; c < UA_TYPECACHE_CLASSES && retval == UA_STATUSCODE_GOOD; ++c)
+        retval = addTypeCacheCandidate(&tcc, &typeCacheRoots[c]);
+    for(size_t i = 0; i < tcc.entriesSize && retval == UA_STATUSCODE_GOOD; ++i) {
+        const UA_Node *node = UA_Nodestore_get(server, &tcc.entries[i].nodeId);
+        if(!node)
+            continue;
+        retval = visitTypeCacheCandidate(&tcc, i, node);
+        UA_Nodestore_release(server, node);
+    }
+    UA_free(tcc.slots);
+
+    /* Drop the candidates that are no type nodes */
+    size_t found = 0;
+    for(size_t i = 0; i < tcc.entriesSize; ++i) {
+        if(tcc.entries[i].typeClass != UA_TYPECACHE_NOCLASS) {
+            tcc.entries[found++] = tcc.entries[i];
+            continue;
+        }
+        UA_NodeId_deleteMembers(&tcc.entries[i].nodeId);
+        UA_Array_delete(tcc.entries[i].parents, tcc.entries[i].parentsSize,
+                        &UA_TYPES[UA_TYPES_NODEID]);
+    }
+    tc->entries = tcc.entries;
+    tc->entriesSize = found;
+    if(retval != UA_STATUSCODE_GOOD)
+        goto error;
+
+    /* Index the entries by their NodeId */
+    tc->slotsSize = 16;
+    while(tc->slotsSize < tc->entriesSize * 2)
+        tc->slotsSize *= 2;
+    tc->slots = (u32*)UA_calloc(tc->slotsSize, sizeof(u32));
+    if(!tc->slots)
+        goto error;
+    size_t mask = tc->slotsSize - 1;
+    size_t classSize[UA_TYPECACHE_CLASSES] = {0};
+    for(size_t i = 0; i < tc->entriesSize; ++i) {
+        UA_TypeCacheEntry *entry = &tc->entries[i];
+        size_t slot = UA_NodeId_hash(&entry->nodeId) & mask;
+        while(tc->slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        tc->slots[slot] = (u32)(i + 1);
+        entry->index = (u32)classSize[entry->typeClass]++;
+    }
+
+    /* Allocate the bitsets. Every type is a subtype of itself. */
+    size_t words[UA_TYPECACHE_CLASSES];
+    size_t bitsSize = 0;
+    for(size_t c = 0; c < UA_TYPECACHE_CLASSES; ++c) {
+        words[c] = (classSize[c] + UA_TYPECACHE_WORDBITS - 1) / UA_TYPECACHE_WORDBITS;
+        bitsSize += classSize[c] * words[c];
+    }
+    tc->bits = (size_t*)UA_calloc(bitsSize > 0 ? bitsSize : 1, sizeof(size_t));
+    if(!tc->bits)
+        goto error;
+    size_t *bits = tc->bits;
+    for(size_t i = 0; i < tc->entriesSize; ++i) {
+        UA_TypeCacheEntry *entry = &tc->entries[i];
+        entry->bits = bits;
+        bits += words[entry->typeClass];
+        entry->bits[entry->index / UA_TYPECACHE_WORDBITS] |=
+            (size_t)1 << (entry->index % UA_TYPECACHE_WORDBITS);
+    }
+
+    /* Resolve the supertypes of the same node class */
+    for(size_t i = 0; i < tc->entriesSize; ++i) {
+        UA_TypeCacheEntry *entry = &tc->entries[i];
+        if(entry->parentsSize == 0)
+            continue;
+        entry->parentEntries = (u32*)UA_malloc(entry->parentsSize * sizeof(u32));
+        if(!entry->parentEntries)
+            goto error;
+        size_t resolved = 0;
+        for(size_t j = 0; j < entry->parentsSize; ++j) {
+            const UA_TypeCacheEntry *parent = findTypeCacheEntry(tc, &entry->parents[j]);
+            if(!parent || parent->typeClass != entry->typeClass)
+                continue;
+            entry->parentEntries[resolved++] = (u32)(parent - tc->entries);
+        }
+        UA_Array_delete(entry->parents, entry->parentsSize, &UA_TYPES[UA_TYPES_NODEID]);
+        entry->parents = NULL;
+        entry->parentsSize = resolved;
+    }
+
+    /* Propagate the bits from the supertypes until nothing changes. This also
+     * terminates for (forbidden) circular hierarchies. */
+    UA_Boolean changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t i = 0; i < tc->entriesSize; ++i) {
+            UA_TypeCacheEntry *entry = &tc->entries[i];
+            size_t w = words[entry->typeClass];
+            for(size_t j = 0; j < entry->parentsSize; ++j) {
+                const size_t *parentBits = tc->entries[entry->parentEntries[j]].bits;
+                for(size_t k = 0; k < w; ++k) {
+                    size_t merged = entry->bits[k] | parentBits[k];
+                    if(merged == entry->bits[k])
+                        continue;
+                    entry->bits[k] = merged;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    /* Remove the build information */
+    for(size_t i = 0; i < tc->entriesSize; ++i) {
+        UA_free(tc->entries[i].parentEntries);
+        tc->entries[i].parentEntries = NULL;
+        tc->entries[i].parentsSize = 0;
+    }
+    return tc;
+
+ error:
+    deleteTypeCache(server, tc);
+    return NULL;
+}
+
+/* Returns the current cache or NULL if it is not available */
+static const UA_TypeCache *
+getTypeCache(UA_Server *server) {
+    size_t generation = server->typeCacheGeneration;
+    UA_TypeCache *tc = server->typeCache;
+    if(tc && tc->generation == generation)
+        return tc;
+
+    /* Rebuild only when the type hierarchies no longer change with every
+     * lookup. Only one thread reaches the threshold. */
+    if(server->bootstrapNS0 ||
+       UA_atomic_addSize(&server->typeCacheMisses, 1) != UA_TYPECACHE_REBUILD)
+        return NULL;
+    UA_TypeCache *newTc = buildTypeCache(server, generation);
+    server->typeCacheMisses = 0;
+    if(!newTc)
+        return NULL;
+
+    /* Replace the (outdated) cache. A cache that is outdated by a concurrent
+     * invalidation is recognized from its generation. */
+    tc = (UA_TypeCache*)UA_atomic_xchg((void * volatile *)&server->typeCache, newTc);
+    if(tc)
+        UA_Server_delayedCallback(server, (UA_ServerCallback)deleteTypeCache, tc);
+    return newTc;
+}
+
+void
+UA_Server_invalidateTypeCache(UA_Server *server) {
+    UA_atomic_addSize(&server->typeCacheGeneration, 1);
+    UA_TypeCache *tc = (UA_TypeCache*)
+        UA_atomic_xchg((void * volatile *)&server->typeCache, NULL);
+    if(tc)
+        UA_Server_delayedCallback(server, (UA_ServerCallback)deleteTypeCache, tc);
+}
+
+UA_Boolean
+isSubtypeOf(UA_Server *server, const UA_NodeId *subType, const UA_NodeId *superType) {
+    if(UA_NodeId_equal(subType, superType))
+        return true;
+
+    /* Lookup in the cache. Fall back to following the references if one of
+     * the nodes is not a cached type. */
+    const UA_TypeCache *tc = getTypeCache(server);
+    if(tc) {
+        const UA_TypeCacheEntry *sub = findTypeCacheEntry(tc, subType);
+        const UA_TypeCacheEntry *super = findTypeCacheEntry(tc, superType);
+        if(sub && super && sub->typeClass == super->typeClass)
+            return ((sub->bits[super->index / UA_TYPECACHE_WORDBITS] >>
+                     (super->index % UA_TYPECACHE_WORDBITS)) & 1) != 0;
+    }
+    return isNodeInTree(&server->config.nodestore, subType, superType, &subtypeId, 1);
+}
+
 const UA_Node *
 getNodeType(UA_Server *server, const UA_Node *node) {
     /* The reference to the parent is different for variable and variabletype */
@@ -278,14 +664,17 @@ UA_Server_editNode(UA_Server *server, UA_Session *session,
                    const UA_NodeId *nodeId, UA_EditNodeCallback callback,
                    void *data) {
 #ifndef UA_ENABLE_IMMUTABLE_NODES
-    /* Get the node and process it in-situ */
-    const UA_Node *node = UA_Nodestore_get(server, nodeId);
+    /* Get the node and process it in-situ. Registered handles take the held
+     * node. */
+    const UA_Node *node = UA_Server_getNodeWithSession(server, session, nodeId);
     if(!node)
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
     UA_StatusCode retval = callback(server, session, (UA_Node*)(uintptr_t)node, data);
     UA_Nodestore_release(server, node);
     return retval;
 #else
+    /* The copy is made from the registered NodeId */
+    nodeId = UA_Server_getRegisteredNodeId(server, session, nodeId);
     UA_StatusCode retval;
     do {
         /* Get an editable copy of the node */
@@ -309,13 +698,37 @@ UA_Server_editNode(UA_Server *server, UA_Session *session,
 #endif
 }
 
-UA_StatusCode
-UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
-                                   UA_ServiceOperation operationCallback,
-                                   void *context, const size_t *requestOperations,
-                                   const UA_DataType *requestOperationsType,
-                                   size_t *responseOperations,
-                                   const UA_DataType *responseOperationsType) {
+typedef struct {
+    UA_Session *session;
+    UA_ServiceOperation operationCallback;
+    void *context;
+    uintptr_t reqOp;
+    const UA_DataType *requestOperationsType;
+    uintptr_t respOp;
+    const UA_DataType *responseOperationsType;
+} ServiceOperations;
+
+static void
+processOperations(UA_Server *server, ServiceOperations *so,
+                  size_t begin, size_t end) {
+    uintptr_t reqOp = so->reqOp + (begin * so->requestOperationsType->memSize);
+    uintptr_t respOp = so->respOp + (begin * so->responseOperationsType->memSize);
+    for(size_t i = begin; i < end; i++) {
+        so->operationCallback(server, so->session, so->context,
+                              (void*)reqOp, (void*)respOp);
+        reqOp += so->requestOperationsType->memSize;
+        respOp += so->responseOperationsType->memSize;
+    }
+}
+
+static UA_StatusCode
+processServiceOperations(UA_Server *server, UA_Session *session,
+                         UA_ServiceOperation operationCallback,
+                         void *context, const size_t *requestOperations,
+                         const UA_DataType *requestOperationsType,
+                         size_t *responseOperations,
+                         const UA_DataType *responseOperationsType,
+                         UA_Boolean parallel) {
     size_t ops = *requestOperations;
     if(ops == 0)
         return UA_STATUSCODE_BADNOTHINGTODO;
@@ -327,17 +740,52 @@ UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     *responseOperations = ops;
-    uintptr_t respOp = (uintptr_t)*respPos;
+    ServiceOperations so;
+    so.session = session;
+    so.operationCallback = operationCallback;
+    so.context = context;
     /* No padding after size_t */
-    uintptr_t reqOp = *(uintptr_t*)((uintptr_t)requestOperations + sizeof(size_t));
-    for(size_t i = 0; i < ops; i++) {
-        operationCallback(server, session, context, (void*)reqOp, (void*)respOp);
-        reqOp += requestOperationsType->memSize;
-        respOp += responseOperationsType->memSize;
-    }
+    so.reqOp = *(uintptr_t*)((uintptr_t)requestOperations + sizeof(size_t));
+    so.requestOperationsType = requestOperationsType;
+    so.respOp = (uintptr_t)*respPos;
+    so.responseOperationsType = responseOperationsType;
+
+    if(parallel)
+        UA_Server_processParallel(server, ops, (UA_ParallelCallback)processOperations, &so);
+    else
+        processOperations(server, &so, 0, ops);
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
+                                   UA_ServiceOperation operationCallback,
+                                   void *context, const size_t *requestOperations,
+                                   const UA_DataType *requestOperationsType,
+                                   size_t *responseOperations,
+                                   const UA_DataType *responseOperationsType) {
+    return processServiceOperations(server, session, operationCallback, context,
+                                    requestOperations, requestOperationsType,
+                                    responseOperations, responseOperationsType, false);
+}
+
+UA_StatusCode
+UA_Server_processServiceOperationsParallel(UA_Server *server, UA_Session *session,
+                                           UA_ServiceOperation operationCallback,
+                                           void *context, const size_t *requestOperations,
+                                           const UA_DataType *requestOperationsType,
+                                           size_t *responseOperations,
+                                           const UA_DataType *responseOperationsType) {
+    UA_Boolean parallel = false;
+#ifdef UA_ENABLE_MULTITHREADING
+    parallel = (server->config.parallelOperationsThreshold > 0 &&
+                *requestOperations >= server->config.parallelOperationsThreshold);
+#endif
+    return processServiceOperations(server, session, operationCallback, context,
+                                    requestOperations, requestOperationsType,
+                                    responseOperations, responseOperationsType, parallel);
+}
+
 /* A few global NodeId definitions */
 const UA_NodeId subtypeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASSUBTYPE}};
 const UA_NodeId hierarchicalReferences = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HIERARCHICALREFERENCES}};
@@ -26,96 +26,433 @@
 /**
  * Worker Threads and Dispatch Queue
  * ---------------------------------
- * The worker threads dequeue callbacks from a central Multi-Producer
- * Multi-Consumer Queue (MPMC). When there are no callbacks, workers go idle.
- * The condition to wake them up is triggered whenever a callback is
- * dispatched.
+ * Every worker owns two work-stealing deques (Chase-Lev). Callbacks dispatched
+ * from a worker thread are pushed to its own deque. Callbacks dispatched from
+ * outside (the main loop, usually) are distributed round-robin over the
+ * "inbox" deques of the workers. A worker takes callbacks from the bottom of
+ * its own deque and from the top of its inbox. When both are empty, it steals
+ * from the top of the deques of the other workers. Only then the worker goes
+ * idle.
+ *
+ * Callbacks dispatched during a main-loop iteration are batched. The sleeping
+ * workers are woken up only once at the end of the batch.
+ *
+ * The callback nodes are preallocated and recycled over a lock-free list.
  *
- * Future Plans: Use work-stealing to load-balance between cores.
  * Le, Nhat Minh, et al. "Correct and efficient work-stealing for weak memory
  * models." ACM SIGPLAN Notices. Vol. 48. No. 8. ACM, 2013. */
 
 #ifdef UA_ENABLE_MULTITHREADING
 
+#define UA_DISPATCH_DEQUESIZE 256   /* Initial deque capacity (power of two) */
+#define UA_DISPATCH_PREALLOC 256    /* Preallocated callback nodes */
+#define UA_DISPATCH_RETIREBATCH 32  /* Nodes returned at once by a worker */
+
+struct UA_WorkerCallback {
+    UA_WorkerCallback *next; /* In the lists of free nodes and delayed callbacks */
+    UA_ServerCallback callback;
+    void *data;
+    size_t epoch;
+};
+typedef struct UA_WorkerCallback WorkerCallback;
+
+/* The array is replaced with a larger one when the deque is full. Thieves
+ * might still read from the old array. So it is retained until the deque is
+ * deleted. */
+typedef struct UA_DispatchArray {
+    struct UA_DispatchArray *retired;
+    size_t mask;
+    WorkerCallback *items[];
+} UA_DispatchArray;
+
+typedef struct {
+    volatile size_t top;    /* Taken by thieves with CAS */
+    char padding[64 - sizeof(size_t)]; /* separate cache lines */
+    volatile size_t bottom; /* Only written by the owner */
+    UA_DispatchArray * volatile array;
+} UA_DispatchDeque;
+
 struct UA_Worker {
     UA_Server *server;
     pthread_t thr;
-    UA_UInt32 counter;
+    size_t index;
+    UA_Boolean started;
     volatile UA_Boolean running;
 
-    /* separate cache lines */
-    char padding[64 - sizeof(void*) - sizeof(pthread_t) -
-                 sizeof(UA_UInt32) - sizeof(UA_Boolean)];
+    UA_DispatchDeque deque; /* Pushed and popped by the worker */
+    UA_DispatchDeque inbox; /* Pushed from outside the workers */
+
+    WorkerCallback *freeCallbacks;  /* Nodes for dispatch from the worker */
+    WorkerCallback *retiredFirst;   /* Executed nodes, not yet returned */
+    WorkerCallback *retiredLast;
+    size_t retiredCount;
 };
 
-struct UA_WorkerCallback {
-    SIMPLEQ_ENTRY(UA_WorkerCallback) next;
-    UA_ServerCallback callback;
-    void *data;
+static UA_DispatchArray *
+UA_DispatchArray_new(size_t size) {
+    UA_DispatchArray *a = (UA_DispatchArray*)
+        UA_malloc(sizeof(UA_DispatchArray) + (size * sizeof(WorkerCallback*)));
+    if(!a)
+        return NULL;
+    a->retired = NULL;
+    a->mask = size - 1;
+    return a;
+}
 
-    UA_Boolean delayed;         /* Is it a delayed callback? */
-    UA_Boolean countersSampled; /* Have the worker counters been sampled? */
-    UA_UInt32 workerCounters[]; /* Counter value for each worker */
-};
-typedef struct UA_WorkerCallback WorkerCallback;
+static UA_StatusCode
+UA_DispatchDeque_init(UA_DispatchDeque *d) {
+    d->top = 0;
+    d->bottom = 0;
+    d->array = UA_DispatchArray_new(UA_DISPATCH_DEQUESIZE);
+    if(!d->array)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    return UA_STATUSCODE_GOOD;
+}
 
-/* Forward Declaration */
 static void
-processDelayedCallback(UA_Server *server, WorkerCallback *dc);
+UA_DispatchDeque_deleteMembers(UA_DispatchDeque *d) {
+    UA_DispatchArray *a = d->array;
+    while(a) {
+        UA_DispatchArray *retired = a->retired;
+        UA_free(a);
+        a = retired;
+    }
+    d->array = NULL;
+}
+
+static size_t
+UA_DispatchDeque_size(const UA_DispatchDeque *d) {
+    ptrdiff_t size = (ptrdiff_t)(d->bottom - d->top);
+    return (size > 0) ? (size_t)size : 0;
+}
+
+/* Only called by the owner of the deque */
+static UA_StatusCode
+UA_DispatchDeque_push(UA_DispatchDeque *d, WorkerCallback *dc) {
+    size_t b = d->bottom;
+    size_t t = d->top;
+    UA_DispatchArray *a = d->array;
+    if(b - t > a->mask) {
+        /* Full. Copy the content to an array of double size. */
+        UA_DispatchArray *larger = UA_DispatchArray_new((a->mask + 1) * 2);
+        if(!larger)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        for(size_t i = t; i != b; i++)
+            larger->items[i & larger->mask] = a->items[i & a->mask];
+        larger->retired = a;
+        UA_atomic_sync();
+        d->array = larger;
+        a = larger;
+    }
+    a->items[b & a->mask] = dc;
+    UA_atomic_sync();
+    d->bottom = b + 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Only called by the owner of the deque */
+static WorkerCallback *
+UA_DispatchDeque_pop(UA_DispatchDeque *d) {
+    size_t b = d->bottom - 1;
+    UA_DispatchArray *a = d->array;
+    d->bottom = b;
+    UA_atomic_sync();
+    size_t t = d->top;
+    ptrdiff_t size = (ptrdiff_t)(b - t);
+    if(size < 0) {
+        /* Empty */
+        d->bottom = t;
+        return NULL;
+    }
+    WorkerCallback *dc = a->items[b & a->mask];
+    if(size > 0)
+        return dc;
+    /* The last element. Race against the thieves. */
+    if(UA_atomic_cmpxchgSize(&d->top, t, t + 1) != t)
+        dc = NULL;
+    d->bottom = t + 1;
+    return dc;
+}
+
+/* Can be called from any thread. Returns NULL if the deque is empty or if
+ * another thread was faster. */
+static WorkerCallback *
+UA_DispatchDeque_steal(UA_DispatchDeque *d) {
+    size_t t = d->top;
+    UA_atomic_sync();
+    size_t b = d->bottom;
+    if((ptrdiff_t)(b - t) <= 0)
+        return NULL;
+    UA_DispatchArray *a = d->array;
+    WorkerCallback *dc = a->items[t & a->mask];
+    if(UA_atomic_cmpxchgSize(&d->top, t, t + 1) != t)
+        return NULL;
+    return dc;
+}
+
+/* Push a chain of nodes to a lock-free list. Multiple producers can push
+ * concurrently. The consumers only take the entire list at once. So there is
+ * no ABA problem. */
+static void
+pushCallbacks(WorkerCallback * volatile *list, WorkerCallback *first,
+              WorkerCallback *last) {
+    WorkerCallback *head;
+    do {
+        head = *list;
+        last->next = head;
+    } while(UA_atomic_cmpxchg((void * volatile *)list, head, first) != head);
+}
+
+static WorkerCallback *
+takeCallbacks(WorkerCallback * volatile *list) {
+    return (WorkerCallback*)UA_atomic_xchg((void * volatile *)list, NULL);
+}
+
+/* Take a node from the cache of the current thread. Refill the cache from the
+ * returned nodes. Allocate only when no node is left. */
+static WorkerCallback *
+newCallback(UA_Server *server, WorkerCallback **cache) {
+    if(!*cache)
+        *cache = takeCallbacks(&server->dispatchFreeShared);
+    WorkerCallback *dc = *cache;
+    if(dc) {
+        *cache = dc->next;
+        return dc;
+    }
+    return (WorkerCallback*)UA_malloc(sizeof(WorkerCallback));
+}
+
+static void
+flushRetired(UA_Server *server, UA_Worker *worker) {
+    if(!worker->retiredFirst)
+        return;
+    pushCallbacks(&server->dispatchFreeShared, worker->retiredFirst,
+                  worker->retiredLast);
+    worker->retiredFirst = NULL;
+    worker->retiredLast = NULL;
+    worker->retiredCount = 0;
+}
+
+/* Return the node after use. Workers collect the nodes and return them in
+ * batches. */
+static void
+retireCallback(UA_Server *server, UA_Worker *worker, WorkerCallback *dc) {
+    if(!worker) {
+        pushCallbacks(&server->dispatchFreeShared, dc, dc);
+        return;
+    }
+    dc->next = worker->retiredFirst;
+    worker->retiredFirst = dc;
+    if(!worker->retiredLast)
+        worker->retiredLast = dc;
+    if(++worker->retiredCount >= UA_DISPATCH_RETIREBATCH)
+        flushRetired(server, worker);
+}
+
+/* Register the callback in the current epoch. Delayed callbacks wait until
+ * the callbacks of the epoch (and all earlier epochs) are done. */
+static void
+enterEpoch(UA_Server *server, WorkerCallback *dc) {
+    dc->epoch = server->dispatchEpoch;
+    UA_atomic_addSize(&server->dispatchActive[dc->epoch & 1], 1);
+}
+
+static void
+leaveEpoch(UA_Server *server, size_t epoch) {
+    UA_atomic_subSize(&server->dispatchActive[epoch & 1], 1);
+}
+
+static void
+executeCallback(UA_Server *server, UA_Worker *worker, WorkerCallback *dc) {
+    UA_ServerCallback callback = dc->callback;
+    void *data = dc->data;
+    size_t epoch = dc->epoch;
+    retireCallback(server, worker, dc);
+    callback(server, data);
+    leaveEpoch(server, epoch);
+}
+
+/* Wake up to count sleeping workers */
+static void
+wakeWorkers(UA_Server *server, size_t count) {
+    UA_atomic_sync();
+    if(server->dispatchSleeping == 0 || count == 0)
+        return;
+    pthread_mutex_lock(&server->dispatchQueue_conditionMutex);
+    if(count >= server->dispatchSleeping) {
+        pthread_cond_broadcast(&server->dispatchQueue_condition);
+    } else {
+        for(size_t i = 0; i < count; i++)
+            pthread_cond_signal(&server->dispatchQueue_condition);
+    }
+    pthread_mutex_unlock(&server->dispatchQueue_conditionMutex);
+}
+
+static UA_Boolean
+hasCallbacks(UA_Server *server) {
+    for(size_t i = 0; i < server->workersSize; i++) {
+        UA_Worker *w = &server->workers[i];
+        if(UA_DispatchDeque_size(&w->deque) > 0 ||
+           UA_DispatchDeque_size(&w->inbox) > 0)
+            return true;
+    }
+    return false;
+}
+
+static WorkerCallback *
+nextCallback(UA_Server *server, UA_Worker *worker) {
+    /* Own work first */
+    WorkerCallback *dc = UA_DispatchDeque_pop(&worker->deque);
+    if(dc)
+        return dc;
+    dc = UA_DispatchDeque_steal(&worker->inbox);
+    if(dc)
+        return dc;
+
+    /* Steal from the others */
+    for(size_t i = 1; i < server->workersSize; i++) {
+        UA_Worker *victim = &server->workers[(worker->index + i) % server->workersSize];
+        dc = UA_DispatchDeque_steal(&victim->deque);
+        if(dc)
+            return dc;
+        dc = UA_DispatchDeque_steal(&victim->inbox);
+        if(dc)
+            return dc;
+    }
+    return NULL;
+}
+
+static void
+waitForCallbacks(UA_Server *server, UA_Worker *worker) {
+    pthread_mutex_lock(&server->dispatchQueue_conditionMutex);
+    UA_atomic_addSize(&server->dispatchSleeping, 1);
+    /* Check again after announcing the sleep. The dispatching thread first
+     * pushes and then checks for sleeping workers. */
+    if(worker->running && !hasCallbacks(server))
+        pthread_cond_wait(&server->dispatchQueue_condition,
+                          &server->dispatchQueue_conditionMutex);
+    UA_atomic_subSize(&server->dispatchSleeping, 1);
+    pthread_mutex_unlock(&server->dispatchQueue_conditionMutex);
+}
 
 static void *
 workerLoop(UA_Worker *worker) {
     UA_Server *server = worker->server;
-    UA_UInt32 *counter = &worker->counter;
     volatile UA_Boolean *running = &worker->running;
+    pthread_setspecific(server->workerKey, worker);
 
     /* Initialize the (thread local) random seed with the ram address
      * of the worker. Not for security-critical entropy! */
     UA_random_seed((uintptr_t)worker);
 
     while(*running) {
-        UA_atomic_addUInt32(counter, 1);
-        pthread_mutex_lock(&server->dispatchQueue_accessMutex);
-        WorkerCallback *dc = SIMPLEQ_FIRST(&server->dispatchQueue);
+        WorkerCallback *dc = nextCallback(server, worker);
         if(dc) {
-            SIMPLEQ_REMOVE_HEAD(&server->dispatchQueue, next);
-        }
-        pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
-        if(!dc) {
-            /* Nothing to do. Sleep until a callback is dispatched */
-            pthread_mutex_lock(&server->dispatchQueue_conditionMutex);
-            pthread_cond_wait(&server->dispatchQueue_condition,
-                              &server->dispatchQueue_conditionMutex);
-            pthread_mutex_unlock(&server->dispatchQueue_conditionMutex);
+            executeCallback(server, worker, dc);
             continue;
         }
 
-        if(dc->delayed) {
-            processDelayedCallback(server, dc);
-            continue;
-        }
-
-        dc->callback(server, dc->data);
-        UA_free(dc);
+        /* Nothing to do. Return the nodes and sleep until a callback is
+         * dispatched. */
+        flushRetired(server, worker);
+        waitForCallbacks(server, worker);
     }
 
+    flushRetired(server, worker);
     UA_LOG_DEBUG(server->config.logger, UA_LOGCATEGORY_SERVER,
                  "Worker shut down");
     return NULL;
 }
 
-void UA_Server_cleanupDispatchQueue(UA_Server *server) {
-    while(true) {
-        pthread_mutex_lock(&server->dispatchQueue_accessMutex);
-        WorkerCallback *dc = SIMPLEQ_FIRST(&server->dispatchQueue);
+UA_StatusCode
+UA_Server_initDispatchQueue(UA_Server *server) {
+    /* The queues exist also without worker threads */
+    server->workersSize = server->config.nThreads;
+    if(server->workersSize == 0)
+        server->workersSize = 1;
+    server->workers = (UA_Worker*)UA_calloc(server->workersSize, sizeof(UA_Worker));
+    if(!server->workers)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    pthread_key_create(&server->workerKey, NULL);
+    pthread_mutex_init(&server->dispatchMutex, NULL);
+    pthread_cond_init(&server->dispatchQueue_condition, NULL);
+    pthread_mutex_init(&server->dispatchQueue_conditionMutex, NULL);
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < server->workersSize; i++) {
+        UA_Worker *worker = &server->workers[i];
+        worker->server = server;
+        worker->index = i;
+        retval |= UA_DispatchDeque_init(&worker->deque);
+        retval |= UA_DispatchDeque_init(&worker->inbox);
+    }
+
+    /* Preallocate the callback nodes */
+    for(size_t i = 0; i < UA_DISPATCH_PREALLOC && retval == UA_STATUSCODE_GOOD; i++) {
+        WorkerCallback *dc = (WorkerCallback*)UA_malloc(sizeof(WorkerCallback));
         if(!dc) {
-            pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
             break;
         }
-        SIMPLEQ_REMOVE_HEAD(&server->dispatchQueue, next);
-        pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
-        dc->callback(server, dc->data);
+        dc->next = server->dispatchFree;
+        server->dispatchFree = dc;
+    }
+
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_Server_deleteDispatchQueue(server);
+    return retval;
+}
+
+static void
+deleteCallbacks(WorkerCallback *dc) {
+    while(dc) {
+        WorkerCallback *next = dc->next;
         UA_free(dc);
+        dc = next;
+    }
+}
+
+void
+UA_Server_deleteDispatchQueue(UA_Server *server) {
+    if(!server->workers)
+        return;
+    for(size_t i = 0; i < server->workersSize; i++) {
+        UA_Worker *worker = &server->workers[i];
+        UA_DispatchDeque_deleteMembers(&worker->deque);
+        UA_DispatchDeque_deleteMembers(&worker->inbox);
+        deleteCallbacks(worker->freeCallbacks);
+        deleteCallbacks(worker->retiredFirst);
+    }
+    UA_free(server->workers);
+    server->workers = NULL;
+    deleteCallbacks(server->dispatchFree);
+    server->dispatchFree = NULL;
+    deleteCallbacks(takeCallbacks(&server->dispatchFreeShared));
+    pthread_key_delete(server->workerKey);
+    pthread_mutex_destroy(&server->dispatchMutex);
+    pthread_cond_destroy(&server->dispatchQueue_condition);
+    pthread_mutex_destroy(&server->dispatchQueue_conditionMutex);
+}
+
+/* Forward Declaration */
+static UA_Boolean
+processDelayedCallbacks(UA_Server *server);
+
+void
+UA_Server_cleanupDispatchQueue(UA_Server *server) {
+    UA_Boolean pending = true;
+    while(pending) {
+        /* Execute the dispatched callbacks */
+        for(size_t i = 0; i < server->workersSize; i++) {
+            UA_Worker *worker = &server->workers[i];
+            WorkerCallback *dc;
+            while((dc = UA_DispatchDeque_steal(&worker->deque)) ||
+                  (dc = UA_DispatchDeque_steal(&worker->inbox)))
+                executeCallback(server, NULL, dc);
+        }
+        /* Without running workers, all delayed callbacks become ready. They
+         * may dispatch new callbacks in turn. */
+        pending = processDelayedCallbacks(server) || hasCallbacks(server);
     }
 }
 
@@ -135,23 +472,179 @@ UA_Server_workerCallback(UA_Server *server, UA_ServerCallback callback,
     /* Execute immediately */
     callback(server, data);
 #else
-    /* Execute immediately if memory could not be allocated */
-    WorkerCallback *dc = (WorkerCallback*)UA_malloc(sizeof(WorkerCallback));
+    /* Dispatch from a worker thread to its own deque */
+    UA_Worker *worker = (UA_Worker*)pthread_getspecific(server->workerKey);
+    if(worker) {
+        WorkerCallback *dc = newCallback(server, &worker->freeCallbacks);
+        if(!dc) {
+            callback(server, data);
+            return;
+        }
+        dc->callback = callback;
+        dc->data = data;
+        enterEpoch(server, dc);
+        if(UA_DispatchDeque_push(&worker->deque, dc) != UA_STATUSCODE_GOOD) {
+            executeCallback(server, worker, dc);
+            return;
+        }
+        wakeWorkers(server, 1);
+        return;
+    }
+
+    /* Dispatch from outside to the next inbox */
+    pthread_mutex_lock(&server->dispatchMutex);
+    WorkerCallback *dc = newCallback(server, &server->dispatchFree);
     if(!dc) {
+        /* Execute immediately if memory could not be allocated */
+        pthread_mutex_unlock(&server->dispatchMutex);
         callback(server, data);
         return;
     }
-
-    /* Enqueue for the worker threads */
     dc->callback = callback;
     dc->data = data;
-    dc->delayed = false;
-    pthread_mutex_lock(&server->dispatchQueue_accessMutex);
-    SIMPLEQ_INSERT_TAIL(&server->dispatchQueue, dc, next);
-    pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
+    enterEpoch(server, dc);
+    worker = &server->workers[server->dispatchNext];
+    server->dispatchNext = (server->dispatchNext + 1) % server->workersSize;
+    UA_StatusCode retval = UA_DispatchDeque_push(&worker->inbox, dc);
+    UA_Boolean batching = server->dispatchBatching;
+    if(batching && retval == UA_STATUSCODE_GOOD)
+        server->dispatchBatched++;
+    pthread_mutex_unlock(&server->dispatchMutex);
+    if(retval != UA_STATUSCODE_GOOD) {
+        executeCallback(server, NULL, dc);
+        return;
+    }
+
+    /* Wake up a sleeping worker. Or wait for the end of the batch. */
+    if(!batching)
+        wakeWorkers(server, 1);
+#endif
+}
+
+#ifdef UA_ENABLE_MULTITHREADING
+
+/* Callbacks dispatched during a main-loop iteration wake up the workers only
+ * once at the end */
+static void
+beginDispatchBatch(UA_Server *server) {
+    pthread_mutex_lock(&server->dispatchMutex);
+    server->dispatchBatching = true;
+    server->dispatchBatched = 0;
+    pthread_mutex_unlock(&server->dispatchMutex);
+}
+
+static void
+endDispatchBatch(UA_Server *server) {
+    pthread_mutex_lock(&server->dispatchMutex);
+    server->dispatchBatching = false;
+    size_t batched = server->dispatchBatched;
+    pthread_mutex_unlock(&server->dispatchMutex);
+    wakeWorkers(server, batched);
+}
+
+#endif
+
+/**
+ * Parallel Processing
+ * -------------------
+ * A worker splits a large batch into chunks and pushes them to its own deque.
+ * Idle workers steal the chunks. The worker processes the chunks itself that
+ * are not stolen and then waits until the stolen chunks are done. */
+
+#define UA_PARALLEL_MINCHUNK 64 /* Minimum number of items per chunk */
+
+#ifdef UA_ENABLE_MULTITHREADING
+
+typedef struct {
+    UA_ParallelCallback callback;
+    void *context;
+    volatile size_t remaining; /* Chunks not yet done */
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+} ParallelJob;
+
+typedef struct {
+    ParallelJob *job;
+    size_t begin;
+    size_t end;
+} ParallelChunk;
+
+static void
+processChunk(UA_Server *server, ParallelChunk *chunk) {
+    ParallelJob *job = chunk->job;
+    job->callback(server, job->context, chunk->begin, chunk->end);
+    /* The job lives on the stack of the waiting worker. Don't touch it after
+     * the mutex is released. */
+    pthread_mutex_lock(&job->mutex);
+    if(--job->remaining == 0)
+        pthread_cond_signal(&job->done);
+    pthread_mutex_unlock(&job->mutex);
+}
+
+#endif
+
+void
+UA_Server_processParallel(UA_Server *server, size_t count,
+                          UA_ParallelCallback callback, void *context) {
+#ifdef UA_ENABLE_MULTITHREADING
+    /* Split only in a worker thread. Otherwise the workers might not run. */
+    UA_Worker *worker = (UA_Worker*)pthread_getspecific(server->workerKey);
+    size_t chunks = server->workersSize * 2;
+    if(chunks > count / UA_PARALLEL_MINCHUNK)
+        chunks = count / UA_PARALLEL_MINCHUNK;
+    if(!worker || server->workersSize < 2 || chunks < 2) {
+        callback(server, context, 0, count);
+        return;
+    }
+
+    ParallelChunk *c = (ParallelChunk*)UA_malloc(chunks * sizeof(ParallelChunk));
+    if(!c) {
+        callback(server, context, 0, count);
+        return;
+    }
+
+    ParallelJob job;
+    job.callback = callback;
+    job.context = context;
+    job.remaining = chunks;
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.done, NULL);
+
+    /* Dispatch the chunks to the own deque */
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for(size_t i = 0; i < chunks; i++) {
+        c[i].job = &job;
+        c[i].begin = i * chunkSize;
+        c[i].end = (i + 1) * chunkSize;
+        if(c[i].end > count)
+            c[i].end = count;
+        UA_Server_workerCallback(server, (UA_ServerCallback)processChunk, &c[i]);
+    }
+
+    /* Process the chunks that were not stolen. They are on top of the own
+     * deque. */
+    WorkerCallback *dc;
+    while(job.remaining > 0 && (dc = UA_DispatchDeque_pop(&worker->deque))) {
+        if(dc->callback != (UA_ServerCallback)processChunk ||
+           ((ParallelChunk*)dc->data)->job != &job) {
+            /* Not from this job. Cannot fail as the item was just popped. */
+            UA_DispatchDeque_push(&worker->deque, dc);
+            break;
+        }
+        executeCallback(server, worker, dc);
+    }
+
+    /* Wait for the stolen chunks */
+    pthread_mutex_lock(&job.mutex);
+    while(job.remaining > 0)
+        pthread_cond_wait(&job.done, &job.mutex);
+    pthread_mutex_unlock(&job.mutex);
 
-    /* Wake up sleeping workers */
-    pthread_cond_broadcast(&server->dispatchQueue_condition);
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.done);
+    UA_free(c);
+#else
+    callback(server, context, 0, count);
 #endif
 }
 
@@ -162,16 +655,21 @@ UA_Server_workerCallback(UA_Server *server, UA_ServerCallback callback,
  * Delayed Callbacks are called only when all callbacks that were dispatched
  * prior are finished. In the single-threaded case, the callback is added to a
  * singly-linked list that is processed at the end of the server's main-loop. In
- * the multi-threaded case, the delay is ensure by a three-step procedure:
+ * the multi-threaded case, the delay is ensured with epochs:
+ *
+ * 1. Every dispatched callback is counted as active in the current epoch until
+ *    it is done. The delayed callback remembers the epoch of its creation.
  *
- * 1. The delayed callback is dispatched to the worker queue. So it is only
- *    dequeued when all prior callbacks have been dequeued.
+ * 2. When the callbacks of the previous epoch are done, a worker begins the
+ *    next epoch.
  *
- * 2. When the callback is first dequeued by a worker, sample the counter of all
- *    workers. Once all counters have advanced, the callback is ready.
+ * 3. The delayed callback is ready when the epoch of its creation has passed
+ *    and no callbacks from that epoch remain active. The main loop checks the
+ *    delayed callbacks after listening on the network layers.
  *
- * 3. Check regularly if the callback is ready by adding it back to the dispatch
- *    queue. */
+ * The delayed callbacks are executed in the main loop and not by the workers.
+ * They tear down SecureChannels and connections. This must not race with the
+ * network layer that closes and frees the connections in the same thread. */
 
 /* Delayed callback to free the subscription memory */
 static void
@@ -222,70 +720,68 @@ void UA_Server_cleanupDelayedCallbacks(UA_Server *server) {
 UA_StatusCode
 UA_Server_delayedCallback(UA_Server *server, UA_ServerCallback callback,
                           void *data) {
-    size_t dcsize = sizeof(WorkerCallback) +
-        (sizeof(UA_UInt32) * server->config.nThreads);
-    WorkerCallback *dc = (WorkerCallback*)UA_malloc(dcsize);
+    WorkerCallback *dc;
+    UA_Worker *worker = (UA_Worker*)pthread_getspecific(server->workerKey);
+    if(worker) {
+        dc = newCallback(server, &worker->freeCallbacks);
+    } else {
+        pthread_mutex_lock(&server->dispatchMutex);
+        dc = newCallback(server, &server->dispatchFree);
+        pthread_mutex_unlock(&server->dispatchMutex);
+    }
     if(!dc)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    /* Enqueue for the worker threads */
+    /* The delayed callback waits for the callbacks of the current epoch */
     dc->callback = callback;
     dc->data = data;
-    dc->delayed = true;
-    dc->countersSampled = false;
-    pthread_mutex_lock(&server->dispatchQueue_accessMutex);
-    SIMPLEQ_INSERT_TAIL(&server->dispatchQueue, dc, next);
-    pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
-
-    /* Wake up sleeping workers */
-    pthread_cond_broadcast(&server->dispatchQueue_condition);
+    dc->epoch = server->dispatchEpoch;
+    pushCallbacks(&server->delayedCallbacks, dc, dc);
     return UA_STATUSCODE_GOOD;
 }
 
-/* Called from the worker loop */
-static void
-processDelayedCallback(UA_Server *server, WorkerCallback *dc) {
-    /* Set the worker counters */
-    if(!dc->countersSampled) {
-        for(size_t i = 0; i < server->config.nThreads; ++i)
-            dc->workerCounters[i] = server->workers[i].counter;
-        dc->countersSampled = true;
-
-        /* Re-add to the dispatch queue */
-        pthread_mutex_lock(&server->dispatchQueue_accessMutex);
-        SIMPLEQ_INSERT_TAIL(&server->dispatchQueue, dc, next);
-        pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
-
-        /* Wake up sleeping workers */
-        pthread_cond_broadcast(&server->dispatchQueue_condition);
-        return;
+/* Are all callbacks done that were dispatched before the delayed callback?
+ * There are two counters for the active callbacks, for the current and the
+ * previous epoch. A new epoch begins when the callbacks from the previous
+ * epoch are done. Then the counter is reused. */
+static UA_Boolean
+delayedReady(UA_Server *server, const WorkerCallback *dc) {
+    size_t epoch = server->dispatchEpoch;
+    if(epoch == dc->epoch) {
+        if(server->dispatchActive[(epoch + 1) & 1] != 0)
+            return false;
+        UA_atomic_cmpxchgSize(&server->dispatchEpoch, epoch, epoch + 1);
+        epoch = server->dispatchEpoch;
     }
+    if(epoch - dc->epoch >= 2)
+        return true;
+    return (server->dispatchActive[dc->epoch & 1] == 0);
+}
 
-    /* Have all other jobs finished? */
-    UA_Boolean ready = true;
-    for(size_t i = 0; i < server->config.nThreads; ++i) {
-        if(dc->workerCounters[i] == server->workers[i].counter) {
-            ready = false;
-            break;
+/* Execute the delayed callbacks that are ready. Returns whether delayed
+ * callbacks are left. Called from the main loop. */
+static UA_Boolean
+processDelayedCallbacks(UA_Server *server) {
+    WorkerCallback *dc = takeCallbacks(&server->delayedCallbacks);
+    WorkerCallback *first = NULL, *last = NULL;
+    while(dc) {
+        WorkerCallback *next = dc->next;
+        if(delayedReady(server, dc)) {
+            /* Delayed callbacks created during the execution wait for it */
+            enterEpoch(server, dc);
+            executeCallback(server, NULL, dc);
+        } else {
+            dc->next = first;
+            first = dc;
+            if(!last)
+                last = dc;
         }
+        dc = next;
     }
-
-    /* Re-add to the dispatch queue.
-     * TODO: What is the impact of this loop?
-     * Can we add a small delay here? */
-    if(!ready) {
-        pthread_mutex_lock(&server->dispatchQueue_accessMutex);
-        SIMPLEQ_INSERT_TAIL(&server->dispatchQueue, dc, next);
-        pthread_mutex_unlock(&server->dispatchQueue_accessMutex);
-
-        /* Wake up sleeping workers */
-        pthread_cond_broadcast(&server->dispatchQueue_condition);
-        return;
-    }
-
-    /* Execute the callback */
-    dc->callback(server, dc->data);
-    UA_free(dc);
+    if(!first)
+        return false;
+    pushCallbacks(&server->delayedCallbacks, first, last);
+    return true;
 }
 
 #endif
@@ -324,17 +820,10 @@ UA_Server_run_startup(UA_Server *server) {
 #ifdef UA_ENABLE_MULTITHREADING
     UA_LOG_INFO(server->config.logger, UA_LOGCATEGORY_SERVER,
                 "Spinning up %u worker thread(s)", server->config.nThreads);
-    pthread_mutex_init(&server->dispatchQueue_accessMutex, NULL);
-    pthread_cond_init(&server->dispatchQueue_condition, NULL);
-    pthread_mutex_init(&server->dispatchQueue_conditionMutex, NULL);
-    server->workers = (UA_Worker*)UA_malloc(server->config.nThreads * sizeof(UA_Worker));
-    if(!server->workers)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
     for(size_t i = 0; i < server->config.nThreads; ++i) {
         UA_Worker *worker = &server->workers[i];
-        worker->server = server;
-        worker->counter = 0;
         worker->running = true;
+        worker->started = true;
         pthread_create(&worker->thr, NULL, (void* (*)(void*))workerLoop, worker);
     }
 #endif
@@ -349,8 +838,31 @@ UA_Server_run_startup(UA_Server *server) {
     return result;
 }
 
+#if defined(UA_clock_nanosleep)
+/* Sleep until the deadline of the next repeated callback. The network layers
+ * wait with millisecond resolution. Deadlines closer than that (e.g. for
+ * PubSub cycles below one millisecond) are met by sleeping until an absolute
+ * time of the monotonic clock. */
+static void
+waitUntil(UA_DateTime deadline) {
+    UA_DateTime remaining = deadline - UA_DateTime_nowMonotonic();
+    if(remaining <= 0)
+        return;
+    struct timespec ts;
+    UA_clock_gettime(CLOCK_MONOTONIC, &ts);
+    UA_Int64 nsec = (UA_Int64)ts.tv_nsec + (remaining * 100);
+    ts.tv_sec += (time_t)(nsec / 1000000000);
+    ts.tv_nsec = (long)(nsec % 1000000000);
+    while(UA_clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == UA_INTERRUPTED) {}
+}
+#endif
+
 UA_UInt16
 UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal) {
+#ifdef UA_ENABLE_MULTITHREADING
+    beginDispatchBatch(server);
+#endif
+
     /* Process repeated work */
     UA_DateTime now = UA_DateTime_nowMonotonic();
     UA_DateTime nextRepeated =
@@ -363,10 +875,23 @@ UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal) {
 
     UA_UInt16 timeout = 0;
 
+#if defined(UA_clock_nanosleep)
+    /* Round down. The remainder below one millisecond is slept precisely after
+     * the network layer returns. */
+    if(waitInternal)
+        timeout = (UA_UInt16)((nextRepeated - now) / UA_DATETIME_MSEC);
+#else
     /* round always to upper value to avoid timeout to be set to 0
     * if(nextRepeated - now) < (UA_DATETIME_MSEC/2) */
     if(waitInternal)
         timeout = (UA_UInt16)(((nextRepeated - now) + (UA_DATETIME_MSEC - 1)) / UA_DATETIME_MSEC);
+#endif
+
+#ifdef UA_ENABLE_MULTITHREADING
+    /* Wake up the workers for the repeated callbacks before blocking */
+    endDispatchBatch(server);
+    beginDispatchBatch(server);
+#endif
 
     /* Listen on the networklayer */
     for(size_t i = 0; i < server->config.networkLayersSize; ++i) {
@@ -374,11 +899,24 @@ UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal) {
         nl->listen(nl, server, timeout);
     }
 
-#ifndef UA_ENABLE_MULTITHREADING
+#ifdef UA_ENABLE_MULTITHREADING
+    endDispatchBatch(server);
+#endif
+
+#if defined(UA_clock_nanosleep)
+    /* Sleep precisely if the network layer returned less than one millisecond
+     * before the deadline. Otherwise return to process the network events. */
+    if(waitInternal && nextRepeated - UA_DateTime_nowMonotonic() < UA_DATETIME_MSEC)
+        waitUntil(nextRepeated);
+#endif
+
     /* Process delayed callbacks when all callbacks and network events are done.
-     * If multithreading is enabled, the cleanup of delayed values is attempted
-     * by a callback in the job queue. */
+     * If multithreading is enabled, only the delayed callbacks are executed
+     * whose prior dispatched callbacks are done. */
+#ifndef UA_ENABLE_MULTITHREADING
     UA_Server_cleanupDelayedCallbacks(server);
+#else
+    processDelayedCallbacks(server);
 #endif
 
 #if defined(UA_ENABLE_DISCOVERY_MULTICAST) && !defined(UA_ENABLE_MULTITHREADING)
@@ -413,17 +951,17 @@ UA_Server_run_shutdown(UA_Server *server) {
 
 #ifdef UA_ENABLE_MULTITHREADING
     /* Shut down the workers */
-    if(server->workers) {
+    if(server->config.nThreads > 0 && server->workers[0].started) {
         UA_LOG_INFO(server->config.logger, UA_LOGCATEGORY_SERVER,
                     "Shutting down %u worker thread(s)",
                     server->config.nThreads);
         for(size_t i = 0; i < server->config.nThreads; ++i)
             server->workers[i].running = false;
-        pthread_cond_broadcast(&server->dispatchQueue_condition);
-        for(size_t i = 0; i < server->config.nThreads; ++i)
+        wakeWorkers(server, server->config.nThreads);
+        for(size_t i = 0; i < server->config.nThreads; ++i) {
             pthread_join(server->workers[i].thr, NULL);
-        UA_free(server->workers);
-        server->workers = NULL;
+            server->workers[i].started = false;
+        }
     }
 
     /* Execute the remaining callbacks in the dispatch queue. Also executes
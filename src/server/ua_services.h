@@ -257,7 +257,10 @@ void Service_TranslateBrowsePathsToNodeIds(UA_Server *server, UA_Session *sessio
  * ^^^^^^^^^^^^^^^^^^^^^
  * Used by Clients to register the Nodes that they know they will access
  * repeatedly (e.g. Write, Call). It allows Servers to set up anything needed so
- * that the access operations will be more efficient. */
+ * that the access operations will be more efficient. The registered NodeIds
+ * are compact numeric handles of the session. Read and Write take the node
+ * held for the handle without a lookup in the nodestore. In the requests of the
+ * other services, the handles are replaced by the original NodeIds. */
 void Service_RegisterNodes(UA_Server *server, UA_Session *session,
                            const UA_RegisterNodesRequest *request,
                            UA_RegisterNodesResponse *response);
@@ -365,32 +365,77 @@ Read(const UA_Node *node, UA_Server *server, UA_Session *session,
     }
 }
 
-static UA_StatusCode
-Operation_Read(UA_Server *server, UA_Session *session, UA_MessageContext *mc,
-               UA_TimestampsToReturn timestampsToReturn, const UA_ReadValueId *id) {
-    UA_DataValue dv;
-    UA_DataValue_init(&dv);
-
-    /* Get the node */
-    const UA_Node *node = UA_Nodestore_get(server, &id->nodeId);
+static void
+Operation_Read(UA_Server *server, UA_Session *session,
+               UA_TimestampsToReturn timestampsToReturn, const UA_ReadValueId *id,
+               UA_DataValue *dv) {
+    /* Get the node. Also from a registered handle. */
+    const UA_Node *node = UA_Server_getNodeWithSession(server, session, &id->nodeId);
 
     /* Perform the read operation */
     if(node) {
-        Read(node, server, session, timestampsToReturn, id, &dv);
+        Read(node, server, session, timestampsToReturn, id, dv);
     } else {
-        dv.hasStatus = true;
-        dv.status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        dv->hasStatus = true;
+        dv->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
     }
 
-    /* Encode (and send) the results */
-    UA_StatusCode retval = UA_MessageContext_encode(mc, &dv, &UA_TYPES[UA_TYPES_DATAVALUE]);
-
-    /* Free copied data and release the node */
-    UA_Variant_deleteMembers(&dv.value);
+    /* Release the node */
     UA_Nodestore_release(server, node);
+}
+
+/* Read and encode (and send) the results one after the other */
+static UA_StatusCode
+encodeReadResults(UA_Server *server, UA_Session *session, UA_MessageContext *mc,
+                  const UA_ReadRequest *request, size_t size) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < size && retval == UA_STATUSCODE_GOOD; i++) {
+        UA_DataValue dv;
+        UA_DataValue_init(&dv);
+        Operation_Read(server, session, request->timestampsToReturn,
+                       &request->nodesToRead[i], &dv);
+        retval = UA_MessageContext_encode(mc, &dv, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        UA_DataValue_deleteMembers(&dv);
+    }
     return retval;
 }
 
+#ifdef UA_ENABLE_MULTITHREADING
+
+typedef struct {
+    UA_Session *session;
+    const UA_ReadRequest *request;
+    UA_DataValue *results;
+} ParallelRead;
+
+static void
+readParallel(UA_Server *server, ParallelRead *pr, size_t begin, size_t end) {
+    for(size_t i = begin; i < end; i++)
+        Operation_Read(server, pr->session, pr->request->timestampsToReturn,
+                       &pr->request->nodesToRead[i], &pr->results[i]);
+}
+
+/* Read all values in parallel before they are encoded */
+static UA_StatusCode
+encodeReadResultsParallel(UA_Server *server, UA_Session *session, UA_MessageContext *mc,
+                          const UA_ReadRequest *request, size_t size) {
+    UA_DataValue *results = (UA_DataValue*)
+        UA_Array_new(size, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(!results)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    ParallelRead pr = {session, request, results};
+    UA_Server_processParallel(server, size, (UA_ParallelCallback)readParallel, &pr);
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < size && retval == UA_STATUSCODE_GOOD; i++)
+        retval = UA_MessageContext_encode(mc, &results[i], &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_Array_delete(results, size, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    return retval;
+}
+
+#endif
+
 UA_StatusCode Service_Read(UA_Server *server, UA_Session *session, UA_MessageContext *mc,
                            const UA_ReadRequest *request, UA_ResponseHeader *responseHeader) {
     UA_LOG_DEBUG_SESSION(server->config.logger, session,
@@ -428,12 +473,17 @@ UA_StatusCode Service_Read(UA_Server *server, UA_Session *session, UA_MessageCon
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
 
-    for(UA_Int32 i = 0; i < arraySize; i++) {
-        retval = Operation_Read(server, session, mc, request->timestampsToReturn,
-                                &request->nodesToRead[i]);
-        if(retval != UA_STATUSCODE_GOOD)
-            return retval;
-    }
+#ifdef UA_ENABLE_MULTITHREADING
+    if(server->config.parallelOperationsThreshold > 0 &&
+       arraySize >= (UA_Int32)server->config.parallelOperationsThreshold)
+        retval = encodeReadResultsParallel(server, session, mc, request, (size_t)arraySize);
+    else
+        retval = encodeReadResults(server, session, mc, request, (size_t)arraySize);
+#else
+    retval = encodeReadResults(server, session, mc, request, (size_t)arraySize);
+#endif
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
 
     /* Don't return any DiagnosticInfo */
     arraySize = -1;
@@ -448,7 +498,7 @@ UA_Server_readWithSession(UA_Server *server, UA_Session *session,
     UA_DataValue_init(&dv);
 
     /* Get the node */
-    const UA_Node *node = UA_Nodestore_get(server, &item->nodeId);
+    const UA_Node *node = UA_Server_getNodeWithSession(server, session, &item->nodeId);
     if(!node) {
         dv.hasStatus = true;
         dv.status = UA_STATUSCODE_BADNODEIDUNKNOWN;
@@ -592,12 +642,12 @@ compatibleDataType(UA_Server *server, const UA_NodeId *dataType,
         return true;
 
     /* Is the value-type a subtype of the required type? */
-    if(isNodeInTree(&server->config.nodestore, dataType, constraintDataType, &subtypeId, 1))
+    if(isSubtypeOf(server, dataType, constraintDataType))
         return true;
 
     /* Enum allows Int32 (only) */
     if(UA_NodeId_equal(dataType, &UA_TYPES[UA_TYPES_INT32].typeId) &&
-       isNodeInTree(&server->config.nodestore, constraintDataType, &enumNodeId, &subtypeId, 1))
+       isSubtypeOf(server, constraintDataType, &enumNodeId))
         return true;
 
     /* More checks for the data type of real values (variants) */
@@ -609,8 +659,7 @@ compatibleDataType(UA_Server *server, const UA_NodeId *dataType,
         if(dataType->namespaceIndex == 0 &&
            dataType->identifierType == UA_NODEIDTYPE_NUMERIC &&
            dataType->identifier.numeric <= 25 &&
-           isNodeInTree(&server->config.nodestore, constraintDataType,
-                        dataType, &subtypeId, 1))
+           isSubtypeOf(server, constraintDataType, dataType))
             return true;
     }
 
@@ -991,6 +1040,8 @@ writeDataTypeAttribute(UA_Server *server, UA_Session *session,
 
 static UA_StatusCode
 writeValueAttributeWithoutRange(UA_VariableNode *node, const UA_DataValue *value) {
+    if(UA_VariableNode_setInlineValue(node, value))
+        return UA_STATUSCODE_GOOD;
     UA_DataValue new_value;
     UA_StatusCode retval = UA_DataValue_copy(value, &new_value);
     if(retval != UA_STATUSCODE_GOOD)
@@ -1338,11 +1389,24 @@ copyAttributeIntoNode(UA_Server *server, UA_Session *session,
     return retval;
 }
 
+/* The cached browse paths are outdated once the new BrowseName is visible. With
+ * immutable nodes, that is only after the edited copy has replaced the node. */
+static UA_StatusCode
+writeAttribute(UA_Server *server, UA_Session *session, const UA_WriteValue *wv) {
+    UA_StatusCode retval =
+        UA_Server_editNode(server, session, &wv->nodeId,
+                           (UA_EditNodeCallback)copyAttributeIntoNode,
+                           /* casting away const qualifier because callback uses const anyway */
+                           (UA_WriteValue *)(uintptr_t)wv);
+    if(retval == UA_STATUSCODE_GOOD && wv->attributeId == UA_ATTRIBUTEID_BROWSENAME)
+        UA_Server_invalidatePathCache(server);
+    return retval;
+}
+
 static void
 Operation_Write(UA_Server *server, UA_Session *session, void *context,
                 UA_WriteValue *wv, UA_StatusCode *result) {
-    *result = UA_Server_editNode(server, session, &wv->nodeId,
-                        (UA_EditNodeCallback)copyAttributeIntoNode, wv);
+    *result = writeAttribute(server, session, wv);
 }
 
 void
@@ -1359,26 +1423,20 @@ Service_Write(UA_Server *server, UA_Session *session,
     }
 
     response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session, (UA_ServiceOperation)Operation_Write, NULL,
-                                           &request->nodesToWriteSize, &UA_TYPES[UA_TYPES_WRITEVALUE],
-                                           &response->resultsSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
+        UA_Server_processServiceOperationsParallel(server, session, (UA_ServiceOperation)Operation_Write, NULL,
+                                                   &request->nodesToWriteSize, &UA_TYPES[UA_TYPES_WRITEVALUE],
+                                                   &response->resultsSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
 }
 
 UA_StatusCode
 UA_Server_writeWithSession(UA_Server *server, UA_Session *session,
                            const UA_WriteValue *value) {
-    return UA_Server_editNode(server, session, &value->nodeId,
-                              (UA_EditNodeCallback)copyAttributeIntoNode,
-                              /* casting away const qualifier because callback uses const anyway */
-                              (UA_WriteValue *)(uintptr_t)value);
+    return writeAttribute(server, session, value);
 }
 
 UA_StatusCode
 UA_Server_write(UA_Server *server, const UA_WriteValue *value) {
-    return UA_Server_editNode(server, &adminSession, &value->nodeId,
-                              (UA_EditNodeCallback)copyAttributeIntoNode,
-                              /* casting away const qualifier because callback uses const anyway */
-                              (UA_WriteValue *)(uintptr_t)value);
+    return writeAttribute(server, &adminSession, value);
 }
 
 /* Convenience function to be wrapped into inline functions */
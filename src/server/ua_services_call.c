@@ -113,7 +113,6 @@ validMethodArguments(UA_Server *server, UA_Session *session, const UA_MethodNode
 }
 
 static const UA_NodeId hasComponentNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASCOMPONENT}};
-static const UA_NodeId hasSubTypeNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASSUBTYPE}};
 
 static void
 callWithMethodAndObject(UA_Server *server, UA_Session *session,
@@ -147,15 +146,10 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
         UA_NodeReferenceKind *rk = &object->references[i];
         if(rk->isInverse)
             continue;
-        if(!isNodeInTree(&server->config.nodestore, &rk->referenceTypeId,
-                         &hasComponentNodeId, &hasSubTypeNodeId, 1))
+        if(!isSubtypeOf(server, &rk->referenceTypeId, &hasComponentNodeId))
             continue;
-        for(size_t j = 0; j < rk->targetIdsSize; ++j) {
-            if(UA_NodeId_equal(&rk->targetIds[j].nodeId, &request->methodId)) {
-                found = true;
-                break;
-            }
-        }
+        if(UA_NodeReferenceKind_findTarget(rk, &request->methodId))
+            found = true;
     }
     if(!found) {
         result->statusCode = UA_STATUSCODE_BADMETHODINVALID;
@@ -274,9 +268,9 @@ void Service_Call(UA_Server *server, UA_Session *session,
     }
 
     response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session, (UA_ServiceOperation)Operation_CallMethod, NULL,
-                                           &request->methodsToCallSize, &UA_TYPES[UA_TYPES_CALLMETHODREQUEST],
-                                           &response->resultsSize, &UA_TYPES[UA_TYPES_CALLMETHODRESULT]);
+        UA_Server_processServiceOperationsParallel(server, session, (UA_ServiceOperation)Operation_CallMethod, NULL,
+                                                   &request->methodsToCallSize, &UA_TYPES[UA_TYPES_CALLMETHODREQUEST],
+                                                   &response->resultsSize, &UA_TYPES[UA_TYPES_CALLMETHODRESULT]);
 }
 
 UA_CallMethodResult UA_EXPORT
@@ -132,8 +132,7 @@ checkParentReference(UA_Server *server, UA_Session *session, UA_NodeClass nodeCl
     }
 
     /* Test if the referencetype is hierarchical */
-    if(!isNodeInTree(&server->config.nodestore, referenceTypeId,
-                     &hierarchicalReferences, &subtypeId, 1)) {
+    if(!isSubtypeOf(server, referenceTypeId, &hierarchicalReferences)) {
         UA_LOG_INFO_SESSION(server->config.logger, session,
                             "AddNodes: Reference type to the parent is not hierarchical");
         return UA_STATUSCODE_BADREFERENCETYPEIDINVALID;
@@ -350,11 +349,9 @@ isMandatoryChild(UA_Server *server, UA_Session *session,
             continue;
         if(refs->isInverse)
             continue;
-        for(size_t j = 0; j < refs->targetIdsSize; ++j) {
-            if(UA_NodeId_equal(&mandatoryId, &refs->targetIds[j].nodeId)) {
-                UA_Nodestore_release(server, child);
-                return true;
-            }
+        if(UA_NodeReferenceKind_findTarget(refs, &mandatoryId)) {
+            UA_Nodestore_release(server, child);
+            return true;
         }
     }
 
@@ -398,7 +395,7 @@ static void deleteReferencesSubset(UA_Node *node, size_t referencesSkipSize, UA_
     }
 
     /* Now copy the remaining references to a new array */
-    UA_NodeReferenceKind *newReferences = (UA_NodeReferenceKind *)UA_malloc(sizeof(UA_NodeReferenceKind) * (newSize));
+    UA_NodeReferenceKind *newReferences = (UA_NodeReferenceKind *)UA_calloc(newSize, sizeof(UA_NodeReferenceKind));
     size_t curr = 0;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     for(size_t i = 0; i < node->referencesSize && retval == UA_STATUSCODE_GOOD; ++i) {
@@ -660,31 +657,45 @@ removeDeconstructedNode(UA_Server *server, UA_Session *session,
 
 static const UA_NodeId hasSubtype = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASSUBTYPE}};
 
-UA_StatusCode
-AddNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
-                const UA_NodeId *parentNodeId, const UA_NodeId *referenceTypeId,
-                const UA_NodeId *typeDefinitionId) {
-    /* Get the node */
-    const UA_Node *type = NULL;
-    const UA_Node *node = UA_Nodestore_get(server, nodeId);
-    if(!node)
-        return UA_STATUSCODE_BADNODEIDUNKNOWN;
-
-    /* Use the typeDefinition as parent for type-nodes */
-    if(node->nodeClass == UA_NODECLASS_VARIABLETYPE ||
-       node->nodeClass == UA_NODECLASS_OBJECTTYPE ||
-       node->nodeClass == UA_NODECLASS_REFERENCETYPE ||
-       node->nodeClass == UA_NODECLASS_DATATYPE) {
-        if(UA_NodeId_equal(referenceTypeId, &UA_NODEID_NULL))
-            referenceTypeId = &hasSubtype;
+/* Use the parent as the typeDefinition of type-nodes. Replace an empty
+ * typeDefinition of variables and objects with the most permissive default. */
+static void
+resolveAddNodeRefs(UA_Server *server, UA_Session *session, UA_NodeClass nodeClass,
+                   const UA_NodeId *parentNodeId, const UA_NodeId **referenceTypeId,
+                   const UA_NodeId **typeDefinitionId) {
+    if(nodeClass == UA_NODECLASS_VARIABLETYPE ||
+       nodeClass == UA_NODECLASS_OBJECTTYPE ||
+       nodeClass == UA_NODECLASS_REFERENCETYPE ||
+       nodeClass == UA_NODECLASS_DATATYPE) {
+        if(UA_NodeId_equal(*referenceTypeId, &UA_NODEID_NULL))
+            *referenceTypeId = &hasSubtype;
         const UA_Node *parentNode = UA_Nodestore_get(server, parentNodeId);
         if(parentNode) {
-            if(parentNode->nodeClass == node->nodeClass)
-                typeDefinitionId = parentNodeId;
+            if(parentNode->nodeClass == nodeClass)
+                *typeDefinitionId = parentNodeId;
             UA_Nodestore_release(server, parentNode);
         }
+        return;
     }
 
+    if((nodeClass == UA_NODECLASS_VARIABLE || nodeClass == UA_NODECLASS_OBJECT) &&
+       UA_NodeId_isNull(*typeDefinitionId)) {
+        UA_LOG_INFO_SESSION(server->config.logger, session,
+                            "AddNodes: No TypeDefinition; Use the default "
+                            "TypeDefinition for the Variable/Object");
+        if(nodeClass == UA_NODECLASS_VARIABLE)
+            *typeDefinitionId = &baseDataVariableType;
+        else
+            *typeDefinitionId = &baseObjectType;
+    }
+}
+
+/* Check the parent reference and the typeDefinition of a node. The references
+ * are already resolved with resolveAddNodeRefs. */
+static UA_StatusCode
+checkAddNodeRefs(UA_Server *server, UA_Session *session, const UA_Node *node,
+                 const UA_NodeId *parentNodeId, const UA_NodeId *referenceTypeId,
+                 const UA_NodeId *typeDefinitionId) {
     /* Check parent reference. Objects may have no parent. */
     UA_StatusCode retval = checkParentReference(server, session, node->nodeClass,
                                                 parentNodeId, referenceTypeId);
@@ -692,119 +703,126 @@ AddNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
         UA_LOG_INFO_SESSION(server->config.logger, session,
                             "AddNodes: The parent reference is invalid "
                             "with status code %s", UA_StatusCode_name(retval));
-        goto cleanup;
+        return retval;
     }
 
-    /* Replace empty typeDefinition with the most permissive default */
-    if((node->nodeClass == UA_NODECLASS_VARIABLE ||
-        node->nodeClass == UA_NODECLASS_OBJECT) &&
-       UA_NodeId_isNull(typeDefinitionId)) {
+    if(!UA_NodeId_isNull(parentNodeId) && UA_NodeId_isNull(referenceTypeId)) {
         UA_LOG_INFO_SESSION(server->config.logger, session,
-                            "AddNodes: No TypeDefinition; Use the default "
-                            "TypeDefinition for the Variable/Object");
-        if(node->nodeClass == UA_NODECLASS_VARIABLE)
-            typeDefinitionId = &baseDataVariableType;
-        else
-            typeDefinitionId = &baseObjectType;
+                            "AddNodes: Reference to parent cannot be null");
+        return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
     }
 
-    /* Get the node type. There must be a typedefinition for variables, objects
-     * and type-nodes. See the above checks. */
-    if(!UA_NodeId_isNull(typeDefinitionId)) {
-        /* Get the type node */
-        type = UA_Nodestore_get(server, typeDefinitionId);
-        if(!type) {
-            UA_LOG_INFO_SESSION(server->config.logger, session,
-                                "AddNodes: Node type not found");
-            retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-            goto cleanup;
-        }
+    /* There must be a typedefinition for variables, objects and type-nodes.
+     * See resolveAddNodeRefs. */
+    if(UA_NodeId_isNull(typeDefinitionId))
+        return UA_STATUSCODE_GOOD;
 
-        UA_Boolean typeOk = UA_FALSE;
-        switch(node->nodeClass) {
-            case UA_NODECLASS_DATATYPE:
-                typeOk = type->nodeClass == UA_NODECLASS_DATATYPE;
-                break;
-            case UA_NODECLASS_METHOD:
-                typeOk = type->nodeClass == UA_NODECLASS_METHOD;
-                break;
-            case UA_NODECLASS_OBJECT:
-                typeOk = type->nodeClass == UA_NODECLASS_OBJECTTYPE;
-                break;
-            case UA_NODECLASS_OBJECTTYPE:
-                typeOk = type->nodeClass == UA_NODECLASS_OBJECTTYPE;
-                break;
-            case UA_NODECLASS_REFERENCETYPE:
-                typeOk = type->nodeClass == UA_NODECLASS_REFERENCETYPE;
-                break;
-            case UA_NODECLASS_VARIABLE:
-                typeOk = type->nodeClass == UA_NODECLASS_VARIABLETYPE;
-                break;
-            case UA_NODECLASS_VARIABLETYPE:
-                typeOk = type->nodeClass == UA_NODECLASS_VARIABLETYPE;
-                break;
-            case UA_NODECLASS_VIEW:
-                typeOk = type->nodeClass == UA_NODECLASS_VIEW;
-                break;
-            default:
-                typeOk = UA_FALSE;
-        }
-        if(!typeOk) {
-            UA_LOG_INFO_SESSION(server->config.logger, session,
-                                "AddNodes: Type does not match node class");
-            retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-            goto cleanup;
-        }
+    /* Get the type node */
+    const UA_Node *type = UA_Nodestore_get(server, typeDefinitionId);
+    if(!type) {
+        UA_LOG_INFO_SESSION(server->config.logger, session,
+                            "AddNodes: Node type not found");
+        return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+    }
 
-        /* See if the type has the correct node class. For type-nodes, we know
-         * that type has the same nodeClass from checkParentReference. */
-        if(node->nodeClass == UA_NODECLASS_VARIABLE) {
-            if(((const UA_VariableTypeNode*)type)->isAbstract) {
-                /* Abstract variable is allowed if parent is a children of a base data variable */
-                const UA_NodeId variableTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE);
-                /* A variable may be of an object type which again is below BaseObjectType */
-                const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
-                // TODO handle subtypes of parent reference types
-                if(!isNodeInTree(&server->config.nodestore, parentNodeId, &variableTypes,
-                                 parentReferences, UA_PARENT_REFERENCES_COUNT) &&
-                   !isNodeInTree(&server->config.nodestore, parentNodeId, &objectTypes,
-                                 parentReferences, UA_PARENT_REFERENCES_COUNT)) {
-                    UA_LOG_INFO_SESSION(server->config.logger, session,
-                                        "AddNodes: Type of variable node must "
-                                        "be VariableType and not cannot be abstract");
-                    retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-                    goto cleanup;
-                }
+    UA_Boolean typeOk = UA_FALSE;
+    switch(node->nodeClass) {
+        case UA_NODECLASS_DATATYPE:
+            typeOk = type->nodeClass == UA_NODECLASS_DATATYPE;
+            break;
+        case UA_NODECLASS_METHOD:
+            typeOk = type->nodeClass == UA_NODECLASS_METHOD;
+            break;
+        case UA_NODECLASS_OBJECT:
+            typeOk = type->nodeClass == UA_NODECLASS_OBJECTTYPE;
+            break;
+        case UA_NODECLASS_OBJECTTYPE:
+            typeOk = type->nodeClass == UA_NODECLASS_OBJECTTYPE;
+            break;
+        case UA_NODECLASS_REFERENCETYPE:
+            typeOk = type->nodeClass == UA_NODECLASS_REFERENCETYPE;
+            break;
+        case UA_NODECLASS_VARIABLE:
+            typeOk = type->nodeClass == UA_NODECLASS_VARIABLETYPE;
+            break;
+        case UA_NODECLASS_VARIABLETYPE:
+            typeOk = type->nodeClass == UA_NODECLASS_VARIABLETYPE;
+            break;
+        case UA_NODECLASS_VIEW:
+            typeOk = type->nodeClass == UA_NODECLASS_VIEW;
+            break;
+        default:
+            typeOk = UA_FALSE;
+    }
+    if(!typeOk) {
+        UA_LOG_INFO_SESSION(server->config.logger, session,
+                            "AddNodes: Type does not match node class");
+        retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+        goto cleanup;
+    }
+
+    /* See if the type has the correct node class. For type-nodes, we know
+     * that type has the same nodeClass from checkParentReference. */
+    if(node->nodeClass == UA_NODECLASS_VARIABLE) {
+        if(((const UA_VariableTypeNode*)type)->isAbstract) {
+            /* Abstract variable is allowed if parent is a children of a base data variable */
+            const UA_NodeId variableTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE);
+            /* A variable may be of an object type which again is below BaseObjectType */
+            const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+            // TODO handle subtypes of parent reference types
+            if(!isNodeInTree(&server->config.nodestore, parentNodeId, &variableTypes,
+                             parentReferences, UA_PARENT_REFERENCES_COUNT) &&
+               !isNodeInTree(&server->config.nodestore, parentNodeId, &objectTypes,
+                             parentReferences, UA_PARENT_REFERENCES_COUNT)) {
+                UA_LOG_INFO_SESSION(server->config.logger, session,
+                                    "AddNodes: Type of variable node must "
+                                    "be VariableType and not cannot be abstract");
+                retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+                goto cleanup;
             }
         }
+    }
 
-        if(node->nodeClass == UA_NODECLASS_OBJECT) {
-            if(((const UA_ObjectTypeNode*)type)->isAbstract) {
-                /* Object node created of an abstract ObjectType. Only allowed
-                 * if within BaseObjectType folder */
-                const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
-                // TODO handle subtypes of parent reference types
-                if(!isNodeInTree(&server->config.nodestore, parentNodeId, &objectTypes,
-                                 parentReferences, UA_PARENT_REFERENCES_COUNT)) {
-                    UA_LOG_INFO_SESSION(server->config.logger, session,
-                                        "AddNodes: Type of object node must "
-                                        "be ObjectType and not be abstract");
-                    retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-                    goto cleanup;
-                }
+    if(node->nodeClass == UA_NODECLASS_OBJECT) {
+        if(((const UA_ObjectTypeNode*)type)->isAbstract) {
+            /* Object node created of an abstract ObjectType. Only allowed
+             * if within BaseObjectType folder */
+            const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+            // TODO handle subtypes of parent reference types
+            if(!isNodeInTree(&server->config.nodestore, parentNodeId, &objectTypes,
+                             parentReferences, UA_PARENT_REFERENCES_COUNT)) {
+                UA_LOG_INFO_SESSION(server->config.logger, session,
+                                    "AddNodes: Type of object node must "
+                                    "be ObjectType and not be abstract");
+                retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+                goto cleanup;
             }
         }
     }
 
+ cleanup:
+    UA_Nodestore_release(server, type);
+    return retval;
+}
+
+UA_StatusCode
+AddNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
+                const UA_NodeId *parentNodeId, const UA_NodeId *referenceTypeId,
+                const UA_NodeId *typeDefinitionId) {
+    /* Get the node */
+    const UA_Node *node = UA_Nodestore_get(server, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+
+    resolveAddNodeRefs(server, session, node->nodeClass, parentNodeId,
+                       &referenceTypeId, &typeDefinitionId);
+    UA_StatusCode retval = checkAddNodeRefs(server, session, node, parentNodeId,
+                                            referenceTypeId, typeDefinitionId);
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
     /* Add reference to the parent */
     if(!UA_NodeId_isNull(parentNodeId)) {
-        if(UA_NodeId_isNull(referenceTypeId)) {
-            UA_LOG_INFO_SESSION(server->config.logger, session,
-                                "AddNodes: Reference to parent cannot be null");
-            retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-            goto cleanup;
-        }
-
         retval = addRef(server, session, &node->nodeId, referenceTypeId, parentNodeId, false);
         if(retval != UA_STATUSCODE_GOOD) {
             UA_LOG_INFO_SESSION(server->config.logger, session,
@@ -816,8 +834,7 @@ AddNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
     /* Add a hasTypeDefinition reference */
     if(node->nodeClass == UA_NODECLASS_VARIABLE ||
        node->nodeClass == UA_NODECLASS_OBJECT) {
-        UA_assert(type != NULL); /* see above */
-        retval = addRef(server, session, &node->nodeId, &hasTypeDefinition, &type->nodeId, true);
+        retval = addRef(server, session, &node->nodeId, &hasTypeDefinition, typeDefinitionId, true);
         if(retval != UA_STATUSCODE_GOOD)
             UA_LOG_INFO_SESSION(server->config.logger, session,
                                 "AddNodes: Adding a reference to the type "
@@ -827,16 +844,13 @@ AddNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
 
  cleanup:
     UA_Nodestore_release(server, node);
-    if(type)
-        UA_Nodestore_release(server, type);
     return retval;
 }
 
-/* Create the node and add it to the nodestore. But don't typecheck and add
- * references so far */
-UA_StatusCode
-AddNode_raw(UA_Server *server, UA_Session *session, void *nodeContext,
-            const UA_AddNodesItem *item, UA_NodeId *outNewNodeId) {
+/* Create the node with the attributes of the AddNodesItem */
+static UA_StatusCode
+createNode(UA_Server *server, UA_Session *session, void *nodeContext,
+           const UA_AddNodesItem *item, UA_Node **outNode) {
     /* Do not check access for server */
     if(session != &adminSession && server->config.accessControl.allowAddNode &&
        !server->config.accessControl.allowAddNode(server, &server->config.accessControl,
@@ -882,6 +896,20 @@ AddNode_raw(UA_Server *server, UA_Session *session, void *nodeContext,
         return retval;
     }
 
+    *outNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Create the node and add it to the nodestore. But don't typecheck and add
+ * references so far */
+UA_StatusCode
+AddNode_raw(UA_Server *server, UA_Session *session, void *nodeContext,
+            const UA_AddNodesItem *item, UA_NodeId *outNewNodeId) {
+    UA_Node *node;
+    UA_StatusCode retval = createNode(server, session, nodeContext, item, &node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
     /* Add the node to the nodestore */
     retval = UA_Nodestore_insert(server, node, outNewNodeId);
     if(retval != UA_STATUSCODE_GOOD)
@@ -920,9 +948,11 @@ Operation_addNode_begin(UA_Server *server, UA_Session *session, void *nodeContex
     return retval;
 }
 
-/* Children, references, type-checking, constructors. */
-UA_StatusCode
-AddNode_finish(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId) {
+/* Children, references, type-checking, constructors. The type-check of
+ * variables can be skipped for trusted nodes. */
+static UA_StatusCode
+finishNode(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
+           UA_Boolean typeCheck) {
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
 
     /* Get the node */
@@ -964,8 +994,9 @@ AddNode_finish(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId)
             /* Check if all attributes hold the constraints of the type now. The initial
              * attributes must type-check. The constructor might change the attributes
              * again. Then, the changes are type-checked by the normal write service. */
-            retval = typeCheckVariableNode(server, session, (const UA_VariableNode*)node,
-                                           (const UA_VariableTypeNode*)type);
+            if(typeCheck)
+                retval = typeCheckVariableNode(server, session, (const UA_VariableNode*)node,
+                                               (const UA_VariableTypeNode*)type);
             if(retval != UA_STATUSCODE_GOOD) {
                 UA_LOG_INFO_SESSION(server->config.logger, session,
                                     "AddNodes: Type-checking the variable node "
@@ -1005,6 +1036,11 @@ AddNode_finish(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId)
     return retval;
 }
 
+UA_StatusCode
+AddNode_finish(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId) {
+    return finishNode(server, session, nodeId, true);
+}
+
 static void
 Operation_addNode(UA_Server *server, UA_Session *session, void *nodeContext,
                   const UA_AddNodesItem *item, UA_AddNodesResult *result) {
@@ -1102,6 +1138,259 @@ UA_Server_addNode_finish(UA_Server *server, const UA_NodeId nodeId) {
     return AddNode_finish(server, &adminSession, &nodeId);
 }
 
+/************/
+/* Bulk Add */
+/************/
+
+/* A reference from an existing node back to a new node of the batch. The
+ * back-links are sorted by the hash of the existing node. Then every node is
+ * edited only once for all of its new references. */
+typedef struct {
+    UA_AddReferencesItem ref;
+    UA_UInt32 hash;
+    UA_Boolean done;
+    size_t item; /* Index of the new node in the batch */
+} BulkBackLink;
+
+typedef struct {
+    BulkBackLink *links;
+    size_t linksSize;
+    const UA_NodeId *nodeId;
+} BulkBackLinkRun;
+
+static int
+cmpBackLink(const void *a, const void *b) {
+    UA_UInt32 ha = ((const BulkBackLink*)a)->hash;
+    UA_UInt32 hb = ((const BulkBackLink*)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+static UA_StatusCode
+addBackLinks(UA_Server *server, UA_Session *session,
+             UA_Node *node, const BulkBackLinkRun *run) {
+    for(size_t i = 0; i < run->linksSize; i++) {
+        const UA_AddReferencesItem *ref = &run->links[i].ref;
+        if(!UA_NodeId_equal(&ref->sourceNodeId, run->nodeId))
+            continue;
+        UA_StatusCode retval = UA_Node_addReference(node, ref);
+        if(retval != UA_STATUSCODE_GOOD &&
+           retval != UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED)
+            return retval;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Create the node with the references to its parent and type definition and
+ * add it to the nodestore. The inverse references are returned as back-links
+ * and added later. */
+static UA_StatusCode
+bulkAddNode_raw(UA_Server *server, UA_Session *session, const UA_AddNodesItem *item,
+                size_t itemIndex, BulkBackLink *links, size_t *linksSize,
+                UA_NodeId *outNewNodeId) {
+    UA_Node *node;
+    UA_StatusCode retval = createNode(server, session, NULL, item, &node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    const UA_NodeId *parentNodeId = &item->parentNodeId.nodeId;
+    const UA_NodeId *referenceTypeId = &item->referenceTypeId;
+    const UA_NodeId *typeDefinitionId = &item->typeDefinition.nodeId;
+    resolveAddNodeRefs(server, session, node->nodeClass, parentNodeId,
+                       &referenceTypeId, &typeDefinitionId);
+
+    UA_AddReferencesItem ref;
+    UA_AddReferencesItem_init(&ref);
+    if(!UA_NodeId_isNull(parentNodeId)) {
+        ref.referenceTypeId = *referenceTypeId;
+        ref.isForward = false;
+        ref.targetNodeId.nodeId = *parentNodeId;
+        retval |= UA_Node_addReference(node, &ref);
+    }
+    if(node->nodeClass == UA_NODECLASS_VARIABLE ||
+       node->nodeClass == UA_NODECLASS_OBJECT) {
+        ref.referenceTypeId = hasTypeDefinition;
+        ref.isForward = true;
+        ref.targetNodeId.nodeId = *typeDefinitionId;
+        retval |= UA_Node_addReference(node, &ref);
+    }
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_Nodestore_delete(server, node);
+        return retval;
+    }
+
+    retval = UA_Nodestore_insert(server, node, outNewNodeId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO_SESSION(server->config.logger, session,
+                            "AddNodes: Node could not add the new node "
+                            "to the nodestore with error code %s",
+                            UA_StatusCode_name(retval));
+        return retval;
+    }
+
+    /* The back-links point into the item and the results. They remain valid
+     * until the batch is finished. */
+    if(!UA_NodeId_isNull(parentNodeId)) {
+        BulkBackLink *link = &links[(*linksSize)++];
+        UA_AddReferencesItem_init(&link->ref);
+        link->ref.sourceNodeId = *parentNodeId;
+        link->ref.referenceTypeId = *referenceTypeId;
+        link->ref.isForward = true;
+        link->ref.targetNodeId.nodeId = *outNewNodeId;
+        link->item = itemIndex;
+    }
+    if(node->nodeClass == UA_NODECLASS_VARIABLE ||
+       node->nodeClass == UA_NODECLASS_OBJECT) {
+        BulkBackLink *link = &links[(*linksSize)++];
+        UA_AddReferencesItem_init(&link->ref);
+        link->ref.sourceNodeId = *typeDefinitionId;
+        link->ref.referenceTypeId = hasTypeDefinition;
+        link->ref.isForward = false;
+        link->ref.targetNodeId.nodeId = *outNewNodeId;
+        link->item = itemIndex;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_addNodes_bulk(UA_Server *server, size_t itemsSize,
+                        const UA_AddNodesItem *items, UA_Boolean trusted,
+                        UA_AddNodesResult *results) {
+    if(itemsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_AddNodesResult *res = results;
+    if(!res) {
+        res = (UA_AddNodesResult*)
+            UA_Array_new(itemsSize, &UA_TYPES[UA_TYPES_ADDNODESRESULT]);
+        if(!res)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    } else {
+        for(size_t i = 0; i < itemsSize; i++)
+            UA_AddNodesResult_init(&res[i]);
+    }
+
+    /* Every node has at most two back-links (parent and type definition) */
+    BulkBackLink *links = (BulkBackLink*)UA_malloc(sizeof(BulkBackLink) * itemsSize * 2);
+    if(!links) {
+        if(!results)
+            UA_Array_delete(res, itemsSize, &UA_TYPES[UA_TYPES_ADDNODESRESULT]);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* 1. Create and insert all nodes with their own references */
+    size_t linksSize = 0;
+    for(size_t i = 0; i < itemsSize; i++)
+        res[i].statusCode = bulkAddNode_raw(server, &adminSession, &items[i], i, links,
+                                            &linksSize, &res[i].addedNodeId);
+
+    /* 2. Add the back-links. Every node is edited once. */
+    UA_Boolean subtypes = false;
+    for(size_t i = 0; i < linksSize; i++) {
+        links[i].hash = UA_NodeId_hash(&links[i].ref.sourceNodeId);
+        links[i].done = false;
+        if(UA_NodeId_equal(&links[i].ref.referenceTypeId, &subtypeId))
+            subtypes = true;
+    }
+    qsort(links, linksSize, sizeof(BulkBackLink), cmpBackLink);
+    for(size_t start = 0, end = 0; start < linksSize; start = end) {
+        /* The run of back-links with the same hash */
+        while(end < linksSize && links[end].hash == links[start].hash)
+            end++;
+        BulkBackLinkRun run = {&links[start], end - start, NULL};
+        for(size_t i = start; i < end; i++) {
+            if(links[i].done)
+                continue;
+            run.nodeId = &links[i].ref.sourceNodeId;
+            UA_StatusCode retval =
+                UA_Server_editNode(server, &adminSession, run.nodeId,
+                                   (UA_EditNodeCallback)addBackLinks, &run);
+            for(size_t j = i; j < end; j++) {
+                if(!UA_NodeId_equal(&links[j].ref.sourceNodeId, run.nodeId))
+                    continue;
+                links[j].done = true;
+                if(retval != UA_STATUSCODE_GOOD &&
+                   res[links[j].item].statusCode == UA_STATUSCODE_GOOD)
+                    res[links[j].item].statusCode = retval;
+            }
+        }
+    }
+    UA_free(links);
+    UA_Server_invalidatePathCache(server);
+    if(subtypes)
+        UA_Server_invalidateTypeCache(server);
+
+    /* 3. Check the references of untrusted nodes */
+    UA_Boolean failed = false;
+    for(size_t i = 0; i < itemsSize; i++) {
+        if(UA_NodeId_isNull(&res[i].addedNodeId))
+            continue;
+        if(res[i].statusCode == UA_STATUSCODE_GOOD && !trusted) {
+            const UA_NodeId *referenceTypeId = &items[i].referenceTypeId;
+            const UA_NodeId *typeDefinitionId = &items[i].typeDefinition.nodeId;
+            resolveAddNodeRefs(server, &adminSession, items[i].nodeClass,
+                               &items[i].parentNodeId.nodeId,
+                               &referenceTypeId, &typeDefinitionId);
+            const UA_Node *node = UA_Nodestore_get(server, &res[i].addedNodeId);
+            if(node) {
+                res[i].statusCode =
+                    checkAddNodeRefs(server, &adminSession, node, &items[i].parentNodeId.nodeId,
+                                     referenceTypeId, typeDefinitionId);
+                UA_Nodestore_release(server, node);
+            } else {
+                res[i].statusCode = UA_STATUSCODE_BADNODEIDUNKNOWN;
+            }
+        }
+        if(res[i].statusCode != UA_STATUSCODE_GOOD)
+            failed = true;
+    }
+
+    /* Nodes below a failed node of the batch fail as well. One pass suffices
+     * for ordered items. Repeat until nothing changes in case they are not. */
+    for(UA_Boolean changed = failed; changed;) {
+        changed = false;
+        for(size_t i = 0; i < itemsSize; i++) {
+            if(res[i].statusCode == UA_STATUSCODE_GOOD ||
+               UA_NodeId_isNull(&res[i].addedNodeId))
+                continue;
+            for(size_t j = 0; j < itemsSize; j++) {
+                if(res[j].statusCode != UA_STATUSCODE_GOOD ||
+                   !UA_NodeId_equal(&items[j].parentNodeId.nodeId, &res[i].addedNodeId))
+                    continue;
+                res[j].statusCode = UA_STATUSCODE_BADPARENTNODEIDINVALID;
+                changed = true;
+            }
+        }
+    }
+
+    /* Remove the nodes that could not be linked */
+    for(size_t i = 0; i < itemsSize && failed; i++) {
+        if(res[i].statusCode == UA_STATUSCODE_GOOD ||
+           UA_NodeId_isNull(&res[i].addedNodeId))
+            continue;
+        UA_Server_deleteNode(server, res[i].addedNodeId, true);
+        UA_NodeId_deleteMembers(&res[i].addedNodeId);
+    }
+
+    /* 4. Instantiate and construct in reverse order. As in the code generated
+     * by the nodeset compiler. */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = itemsSize; i > 0; i--) {
+        UA_AddNodesResult *r = &res[i-1];
+        if(r->statusCode == UA_STATUSCODE_GOOD) {
+            r->statusCode = finishNode(server, &adminSession, &r->addedNodeId, !trusted);
+            if(r->statusCode != UA_STATUSCODE_GOOD)
+                UA_NodeId_deleteMembers(&r->addedNodeId);
+        }
+        /* Iterating backwards, the last bad status is that of the first item */
+        if(r->statusCode != UA_STATUSCODE_GOOD)
+            retval = r->statusCode;
+    }
+
+    if(!results)
+        UA_Array_delete(res, itemsSize, &UA_TYPES[UA_TYPES_ADDNODESRESULT]);
+    return retval;
+}
+
 /****************/
 /* Delete Nodes */
 /****************/
@@ -1213,7 +1502,13 @@ removeDeconstructedNode(UA_Server *server, UA_Session *session,
         removeIncomingReferences(server, session, node);
 
     /* Remove the node in the nodestore */
+    UA_NodeClass nodeClass = node->nodeClass;
     UA_Nodestore_remove(server, &node->nodeId);
+
+    /* The node was part of a type hierarchy */
+    if(nodeClass == UA_NODECLASS_REFERENCETYPE || nodeClass == UA_NODECLASS_DATATYPE ||
+       nodeClass == UA_NODECLASS_OBJECTTYPE || nodeClass == UA_NODECLASS_VARIABLETYPE)
+        UA_Server_invalidateTypeCache(server);
 }
 
 static void
@@ -1295,6 +1590,15 @@ deleteOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
     return UA_Node_deleteReference(node, item);
 }
 
+/* Subtype relations and browse paths are cached. Invalidate after the
+ * references changed. */
+static void
+invalidateReferenceCaches(UA_Server *server, const UA_NodeId *referenceTypeId) {
+    UA_Server_invalidatePathCache(server);
+    if(UA_NodeId_equal(referenceTypeId, &subtypeId))
+        UA_Server_invalidateTypeCache(server);
+}
+
 static void
 Operation_addReference(UA_Server *server, UA_Session *session, void *context,
                        const UA_AddReferencesItem *item, UA_StatusCode *retval) {
@@ -1352,6 +1656,8 @@ Operation_addReference(UA_Server *server, UA_Session *session, void *context,
                            (UA_EditNodeCallback)deleteOneWayReference, &deleteItem);
     }
 
+    invalidateReferenceCaches(server, &item->referenceTypeId);
+
     /* Calculate common duplicate reference not allowed result and set bad result
      * if BOTH directions already existed */
     if(firstExisted && secondExisted)
@@ -1415,6 +1721,7 @@ Operation_deleteReference(UA_Server *server, UA_Session *session, void *context,
                                  (UA_DeleteReferencesItem *)(uintptr_t)item);
     if(*retval != UA_STATUSCODE_GOOD)
         return;
+    invalidateReferenceCaches(server, &item->referenceTypeId);
 
     if(!item->deleteBidirectional || item->targetNodeId.serverIndex != 0)
         return;
@@ -1428,6 +1735,7 @@ Operation_deleteReference(UA_Server *server, UA_Session *session, void *context,
     *retval = UA_Server_editNode(server, session, &secondItem.sourceNodeId,
                                  (UA_EditNodeCallback)deleteOneWayReference,
                                  &secondItem);
+    invalidateReferenceCaches(server, &item->referenceTypeId);
 }
 
 void
@@ -18,6 +18,7 @@
 
 #include "ua_server_internal.h"
 #include "ua_services.h"
+#include "ua_types_encoding_binary.h"
 
 /**********/
 /* Browse */
@@ -67,9 +68,7 @@ relevantReference(UA_Server *server, UA_Boolean includeSubtypes,
                   const UA_NodeId *rootRef, const UA_NodeId *testRef) {
     if(!includeSubtypes)
         return UA_NodeId_equal(rootRef, testRef);
-
-    const UA_NodeId hasSubType = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
-    return isNodeInTree(&server->config.nodestore, testRef, rootRef, &hasSubType, 1);
+    return isSubtypeOf(server, testRef, rootRef);
 }
 
 static UA_Boolean
@@ -626,9 +625,8 @@ walkBrowsePath(UA_Server *server, UA_Session *session, const UA_BrowsePath *path
 }
 
 static void
-Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
-                                       UA_UInt32 *nodeClassMask, const UA_BrowsePath *path,
-                                       UA_BrowsePathResult *result) {
+translateBrowsePath(UA_Server *server, UA_Session *session, UA_UInt32 *nodeClassMask,
+                    const UA_BrowsePath *path, UA_BrowsePathResult *result) {
     if(path->relativePath.elementsSize <= 0) {
         result->statusCode = UA_STATUSCODE_BADNOTHINGTODO;
         return;
@@ -707,6 +705,167 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
     }
 }
 
+/* The results of TranslateBrowsePath are cached with the encoded BrowsePath
+ * and NodeClass mask as the key. A slot of the cache holds one entry. The
+ * entries are never changed after they are added. Changes to the address space
+ * (references, BrowseNames, removed nodes) increase the generation of the
+ * cache. Entries of an older generation are outdated. */
+struct UA_PathCacheEntry {
+    size_t generation;
+    UA_UInt32 hash;
+    UA_ByteString key; /* Points into the same allocation */
+    UA_BrowsePathResult result;
+};
+
+#define UA_PATHCACHE_KEYBUFSIZE 256
+
+static UA_UInt32
+pathCacheHash(const UA_ByteString *key) {
+    /* FNV-1a */
+    UA_UInt32 hash = 2166136261u;
+    for(size_t i = 0; i < key->length; ++i) {
+        hash ^= key->data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Encode the key into the buffer if it fits. Otherwise, the key is
+ * allocated. */
+static UA_StatusCode
+encodePathCacheKey(const UA_BrowsePath *path, UA_UInt32 nodeClassMask,
+                   UA_Byte *buf, UA_ByteString *key) {
+    size_t keySize = UA_calcSizeBinary(path, &UA_TYPES[UA_TYPES_BROWSEPATH]) +
+        sizeof(UA_UInt32);
+    key->length = keySize;
+    key->data = buf;
+    if(keySize > UA_PATHCACHE_KEYBUFSIZE) {
+        key->data = (UA_Byte*)UA_malloc(keySize);
+        if(!key->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_Byte *pos = key->data;
+    const UA_Byte *end = &key->data[keySize];
+    UA_StatusCode retval = UA_encodeBinary(path, &UA_TYPES[UA_TYPES_BROWSEPATH],
+                                           &pos, &end, NULL, NULL);
+    retval |= UA_encodeBinary(&nodeClassMask, &UA_TYPES[UA_TYPES_UINT32],
+                              &pos, &end, NULL, NULL);
+    if(retval != UA_STATUSCODE_GOOD && key->data != buf)
+        UA_free(key->data);
+    return retval;
+}
+
+static void
+deletePathCacheEntry(UA_Server *server, struct UA_PathCacheEntry *entry) {
+    UA_BrowsePathResult_deleteMembers(&entry->result);
+    UA_free(entry);
+}
+
+static UA_Boolean
+lookupPathCache(UA_Server *server, const UA_ByteString *key, UA_UInt32 hash,
+                UA_BrowsePathResult *result) {
+    struct UA_PathCacheEntry *entry =
+        server->pathCache[hash & (server->pathCacheSize - 1)];
+    if(!entry || entry->generation != server->pathCacheGeneration ||
+       entry->hash != hash || !UA_ByteString_equal(&entry->key, key))
+        return false;
+    /* The cached status is kept. Also BadNoMatch is cached. */
+    UA_StatusCode retval = UA_BrowsePathResult_copy(&entry->result, result);
+    if(retval != UA_STATUSCODE_GOOD)
+        result->statusCode = retval;
+    return true;
+}
+
+static void
+storePathCache(UA_Server *server, const UA_ByteString *key, UA_UInt32 hash,
+               size_t generation, const UA_BrowsePathResult *result) {
+    struct UA_PathCacheEntry *entry = (struct UA_PathCacheEntry*)
+        UA_malloc(sizeof(struct UA_PathCacheEntry) + key->length);
+    if(!entry)
+        return;
+    entry->generation = generation;
+    entry->hash = hash;
+    entry->key.length = key->length;
+    entry->key.data = (UA_Byte*)entry + sizeof(struct UA_PathCacheEntry);
+    memcpy(entry->key.data, key->data, key->length);
+    if(UA_BrowsePathResult_copy(result, &entry->result) != UA_STATUSCODE_GOOD) {
+        UA_free(entry);
+        return;
+    }
+
+    /* Replace the entry in the slot. Concurrent lookups might still use the
+     * old entry. */
+    struct UA_PathCacheEntry *old = (struct UA_PathCacheEntry*)
+        UA_atomic_xchg((void * volatile *)&server->pathCache[hash & (server->pathCacheSize - 1)],
+                       entry);
+    if(!old)
+        return;
+#ifdef UA_ENABLE_MULTITHREADING
+    UA_Server_delayedCallback(server, (UA_ServerCallback)deletePathCacheEntry, old);
+#else
+    deletePathCacheEntry(server, old);
+#endif
+}
+
+void
+UA_Server_invalidatePathCache(UA_Server *server) {
+    UA_atomic_addSize(&server->pathCacheGeneration, 1);
+}
+
+void
+UA_Server_deletePathCache(UA_Server *server) {
+    for(size_t i = 0; i < server->pathCacheSize; ++i) {
+        if(server->pathCache[i])
+            deletePathCacheEntry(server, server->pathCache[i]);
+    }
+    UA_free((void*)(uintptr_t)server->pathCache);
+    server->pathCache = NULL;
+    server->pathCacheSize = 0;
+}
+
+void
+UA_Server_getPathCacheStatistics(UA_Server *server, size_t *hits, size_t *misses) {
+    *hits = server->pathCacheHits;
+    *misses = server->pathCacheMisses;
+}
+
+static void
+Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
+                                       UA_UInt32 *nodeClassMask, const UA_BrowsePath *path,
+                                       UA_BrowsePathResult *result) {
+    if(server->pathCacheSize == 0) {
+        translateBrowsePath(server, session, nodeClassMask, path, result);
+        return;
+    }
+
+    UA_Byte buf[UA_PATHCACHE_KEYBUFSIZE];
+    UA_ByteString key;
+    if(encodePathCacheKey(path, *nodeClassMask, buf, &key) != UA_STATUSCODE_GOOD) {
+        translateBrowsePath(server, session, nodeClassMask, path, result);
+        return;
+    }
+
+    UA_UInt32 hash = pathCacheHash(&key);
+    if(lookupPathCache(server, &key, hash, result)) {
+        UA_atomic_addSize(&server->pathCacheHits, 1);
+        goto cleanup;
+    }
+
+    /* Walk the path. The result is outdated if the address space changes
+     * during the walk. Only cache results that depend on the address space
+     * as it is and not on an unknown starting node. */
+    UA_atomic_addSize(&server->pathCacheMisses, 1);
+    size_t generation = server->pathCacheGeneration;
+    translateBrowsePath(server, session, nodeClassMask, path, result);
+    if(result->statusCode == UA_STATUSCODE_GOOD ||
+       result->statusCode == UA_STATUSCODE_BADNOMATCH)
+        storePathCache(server, &key, hash, generation, result);
+
+ cleanup:
+    if(key.data != buf)
+        UA_free(key.data);
+}
+
 UA_BrowsePathResult
 UA_Server_translateBrowsePathToNodeIds(UA_Server *server,
                                        const UA_BrowsePath *browsePath) {
@@ -769,13 +928,294 @@ UA_Server_browseSimplifiedBrowsePath(UA_Server *server, const UA_NodeId origin,
 /* Register */
 /************/
 
+/* Registered nodes are kept in a table of the session. The handle returned to
+ * the client is a numeric NodeId in namespace zero with the most significant
+ * bit set. OPC UA does not define NodeIds in this range. The lower 16 bits hold
+ * the position of the entry, the next 15 bits its generation. A handle resolves
+ * only for the session that registered it and only until the entry is reused.
+ *
+ * The entry holds the node if the nodestore implements retainNode. Read and
+ * Write take the held node without a lookup in the nodestore. When the node
+ * was replaced or removed, it is looked up again by the registered NodeId and
+ * the entry is replaced. Handles in the requests of the other services are
+ * replaced by the registered NodeIds when the request is received. So the
+ * services, the nodestore and stored references never see them.
+ *
+ * The entries and the table are replaced atomically. Replaced entries and
+ * tables are freed in a delayed callback, as concurrent requests of the
+ * session may still use them. */
+
+#define UA_REGISTEREDNODES_INITIALSIZE 8
+#define UA_REGISTEREDNODES_MAXSIZE 0x10000
+#define UA_REGISTEREDNODES_HANDLE 0x80000000
+
+static UA_NodeId
+registeredNodeHandle(size_t index, UA_UInt16 generation) {
+    return UA_NODEID_NUMERIC(0, UA_REGISTEREDNODES_HANDLE |
+                             ((UA_UInt32)generation << 16) | (UA_UInt32)index);
+}
+
+static UA_RegisteredNode *
+getRegisteredNode(const UA_Session *session, const UA_NodeId *handle) {
+    if(handle->namespaceIndex != 0 || handle->identifierType != UA_NODEIDTYPE_NUMERIC ||
+       !(handle->identifier.numeric & UA_REGISTEREDNODES_HANDLE))
+        return NULL;
+    size_t index = handle->identifier.numeric & 0xffff;
+    UA_UInt16 generation = (UA_UInt16)((handle->identifier.numeric >> 16) & 0x7fff);
+    /* The size grows only after the larger table is set */
+    if(index >= session->registeredNodesSize)
+        return NULL;
+    UA_RegisteredNode *rn = session->registeredNodes[index];
+    if(!rn || rn->generation != generation)
+        return NULL;
+    return rn;
+}
+
+static void
+deleteRegisteredNode(UA_Server *server, UA_RegisteredNode *rn) {
+    if(rn->node)
+        UA_Nodestore_release(server, rn->node);
+    UA_NodeId_deleteMembers(&rn->nodeId);
+    UA_free(rn);
+}
+
+static UA_RegisteredNode *
+newRegisteredNode(UA_Server *server, const UA_NodeId *nodeId,
+                  UA_UInt16 generation, const UA_Node *node) {
+    UA_RegisteredNode *rn = (UA_RegisteredNode*)UA_malloc(sizeof(UA_RegisteredNode));
+    if(!rn)
+        return NULL;
+    if(UA_NodeId_copy(nodeId, &rn->nodeId) != UA_STATUSCODE_GOOD) {
+        UA_free(rn);
+        return NULL;
+    }
+    rn->generation = generation;
+
+    /* Hold the node if the nodestore supports it */
+    rn->node = NULL;
+    if(node && server->config.nodestore.retainNode)
+        rn->node = server->config.nodestore.retainNode(server->config.nodestore.context, node);
+    return rn;
+}
+
+/* Concurrent requests of the session may still use the entry */
+static void
+retireRegisteredNode(UA_Server *server, UA_RegisteredNode *rn) {
+    if(UA_Server_delayedCallback(server, (UA_ServerCallback)deleteRegisteredNode,
+                                 rn) != UA_STATUSCODE_GOOD)
+        deleteRegisteredNode(server, rn);
+}
+
+const UA_Node *
+UA_Server_getNodeWithSession(UA_Server *server, UA_Session *session,
+                             const UA_NodeId *nodeId) {
+    UA_RegisteredNode *rn = NULL;
+    if(session && session->registeredNodesCount > 0)
+        rn = getRegisteredNode(session, nodeId);
+    if(!rn)
+        return UA_Nodestore_get(server, nodeId);
+
+    /* Take the held node if it is still current */
+    if(rn->node) {
+        const UA_Node *node =
+            server->config.nodestore.retainNode(server->config.nodestore.context, rn->node);
+        if(node)
+            return node;
+    }
+
+    /* Look up the node and hold the current version in a new entry */
+    const UA_Node *node = UA_Nodestore_get(server, &rn->nodeId);
+    if(!node || !server->config.nodestore.retainNode)
+        return node;
+    UA_RegisteredNode *newRn = newRegisteredNode(server, &rn->nodeId, rn->generation, node);
+    if(!newRn)
+        return node;
+    size_t index = (size_t)(nodeId->identifier.numeric & 0xffff);
+    if(UA_atomic_cmpxchg((void * volatile *)&session->registeredNodes[index],
+                         rn, newRn) == rn)
+        retireRegisteredNode(server, rn);
+    else
+        deleteRegisteredNode(server, newRn); /* The entry changed concurrently */
+    return node;
+}
+
+const UA_NodeId *
+UA_Server_getRegisteredNodeId(UA_Server *server, UA_Session *session,
+                              const UA_NodeId *nodeId) {
+    if(!session || session->registeredNodesCount == 0)
+        return nodeId;
+    const UA_RegisteredNode *rn = getRegisteredNode(session, nodeId);
+    return rn ? &rn->nodeId : nodeId;
+}
+
+/* Grow the table up to the limit. Returns false if the table is full. */
+static UA_Boolean
+growRegisteredNodes(UA_Server *server, UA_Session *session) {
+    size_t size = session->registeredNodesSize;
+    size_t maxSize = server->config.maxRegisteredNodes;
+    if(maxSize > UA_REGISTEREDNODES_MAXSIZE)
+        maxSize = UA_REGISTEREDNODES_MAXSIZE;
+    size_t newSize = size * 2;
+    if(newSize == 0)
+        newSize = UA_REGISTEREDNODES_INITIALSIZE;
+    if(newSize > maxSize)
+        newSize = maxSize;
+    if(newSize <= size)
+        return false;
+    UA_RegisteredNode **rns = (UA_RegisteredNode**)
+        UA_calloc(newSize, sizeof(UA_RegisteredNode*));
+    if(!rns)
+        return false;
+    if(size > 0)
+        memcpy(rns, session->registeredNodes, size * sizeof(UA_RegisteredNode*));
+
+    /* Set the table before the size. Concurrent lookups check the size first. */
+    UA_RegisteredNode **old = (UA_RegisteredNode**)
+        UA_atomic_xchg((void * volatile *)&session->registeredNodes, rns);
+    UA_atomic_sync();
+    session->registeredNodesSize = newSize;
+    if(old)
+        UA_Server_delayedFree(server, old);
+    return true;
+}
+
+/* Returns the NodeId unchanged if no handle can be created */
+static UA_StatusCode
+registerNode(UA_Server *server, UA_Session *session,
+             const UA_NodeId *nodeId, UA_NodeId *handle) {
+    /* Local access uses the NodeIds directly */
+    if(session == &adminSession || UA_NodeId_isNull(nodeId))
+        return UA_NodeId_copy(nodeId, handle);
+
+    /* Take an unused entry or grow the table */
+    size_t index = 0;
+    if(session->registeredNodesCount < session->registeredNodesSize) {
+        while(session->registeredNodes[index])
+            ++index;
+    } else {
+        index = session->registeredNodesSize;
+        if(!growRegisteredNodes(server, session))
+            return UA_NodeId_copy(nodeId, handle);
+    }
+
+    /* Unknown nodes can be registered. They are looked up on access. */
+    session->lastRegisteredNodeGeneration =
+        (UA_UInt16)((session->lastRegisteredNodeGeneration + 1) & 0x7fff);
+    const UA_Node *node = UA_Nodestore_get(server, nodeId);
+    UA_RegisteredNode *rn =
+        newRegisteredNode(server, nodeId, session->lastRegisteredNodeGeneration, node);
+    if(node)
+        UA_Nodestore_release(server, node);
+    if(!rn)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    session->registeredNodes[index] = rn;
+    ++session->registeredNodesCount;
+    *handle = registeredNodeHandle(index, rn->generation);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+unregisterNode(UA_Server *server, UA_Session *session, const UA_NodeId *handle) {
+    UA_RegisteredNode *rn = getRegisteredNode(session, handle);
+    if(!rn)
+        return;
+    size_t index = handle->identifier.numeric & 0xffff;
+    if(UA_atomic_cmpxchg((void * volatile *)&session->registeredNodes[index],
+                         rn, NULL) != rn)
+        return;
+    --session->registeredNodesCount;
+    retireRegisteredNode(server, rn);
+}
+
+void
+UA_Server_deleteRegisteredNodes(UA_Server *server, UA_Session *session) {
+    for(size_t i = 0; i < session->registeredNodesSize; ++i) {
+        if(session->registeredNodes[i])
+            deleteRegisteredNode(server, session->registeredNodes[i]);
+    }
+    UA_free(session->registeredNodes);
+    session->registeredNodes = NULL;
+    session->registeredNodesSize = 0;
+    session->registeredNodesCount = 0;
+}
+
+static void
+resolveRegisteredNode(UA_Session *session, UA_NodeId *nodeId) {
+    const UA_RegisteredNode *rn = getRegisteredNode(session, nodeId);
+    if(rn)
+        *nodeId = rn->nodeId;
+}
+
+void
+UA_Server_resolveRegisteredNodes(UA_Server *server, UA_Session *session,
+                                 const UA_DataType *requestType, void *request) {
+    if(session->registeredNodesCount == 0)
+        return;
+
+    /* Read and Write take the held nodes directly */
+    if(requestType == &UA_TYPES[UA_TYPES_BROWSEREQUEST]) {
+        UA_BrowseRequest *req = (UA_BrowseRequest*)request;
+        for(size_t i = 0; i < req->nodesToBrowseSize; ++i)
+            resolveRegisteredNode(session, &req->nodesToBrowse[i].nodeId);
+    } else if(requestType == &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST]) {
+        UA_TranslateBrowsePathsToNodeIdsRequest *req =
+            (UA_TranslateBrowsePathsToNodeIdsRequest*)request;
+        for(size_t i = 0; i < req->browsePathsSize; ++i)
+            resolveRegisteredNode(session, &req->browsePaths[i].startingNode);
+    } else if(requestType == &UA_TYPES[UA_TYPES_REGISTERNODESREQUEST]) {
+        UA_RegisterNodesRequest *req = (UA_RegisterNodesRequest*)request;
+        for(size_t i = 0; i < req->nodesToRegisterSize; ++i)
+            resolveRegisteredNode(session, &req->nodesToRegister[i]);
+    }
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    else if(requestType == &UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSREQUEST]) {
+        UA_CreateMonitoredItemsRequest *req = (UA_CreateMonitoredItemsRequest*)request;
+        for(size_t i = 0; i < req->itemsToCreateSize; ++i)
+            resolveRegisteredNode(session, &req->itemsToCreate[i].itemToMonitor.nodeId);
+    }
+#endif
+#ifdef UA_ENABLE_METHODCALLS
+    else if(requestType == &UA_TYPES[UA_TYPES_CALLREQUEST]) {
+        UA_CallRequest *req = (UA_CallRequest*)request;
+        for(size_t i = 0; i < req->methodsToCallSize; ++i) {
+            resolveRegisteredNode(session, &req->methodsToCall[i].objectId);
+            resolveRegisteredNode(session, &req->methodsToCall[i].methodId);
+        }
+    }
+#endif
+#ifdef UA_ENABLE_NODEMANAGEMENT
+    else if(requestType == &UA_TYPES[UA_TYPES_ADDNODESREQUEST]) {
+        UA_AddNodesRequest *req = (UA_AddNodesRequest*)request;
+        for(size_t i = 0; i < req->nodesToAddSize; ++i) {
+            resolveRegisteredNode(session, &req->nodesToAdd[i].parentNodeId.nodeId);
+            resolveRegisteredNode(session, &req->nodesToAdd[i].typeDefinition.nodeId);
+        }
+    } else if(requestType == &UA_TYPES[UA_TYPES_ADDREFERENCESREQUEST]) {
+        UA_AddReferencesRequest *req = (UA_AddReferencesRequest*)request;
+        for(size_t i = 0; i < req->referencesToAddSize; ++i) {
+            resolveRegisteredNode(session, &req->referencesToAdd[i].sourceNodeId);
+            resolveRegisteredNode(session, &req->referencesToAdd[i].targetNodeId.nodeId);
+        }
+    } else if(requestType == &UA_TYPES[UA_TYPES_DELETENODESREQUEST]) {
+        UA_DeleteNodesRequest *req = (UA_DeleteNodesRequest*)request;
+        for(size_t i = 0; i < req->nodesToDeleteSize; ++i)
+            resolveRegisteredNode(session, &req->nodesToDelete[i].nodeId);
+    } else if(requestType == &UA_TYPES[UA_TYPES_DELETEREFERENCESREQUEST]) {
+        UA_DeleteReferencesRequest *req = (UA_DeleteReferencesRequest*)request;
+        for(size_t i = 0; i < req->referencesToDeleteSize; ++i) {
+            resolveRegisteredNode(session, &req->referencesToDelete[i].sourceNodeId);
+            resolveRegisteredNode(session, &req->referencesToDelete[i].targetNodeId.nodeId);
+        }
+    }
+#endif
+}
+
 void Service_RegisterNodes(UA_Server *server, UA_Session *session,
                            const UA_RegisterNodesRequest *request,
                            UA_RegisterNodesResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logger, session,
                          "Processing RegisterNodesRequest");
 
-    //TODO: hang the nodeids to the session if really needed
     if(request->nodesToRegisterSize == 0) {
         response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
         return;
@@ -787,11 +1227,29 @@ void Service_RegisterNodes(UA_Server *server, UA_Session *session,
         return;
     }
 
-    response->responseHeader.serviceResult =
-        UA_Array_copy(request->nodesToRegister, request->nodesToRegisterSize,
-                      (void**)&response->registeredNodeIds, &UA_TYPES[UA_TYPES_NODEID]);
-    if(response->responseHeader.serviceResult == UA_STATUSCODE_GOOD)
-        response->registeredNodeIdsSize = request->nodesToRegisterSize;
+    response->registeredNodeIds = (UA_NodeId*)
+        UA_Array_new(request->nodesToRegisterSize, &UA_TYPES[UA_TYPES_NODEID]);
+    if(!response->registeredNodeIds) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADOUTOFMEMORY;
+        return;
+    }
+    response->registeredNodeIdsSize = request->nodesToRegisterSize;
+
+    for(size_t i = 0; i < request->nodesToRegisterSize; ++i) {
+        UA_StatusCode retval = registerNode(server, session, &request->nodesToRegister[i],
+                                            &response->registeredNodeIds[i]);
+        if(retval == UA_STATUSCODE_GOOD)
+            continue;
+        /* Roll back */
+        for(size_t j = 0; j < i; ++j)
+            unregisterNode(server, session, &response->registeredNodeIds[j]);
+        UA_Array_delete(response->registeredNodeIds, response->registeredNodeIdsSize,
+                        &UA_TYPES[UA_TYPES_NODEID]);
+        response->registeredNodeIds = NULL;
+        response->registeredNodeIdsSize = 0;
+        response->responseHeader.serviceResult = retval;
+        return;
+    }
 }
 
 void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
@@ -800,7 +1258,6 @@ void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
     UA_LOG_DEBUG_SESSION(server->config.logger, session,
                          "Processing UnRegisterNodesRequest");
 
-    //TODO: remove the nodeids from the session if really needed
     if(request->nodesToUnregisterSize == 0)
         response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
 
@@ -809,4 +1266,7 @@ void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
         response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
         return;
     }
+
+    for(size_t i = 0; i < request->nodesToUnregisterSize; ++i)
+        unregisterNode(server, session, &request->nodesToUnregister[i]);
 }
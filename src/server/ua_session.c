@@ -34,6 +34,10 @@ UA_Session adminSession = {
     {0, NULL},
     UA_MAXCONTINUATIONPOINTS, /* .availableContinuationPoints */
     {NULL}, /* .continuationPoints */
+    NULL, /* .registeredNodes */
+    0, /* .registeredNodesSize */
+    0, /* .registeredNodesCount */
+    0, /* .lastRegisteredNodeGeneration */
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     0, /* .lastSubscriptionId */
     0, /* .lastSeenSubscriptionId */
@@ -66,6 +70,7 @@ void UA_Session_deleteMembersCleanup(UA_Session *session, UA_Server* server) {
         UA_BrowseDescription_deleteMembers(&cp->browseDescription);
         UA_free(cp);
     }
+    UA_Server_deleteRegisteredNodes(server, session);
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_Subscription *sub, *tempsub;
@@ -14,6 +14,7 @@ extern "C" {
 
 #include "ua_securechannel.h"
 #include "ua_util.h"
+#include "ua_plugin_nodestore.h"
 
 #define UA_MAXCONTINUATIONPOINTS 5
 
@@ -39,6 +40,18 @@ typedef struct UA_PublishResponseEntry {
 } UA_PublishResponseEntry;
 #endif
 
+/* A node registered with the RegisterNodes service. The handle returned to
+ * the client encodes the position of the entry in the table of the session and
+ * its generation. So the handle no longer resolves once the entry is reused.
+ * The entry holds the node if the nodestore supports it (see retainNode).
+ * Entries are immutable. They are replaced when the held node is outdated and
+ * freed in a delayed callback. */
+typedef struct {
+    UA_NodeId nodeId;
+    const UA_Node *node; /* Held node or NULL */
+    UA_UInt16 generation;
+} UA_RegisteredNode;
+
 typedef struct {
     UA_SessionHeader  header;
     UA_ApplicationDescription clientDescription;
@@ -53,6 +66,10 @@ typedef struct {
     UA_ByteString     serverNonce;
     UA_UInt16 availableContinuationPoints;
     LIST_HEAD(ContinuationPointList, ContinuationPointEntry) continuationPoints;
+    UA_RegisteredNode **registeredNodes; /* NULL for unused entries */
+    size_t            registeredNodesSize;
+    size_t            registeredNodesCount; /* Entries in use */
+    UA_UInt16         lastRegisteredNodeGeneration;
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_UInt32 lastSubscriptionId;
     UA_UInt32 lastSeenSubscriptionId;
@@ -12,9 +12,14 @@
 #include "ua_session_manager.h"
 #include "ua_server_internal.h"
 
+#define UA_SESSIONMANAGER_MININDEXSIZE 16
+
 UA_StatusCode
 UA_SessionManager_init(UA_SessionManager *sm, UA_Server *server) {
     LIST_INIT(&sm->sessions);
+    sm->tokenIndex = NULL;
+    sm->idIndex = NULL;
+    sm->indexSize = 0;
     sm->currentSessionCount = 0;
     sm->server = server;
     return UA_STATUSCODE_GOOD;
@@ -27,6 +32,82 @@ void UA_SessionManager_deleteMembers(UA_SessionManager *sm) {
         UA_Session_deleteMembersCleanup(&current->session, sm->server);
         UA_free(current);
     }
+    UA_free(sm->tokenIndex);
+    UA_free(sm->idIndex);
+    sm->tokenIndex = NULL;
+    sm->idIndex = NULL;
+    sm->indexSize = 0;
+}
+
+static void
+indexSession(UA_SessionManager *sm, session_list_entry *sentry) {
+    size_t mask = sm->indexSize - 1;
+    LIST_INSERT_HEAD(&sm->tokenIndex[sentry->tokenHash & mask], sentry, tokenPointers);
+    LIST_INSERT_HEAD(&sm->idIndex[sentry->idHash & mask], sentry, idPointers);
+}
+
+/* Allocate the buckets for at least the given number of sessions and rehash
+ * all sessions. The current index is kept if the allocation fails. */
+static UA_StatusCode
+resizeIndex(UA_SessionManager *sm, size_t minSize) {
+    size_t newSize = UA_SESSIONMANAGER_MININDEXSIZE;
+    while(newSize < minSize)
+        newSize <<= 1;
+    if(newSize <= sm->indexSize)
+        return UA_STATUSCODE_GOOD;
+
+    struct session_list *tokenIndex = (struct session_list*)
+        UA_malloc(sizeof(struct session_list) * newSize);
+    struct session_list *idIndex = (struct session_list*)
+        UA_malloc(sizeof(struct session_list) * newSize);
+    if(!tokenIndex || !idIndex) {
+        UA_free(tokenIndex);
+        UA_free(idIndex);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    for(size_t i = 0; i < newSize; i++) {
+        LIST_INIT(&tokenIndex[i]);
+        LIST_INIT(&idIndex[i]);
+    }
+
+    UA_free(sm->tokenIndex);
+    UA_free(sm->idIndex);
+    sm->tokenIndex = tokenIndex;
+    sm->idIndex = idIndex;
+    sm->indexSize = newSize;
+
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &sm->sessions, pointers)
+        indexSession(sm, sentry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static session_list_entry *
+findByToken(UA_SessionManager *sm, const UA_NodeId *token) {
+    if(sm->indexSize == 0)
+        return NULL;
+    UA_UInt32 hash = UA_NodeId_hash(token);
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &sm->tokenIndex[hash & (sm->indexSize - 1)], tokenPointers) {
+        if(sentry->tokenHash == hash &&
+           UA_NodeId_equal(&sentry->session.header.authenticationToken, token))
+            return sentry;
+    }
+    return NULL;
+}
+
+static session_list_entry *
+findById(UA_SessionManager *sm, const UA_NodeId *sessionId) {
+    if(sm->indexSize == 0)
+        return NULL;
+    UA_UInt32 hash = UA_NodeId_hash(sessionId);
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &sm->idIndex[hash & (sm->indexSize - 1)], idPointers) {
+        if(sentry->idHash == hash &&
+           UA_NodeId_equal(&sentry->session.sessionId, sessionId))
+            return sentry;
+    }
+    return NULL;
 }
 
 /* Delayed callback to free the session memory */
@@ -58,6 +139,8 @@ removeSession(UA_SessionManager *sm, session_list_entry *sentry) {
     /* Detach the session from the session manager and make the capacity
      * available */
     LIST_REMOVE(sentry, pointers);
+    LIST_REMOVE(sentry, tokenPointers);
+    LIST_REMOVE(sentry, idPointers);
     UA_atomic_subUInt32(&sm->currentSessionCount, 1);
     return UA_STATUSCODE_GOOD;
 }
@@ -82,54 +165,48 @@ UA_SessionManager_cleanupTimedOut(UA_SessionManager *sm,
 
 UA_Session *
 UA_SessionManager_getSessionByToken(UA_SessionManager *sm, const UA_NodeId *token) {
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &sm->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.header.authenticationToken, token))
-            continue;
+    session_list_entry *current = findByToken(sm, token);
 
-        /* Session has timed out */
-        if(UA_DateTime_nowMonotonic() > current->session.validTill) {
-            UA_LOG_INFO_SESSION(sm->server->config.logger, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+    /* Session not found */
+    if(!current) {
+        UA_LOG_INFO(sm->server->config.logger, UA_LOGCATEGORY_SESSION,
+                    "Try to use Session with token " UA_PRINTF_GUID_FORMAT " but is not found",
+                    UA_PRINTF_GUID_DATA(token->identifier.guid));
+        return NULL;
+    }
 
-        /* Ok, return */
-        return &current->session;
+    /* Session has timed out */
+    if(UA_DateTime_nowMonotonic() > current->session.validTill) {
+        UA_LOG_INFO_SESSION(sm->server->config.logger, &current->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    /* Session not found */
-    UA_LOG_INFO(sm->server->config.logger, UA_LOGCATEGORY_SESSION,
-                "Try to use Session with token " UA_PRINTF_GUID_FORMAT " but is not found",
-                UA_PRINTF_GUID_DATA(token->identifier.guid));
-    return NULL;
+    /* Ok, return */
+    return &current->session;
 }
 
 UA_Session *
 UA_SessionManager_getSessionById(UA_SessionManager *sm, const UA_NodeId *sessionId) {
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &sm->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.sessionId, sessionId))
-            continue;
+    session_list_entry *current = findById(sm, sessionId);
 
-        /* Session has timed out */
-        if(UA_DateTime_nowMonotonic() > current->session.validTill) {
-            UA_LOG_INFO_SESSION(sm->server->config.logger, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+    /* Session not found */
+    if(!current) {
+        UA_LOG_INFO(sm->server->config.logger, UA_LOGCATEGORY_SESSION,
+                    "Try to use Session with identifier " UA_PRINTF_GUID_FORMAT " but is not found",
+                    UA_PRINTF_GUID_DATA(sessionId->identifier.guid));
+        return NULL;
+    }
 
-        /* Ok, return */
-        return &current->session;
+    /* Session has timed out */
+    if(UA_DateTime_nowMonotonic() > current->session.validTill) {
+        UA_LOG_INFO_SESSION(sm->server->config.logger, &current->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    /* Session not found */
-    UA_LOG_INFO(sm->server->config.logger, UA_LOGCATEGORY_SESSION,
-                "Try to use Session with identifier " UA_PRINTF_GUID_FORMAT " but is not found",
-                UA_PRINTF_GUID_DATA(sessionId->identifier.guid));
-    return NULL;
+    /* Ok, return */
+    return &current->session;
 }
 
 /* Creates and adds a session. But it is not yet attached to a secure channel. */
@@ -139,6 +216,13 @@ UA_SessionManager_createSession(UA_SessionManager *sm, UA_SecureChannel *channel
     if(sm->currentSessionCount >= sm->server->config.maxSessions)
         return UA_STATUSCODE_BADTOOMANYSESSIONS;
 
+    /* Grow the index before the session is added. Failing to grow an existing
+     * index only makes the buckets longer. */
+    if(sm->currentSessionCount >= sm->indexSize &&
+       resizeIndex(sm, sm->currentSessionCount + 1) != UA_STATUSCODE_GOOD &&
+       sm->indexSize == 0)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     session_list_entry *newentry = (session_list_entry *)UA_malloc(sizeof(session_list_entry));
     if(!newentry)
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -156,17 +240,16 @@ UA_SessionManager_createSession(UA_SessionManager *sm, UA_SecureChannel *channel
 
     UA_Session_updateLifetime(&newentry->session);
     LIST_INSERT_HEAD(&sm->sessions, newentry, pointers);
+    newentry->tokenHash = UA_NodeId_hash(&newentry->session.header.authenticationToken);
+    newentry->idHash = UA_NodeId_hash(&newentry->session.sessionId);
+    indexSession(sm, newentry);
     *session = &newentry->session;
     return UA_STATUSCODE_GOOD;
 }
 
 UA_StatusCode
 UA_SessionManager_removeSession(UA_SessionManager *sm, const UA_NodeId *token) {
-    session_list_entry *current;
-    LIST_FOREACH(current, &sm->sessions, pointers) {
-        if(UA_NodeId_equal(&current->session.header.authenticationToken, token))
-            break;
-    }
+    session_list_entry *current = findByToken(sm, token);
     if(!current)
         return UA_STATUSCODE_BADSESSIONIDINVALID;
     return removeSession(sm, current);
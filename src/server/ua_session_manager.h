@@ -23,11 +23,25 @@ extern "C" {
 
 typedef struct session_list_entry {
     LIST_ENTRY(session_list_entry) pointers;
+    LIST_ENTRY(session_list_entry) tokenPointers; /* In the token hash bucket */
+    LIST_ENTRY(session_list_entry) idPointers;    /* In the sessionId hash bucket */
+    UA_UInt32 tokenHash;
+    UA_UInt32 idHash;
     UA_Session session;
 } session_list_entry;
 
+LIST_HEAD(session_list, session_list_entry);
+
 typedef struct UA_SessionManager {
-    LIST_HEAD(session_list, session_list_entry) sessions; // doubly-linked list of sessions
+    struct session_list sessions; // doubly-linked list of sessions
+
+    /* Hash index over the authentication token and the sessionId. The number
+     * of buckets is a power of two and doubles when the sessions outnumber the
+     * buckets. */
+    struct session_list *tokenIndex;
+    struct session_list *idIndex;
+    size_t indexSize;
+
     UA_UInt32 currentSessionCount;
     UA_Server *server;
 } UA_SessionManager;
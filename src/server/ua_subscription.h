@@ -103,11 +103,11 @@ struct UA_MonitoredItem {
 #endif
         UA_DataChangeFilter dataChangeFilter;
     } filter;
-    UA_Variant lastValue;
 
     /* Sample Callback */
     UA_UInt64 sampleCallbackId;
-    UA_ByteString lastSampledValue;
+    UA_DataValue lastSampledValue;
+    UA_Boolean hasLastSampledValue; /* False before the first sample */
     UA_Boolean sampleCallbackIsRegistered;
 
     /* Notification Queue */
@@ -10,12 +10,9 @@
 
 #include "ua_server_internal.h"
 #include "ua_subscription.h"
-#include "ua_types_encoding_binary.h"
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
-#define UA_VALUENCODING_MAXSTACK 512
-
 void UA_MonitoredItem_init(UA_MonitoredItem *mon, UA_Subscription *sub) {
     memset(mon, 0, sizeof(UA_MonitoredItem));
     mon->subscription = sub;
@@ -84,8 +81,7 @@ void UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *monitoredItem)
     if(monitoredItem->listEntry.le_prev != NULL)
         LIST_REMOVE(monitoredItem, listEntry);
     UA_String_deleteMembers(&monitoredItem->indexRange);
-    UA_ByteString_deleteMembers(&monitoredItem->lastSampledValue);
-    UA_Variant_deleteMembers(&monitoredItem->lastValue);
+    UA_DataValue_deleteMembers(&monitoredItem->lastSampledValue);
     UA_NodeId_deleteMembers(&monitoredItem->monitoredNodeId);
     UA_Server_delayedFree(server, monitoredItem);
 }
@@ -270,116 +266,54 @@ updateNeededForFilteredValue(const UA_Variant *value, const UA_Variant *oldValue
 }
 
 
-/* When a change is detected, encoding contains the heap-allocated binary encoded value */
-static UA_Boolean
-detectValueChangeWithFilter(UA_Server *server, UA_MonitoredItem *mon, UA_DataValue *value,
-                            UA_ByteString *encoding) {
-    UA_Session *session = &adminSession;
-    UA_UInt32 subscriptionId = 0;
-    UA_Subscription *sub = mon->subscription;
-    if(sub) {
-        session = sub->session;
-        subscriptionId = sub->subscriptionId;
+/* Returns a shallow copy of the value without the fields that are ignored by
+ * the filter */
+static UA_DataValue
+filterDataValue(const UA_MonitoredItem *mon, const UA_DataValue *value) {
+    UA_DataValue filtered = *value;
+    if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUS)
+        filtered.hasValue = false;
+
+    filtered.hasServerTimestamp = false;
+    filtered.hasServerPicoseconds = false;
+    if(mon->filter.dataChangeFilter.trigger < UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
+        filtered.hasSourceTimestamp = false;
+        filtered.hasSourcePicoseconds = false;
     }
+    return filtered;
+}
 
+/* Has this sample changed from the last one? The values are compared
+ * structurally. No memory is allocated. */
+static UA_Boolean
+detectValueChange(UA_MonitoredItem *mon, const UA_DataValue *value) {
+    /* No previous sample. Tracked explicitly, as an empty DataValue is also a
+     * valid sample. */
+    if(!mon->hasLastSampledValue)
+        return true;
+    const UA_DataValue *last = &mon->lastSampledValue;
+
+    /* Apply the deadband filter */
     if(isDataTypeNumeric(value->value.type) &&
        (mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
         mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP)) {
         if(mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE) {
-            if(!updateNeededForFilteredValue(&value->value, &mon->lastValue,
+            if(!updateNeededForFilteredValue(&value->value, &last->value,
                                              mon->filter.dataChangeFilter.deadbandValue))
                 return false;
         }
         /* else if (mon->filter.deadbandType == UA_DEADBANDTYPE_PERCENT) {
             // TODO where do this EURange come from ?
             UA_Double deadbandValue = fabs(mon->filter.deadbandValue * (EURange.high-EURange.low));
-            if (!updateNeededForFilteredValue(value->value, mon->lastValue, deadbandValue))
+            if (!updateNeededForFilteredValue(&value->value, &last->value, deadbandValue))
                 return false;
         }*/
     }
 
-    /* Stack-allocate some memory for the value encoding. We might heap-allocate
-     * more memory if needed. This is just enough for scalars and small
-     * structures. */
-    UA_STACKARRAY(UA_Byte, stackValueEncoding, UA_VALUENCODING_MAXSTACK);
-    UA_ByteString valueEncoding;
-    valueEncoding.data = stackValueEncoding;
-    valueEncoding.length = UA_VALUENCODING_MAXSTACK;
-
-    /* Encode the value */
-    UA_Byte *bufPos = valueEncoding.data;
-    const UA_Byte *bufEnd = &valueEncoding.data[valueEncoding.length];
-    UA_StatusCode retval = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE],
-                                           &bufPos, &bufEnd, NULL, NULL);
-    if(retval == UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED) {
-        size_t binsize = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE]);
-        if(binsize == 0)
-            return false;
-        retval = UA_ByteString_allocBuffer(&valueEncoding, binsize);
-        if(retval == UA_STATUSCODE_GOOD) {
-            bufPos = valueEncoding.data;
-            bufEnd = &valueEncoding.data[valueEncoding.length];
-            retval = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE],
-                                     &bufPos, &bufEnd, NULL, NULL);
-        }
-    }
-
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING_SESSION(server->config.logger, session,
-                               "Subscription %u | MonitoredItem %i | "
-                               "Could not encode the value the MonitoredItem with status %s",
-                               subscriptionId, mon->monitoredItemId, UA_StatusCode_name(retval));
-        return false;
-    }
-
-    /* Has the value changed? */
-    valueEncoding.length = (uintptr_t)bufPos - (uintptr_t)valueEncoding.data;
-    UA_Boolean changed = (!mon->lastSampledValue.data ||
-                          !UA_String_equal(&valueEncoding, &mon->lastSampledValue));
-
-    /* No change */
-    if(!changed) {
-        if(valueEncoding.data != stackValueEncoding)
-            UA_ByteString_deleteMembers(&valueEncoding);
-        return false;
-    }
-
-    /* Change detected. Copy encoding on the heap if necessary. */
-    if(valueEncoding.data == stackValueEncoding) {
-        retval = UA_ByteString_copy(&valueEncoding, encoding);
-        if(retval != UA_STATUSCODE_GOOD) {
-            UA_LOG_WARNING_SESSION(server->config.logger, session,
-                                   "Subscription %u | MonitoredItem %i | "
-                                   "Detected change, but could not allocate memory for the notification"
-                                   "with status %s", subscriptionId, mon->monitoredItemId,
-                                   UA_StatusCode_name(retval));
-            return false;
-        }
-        return true;
-    }
-
-    *encoding = valueEncoding;
-    return true;
-}
-
-/* Has this sample changed from the last one? The method may allocate additional
- * space for the encoding buffer. Detect the change in encoding->data. */
-static UA_Boolean
-detectValueChange(UA_Server *server, UA_MonitoredItem *mon,
-                  UA_DataValue value, UA_ByteString *encoding) {
-    /* Apply Filter */
-    if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUS)
-        value.hasValue = false;
-
-    value.hasServerTimestamp = false;
-    value.hasServerPicoseconds = false;
-    if(mon->filter.dataChangeFilter.trigger < UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
-        value.hasSourceTimestamp = false;
-        value.hasSourcePicoseconds = false;
-    }
-
-    /* Detect the value change */
-    return detectValueChangeWithFilter(server, mon, &value, encoding);
+    /* Compare the fields that are not masked by the filter */
+    UA_DataValue filteredValue = filterDataValue(mon, value);
+    UA_DataValue filteredLast = filterDataValue(mon, last);
+    return !UA_equal(&filteredValue, &filteredLast, &UA_TYPES[UA_TYPES_DATAVALUE]);
 }
 
 /* Returns whether the sample was stored in the MonitoredItem */
@@ -389,14 +323,22 @@ sampleCallbackWithValue(UA_Server *server, UA_MonitoredItem *monitoredItem,
     UA_assert(monitoredItem->monitoredItemType == UA_MONITOREDITEMTYPE_CHANGENOTIFY);
     UA_Subscription *sub = monitoredItem->subscription;
 
-    /* Contains heap-allocated binary encoding of the value if a change was detected */
-    UA_ByteString binaryEncoding = UA_BYTESTRING_NULL;
+    /* Has the value changed? */
+    if(!detectValueChange(monitoredItem, value))
+        return false;
 
-    /* Has the value changed? Allocates memory in binaryEncoding if necessary.
-     * value is edited internally so we make a shallow copy. */
-    UA_Boolean changed = detectValueChange(server, monitoredItem, *value, &binaryEncoding);
-    if(!changed)
+    /* Copy the value for the comparison with the next sample before it is
+     * moved into the notification */
+    UA_DataValue sampledValue;
+    UA_StatusCode retval = UA_DataValue_copy(value, &sampledValue);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING_SESSION(server->config.logger,
+                               sub ? sub->session : &adminSession,
+                               "MonitoredItem %i | Detected change, but could not "
+                               "allocate memory for the sample with status %s",
+                               monitoredItem->monitoredItemId, UA_StatusCode_name(retval));
         return false;
+    }
 
     UA_Boolean storedValue = false;
     if(sub) {
@@ -407,7 +349,7 @@ sampleCallbackWithValue(UA_Server *server, UA_MonitoredItem *monitoredItem,
                                    "Subscription %u | MonitoredItem %i | "
                                    "Item for the publishing queue could not be allocated",
                                    sub->subscriptionId, monitoredItem->monitoredItemId);
-            UA_ByteString_deleteMembers(&binaryEncoding);
+            UA_DataValue_deleteMembers(&sampledValue);
             return false;
         }
 
@@ -433,7 +375,7 @@ sampleCallbackWithValue(UA_Server *server, UA_MonitoredItem *monitoredItem,
 
     // If someone called UA_Server_deleteMonitoredItem in the user callback,
     // then the monitored item will be deleted soon. So, there is no need to
-    // add the lastValue or lastSampledValue to it.
+    // add the lastSampledValue to it.
     //
     // If we do so, we will leak
     // the memory of that values, because UA_Server_deleteMonitoredItem
@@ -446,15 +388,14 @@ sampleCallbackWithValue(UA_Server *server, UA_MonitoredItem *monitoredItem,
     //
     // We do detect if the monitored item is already defunct.
     if (!monitoredItem->sampleCallbackIsRegistered) {
-        UA_ByteString_deleteMembers(&binaryEncoding);
+        UA_DataValue_deleteMembers(&sampledValue);
         return storedValue;
     }
 
-    /* Store the encoding for comparison */
-    UA_ByteString_deleteMembers(&monitoredItem->lastSampledValue);
-    monitoredItem->lastSampledValue = binaryEncoding;
-    UA_Variant_deleteMembers(&monitoredItem->lastValue);
-    UA_Variant_copy(&value->value, &monitoredItem->lastValue);
+    /* Store the sample for comparison */
+    UA_DataValue_deleteMembers(&monitoredItem->lastSampledValue);
+    monitoredItem->lastSampledValue = sampledValue;
+    monitoredItem->hasLastSampledValue = true;
 
     return storedValue;
 }
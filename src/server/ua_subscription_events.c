@@ -51,9 +51,8 @@ UA_Server_createEvent(UA_Server *server, const UA_NodeId eventType, UA_NodeId *o
     }
 
     /* Make sure the eventType is a subtype of BaseEventType */
-    UA_NodeId hasSubtypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
     UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
-    if(!isNodeInTree(&server->config.nodestore, &eventType, &baseEventTypeId, &hasSubtypeId, 1)) {
+    if(!isSubtypeOf(server, &eventType, &baseEventTypeId)) {
         UA_LOG_ERROR(server->config.logger, UA_LOGCATEGORY_USERLAND,
                      "Event type must be a subtype of BaseEventType!");
         return UA_STATUSCODE_BADINVALIDARGUMENT;
@@ -117,9 +116,7 @@ isValidEvent(UA_Server *server, const UA_NodeId *validEventParent, const UA_Node
         UA_BrowsePathResult_deleteMembers(&bpr);
         return UA_FALSE;
     }
-    UA_NodeId hasSubtypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
-    UA_Boolean tmp = isNodeInTree(&server->config.nodestore, &bpr.targets[0].targetId.nodeId,
-                                  validEventParent, &hasSubtypeId, 1);
+    UA_Boolean tmp = isSubtypeOf(server, &bpr.targets[0].targetId.nodeId, validEventParent);
     UA_BrowsePathResult_deleteMembers(&bpr);
     return tmp;
 }
@@ -315,8 +312,7 @@ getParentsNodeIteratorCallback(UA_NodeId parentId, UA_Boolean isInverse,
         return UA_STATUSCODE_GOOD;
 
     /* Is this a hierarchical reference? */
-    if(!isNodeInTree(&handle->server->config.nodestore, &referenceTypeId,
-                     &hierarchicalReferences, &subtypeId, 1))
+    if(!isSubtypeOf(handle->server, &referenceTypeId, &hierarchicalReferences))
         return UA_STATUSCODE_GOOD;
 
     Events_nodeListElement *entry = (Events_nodeListElement *) UA_malloc(sizeof(Events_nodeListElement));
@@ -110,12 +110,8 @@ UA_SecureChannel_deleteMembersCleanup(UA_SecureChannel *channel) {
     /* Remove the buffered chunks */
     struct MessageEntry *me, *temp_me;
     LIST_FOREACH_SAFE(me, &channel->chunks, pointers, temp_me) {
-        struct ChunkPayload *cp, *temp_cp;
-        SIMPLEQ_FOREACH_SAFE(cp, &me->chunkPayload, pointers, temp_cp) {
-            UA_ByteString_deleteMembers(&cp->bytes);
-            UA_free(cp);
-        }
         LIST_REMOVE(me, pointers);
+        UA_ByteString_deleteMembers(&me->messageBuffer);
         UA_free(me);
     }
 }
@@ -488,6 +484,26 @@ setBufPos(UA_MessageContext *mc) {
         mc->buf_end -= 2;
 }
 
+/* Release the current and the queued chunks */
+static void
+releaseMessageBuffers(UA_MessageContext *mc) {
+    UA_Connection *connection = mc->channel->connection;
+    connection->releaseSendBuffer(connection, &mc->messageBuffer);
+    for(size_t i = 0; i < mc->pendingChunksSize; ++i)
+        connection->releaseSendBuffer(connection, &mc->pendingChunks[i]);
+    mc->pendingChunksSize = 0;
+}
+
+/* Send the queued chunks. The buffers are freed in the network layer. */
+static UA_StatusCode
+flushPendingChunks(UA_MessageContext *mc) {
+    UA_Connection *connection = mc->channel->connection;
+    UA_StatusCode retval =
+        connection->sendBatch(connection, mc->pendingChunks, mc->pendingChunksSize);
+    mc->pendingChunksSize = 0;
+    return retval;
+}
+
 static UA_StatusCode
 sendSymmetricChunk(UA_MessageContext *mc) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
@@ -510,7 +526,7 @@ sendSymmetricChunk(UA_MessageContext *mc) {
        connection->remoteConf.maxChunkCount != 0)
         res = UA_STATUSCODE_BADRESPONSETOOLARGE;
     if(res != UA_STATUSCODE_GOOD) {
-        connection->releaseSendBuffer(channel->connection, &mc->messageBuffer);
+        releaseMessageBuffers(mc);
         return res;
     }
 
@@ -593,12 +609,22 @@ sendSymmetricChunk(UA_MessageContext *mc) {
     }
 
     if(res != UA_STATUSCODE_GOOD) {
-        connection->releaseSendBuffer(channel->connection, &mc->messageBuffer);
+        releaseMessageBuffers(mc);
         return res;
     }
 
     /* Send the chunk, the buffer is freed in the network layer */
-    return connection->send(channel->connection, &mc->messageBuffer);
+    if(!connection->sendBatch)
+        return connection->send(channel->connection, &mc->messageBuffer);
+
+    /* Queue the chunk. The chunks of a message are handed to the network layer
+     * together when the message is finished or the queue is full. */
+    mc->pendingChunks[mc->pendingChunksSize] = mc->messageBuffer;
+    mc->pendingChunksSize++;
+    mc->messageBuffer = UA_BYTESTRING_NULL;
+    if(!mc->final && mc->pendingChunksSize < UA_MESSAGECONTEXT_MAXPENDINGCHUNKS)
+        return UA_STATUSCODE_GOOD;
+    return flushPendingChunks(mc);
 }
 
 /* Callback from the encoding layer. Send the chunk and replace the buffer. */
@@ -645,6 +671,7 @@ UA_MessageContext_begin(UA_MessageContext *mc, UA_SecureChannel *channel,
     mc->messageSizeSoFar = 0;
     mc->final = false;
     mc->messageBuffer = UA_BYTESTRING_NULL;
+    mc->pendingChunksSize = 0;
     mc->messageType = messageType;
 
     /* Minimum required size */
@@ -670,10 +697,7 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
                                            sendSymmetricEncodingCallback, mc);
     if(retval != UA_STATUSCODE_GOOD) {
         /* TODO: Send the abort message */
-        if(mc->messageBuffer.length > 0) {
-            UA_Connection *connection = mc->channel->connection;
-            connection->releaseSendBuffer(connection, &mc->messageBuffer);
-        }
+        releaseMessageBuffers(mc);
     }
     return retval;
 }
@@ -686,8 +710,7 @@ UA_MessageContext_finish(UA_MessageContext *mc) {
 
 void
 UA_MessageContext_abort(UA_MessageContext *mc) {
-    UA_Connection *connection = mc->channel->connection;
-    connection->releaseSendBuffer(connection, &mc->messageBuffer);
+    releaseMessageBuffers(mc);
 }
 
 UA_StatusCode
@@ -727,44 +750,69 @@ UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 reque
 /* Assemble Complete Message */
 /*****************************/
 
-static void
-UA_SecureChannel_removeChunks(UA_SecureChannel *channel, UA_UInt32 requestId) {
+/* Chunks of different messages are usually not interleaved. The entry of the
+ * latest message is at the head of the list and found immediately. */
+static struct MessageEntry *
+findMessageEntry(UA_SecureChannel *channel, UA_UInt32 requestId) {
     struct MessageEntry *me;
     LIST_FOREACH(me, &channel->chunks, pointers) {
-        if(me->requestId == requestId) {
-            struct ChunkPayload *cp, *temp_cp;
-            SIMPLEQ_FOREACH_SAFE(cp, &me->chunkPayload, pointers, temp_cp) {
-                UA_ByteString_deleteMembers(&cp->bytes);
-                UA_free(cp);
-            }
-            LIST_REMOVE(me, pointers);
-            UA_free(me);
-            return;
-        }
+        if(me->requestId == requestId)
+            return me;
     }
+    return NULL;
+}
+
+static void
+deleteMessageEntry(struct MessageEntry *me) {
+    LIST_REMOVE(me, pointers);
+    UA_ByteString_deleteMembers(&me->messageBuffer);
+    UA_free(me);
+}
+
+static void
+UA_SecureChannel_removeChunks(UA_SecureChannel *channel, UA_UInt32 requestId) {
+    struct MessageEntry *me = findMessageEntry(channel, requestId);
+    if(me)
+        deleteMessageEntry(me);
 }
 
+/* Copy the chunk body to the end of the message buffer. The buffer starts at
+ * twice the size of the first chunk and doubles when full. The capacity is
+ * capped at the maximum message size. It is not preallocated to that size, as
+ * a large configured limit would then cost a large allocation per message. */
 static UA_StatusCode
-appendChunk(struct MessageEntry *messageEntry, const UA_ByteString *chunkBody) {
-    
-    struct ChunkPayload* cp = (struct ChunkPayload*)UA_malloc(sizeof(struct ChunkPayload));
-    UA_StatusCode retval = UA_ByteString_copy(chunkBody, &cp->bytes);
-    if (retval != UA_STATUSCODE_GOOD)
-        return retval;
-    
-    SIMPLEQ_INSERT_TAIL(&messageEntry->chunkPayload, cp, pointers);
-    messageEntry->chunkPayloadSize += chunkBody->length;
+appendChunk(const UA_Connection *connection, struct MessageEntry *me,
+            const UA_ByteString *chunkBody) {
+    size_t maxMessageSize = 0;
+    if(connection)
+        maxMessageSize = connection->localConf.maxMessageSize;
+
+    size_t newSize = me->messageSize + chunkBody->length;
+    if(maxMessageSize != 0 && newSize > maxMessageSize)
+        return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
+
+    if(newSize > me->messageBuffer.length) {
+        size_t capacity = me->messageBuffer.length * 2;
+        if(capacity < newSize * 2)
+            capacity = newSize * 2;
+        if(maxMessageSize != 0 && capacity > maxMessageSize)
+            capacity = maxMessageSize;
+        UA_Byte *data = (UA_Byte*)UA_realloc(me->messageBuffer.data, capacity);
+        if(!data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        me->messageBuffer.data = data;
+        me->messageBuffer.length = capacity;
+    }
+
+    memcpy(&me->messageBuffer.data[me->messageSize], chunkBody->data, chunkBody->length);
+    me->messageSize = newSize;
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
 UA_SecureChannel_appendChunk(UA_SecureChannel *channel, UA_UInt32 requestId,
                              const UA_ByteString *chunkBody) {
-    struct MessageEntry *me;
-    LIST_FOREACH(me, &channel->chunks, pointers) {
-        if(me->requestId == requestId)
-            break;
-    }
+    struct MessageEntry *me = findMessageEntry(channel, requestId);
 
     /* No chunkentry on the channel, create one */
     if(!me) {
@@ -773,55 +821,38 @@ UA_SecureChannel_appendChunk(UA_SecureChannel *channel, UA_UInt32 requestId,
             return UA_STATUSCODE_BADOUTOFMEMORY;
         memset(me, 0, sizeof(struct MessageEntry));
         me->requestId = requestId;
-        SIMPLEQ_INIT(&me->chunkPayload);
         LIST_INSERT_HEAD(&channel->chunks, me, pointers);
     }
 
-    return appendChunk(me, chunkBody);
+    UA_StatusCode retval = appendChunk(channel->connection, me, chunkBody);
+    if(retval != UA_STATUSCODE_GOOD)
+        deleteMessageEntry(me);
+    return retval;
 }
 
 static UA_StatusCode
 UA_SecureChannel_finalizeChunk(UA_SecureChannel *channel, UA_UInt32 requestId,
                                const UA_ByteString *chunkBody, UA_MessageType messageType,
                                UA_ProcessMessageCallback callback, void *application) {
-    struct MessageEntry *messageEntry;
-    LIST_FOREACH(messageEntry, &channel->chunks, pointers) {
-        if(messageEntry->requestId == requestId)
-            break;
+    /* Single-chunk message. Process without copying. */
+    struct MessageEntry *me = NULL;
+    if(!LIST_EMPTY(&channel->chunks))
+        me = findMessageEntry(channel, requestId);
+    if(!me) {
+        UA_ByteString bytes = *chunkBody;
+        return callback(application, channel, messageType, requestId, &bytes);
     }
 
-    UA_ByteString bytes;
-    if(!messageEntry) {
-        bytes = *chunkBody;
-    } else {
-        UA_StatusCode retval = appendChunk(messageEntry, chunkBody);
-        if(retval != UA_STATUSCODE_GOOD)
-            return retval;
-        
-        UA_ByteString_init(&bytes);
-
-        bytes.data = (UA_Byte*) UA_malloc(messageEntry->chunkPayloadSize);
-        if (!bytes.data)
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-
-        struct ChunkPayload *cp, *temp_cp;
-        size_t curPos = 0;
-        SIMPLEQ_FOREACH_SAFE(cp, &messageEntry->chunkPayload, pointers, temp_cp) {
-            memcpy(&bytes.data[curPos], cp->bytes.data, cp->bytes.length);
-            curPos += cp->bytes.length;
-            UA_ByteString_deleteMembers(&cp->bytes);
-            UA_free(cp);
-        }
-
-        bytes.length = messageEntry->chunkPayloadSize;
-
-        LIST_REMOVE(messageEntry, pointers);
-        UA_free(messageEntry);
+    /* Append the final chunk and process the reassembled message. The entry is
+     * removed from the channel first, as the callback may close the channel. */
+    UA_StatusCode retval = appendChunk(channel->connection, me, chunkBody);
+    LIST_REMOVE(me, pointers);
+    if(retval == UA_STATUSCODE_GOOD) {
+        UA_ByteString bytes = {me->messageSize, me->messageBuffer.data};
+        retval = callback(application, channel, messageType, requestId, &bytes);
     }
-
-    UA_StatusCode retval = callback(application, channel, messageType, requestId, &bytes);
-    if(messageEntry)
-        UA_ByteString_deleteMembers(&bytes);
+    UA_ByteString_deleteMembers(&me->messageBuffer);
+    UA_free(me);
     return retval;
 }
 
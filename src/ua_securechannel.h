@@ -43,17 +43,13 @@ typedef struct UA_SessionHeader {
     UA_SecureChannel *channel; /* The pointer back to the SecureChannel in the session. */
 } UA_SessionHeader;
 
-/* For chunked requests */
-struct ChunkPayload {
-    SIMPLEQ_ENTRY(ChunkPayload) pointers;
-    UA_ByteString bytes;
-};
-
+/* For chunked requests. The chunk bodies are appended to a single buffer that
+ * is handed to the message callback once the final chunk arrives. */
 struct MessageEntry {
     LIST_ENTRY(MessageEntry) pointers;
     UA_UInt32 requestId;
-    SIMPLEQ_HEAD(chunkpayload_pointerlist, ChunkPayload) chunkPayload;
-    size_t chunkPayloadSize;
+    UA_ByteString messageBuffer; /* The length is the allocated capacity */
+    size_t messageSize;          /* The number of bytes used so far */
 };
 
 typedef enum {
@@ -124,6 +120,10 @@ UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 reque
                                       UA_MessageType messageType, void *payload,
                                       const UA_DataType *payloadType);
 
+/* Finished chunks that are queued before they are sent together. Only used if
+ * the connection implements sendBatch. */
+#define UA_MESSAGECONTEXT_MAXPENDINGCHUNKS 16
+
 /* The MessageContext is forwarded into the encoding layer so that we can send
  * chunks before continuing to encode. This lets us reuse a fixed chunk-sized
  * messages buffer. */
@@ -139,6 +139,9 @@ typedef struct {
     UA_Byte *buf_pos;
     const UA_Byte *buf_end;
 
+    UA_ByteString pendingChunks[UA_MESSAGECONTEXT_MAXPENDINGCHUNKS];
+    size_t pendingChunksSize;
+
     UA_Boolean final;
 } UA_MessageContext;
 
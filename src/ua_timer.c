@@ -26,24 +26,244 @@
 #define REMOVE_SENTINEL 0x00
 #define CHANGE_SENTINEL 0x01
 
+/* container_of */
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+
 struct UA_TimerCallbackEntry {
-    SLIST_ENTRY(UA_TimerCallbackEntry) next; /* Next element in the list */
+    SLIST_ENTRY(UA_TimerCallbackEntry) next; /* Next element in the MPSC queue */
     UA_DateTime nextTime;                    /* The next time when the callbacks
                                               * are to be executed */
+    UA_Int64 order;                          /* Execution order among callbacks
+                                              * with the same nextTime */
     UA_UInt64 interval;                      /* Interval in 100ns resolution */
     UA_UInt64 id;                            /* Id of the repeated callback */
 
+    /* Pairing heap. The prev pointer points to the parent for the first child
+     * and to the previous sibling otherwise. */
+    UA_TimerCallbackEntry *heapChild;
+    UA_TimerCallbackEntry *heapNext;
+    UA_TimerCallbackEntry *heapPrev;
+
+    UA_TimerHashEntry idEntry;    /* In the idIndex */
+    UA_TimerHashEntry blockEntry; /* In the blockIndex if this is the first
+                                   * callback of the latest block */
+    UA_Boolean blockHead;
+
     UA_TimerCallback callback;
     void *data;
 };
 
+/************/
+/* Hash Map */
+/************/
+
+#define UA_TIMERHASH_MINSIZE 16
+
+static void
+UA_TimerHash_init(UA_TimerHash *h) {
+    h->buckets = NULL;
+    h->single = NULL;
+    h->size = 1;
+    h->count = 0;
+}
+
+static void
+UA_TimerHash_deleteMembers(UA_TimerHash *h) {
+    UA_free(h->buckets);
+    UA_TimerHash_init(h);
+}
+
+/* Fibonacci hashing spreads sequential keys */
+static UA_TimerHashEntry **
+UA_TimerHash_bucket(UA_TimerHash *h, UA_UInt64 key) {
+    if(!h->buckets)
+        return &h->single;
+    UA_UInt64 hash = (key * 11400714819323198485ull) >> 32;
+    return &h->buckets[hash & (h->size - 1)];
+}
+
+/* Double the number of buckets. The current buckets are kept if the allocation
+ * fails. That only makes the chains longer. */
+static void
+UA_TimerHash_grow(UA_TimerHash *h) {
+    size_t newSize = h->buckets ? h->size << 1 : UA_TIMERHASH_MINSIZE;
+    UA_TimerHashEntry **buckets = (UA_TimerHashEntry**)
+        UA_calloc(newSize, sizeof(UA_TimerHashEntry*));
+    if(!buckets)
+        return;
+
+    UA_TimerHash old = *h;
+    h->buckets = buckets;
+    h->size = newSize;
+    for(size_t i = 0; i < old.size; i++) {
+        UA_TimerHashEntry *e = old.buckets ? old.buckets[i] : old.single;
+        while(e) {
+            UA_TimerHashEntry *next = e->next;
+            UA_TimerHashEntry **bucket = UA_TimerHash_bucket(h, e->key);
+            e->next = *bucket;
+            *bucket = e;
+            e = next;
+        }
+    }
+    UA_free(old.buckets);
+}
+
+static void
+UA_TimerHash_insert(UA_TimerHash *h, UA_TimerHashEntry *e) {
+    if(h->count >= h->size)
+        UA_TimerHash_grow(h);
+    UA_TimerHashEntry **bucket = UA_TimerHash_bucket(h, e->key);
+    e->next = *bucket;
+    *bucket = e;
+    h->count++;
+}
+
+static UA_TimerHashEntry *
+UA_TimerHash_find(UA_TimerHash *h, UA_UInt64 key) {
+    UA_TimerHashEntry *e = *UA_TimerHash_bucket(h, key);
+    while(e && e->key != key)
+        e = e->next;
+    return e;
+}
+
+static void
+UA_TimerHash_remove(UA_TimerHash *h, UA_TimerHashEntry *e) {
+    UA_TimerHashEntry **prev = UA_TimerHash_bucket(h, e->key);
+    while(*prev && *prev != e)
+        prev = &(*prev)->next;
+    if(!*prev)
+        return;
+    *prev = e->next;
+    h->count--;
+}
+
+/****************/
+/* Pairing Heap */
+/****************/
+
+static UA_Boolean
+executedBefore(const UA_TimerCallbackEntry *a, const UA_TimerCallbackEntry *b) {
+    if(a->nextTime != b->nextTime)
+        return a->nextTime < b->nextTime;
+    return a->order < b->order;
+}
+
+/* Meld two heap roots. The sibling pointers of the roots are ignored. */
+static UA_TimerCallbackEntry *
+heapMeld(UA_TimerCallbackEntry *a, UA_TimerCallbackEntry *b) {
+    if(executedBefore(b, a)) {
+        UA_TimerCallbackEntry *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    b->heapPrev = a;
+    b->heapNext = a->heapChild;
+    if(a->heapChild)
+        a->heapChild->heapPrev = b;
+    a->heapChild = b;
+    return a;
+}
+
+/* Meld a list of siblings in two passes. First meld pairs from left to right,
+ * then meld the results from right to left. */
+static UA_TimerCallbackEntry *
+heapMergePairs(UA_TimerCallbackEntry *first) {
+    UA_TimerCallbackEntry *paired = NULL;
+    while(first) {
+        UA_TimerCallbackEntry *a = first;
+        UA_TimerCallbackEntry *b = first->heapNext;
+        first = b ? b->heapNext : NULL;
+        a->heapNext = a->heapPrev = NULL;
+        if(b) {
+            b->heapNext = b->heapPrev = NULL;
+            a = heapMeld(a, b);
+        }
+        a->heapNext = paired; /* Chain the pairs in reverse order */
+        paired = a;
+    }
+
+    if(!paired)
+        return NULL;
+    UA_TimerCallbackEntry *root = paired;
+    paired = paired->heapNext;
+    root->heapNext = NULL;
+    while(paired) {
+        UA_TimerCallbackEntry *next = paired->heapNext;
+        paired->heapNext = NULL;
+        root = heapMeld(root, paired);
+        paired = next;
+    }
+    root->heapPrev = NULL;
+    return root;
+}
+
+static void
+heapInsert(UA_Timer *t, UA_TimerCallbackEntry *tc) {
+    tc->heapChild = tc->heapNext = tc->heapPrev = NULL;
+    t->root = t->root ? heapMeld(t->root, tc) : tc;
+}
+
+static void
+heapRemove(UA_Timer *t, UA_TimerCallbackEntry *tc) {
+    UA_TimerCallbackEntry *sub = heapMergePairs(tc->heapChild);
+    if(tc == t->root) {
+        t->root = sub;
+        return;
+    }
+
+    /* Detach from the parent or the previous sibling */
+    if(tc->heapPrev->heapChild == tc)
+        tc->heapPrev->heapChild = tc->heapNext;
+    else
+        tc->heapPrev->heapNext = tc->heapNext;
+    if(tc->heapNext)
+        tc->heapNext->heapPrev = tc->heapPrev;
+    if(sub)
+        t->root = heapMeld(t->root, sub);
+}
+
+/**********/
+/* Blocks */
+/**********/
+
+static UA_TimerCallbackEntry *
+getBlockHead(UA_Timer *t, UA_UInt64 interval) {
+    UA_TimerHashEntry *e = UA_TimerHash_find(&t->blockIndex, interval);
+    if(!e)
+        return NULL;
+    return container_of(e, UA_TimerCallbackEntry, blockEntry);
+}
+
+static void
+setBlockHead(UA_Timer *t, UA_TimerCallbackEntry *oldHead, UA_TimerCallbackEntry *tc) {
+    if(oldHead) {
+        UA_TimerHash_remove(&t->blockIndex, &oldHead->blockEntry);
+        oldHead->blockHead = false;
+    }
+    tc->blockEntry.key = tc->interval;
+    UA_TimerHash_insert(&t->blockIndex, &tc->blockEntry);
+    tc->blockHead = true;
+}
+
+static void
+removeBlockHead(UA_Timer *t, UA_TimerCallbackEntry *tc) {
+    if(!tc->blockHead)
+        return;
+    UA_TimerHash_remove(&t->blockIndex, &tc->blockEntry);
+    tc->blockHead = false;
+}
+
 void
 UA_Timer_init(UA_Timer *t) {
-    SLIST_INIT(&t->repeatedCallbacks);
+    t->root = NULL;
+    UA_TimerHash_init(&t->idIndex);
+    UA_TimerHash_init(&t->blockIndex);
     t->changes_head = (UA_TimerCallbackEntry*)&t->changes_stub;
     t->changes_tail = (UA_TimerCallbackEntry*)&t->changes_stub;
     t->changes_stub = NULL;
     t->idCounter = 0;
+    t->orderCounter = 0;
 }
 
 static void
@@ -86,19 +306,15 @@ dequeueChange(UA_Timer *t) {
 
 /* Adding repeated callbacks: Add an entry with the "nextTime" timestamp in the
  * future. This will be picked up in the next iteration and inserted at the
- * correct place. So that the next execution takes place ät "nextTime". */
-UA_StatusCode
-UA_Timer_addRepeatedCallback(UA_Timer *t, UA_TimerCallback callback,
-                             void *data, UA_UInt32 interval,
-                             UA_UInt64 *callbackId) {
+ * correct place. So that the next execution takes place ät "nextTime". The
+ * interval is given in 100ns resolution. */
+static UA_StatusCode
+addRepeatedCallback(UA_Timer *t, UA_TimerCallback callback, void *data,
+                    UA_UInt64 interval, UA_UInt64 *callbackId) {
     /* A callback method needs to be present */
     if(!callback)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* The interval needs to be at least 5ms */
-    if(interval < 5)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
     /* Allocate the repeated callback structure */
     UA_TimerCallbackEntry *tc =
         (UA_TimerCallbackEntry*)UA_malloc(sizeof(UA_TimerCallbackEntry));
@@ -106,7 +322,7 @@ UA_Timer_addRepeatedCallback(UA_Timer *t, UA_TimerCallback callback,
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Set the repeated callback */
-    tc->interval = (UA_UInt64)interval * UA_DATETIME_MSEC;
+    tc->interval = interval;
     tc->id = ++t->idCounter;
     tc->callback = callback;
     tc->data = data;
@@ -121,48 +337,70 @@ UA_Timer_addRepeatedCallback(UA_Timer *t, UA_TimerCallback callback,
     return UA_STATUSCODE_GOOD;
 }
 
-static void
-addTimerCallbackEntry(UA_Timer *t, UA_TimerCallbackEntry * UA_RESTRICT tc) {
-    /* Find the last entry before this callback */
-    UA_TimerCallbackEntry *tmpTc, *afterTc = NULL;
-    SLIST_FOREACH(tmpTc, &t->repeatedCallbacks, next) {
-        if(tmpTc->nextTime >= tc->nextTime)
-            break;
+UA_StatusCode
+UA_Timer_addRepeatedCallback(UA_Timer *t, UA_TimerCallback callback,
+                             void *data, UA_UInt32 interval,
+                             UA_UInt64 *callbackId) {
+    /* The interval needs to be at least 5ms */
+    if(interval < 5)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return addRepeatedCallback(t, callback, data,
+                               (UA_UInt64)interval * UA_DATETIME_MSEC, callbackId);
+}
 
-        /* The goal is to have many repeated callbacks with the same repetition
-         * interval in a "block" in order to reduce linear search for re-entry
-         * to the sorted list after processing. Allow the first execution to lie
-         * between "nextTime - 1s" and "nextTime" if this adjustment groups
-         * callbacks with the same repetition interval.
-         * Callbacks of a block are added in reversed order. This design allows
-         * the monitored items of a subscription (if created in a sequence with the
-         * same publish/sample interval) to be executed before the subscription
-         * publish the notifications */
-        if(tmpTc->interval == tc->interval &&
-           tmpTc->nextTime > (tc->nextTime - UA_DATETIME_SEC)) {
-            tc->nextTime = tmpTc->nextTime;
-            break;
-        }
+UA_StatusCode
+UA_Timer_addRepeatedCallbackNsec(UA_Timer *t, UA_TimerCallback callback,
+                                 void *data, UA_UInt64 interval,
+                                 UA_UInt64 *callbackId) {
+    if(interval < UA_TIMER_MININTERVAL_NSEC)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return addRepeatedCallback(t, callback, data, (interval + 50) / 100, callbackId);
+}
 
-        /* tc is neither in the same interval nor supposed to be executed sooner
-         * than tmpTc. Update afterTc to push tc further back in the timer list. */
-        afterTc = tmpTc;
+static void
+addTimerCallbackEntry(UA_Timer *t, UA_TimerCallbackEntry * UA_RESTRICT tc) {
+    /* The goal is to have many repeated callbacks with the same repetition
+     * interval in a "block". Allow the first execution to lie between
+     * "nextTime - 1s" and "nextTime" if this adjustment groups callbacks with
+     * the same repetition interval. Callbacks of a block are added in reversed
+     * order. This design allows the monitored items of a subscription (if
+     * created in a sequence with the same publish/sample interval) to be
+     * executed before the subscription publish the notifications. */
+    UA_TimerCallbackEntry *head = getBlockHead(t, tc->interval);
+    if(head && head->nextTime <= tc->nextTime &&
+       head->nextTime > (tc->nextTime - UA_DATETIME_SEC)) {
+        tc->nextTime = head->nextTime;
+        tc->order = head->order - 1;
+        setBlockHead(t, head, tc);
+    } else {
+        tc->order = ++t->orderCounter;
+        if(!head || head->nextTime < tc->nextTime)
+            setBlockHead(t, head, tc);
     }
 
     /* Add the repeated callback */
-    if(afterTc)
-        SLIST_INSERT_AFTER(afterTc, tc, next);
-    else
-        SLIST_INSERT_HEAD(&t->repeatedCallbacks, tc, next);
+    heapInsert(t, tc);
 }
 
-UA_StatusCode
-UA_Timer_changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
-                                        UA_UInt32 interval) {
-    /* The interval needs to be at least 5ms */
-    if(interval < 5)
-        return UA_STATUSCODE_BADINTERNALERROR;
+static void
+addTimerCallbackEntryIndexed(UA_Timer *t, UA_TimerCallbackEntry * UA_RESTRICT tc) {
+    tc->blockHead = false;
+    tc->idEntry.key = tc->id;
+    UA_TimerHash_insert(&t->idIndex, &tc->idEntry);
+    addTimerCallbackEntry(t, tc);
+}
 
+static UA_TimerCallbackEntry *
+findTimerCallbackEntry(UA_Timer *t, UA_UInt64 callbackId) {
+    UA_TimerHashEntry *e = UA_TimerHash_find(&t->idIndex, callbackId);
+    if(!e)
+        return NULL;
+    return container_of(e, UA_TimerCallbackEntry, idEntry);
+}
+
+static UA_StatusCode
+changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
+                               UA_UInt64 interval) {
     /* Allocate the repeated callback structure */
     UA_TimerCallbackEntry *tc =
         (UA_TimerCallbackEntry*)UA_malloc(sizeof(UA_TimerCallbackEntry));
@@ -170,7 +408,7 @@ UA_Timer_changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Set the repeated callback */
-    tc->interval = (UA_UInt64)interval * UA_DATETIME_MSEC;
+    tc->interval = interval;
     tc->id = callbackId;
     tc->nextTime = UA_DateTime_nowMonotonic() + (UA_DateTime)tc->interval;
     tc->callback = (UA_TimerCallback)CHANGE_SENTINEL;
@@ -180,23 +418,33 @@ UA_Timer_changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Timer_changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
+                                        UA_UInt32 interval) {
+    /* The interval needs to be at least 5ms */
+    if(interval < 5)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return changeRepeatedCallbackInterval(t, callbackId,
+                                          (UA_UInt64)interval * UA_DATETIME_MSEC);
+}
+
+UA_StatusCode
+UA_Timer_changeRepeatedCallbackIntervalNsec(UA_Timer *t, UA_UInt64 callbackId,
+                                            UA_UInt64 interval) {
+    if(interval < UA_TIMER_MININTERVAL_NSEC)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return changeRepeatedCallbackInterval(t, callbackId, (interval + 50) / 100);
+}
+
 static void
 changeTimerCallbackEntryInterval(UA_Timer *t, UA_UInt64 callbackId,
                                  UA_UInt64 interval, UA_DateTime nextTime) {
-    /* Remove from the sorted list */
-    UA_TimerCallbackEntry *tc, *prev = NULL;
-    SLIST_FOREACH(tc, &t->repeatedCallbacks, next) {
-        if(callbackId == tc->id) {
-            if(prev)
-                SLIST_REMOVE_AFTER(prev, next);
-            else
-                SLIST_REMOVE_HEAD(&t->repeatedCallbacks, next);
-            break;
-        }
-        prev = tc;
-    }
+    /* Remove from the heap */
+    UA_TimerCallbackEntry *tc = findTimerCallbackEntry(t, callbackId);
     if(!tc)
         return;
+    heapRemove(t, tc);
+    removeBlockHead(t, tc);
 
     /* Adjust settings */
     tc->interval = interval;
@@ -208,7 +456,7 @@ changeTimerCallbackEntryInterval(UA_Timer *t, UA_UInt64 callbackId,
 
 /* Removing a repeated callback: Add an entry with the "nextTime" timestamp set
  * to UA_INT64_MAX. The next iteration picks this up and removes the repated
- * callback from the linked list. */
+ * callback from the heap. */
 UA_StatusCode
 UA_Timer_removeRepeatedCallback(UA_Timer *t, UA_UInt64 callbackId) {
     /* Allocate the repeated callback structure */
@@ -228,18 +476,13 @@ UA_Timer_removeRepeatedCallback(UA_Timer *t, UA_UInt64 callbackId) {
 
 static void
 removeRepeatedCallback(UA_Timer *t, UA_UInt64 callbackId) {
-    UA_TimerCallbackEntry *tc, *prev = NULL;
-    SLIST_FOREACH(tc, &t->repeatedCallbacks, next) {
-        if(callbackId == tc->id) {
-            if(prev)
-                SLIST_REMOVE_AFTER(prev, next);
-            else
-                SLIST_REMOVE_HEAD(&t->repeatedCallbacks, next);
-            UA_free(tc);
-            break;
-        }
-        prev = tc;
-    }
+    UA_TimerCallbackEntry *tc = findTimerCallbackEntry(t, callbackId);
+    if(!tc)
+        return;
+    heapRemove(t, tc);
+    removeBlockHead(t, tc);
+    UA_TimerHash_remove(&t->idIndex, &tc->idEntry);
+    UA_free(tc);
 }
 
 /* Process the changes that were added to the MPSC queue (by other threads) */
@@ -258,7 +501,7 @@ processChanges(UA_Timer *t) {
             UA_free(change);
             break;
         default:
-            addTimerCallbackEntry(t, change);
+            addTimerCallbackEntryIndexed(t, change);
         }
     }
 }
@@ -270,37 +513,11 @@ UA_Timer_process(UA_Timer *t, UA_DateTime nowMonotonic,
     /* Insert and remove callbacks */
     processChanges(t);
 
-    /* Find the last callback to be executed now */
-    UA_TimerCallbackEntry *firstAfter, *lastNow = NULL;
-    SLIST_FOREACH(firstAfter, &t->repeatedCallbacks, next) {
-        if(firstAfter->nextTime > nowMonotonic)
-            break;
-        lastNow = firstAfter;
-    }
-
-    /* Nothing to do */
-    if(!lastNow) {
-        if(firstAfter)
-            return firstAfter->nextTime;
-        return UA_INT64_MAX;
-    }
-
-    /* Put the callbacks that are executed now in a separate list */
-    UA_TimerCallbackList executedNowList;
-    executedNowList.slh_first = SLIST_FIRST(&t->repeatedCallbacks);
-    lastNow->next.sle_next = NULL;
-
-    /* Fake entry to represent the first element in the newly-sorted list */
-    UA_TimerCallbackEntry tmp_first;
-    tmp_first.nextTime = nowMonotonic - 1; /* never matches for last_dispatched */
-    tmp_first.next.sle_next = firstAfter;
-    UA_TimerCallbackEntry *last_dispatched = &tmp_first;
-
-    /* Iterate over the list of callbacks to process now */
+    /* Execute the callbacks in the order of the heap. Callbacks are
+     * rescheduled to the future. So the loop terminates. */
     UA_TimerCallbackEntry *tc;
-    while((tc = SLIST_FIRST(&executedNowList))) {
-        /* Remove from the list */
-        SLIST_REMOVE_HEAD(&executedNowList, next);
+    while((tc = t->root) && tc->nextTime <= nowMonotonic) {
+        heapRemove(t, tc);
 
         /* Dispatch/process callback */
         dispatchCallback(application, tc->callback, tc->data);
@@ -311,51 +528,24 @@ UA_Timer_process(UA_Timer *t, UA_DateTime nowMonotonic,
         if(tc->nextTime < nowMonotonic)
             tc->nextTime = nowMonotonic + 1;
 
-        /* Find the new position for tc to keep the list sorted */
-        UA_TimerCallbackEntry *prev_tc;
-        if(last_dispatched->nextTime == tc->nextTime) {
-            /* We try to "batch" repeatedCallbacks with the same interval. This
-             * saves a linear search when the last dispatched entry has the same
-             * nextTime timestamp as this entry. */
-            UA_assert(last_dispatched != &tmp_first);
-            prev_tc = last_dispatched;
-        } else {
-            /* Find the position for the next execution by a linear search
-             * starting at last_dispatched or the first element */
-            if(last_dispatched->nextTime < tc->nextTime)
-                prev_tc = last_dispatched;
-            else
-                prev_tc = &tmp_first;
-
-            while(true) {
-                UA_TimerCallbackEntry *n = SLIST_NEXT(prev_tc, next);
-                if(!n || n->nextTime >= tc->nextTime)
-                    break;
-                prev_tc = n;
-            }
-        }
-
-        /* Update last_dispatched to make sure batched callbacks are added in the
-         * same sequence as before they were executed and to save some iterations
-         * of the linear search for callbacks to be added further back in the list. */
-        last_dispatched = tc;
-
-        /* Add entry to the new position in the sorted list */
-        SLIST_INSERT_AFTER(prev_tc, tc, next);
+        /* Rescheduled callbacks keep the order in which they were executed. The
+         * first callback of a block becomes the head of the latest block for
+         * its interval. */
+        tc->order = ++t->orderCounter;
+        UA_TimerCallbackEntry *head = getBlockHead(t, tc->interval);
+        if(!head || head->nextTime < tc->nextTime)
+            setBlockHead(t, head, tc);
+        heapInsert(t, tc);
     }
 
-    /* Set the entry-point for the newly sorted list */
-    t->repeatedCallbacks.slh_first = tmp_first.next.sle_next;
-
     /* Re-repeat processAddRemoved since one of the callbacks might have removed
      * or added a callback. So we return a correct timeout. */
     processChanges(t);
 
     /* Return timestamp of next repetition */
-    tc = SLIST_FIRST(&t->repeatedCallbacks);
-    if(!tc)
+    if(!t->root)
         return UA_INT64_MAX; /* Main-loop has a max timeout / will continue earlier */
-    return tc->nextTime;
+    return t->root->nextTime;
 }
 
 void
@@ -364,9 +554,16 @@ UA_Timer_deleteMembers(UA_Timer *t) {
     processChanges(t);
 
     /* Remove repeated callbacks */
-    UA_TimerCallbackEntry *current;
-    while((current = SLIST_FIRST(&t->repeatedCallbacks))) {
-        SLIST_REMOVE_HEAD(&t->repeatedCallbacks, next);
-        UA_free(current);
+    UA_TimerHash *h = &t->idIndex;
+    for(size_t i = 0; i < h->size; i++) {
+        UA_TimerHashEntry *e = h->buckets ? h->buckets[i] : h->single;
+        while(e) {
+            UA_TimerHashEntry *next = e->next;
+            UA_free(container_of(e, UA_TimerCallbackEntry, idEntry));
+            e = next;
+        }
     }
+    UA_TimerHash_deleteMembers(&t->idIndex);
+    UA_TimerHash_deleteMembers(&t->blockIndex);
+    t->root = NULL;
 }
@@ -19,24 +19,45 @@ extern "C" {
  * removing and changing repeated callbacks can be done from independent
  * threads. Processing the changes and dispatching callbacks must be done by a
  * single "mainloop" process.
- * Timer callbacks with the same recurring interval are batched into blocks in
- * order to reduce linear search for re-entry to the sorted list after processing.
- * Callbacks are inserted in reversed order (last callback are put first in the block)
- * to allow the monitored items of a subscription (if created in a sequence with the
- * same publish/sample interval) to be executed before the subscription publish the
- * notifications. When callbacks are entered to the timer list after execution they
- * are added in the same order as before execution. */
+ * Timer callbacks with the same recurring interval are batched into blocks
+ * that share the execution timestamp. Callbacks are inserted in reversed order
+ * (last callback are put first in the block) to allow the monitored items of a
+ * subscription (if created in a sequence with the same publish/sample
+ * interval) to be executed before the subscription publish the notifications.
+ * When callbacks are rescheduled after execution they keep the same order as
+ * before execution.
+ * The callbacks are kept in a pairing heap ordered by the execution timestamp
+ * and the position within the block. Callbacks are found by their identifier
+ * in a hash map. So adding and removing callbacks is O(log n) amortized. */
 
 /* Forward declaration */
 struct UA_TimerCallbackEntry;
 typedef struct UA_TimerCallbackEntry UA_TimerCallbackEntry;
 
-/* Linked-list definition */
-typedef SLIST_HEAD(UA_TimerCallbackList, UA_TimerCallbackEntry) UA_TimerCallbackList;
+/* Intrusive hash map with chaining. Entries are keyed by an integer. Without
+ * allocated buckets, the single inline bucket is used. */
+typedef struct UA_TimerHashEntry {
+    struct UA_TimerHashEntry *next;
+    UA_UInt64 key;
+} UA_TimerHashEntry;
 
 typedef struct {
-    /* The linked list of callbacks is sorted according to the execution timestamp. */
-    UA_TimerCallbackList repeatedCallbacks;
+    UA_TimerHashEntry **buckets;
+    UA_TimerHashEntry *single;
+    size_t size;  /* Power of two */
+    size_t count;
+} UA_TimerHash;
+
+typedef struct {
+    /* The root of the heap of callbacks. The root is executed next. */
+    UA_TimerCallbackEntry *root;
+
+    /* Callbacks by their identifier */
+    UA_TimerHash idIndex;
+
+    /* The first callback of the latest block for every interval. New
+     * callbacks with the same interval are grouped into that block. */
+    UA_TimerHash blockIndex;
 
     /* Changes to the repeated callbacks in a multi-producer single-consumer queue */
     UA_TimerCallbackEntry * volatile changes_head;
@@ -44,6 +65,7 @@ typedef struct {
     UA_TimerCallbackEntry *changes_stub;
 
     UA_UInt64 idCounter;
+    UA_Int64 orderCounter;
 } UA_Timer;
 
 /* Initialize the Timer. Not thread-safe. */
@@ -63,6 +85,19 @@ UA_StatusCode
 UA_Timer_changeRepeatedCallbackInterval(UA_Timer *t, UA_UInt64 callbackId,
                                         UA_UInt32 interval);
 
+/* Variants with the interval in nanoseconds for cycles below one millisecond
+ * (e.g. PubSub). The interval is rounded to the 100ns resolution of
+ * UA_DateTime and needs to be at least UA_TIMER_MININTERVAL_NSEC. */
+#define UA_TIMER_MININTERVAL_NSEC 100000
+
+UA_StatusCode
+UA_Timer_addRepeatedCallbackNsec(UA_Timer *t, UA_TimerCallback callback, void *data,
+                                 UA_UInt64 interval, UA_UInt64 *callbackId);
+
+UA_StatusCode
+UA_Timer_changeRepeatedCallbackIntervalNsec(UA_Timer *t, UA_UInt64 callbackId,
+                                            UA_UInt64 interval);
+
 /* Remove a repated callback. Thread-safe, can be used in parallel and in
  * parallel with UA_Timer_process. */
 UA_StatusCode
@@ -1038,6 +1038,238 @@ UA_delete(void *p, const UA_DataType *type) {
     UA_free(p);
 }
 
+/************/
+/* Equality */
+/************/
+
+static UA_Boolean equal_noInit(const void *p1, const void *p2, const UA_DataType *type);
+
+/* Types without pointers and padding are compared bytewise */
+static UA_Boolean
+isMemoryComparable(const UA_DataType *type) {
+    return type->overlayable || (type->builtin && type->pointerFree);
+}
+
+static UA_Boolean
+equalMemory(const void *p1, const void *p2, const UA_DataType *type) {
+    return (memcmp(p1, p2, type->memSize) == 0);
+}
+
+static UA_Boolean
+arrayEqual(const void *a1, size_t size1, const void *a2, size_t size2,
+           const UA_DataType *type) {
+    if(size1 != size2)
+        return false;
+    /* Distinguish the undefined array (NULL) from the empty array */
+    if(size1 == 0)
+        return ((a1 == NULL) == (a2 == NULL));
+    if(isMemoryComparable(type))
+        return (memcmp(a1, a2, size1 * type->memSize) == 0);
+    uintptr_t ptr1 = (uintptr_t)a1;
+    uintptr_t ptr2 = (uintptr_t)a2;
+    for(size_t i = 0; i < size1; i++) {
+        if(!equal_noInit((const void*)ptr1, (const void*)ptr2, type))
+            return false;
+        ptr1 += type->memSize;
+        ptr2 += type->memSize;
+    }
+    return true;
+}
+
+static UA_Boolean
+String_equalNull(const UA_String *s1, const UA_String *s2, const UA_DataType *_) {
+    return arrayEqual(s1->data, s1->length, s2->data, s2->length,
+                      &UA_TYPES[UA_TYPES_BYTE]);
+}
+
+static UA_Boolean
+NodeId_equalType(const UA_NodeId *n1, const UA_NodeId *n2, const UA_DataType *_) {
+    return UA_NodeId_equal(n1, n2);
+}
+
+static UA_Boolean
+ExpandedNodeId_equalType(const UA_ExpandedNodeId *n1, const UA_ExpandedNodeId *n2,
+                         const UA_DataType *_) {
+    return (n1->serverIndex == n2->serverIndex &&
+            String_equalNull(&n1->namespaceUri, &n2->namespaceUri, NULL) &&
+            UA_NodeId_equal(&n1->nodeId, &n2->nodeId));
+}
+
+static UA_Boolean
+QualifiedName_equalType(const UA_QualifiedName *q1, const UA_QualifiedName *q2,
+                        const UA_DataType *_) {
+    return (q1->namespaceIndex == q2->namespaceIndex &&
+            String_equalNull(&q1->name, &q2->name, NULL));
+}
+
+static UA_Boolean
+LocalizedText_equal(const UA_LocalizedText *l1, const UA_LocalizedText *l2,
+                    const UA_DataType *_) {
+    return (String_equalNull(&l1->locale, &l2->locale, NULL) &&
+            String_equalNull(&l1->text, &l2->text, NULL));
+}
+
+static UA_Boolean
+ExtensionObject_equal(const UA_ExtensionObject *e1, const UA_ExtensionObject *e2,
+                      const UA_DataType *_) {
+    UA_Boolean decoded1 = (e1->encoding >= UA_EXTENSIONOBJECT_DECODED);
+    UA_Boolean decoded2 = (e2->encoding >= UA_EXTENSIONOBJECT_DECODED);
+    if(decoded1 != decoded2)
+        return false;
+    if(!decoded1)
+        return (e1->encoding == e2->encoding &&
+                UA_NodeId_equal(&e1->content.encoded.typeId, &e2->content.encoded.typeId) &&
+                String_equalNull(&e1->content.encoded.body, &e2->content.encoded.body, NULL));
+    if(e1->content.decoded.type != e2->content.decoded.type)
+        return false;
+    if(!e1->content.decoded.data || !e2->content.decoded.data)
+        return (e1->content.decoded.data == e2->content.decoded.data);
+    return equal_noInit(e1->content.decoded.data, e2->content.decoded.data,
+                        e1->content.decoded.type);
+}
+
+static UA_Boolean
+Variant_equal(const UA_Variant *v1, const UA_Variant *v2, const UA_DataType *_) {
+    if(v1->type != v2->type)
+        return false;
+    if(!v1->type)
+        return true; /* Both empty */
+    if(!arrayEqual(v1->arrayDimensions, v1->arrayDimensionsSize,
+                   v2->arrayDimensions, v2->arrayDimensionsSize,
+                   &UA_TYPES[UA_TYPES_UINT32]))
+        return false;
+    UA_Boolean scalar1 = UA_Variant_isScalar(v1);
+    if(scalar1 != UA_Variant_isScalar(v2))
+        return false;
+    if(scalar1)
+        return equal_noInit(v1->data, v2->data, v1->type);
+    return arrayEqual(v1->data, v1->arrayLength, v2->data, v2->arrayLength, v1->type);
+}
+
+static UA_Boolean
+DataValue_equal(const UA_DataValue *d1, const UA_DataValue *d2, const UA_DataType *_) {
+    if(d1->hasValue != d2->hasValue ||
+       d1->hasStatus != d2->hasStatus ||
+       d1->hasSourceTimestamp != d2->hasSourceTimestamp ||
+       d1->hasServerTimestamp != d2->hasServerTimestamp ||
+       d1->hasSourcePicoseconds != d2->hasSourcePicoseconds ||
+       d1->hasServerPicoseconds != d2->hasServerPicoseconds)
+        return false;
+    if(d1->hasStatus && d1->status != d2->status)
+        return false;
+    if(d1->hasSourceTimestamp && d1->sourceTimestamp != d2->sourceTimestamp)
+        return false;
+    if(d1->hasServerTimestamp && d1->serverTimestamp != d2->serverTimestamp)
+        return false;
+    if(d1->hasSourcePicoseconds && d1->sourcePicoseconds != d2->sourcePicoseconds)
+        return false;
+    if(d1->hasServerPicoseconds && d1->serverPicoseconds != d2->serverPicoseconds)
+        return false;
+    /* Compare the value last */
+    return (!d1->hasValue || Variant_equal(&d1->value, &d2->value, NULL));
+}
+
+static UA_Boolean
+DiagnosticInfo_equal(const UA_DiagnosticInfo *d1, const UA_DiagnosticInfo *d2,
+                     const UA_DataType *_) {
+    if(d1->hasSymbolicId != d2->hasSymbolicId ||
+       d1->hasNamespaceUri != d2->hasNamespaceUri ||
+       d1->hasLocalizedText != d2->hasLocalizedText ||
+       d1->hasLocale != d2->hasLocale ||
+       d1->hasAdditionalInfo != d2->hasAdditionalInfo ||
+       d1->hasInnerStatusCode != d2->hasInnerStatusCode ||
+       d1->hasInnerDiagnosticInfo != d2->hasInnerDiagnosticInfo)
+        return false;
+    if((d1->hasSymbolicId && d1->symbolicId != d2->symbolicId) ||
+       (d1->hasNamespaceUri && d1->namespaceUri != d2->namespaceUri) ||
+       (d1->hasLocalizedText && d1->localizedText != d2->localizedText) ||
+       (d1->hasLocale && d1->locale != d2->locale) ||
+       (d1->hasInnerStatusCode && d1->innerStatusCode != d2->innerStatusCode))
+        return false;
+    if(d1->hasAdditionalInfo &&
+       !String_equalNull(&d1->additionalInfo, &d2->additionalInfo, NULL))
+        return false;
+    if(!d1->hasInnerDiagnosticInfo)
+        return true;
+    if(!d1->innerDiagnosticInfo || !d2->innerDiagnosticInfo)
+        return (d1->innerDiagnosticInfo == d2->innerDiagnosticInfo);
+    return DiagnosticInfo_equal(d1->innerDiagnosticInfo, d2->innerDiagnosticInfo, NULL);
+}
+
+typedef UA_Boolean (*UA_equalSignature)(const void *p1, const void *p2,
+                                        const UA_DataType *type);
+
+static const UA_equalSignature equalJumpTable[UA_BUILTIN_TYPES_COUNT + 1] = {
+    (UA_equalSignature)equalMemory, // Boolean
+    (UA_equalSignature)equalMemory, // SByte
+    (UA_equalSignature)equalMemory, // Byte
+    (UA_equalSignature)equalMemory, // Int16
+    (UA_equalSignature)equalMemory, // UInt16
+    (UA_equalSignature)equalMemory, // Int32
+    (UA_equalSignature)equalMemory, // UInt32
+    (UA_equalSignature)equalMemory, // Int64
+    (UA_equalSignature)equalMemory, // UInt64
+    (UA_equalSignature)equalMemory, // Float
+    (UA_equalSignature)equalMemory, // Double
+    (UA_equalSignature)String_equalNull, // String
+    (UA_equalSignature)equalMemory, // DateTime
+    (UA_equalSignature)equalMemory, // Guid
+    (UA_equalSignature)String_equalNull, // ByteString
+    (UA_equalSignature)String_equalNull, // XmlElement
+    (UA_equalSignature)NodeId_equalType,
+    (UA_equalSignature)ExpandedNodeId_equalType,
+    (UA_equalSignature)equalMemory, // StatusCode
+    (UA_equalSignature)QualifiedName_equalType,
+    (UA_equalSignature)LocalizedText_equal,
+    (UA_equalSignature)ExtensionObject_equal,
+    (UA_equalSignature)DataValue_equal,
+    (UA_equalSignature)Variant_equal,
+    (UA_equalSignature)DiagnosticInfo_equal,
+    (UA_equalSignature)equal_noInit // all others
+};
+
+static UA_Boolean
+equal_noInit(const void *p1, const void *p2, const UA_DataType *type) {
+    if(type->builtin)
+        return equalJumpTable[type->typeIndex](p1, p2, type);
+    if(isMemoryComparable(type))
+        return equalMemory(p1, p2, type);
+    uintptr_t ptr1 = (uintptr_t)p1;
+    uintptr_t ptr2 = (uintptr_t)p2;
+    u8 membersSize = type->membersSize;
+    for(size_t i = 0; i < membersSize; ++i) {
+        const UA_DataTypeMember *m = &type->members[i];
+        const UA_DataType *typelists[2] = { UA_TYPES, &type[-type->typeIndex] };
+        const UA_DataType *mt = &typelists[!m->namespaceZero][m->memberTypeIndex];
+        ptr1 += m->padding;
+        ptr2 += m->padding;
+        if(!m->isArray) {
+            size_t fi = mt->builtin ? mt->typeIndex : UA_BUILTIN_TYPES_COUNT;
+            if(!equalJumpTable[fi]((const void*)ptr1, (const void*)ptr2, mt))
+                return false;
+            ptr1 += mt->memSize;
+            ptr2 += mt->memSize;
+        } else {
+            size_t size1 = *(const size_t*)ptr1;
+            size_t size2 = *(const size_t*)ptr2;
+            ptr1 += sizeof(size_t);
+            ptr2 += sizeof(size_t);
+            if(!arrayEqual(*(void* const*)ptr1, size1, *(void* const*)ptr2, size2, mt))
+                return false;
+            ptr1 += sizeof(void*);
+            ptr2 += sizeof(void*);
+        }
+    }
+    return true;
+}
+
+UA_Boolean
+UA_equal(const void *p1, const void *p2, const UA_DataType *type) {
+    if(p1 == p2)
+        return true;
+    return equal_noInit(p1, p2, type);
+}
+
 /******************/
 /* Array Handling */
 /******************/
@@ -48,6 +48,8 @@ typedef struct {
 
     UA_exchangeEncodeBuffer exchangeBufferCallback;
     void *exchangeBufferCallbackHandle;
+
+    UA_DecodeArena *arena; /* Decoding only. Allocate from the heap if NULL */
 } Ctx;
 
 typedef status (*encodeBinarySignature)(const void *UA_RESTRICT src, const UA_DataType *type,
@@ -107,6 +109,120 @@ static status exchangeBuffer(Ctx *ctx) {
     return ctx->exchangeBufferCallback(ctx->exchangeBufferCallbackHandle, &ctx->pos, &ctx->end);
 }
 
+/**
+ * Decode Arena
+ * ^^^^^^^^^^^^
+ * When decoding into an arena, the memory for the members is taken from large
+ * blocks with a bump pointer. Memory in the arena is never freed individually.
+ * So values that are only used temporarily during decoding (e.g. the binary
+ * encoding NodeId of an ExtensionObject) are not deleted and the decoding
+ * methods use the following wrappers instead of the heap methods. */
+
+struct UA_DecodeArenaBlock {
+    UA_DecodeArenaBlock *next;
+    size_t size; /* Usable size after the (aligned) header */
+    size_t used;
+};
+
+#define UA_DECODEARENA_ALIGN (2 * sizeof(void*))
+#define UA_DECODEARENA_ALIGNED(SIZE) \
+    (((SIZE) + UA_DECODEARENA_ALIGN - 1) & ~(UA_DECODEARENA_ALIGN - 1))
+#define UA_DECODEARENA_HEADER UA_DECODEARENA_ALIGNED(sizeof(UA_DecodeArenaBlock))
+
+void
+UA_DecodeArena_init(UA_DecodeArena *arena, size_t blockSize) {
+    arena->blocks = NULL;
+    arena->blockSize = blockSize;
+    arena->aliasBuffer = false;
+}
+
+void *
+UA_DecodeArena_alloc(UA_DecodeArena *arena, size_t size) {
+    if(size > SIZE_MAX - UA_DECODEARENA_HEADER - UA_DECODEARENA_ALIGN)
+        return NULL;
+    size = UA_DECODEARENA_ALIGNED(size);
+    if(size == 0)
+        size = UA_DECODEARENA_ALIGN; /* Always return a distinct pointer */
+
+    UA_DecodeArenaBlock *block = arena->blocks;
+    if(!block || block->size - block->used < size) {
+        /* Allocations of more than half the next block size (e.g. large
+         * arrays) get a block of their own behind the current block. The
+         * current block remains in use and the block size does not grow. */
+        UA_Boolean dedicated = (size > arena->blockSize / 2);
+        size_t blockSize = dedicated ? size : arena->blockSize;
+        /* calloc'ed memory is already zeroed. The bump pointer never hands out
+         * the same memory twice. */
+        UA_DecodeArenaBlock *newBlock = (UA_DecodeArenaBlock*)
+            UA_calloc(1, UA_DECODEARENA_HEADER + blockSize);
+        if(!newBlock)
+            return NULL;
+        newBlock->size = blockSize;
+        if(dedicated && block) {
+            newBlock->used = size;
+            newBlock->next = block->next;
+            block->next = newBlock;
+            return (u8*)newBlock + UA_DECODEARENA_HEADER;
+        }
+
+        /* Add a block. The remainder of the current block is not used
+         * further. The next block is twice as large. */
+        newBlock->next = block;
+        arena->blocks = newBlock;
+        block = newBlock;
+        if(!dedicated && arena->blockSize <= (SIZE_MAX - UA_DECODEARENA_HEADER) / 2)
+            arena->blockSize *= 2;
+    }
+
+    void *p = (u8*)block + UA_DECODEARENA_HEADER + block->used;
+    block->used += size;
+    return p;
+}
+
+void
+UA_DecodeArena_clear(UA_DecodeArena *arena) {
+    UA_DecodeArenaBlock *block = arena->blocks;
+    while(block) {
+        UA_DecodeArenaBlock *next = block->next;
+        UA_free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
+
+static void *
+ctxCalloc(Ctx *ctx, size_t nmemb, size_t size) {
+    if(!ctx->arena)
+        return UA_calloc(nmemb, size);
+    if(size > 0 && nmemb > SIZE_MAX / size)
+        return NULL;
+    return UA_DecodeArena_alloc(ctx->arena, nmemb * size);
+}
+
+static void
+ctxDeleteMembers(Ctx *ctx, void *p, const UA_DataType *type) {
+    if(!ctx->arena)
+        UA_deleteMembers(p, type);
+}
+
+/**
+ * Overlayable Runs
+ * ^^^^^^^^^^^^^^^^
+ * Members of a structure that are overlayable and follow each other without
+ * padding have the identical memory layout in memory and on the binary stream.
+ * The generated type descriptions mark such runs in the first member. They are
+ * en- and decoded with a single memcpy instead of dispatching every member
+ * through the jumptable. */
+
+static size_t
+overlayableRunSize(const UA_DataTypeMember *member,
+                   const UA_DataType *const *typelists) {
+    size_t size = 0;
+    for(size_t i = 0; i < member->overlayableRun; ++i)
+        size += typelists[!member[i].namespaceZero][member[i].memberTypeIndex].memSize;
+    return size;
+}
+
 /* If encoding fails, exchange the buffer and try again. It is assumed that the
  * following encoding never fails on a fresh buffer. This is true for numerical
  * types. */
@@ -514,15 +630,29 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
     if(ctx->pos + ((type->memSize * length) / 32) > ctx->end)
         return UA_STATUSCODE_BADDECODINGERROR;
 
+    /* Point into the buffer without copying. The arena does not free the array
+     * later on. Only alias arrays whose members are aligned in the buffer. */
+    if(type->overlayable && ctx->arena && ctx->arena->aliasBuffer &&
+       ((type->memSize & (type->memSize - 1)) == 0) &&
+       ((uintptr_t)ctx->pos & (type->memSize - 1)) == 0) {
+        if(ctx->end < ctx->pos + (type->memSize * length))
+            return UA_STATUSCODE_BADDECODINGERROR;
+        *dst = ctx->pos;
+        ctx->pos += type->memSize * length;
+        *out_length = length;
+        return UA_STATUSCODE_GOOD;
+    }
+
     /* Allocate memory */
-    *dst = UA_calloc(length, type->memSize);
+    *dst = ctxCalloc(ctx, length, type->memSize);
     if(!*dst)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     if(type->overlayable) {
         /* memcpy overlayable array */
         if(ctx->end < ctx->pos + (type->memSize * length)) {
-            UA_free(*dst);
+            if(!ctx->arena)
+                UA_free(*dst);
             *dst = NULL;
             return UA_STATUSCODE_BADDECODINGERROR;
         }
@@ -536,7 +666,8 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
             ret = decodeBinaryJumpTable[decode_index]((void*)ptr, type, ctx);
             if(ret != UA_STATUSCODE_GOOD) {
                 /* +1 because last element is also already initialized */
-                UA_Array_delete(*dst, i+1, type);
+                if(!ctx->arena)
+                    UA_Array_delete(*dst, i+1, type);
                 *dst = NULL;
                 return ret;
             }
@@ -912,12 +1043,15 @@ ExtensionObject_decodeBinaryContent(UA_ExtensionObject *dst, const UA_NodeId *ty
     /* Unknown type, just take the binary content */
     if(!type) {
         dst->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
-        UA_NodeId_copy(typeId, &dst->content.encoded.typeId);
+        if(ctx->arena)
+            dst->content.encoded.typeId = *typeId; /* Lives in the arena */
+        else
+            UA_NodeId_copy(typeId, &dst->content.encoded.typeId);
         return DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
     }
 
     /* Allocate memory */
-    dst->content.decoded.data = UA_new(type);
+    dst->content.decoded.data = ctxCalloc(ctx, 1, type->memSize);
     if(!dst->content.decoded.data)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -943,13 +1077,13 @@ DECODE_BINARY(ExtensionObject) {
     ret |= DECODE_DIRECT(&binTypeId, NodeId);
     ret |= DECODE_DIRECT(&encoding, Byte);
     if(ret != UA_STATUSCODE_GOOD) {
-        UA_NodeId_deleteMembers(&binTypeId);
+        ctxDeleteMembers(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
         return ret;
     }
 
     if(encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING) {
         ret = ExtensionObject_decodeBinaryContent(dst, &binTypeId, ctx);
-        UA_NodeId_deleteMembers(&binTypeId);
+        ctxDeleteMembers(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
     } else if(encoding == UA_EXTENSIONOBJECT_ENCODED_NOBODY) {
         dst->encoding = (UA_ExtensionObjectEncoding)encoding;
         dst->content.encoded.typeId = binTypeId; /* move to dst */
@@ -959,9 +1093,10 @@ DECODE_BINARY(ExtensionObject) {
         dst->content.encoded.typeId = binTypeId; /* move to dst */
         ret = DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
         if(ret != UA_STATUSCODE_GOOD)
-            UA_NodeId_deleteMembers(&dst->content.encoded.typeId);
+            ctxDeleteMembers(ctx, &dst->content.encoded.typeId,
+                             &UA_TYPES[UA_TYPES_NODEID]);
     } else {
-        UA_NodeId_deleteMembers(&binTypeId);
+        ctxDeleteMembers(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
         ret = UA_STATUSCODE_BADDECODINGERROR;
     }
 
@@ -1076,7 +1211,7 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     u8 encoding;
     ret = DECODE_DIRECT(&encoding, Byte);
     if(ret != UA_STATUSCODE_GOOD) {
-        UA_NodeId_deleteMembers(&typeId);
+        ctxDeleteMembers(ctx, &typeId, &UA_TYPES[UA_TYPES_NODEID]);
         return ret;
     }
 
@@ -1089,11 +1224,11 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
         /* Reset and decode as ExtensionObject */
         dst->type = &UA_TYPES[UA_TYPES_EXTENSIONOBJECT];
         ctx->pos = old_pos;
-        UA_NodeId_deleteMembers(&typeId);
+        ctxDeleteMembers(ctx, &typeId, &UA_TYPES[UA_TYPES_NODEID]);
     }
 
     /* Allocate memory */
-    dst->data = UA_new(dst->type);
+    dst->data = ctxCalloc(ctx, 1, dst->type->memSize);
     if(!dst->data)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -1138,7 +1273,7 @@ DECODE_BINARY(Variant) {
     if(isArray) {
         ret = Array_decodeBinary(&dst->data, &dst->arrayLength, dst->type, ctx);
     } else if(typeIndex != UA_TYPES_EXTENSIONOBJECT) {
-        dst->data = UA_new(dst->type);
+        dst->data = ctxCalloc(ctx, 1, dst->type->memSize);
         if(!dst->data)
             return UA_STATUSCODE_BADOUTOFMEMORY;
         ret = decodeBinaryJumpTable[typeIndex](dst->data, dst->type, ctx);
@@ -1326,7 +1461,7 @@ DECODE_BINARY(DiagnosticInfo) {
     if(encodingMask & 0x40) {
         /* innerDiagnosticInfo is allocated on the heap */
         dst->innerDiagnosticInfo = (UA_DiagnosticInfo*)
-            UA_calloc(1, sizeof(UA_DiagnosticInfo));
+            ctxCalloc(ctx, 1, sizeof(UA_DiagnosticInfo));
         if(!dst->innerDiagnosticInfo)
             return UA_STATUSCODE_BADOUTOFMEMORY;
         dst->hasInnerDiagnosticInfo = true;
@@ -1389,6 +1524,18 @@ encodeBinaryInternal(const void *src, const UA_DataType *type, Ctx *ctx) {
     for(size_t i = 0; i < membersSize && ret == UA_STATUSCODE_GOOD; ++i) {
         const UA_DataTypeMember *member = &type->members[i];
         const UA_DataType *membertype = &typelists[!member->namespaceZero][member->memberTypeIndex];
+        if(member->overlayableRun > 1) {
+            /* Encode member-wise if the run does not fit into the buffer */
+            size_t runSize = overlayableRunSize(member, typelists);
+            if(ctx->pos + runSize <= ctx->end) {
+                ptr += member->padding;
+                memcpy(ctx->pos, (const void*)ptr, runSize);
+                ctx->pos += runSize;
+                ptr += runSize;
+                i += (size_t)member->overlayableRun - 1;
+                continue;
+            }
+        }
         if(!member->isArray) {
             ptr += member->padding;
             size_t encode_index = membertype->builtin ? membertype->typeIndex : UA_BUILTIN_TYPES_COUNT;
@@ -1486,6 +1633,19 @@ decodeBinaryInternal(void *dst, const UA_DataType *type, Ctx *ctx) {
     for(size_t i = 0; i < membersSize && ret == UA_STATUSCODE_GOOD; ++i) {
         const UA_DataTypeMember *member = &type->members[i];
         const UA_DataType *membertype = &typelists[!member->namespaceZero][member->memberTypeIndex];
+        if(member->overlayableRun > 1) {
+            size_t runSize = overlayableRunSize(member, typelists);
+            if(ctx->pos + runSize > ctx->end) {
+                ret = UA_STATUSCODE_BADDECODINGERROR;
+                break;
+            }
+            ptr += member->padding;
+            memcpy((void*)ptr, ctx->pos, runSize);
+            ctx->pos += runSize;
+            ptr += runSize;
+            i += (size_t)member->overlayableRun - 1;
+            continue;
+        }
         if(!member->isArray) {
             ptr += member->padding;
             size_t fi = membertype->builtin ? membertype->typeIndex : UA_BUILTIN_TYPES_COUNT;
@@ -1506,9 +1666,9 @@ decodeBinaryInternal(void *dst, const UA_DataType *type, Ctx *ctx) {
 }
 
 status
-UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
-                const UA_DataType *type, size_t customTypesSize,
-                const UA_DataType *customTypes) {
+UA_decodeBinaryArena(const UA_ByteString *src, size_t *offset, void *dst,
+                     const UA_DataType *type, size_t customTypesSize,
+                     const UA_DataType *customTypes, UA_DecodeArena *arena) {
     /* Set up the context */
     Ctx ctx;
     ctx.pos = &src->data[*offset];
@@ -1516,6 +1676,7 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
     ctx.depth = 0;
     ctx.customTypesArraySize = customTypesSize;
     ctx.customTypesArray = customTypes;
+    ctx.arena = arena;
 
     /* Decode */
     memset(dst, 0, type->memSize); /* Initialize the value */
@@ -1526,12 +1687,20 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
         *offset = (size_t)(ctx.pos - src->data) / sizeof(u8);
     } else {
         /* Clean up */
-        UA_deleteMembers(dst, type);
+        ctxDeleteMembers(&ctx, dst, type);
         memset(dst, 0, type->memSize);
     }
     return ret;
 }
 
+status
+UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
+                const UA_DataType *type, size_t customTypesSize,
+                const UA_DataType *customTypes) {
+    return UA_decodeBinaryArena(src, offset, dst, type, customTypesSize,
+                                customTypes, NULL);
+}
+
 /**
  * Compute the Message Size
  * ------------------------
@@ -1753,6 +1922,13 @@ UA_calcSizeBinary(const void *p, const UA_DataType *type) {
     for(size_t i = 0; i < membersSize; ++i) {
         const UA_DataTypeMember *member = &type->members[i];
         const UA_DataType *membertype = &typelists[!member->namespaceZero][member->memberTypeIndex];
+        if(member->overlayableRun > 1) {
+            size_t runSize = overlayableRunSize(member, typelists);
+            s += runSize;
+            ptr += member->padding + runSize;
+            i += (size_t)member->overlayableRun - 1;
+            continue;
+        }
         if(!member->isArray) {
             ptr += member->padding;
             size_t encode_index = membertype->builtin ? membertype->typeIndex : UA_BUILTIN_TYPES_COUNT;
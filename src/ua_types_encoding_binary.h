@@ -67,6 +67,47 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
                 const UA_DataType *type, size_t customTypesSize,
                 const UA_DataType *customTypes) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Bump allocator for request-scoped decoding. All members of a value decoded
+ * into the arena are placed in a few large blocks instead of individual heap
+ * allocations. The decoded value must not be deleted with UA_deleteMembers.
+ * Instead, the memory of all values decoded into the arena is released at once
+ * with UA_DecodeArena_clear. The first block is allocated with blockSize bytes.
+ * Every subsequent block is twice as large as the previous. Allocations larger
+ * than half the next block size get a block of their own.
+ *
+ * If aliasBuffer is set, strings, ByteStrings and (suitably aligned) arrays of
+ * overlayable types are not copied. They point directly into the decoded
+ * buffer instead. The buffer must then outlive the decoded value. Only the
+ * service requests in processMSG are decoded with aliasing. The PubSub
+ * NetworkMessage decoding allocates from the heap and the NetworkMessage is
+ * deleted member-wise (see UA_NetworkMessage_decodeBinary). */
+typedef struct UA_DecodeArenaBlock UA_DecodeArenaBlock;
+
+typedef struct {
+    UA_DecodeArenaBlock *blocks;
+    size_t blockSize;
+    UA_Boolean aliasBuffer;
+} UA_DecodeArena;
+
+void
+UA_DecodeArena_init(UA_DecodeArena *arena, size_t blockSize);
+
+/* Returns zeroed memory or NULL if out of memory */
+void *
+UA_DecodeArena_alloc(UA_DecodeArena *arena, size_t size);
+
+void
+UA_DecodeArena_clear(UA_DecodeArena *arena);
+
+/* Decodes like UA_decodeBinary. If arena is non-NULL, all memory for the
+ * members of dst is taken from the arena. If decoding fails, dst is zeroed and
+ * the memory remains in the arena until it is cleared. */
+UA_StatusCode
+UA_decodeBinaryArena(const UA_ByteString *src, size_t *offset, void *dst,
+                     const UA_DataType *type, size_t customTypesSize,
+                     const UA_DataType *customTypes,
+                     UA_DecodeArena *arena) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 /* Returns the number of bytes the value p takes in binary encoding. Returns
  * zero if an error occurs. UA_calcSizeBinary is thread-safe and reentrant since
  * it does not access global (thread-local) variables. */
@@ -0,0 +1,796 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Micro-benchmarks for the en-/decoding of representative service messages and
+ * for complete request/response round-trips through the server. Every case
+ * prints one line with a JSON object to stdout:
+ *
+ *   {"name":"ReadRequest/encodeBinary","iterations":524288,"ns_per_op":...,
+ *    "ops_per_s":...,"bytes_per_op":...,"allocs_per_op":...}
+ *
+ * Two result files can be compared with tools/bench_compare.py to detect
+ * regressions.
+ *
+ * Usage: bench_types [-t <milliseconds per case>] [name filter] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ua_server.h"
+#include "ua_config_default.h"
+#include "ua_plugin_network.h"
+#include "ua_types.h"
+#include "ua_types_generated_handling.h"
+#include "ua_types_generated_encoding_binary.h"
+#include "ua_transport_generated.h"
+#include "ua_transport_generated_handling.h"
+#include "ua_transport_generated_encoding_binary.h"
+#include "ua_types_encoding_binary.h"
+#include "ua_connection_internal.h"
+#ifdef UA_ENABLE_JSON_ENCODING
+# include "ua_types_encoding_json.h"
+#endif
+
+#define DEFAULT_DURATION_MS 200
+
+/***********************/
+/* Allocation Counting */
+/***********************/
+
+/* With glibc, the allocation functions of the executable take precedence over
+ * the libc implementation. Every allocation done by the library is counted.
+ * The sanitizers replace malloc themselves. */
+
+static size_t allocatedBytes = 0;
+static size_t allocations = 0;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+# define BENCH_COUNT_ALLOCATIONS
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size) {
+    allocatedBytes += size;
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size) {
+    allocatedBytes += nmemb * size;
+    allocations++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size) {
+    allocatedBytes += size;
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+#endif
+
+/**********/
+/* Runner */
+/**********/
+
+typedef UA_StatusCode (*BenchCallback)(void *data);
+
+static UA_DateTime minDuration = DEFAULT_DURATION_MS * UA_DATETIME_MSEC;
+static const char *nameFilter = NULL;
+static UA_Boolean failed = false;
+
+/* Doubles the number of iterations until a batch takes at least minDuration.
+ * The last batch is reported. */
+static void
+runBenchmark(const char *prefix, const char *name,
+             BenchCallback callback, void *data) {
+    char fullName[128];
+    snprintf(fullName, sizeof(fullName), "%s/%s", prefix, name);
+    if(nameFilter && !strstr(fullName, nameFilter))
+        return;
+
+    /* Warm up and make sure only the good path is measured */
+    UA_StatusCode retval = callback(data);
+    if(retval != UA_STATUSCODE_GOOD) {
+        printf("{\"name\":\"%s\",\"error\":\"%s\"}\n",
+               fullName, UA_StatusCode_name(retval));
+        failed = true;
+        return;
+    }
+
+    size_t iterations = 1;
+    UA_DateTime elapsed = 0;
+    while(true) {
+        allocatedBytes = 0;
+        allocations = 0;
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        for(size_t i = 0; i < iterations; i++)
+            retval |= callback(data);
+        elapsed = UA_DateTime_nowMonotonic() - begin;
+        if(elapsed >= minDuration || iterations >= (size_t)1 << 30)
+            break;
+        iterations *= 2;
+    }
+
+    if(retval != UA_STATUSCODE_GOOD) {
+        printf("{\"name\":\"%s\",\"error\":\"%s\"}\n",
+               fullName, UA_StatusCode_name(retval));
+        failed = true;
+        return;
+    }
+
+    double nsPerOp = (double)elapsed * 100.0 / (double)iterations;
+    printf("{\"name\":\"%s\",\"iterations\":%lu,\"ns_per_op\":%.1f,"
+           "\"ops_per_s\":%.0f,", fullName, (unsigned long)iterations,
+           nsPerOp, 1e9 / nsPerOp);
+#ifdef BENCH_COUNT_ALLOCATIONS
+    printf("\"bytes_per_op\":%.1f,\"allocs_per_op\":%.2f}\n",
+           (double)allocatedBytes / (double)iterations,
+           (double)allocations / (double)iterations);
+#else
+    printf("\"bytes_per_op\":null,\"allocs_per_op\":null}\n");
+#endif
+    fflush(stdout);
+}
+
+/*****************/
+/* Type Handling */
+/*****************/
+
+typedef struct {
+    const UA_DataType *type;
+    void *src;
+    void *dst;
+    UA_ByteString encoded;
+    UA_ByteString buf;
+#ifdef UA_ENABLE_JSON_ENCODING
+    UA_ByteString json;
+#endif
+} TypeBench;
+
+static UA_StatusCode
+benchCalcSizeBinary(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    return (UA_calcSizeBinary(tb->src, tb->type) == tb->encoded.length) ?
+        UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+static UA_StatusCode
+benchEncodeBinary(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    UA_Byte *pos = tb->buf.data;
+    const UA_Byte *end = &tb->buf.data[tb->buf.length];
+    return UA_encodeBinary(tb->src, tb->type, &pos, &end, NULL, NULL);
+}
+
+static UA_StatusCode
+benchDecodeBinary(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    size_t offset = 0;
+    UA_StatusCode retval =
+        UA_decodeBinary(&tb->encoded, &offset, tb->dst, tb->type, 0, NULL);
+    UA_deleteMembers(tb->dst, tb->type);
+    return retval;
+}
+
+/* Decoding as done in the server (see processMSG). The first block has the
+ * size of the encoding. */
+static UA_StatusCode
+benchDecodeBinaryArena(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    UA_DecodeArena arena;
+    UA_DecodeArena_init(&arena, tb->encoded.length);
+    arena.aliasBuffer = true;
+    size_t offset = 0;
+    UA_StatusCode retval = UA_decodeBinaryArena(&tb->encoded, &offset, tb->dst,
+                                                tb->type, 0, NULL, &arena);
+    UA_DecodeArena_clear(&arena);
+    memset(tb->dst, 0, tb->type->memSize);
+    return retval;
+}
+
+static UA_StatusCode
+benchCopy(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    UA_StatusCode retval = UA_copy(tb->src, tb->dst, tb->type);
+    UA_deleteMembers(tb->dst, tb->type);
+    return retval;
+}
+
+#ifdef UA_ENABLE_JSON_ENCODING
+static UA_StatusCode
+benchCalcSizeJson(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    size_t size = UA_calcSizeJson(tb->src, tb->type, NULL, 0, NULL, 0, true);
+    return (size == tb->json.length) ?
+        UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+static UA_StatusCode
+benchEncodeJson(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    UA_Byte *pos = tb->buf.data;
+    const UA_Byte *end = &tb->buf.data[tb->buf.length];
+    return UA_encodeJson(tb->src, tb->type, &pos, &end, NULL, 0, NULL, 0, true);
+}
+
+static UA_StatusCode
+benchDecodeJson(void *data) {
+    TypeBench *tb = (TypeBench*)data;
+    UA_StatusCode retval = UA_decodeJson(&tb->json, tb->dst, tb->type);
+    UA_deleteMembers(tb->dst, tb->type);
+    return retval;
+}
+#endif
+
+/* Takes ownership of src */
+static void
+benchType(const char *name, void *src, const UA_DataType *type) {
+    TypeBench tb;
+    memset(&tb, 0, sizeof(TypeBench));
+    tb.type = type;
+    tb.src = src;
+    tb.dst = UA_new(type);
+
+    UA_StatusCode retval =
+        UA_ByteString_allocBuffer(&tb.encoded, UA_calcSizeBinary(src, type));
+    retval |= UA_ByteString_allocBuffer(&tb.buf, tb.encoded.length * 8 + 1024);
+    if(retval == UA_STATUSCODE_GOOD) {
+        UA_Byte *pos = tb.encoded.data;
+        const UA_Byte *end = &tb.encoded.data[tb.encoded.length];
+        retval = UA_encodeBinary(src, type, &pos, &end, NULL, NULL);
+    }
+#ifdef UA_ENABLE_JSON_ENCODING
+    size_t jsonSize = UA_calcSizeJson(src, type, NULL, 0, NULL, 0, true);
+    retval |= UA_ByteString_allocBuffer(&tb.json, jsonSize);
+    if(retval == UA_STATUSCODE_GOOD) {
+        UA_Byte *pos = tb.json.data;
+        const UA_Byte *end = &tb.json.data[tb.json.length];
+        retval = UA_encodeJson(src, type, &pos, &end, NULL, 0, NULL, 0, true);
+    }
+#endif
+    if(retval != UA_STATUSCODE_GOOD) {
+        printf("{\"name\":\"%s\",\"error\":\"%s\"}\n",
+               name, UA_StatusCode_name(retval));
+        failed = true;
+        goto cleanup;
+    }
+
+    runBenchmark(name, "calcSizeBinary", benchCalcSizeBinary, &tb);
+    runBenchmark(name, "encodeBinary", benchEncodeBinary, &tb);
+    runBenchmark(name, "decodeBinary", benchDecodeBinary, &tb);
+    runBenchmark(name, "decodeBinaryArena", benchDecodeBinaryArena, &tb);
+    runBenchmark(name, "copy", benchCopy, &tb);
+#ifdef UA_ENABLE_JSON_ENCODING
+    runBenchmark(name, "calcSizeJson", benchCalcSizeJson, &tb);
+    runBenchmark(name, "encodeJson", benchEncodeJson, &tb);
+    /* The JSON decoding does not yet cover all types. Report the case as
+     * skipped instead of failed. */
+    retval = benchDecodeJson(&tb);
+    if(retval == UA_STATUSCODE_GOOD)
+        runBenchmark(name, "decodeJson", benchDecodeJson, &tb);
+    else if(!nameFilter || strstr(name, nameFilter))
+        printf("{\"name\":\"%s/decodeJson\",\"skipped\":\"%s\"}\n",
+               name, UA_StatusCode_name(retval));
+#endif
+
+ cleanup:
+    UA_delete(tb.src, type);
+    UA_delete(tb.dst, type);
+    UA_ByteString_deleteMembers(&tb.encoded);
+    UA_ByteString_deleteMembers(&tb.buf);
+#ifdef UA_ENABLE_JSON_ENCODING
+    UA_ByteString_deleteMembers(&tb.json);
+#endif
+}
+
+/********************/
+/* Overlayable Runs */
+/********************/
+
+/* Compares the en-/decoding of structures where runs of overlayable members are
+ * copied with a single memcpy against the member-wise processing. The
+ * equivalence of both is tested in check_types_encodespeed. */
+
+typedef struct {
+    const UA_DataType *type;
+    void *src;
+    void *dst;
+    UA_ByteString buf;
+} RunsBench;
+
+static UA_StatusCode
+benchEncodeDecodeBinary(void *data) {
+    RunsBench *rb = (RunsBench*)data;
+    UA_Byte *pos = rb->buf.data;
+    const UA_Byte *end = &rb->buf.data[rb->buf.length];
+    UA_StatusCode retval = UA_encodeBinary(rb->src, rb->type, &pos, &end, NULL, NULL);
+    size_t offset = 0;
+    retval |= UA_decodeBinary(&rb->buf, &offset, rb->dst, rb->type, 0, NULL);
+    UA_deleteMembers(rb->dst, rb->type);
+    return retval;
+}
+
+static void
+benchOverlayableRuns(const char *name, const UA_DataType *type) {
+    /* Copy of the type description without overlayable runs. Only the
+     * top-level members are processed member-wise. */
+    UA_DataTypeMember members[256];
+    UA_DataType mw = *type;
+    mw.typeIndex = 0; /* Only members from namespace zero */
+    memcpy(members, type->members, sizeof(UA_DataTypeMember) * type->membersSize);
+    for(size_t i = 0; i < type->membersSize; i++)
+        members[i].overlayableRun = 0;
+    mw.members = members;
+
+    RunsBench rb;
+    rb.type = type;
+    rb.src = UA_new(type);
+    rb.dst = UA_new(type);
+    UA_ByteString_allocBuffer(&rb.buf, 1024);
+
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "OverlayableRuns/%s", name);
+    runBenchmark(prefix, "runs", benchEncodeDecodeBinary, &rb);
+    rb.type = &mw;
+    runBenchmark(prefix, "memberwise", benchEncodeDecodeBinary, &rb);
+
+    UA_delete(rb.src, type);
+    UA_delete(rb.dst, type);
+    UA_ByteString_deleteMembers(&rb.buf);
+}
+
+/****************************/
+/* Representative Messages  */
+/****************************/
+
+#define READ_NODES 100
+#define WRITE_NODES 20
+#define BROWSE_REFERENCES 50
+
+static const UA_UInt32 readNodes[] =
+    {UA_NS0ID_SERVER_SERVERSTATUS, UA_NS0ID_SERVER_SERVERSTATUS_STARTTIME,
+     UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME, UA_NS0ID_SERVER_SERVERSTATUS_STATE,
+     UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_PRODUCTNAME,
+     UA_NS0ID_SERVER_NAMESPACEARRAY, UA_NS0ID_SERVER_SERVERARRAY};
+
+static const UA_UInt32 readAttributes[] =
+    {UA_ATTRIBUTEID_VALUE, UA_ATTRIBUTEID_DISPLAYNAME,
+     UA_ATTRIBUTEID_BROWSENAME, UA_ATTRIBUTEID_NODECLASS};
+
+static UA_ReadRequest *
+newReadRequest(void) {
+    UA_ReadRequest *req = UA_ReadRequest_new();
+    req->requestHeader.timestamp = UA_DateTime_now();
+    req->requestHeader.timeoutHint = 10000;
+    req->timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    req->nodesToRead = (UA_ReadValueId*)
+        UA_Array_new(READ_NODES, &UA_TYPES[UA_TYPES_READVALUEID]);
+    req->nodesToReadSize = READ_NODES;
+    for(size_t i = 0; i < READ_NODES; i++) {
+        UA_ReadValueId *rvi = &req->nodesToRead[i];
+        rvi->nodeId = UA_NODEID_NUMERIC(0, readNodes[i % 7]);
+        rvi->attributeId = readAttributes[i % 4];
+    }
+    return req;
+}
+
+static UA_ReadResponse *
+newReadResponse(void) {
+    UA_ReadResponse *res = UA_ReadResponse_new();
+    res->responseHeader.timestamp = UA_DateTime_now();
+    res->results = (UA_DataValue*)
+        UA_Array_new(READ_NODES, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    res->resultsSize = READ_NODES;
+    for(size_t i = 0; i < READ_NODES; i++) {
+        UA_DataValue *dv = &res->results[i];
+        UA_Double d = (UA_Double)i * 1.5;
+        UA_Variant_setScalarCopy(&dv->value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+        dv->hasValue = true;
+        dv->sourceTimestamp = res->responseHeader.timestamp;
+        dv->hasSourceTimestamp = true;
+        dv->serverTimestamp = res->responseHeader.timestamp;
+        dv->hasServerTimestamp = true;
+    }
+    return res;
+}
+
+static UA_WriteRequest *
+newWriteRequest(void) {
+    UA_WriteRequest *req = UA_WriteRequest_new();
+    req->requestHeader.timestamp = UA_DateTime_now();
+    req->nodesToWrite = (UA_WriteValue*)
+        UA_Array_new(WRITE_NODES, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+    req->nodesToWriteSize = WRITE_NODES;
+    UA_String s = UA_STRING("0123456789abcdef0123456789abcdef"
+                            "0123456789abcdef0123456789abcdef");
+    for(size_t i = 0; i < WRITE_NODES; i++) {
+        UA_WriteValue *wv = &req->nodesToWrite[i];
+        wv->nodeId = UA_NODEID_NUMERIC(1, (UA_UInt32)(50000 + i));
+        wv->attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_Variant_setScalarCopy(&wv->value.value, &s, &UA_TYPES[UA_TYPES_STRING]);
+        wv->value.hasValue = true;
+    }
+    return req;
+}
+
+static UA_BrowseResponse *
+newBrowseResponse(void) {
+    UA_BrowseResponse *res = UA_BrowseResponse_new();
+    res->responseHeader.timestamp = UA_DateTime_now();
+    res->results = UA_BrowseResult_new();
+    res->resultsSize = 1;
+    UA_BrowseResult *br = res->results;
+    br->references = (UA_ReferenceDescription*)
+        UA_Array_new(BROWSE_REFERENCES, &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+    br->referencesSize = BROWSE_REFERENCES;
+    for(size_t i = 0; i < BROWSE_REFERENCES; i++) {
+        UA_ReferenceDescription *rd = &br->references[i];
+        char name[32];
+        snprintf(name, sizeof(name), "Variable %lu", (unsigned long)i);
+        rd->referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+        rd->isForward = true;
+        rd->nodeId.nodeId = UA_NODEID_NUMERIC(1, (UA_UInt32)(50000 + i));
+        rd->browseName.namespaceIndex = 1;
+        rd->browseName.name = UA_STRING_ALLOC(name);
+        rd->displayName.locale = UA_STRING_ALLOC("en-US");
+        rd->displayName.text = UA_STRING_ALLOC(name);
+        rd->nodeClass = UA_NODECLASS_VARIABLE;
+        rd->typeDefinition.nodeId =
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE);
+    }
+    return res;
+}
+
+/**************************/
+/* Server Round-Trips     */
+/**************************/
+
+/* UA_Server_processBinaryMessage dispatches to worker threads with
+ * multithreading enabled. The round-trips are then not measured. */
+#ifndef UA_ENABLE_MULTITHREADING
+
+#define SEND_BUFFER_SIZE 65535
+
+static UA_ByteString sendBuffer;
+static UA_ByteString lastResponse;
+
+static UA_StatusCode
+benchGetSendBuffer(UA_Connection *connection, size_t length, UA_ByteString *buf) {
+    if(length > sendBuffer.length)
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    *buf = sendBuffer;
+    buf->length = length;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+benchReleaseBuffer(UA_Connection *connection, UA_ByteString *buf) {}
+
+/* The response remains in the send buffer until the next message is sent */
+static UA_StatusCode
+benchSend(UA_Connection *connection, UA_ByteString *buf) {
+    lastResponse = *buf;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+benchClose(UA_Connection *connection) {
+    connection->state = UA_CONNECTION_CLOSED;
+}
+
+typedef struct {
+    UA_Server *server;
+    UA_Connection connection;
+    UA_UInt32 channelId;
+    UA_UInt32 tokenId;
+    UA_UInt32 sequenceNumber;
+    UA_NodeId authenticationToken;
+    UA_ByteString buf;
+    UA_ByteString chunk; /* Points into buf */
+} ServerBench;
+
+/* Encodes a complete chunk with the SecurityPolicy#None into sb->chunk */
+static UA_StatusCode
+encodeChunk(ServerBench *sb, UA_MessageType messageType,
+            const void *request, const UA_DataType *requestType) {
+    UA_Byte *pos = sb->buf.data;
+    const UA_Byte *end = &sb->buf.data[sb->buf.length];
+    UA_TcpMessageHeader header;
+    header.messageTypeAndChunkType = messageType + UA_CHUNKTYPE_FINAL;
+    header.messageSize = 0; /* Set below */
+    UA_StatusCode retval = UA_TcpMessageHeader_encodeBinary(&header, &pos, end);
+
+    if(messageType == UA_MESSAGETYPE_HEL) {
+        retval |= UA_TcpHelloMessage_encodeBinary((const UA_TcpHelloMessage*)request,
+                                                  &pos, end);
+    } else {
+        retval |= UA_UInt32_encodeBinary(&sb->channelId, &pos, end);
+        if(messageType == UA_MESSAGETYPE_OPN) {
+            UA_AsymmetricAlgorithmSecurityHeader asymHeader;
+            UA_AsymmetricAlgorithmSecurityHeader_init(&asymHeader);
+            asymHeader.securityPolicyUri =
+                UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#None");
+            retval |= UA_AsymmetricAlgorithmSecurityHeader_encodeBinary(&asymHeader,
+                                                                        &pos, end);
+        } else {
+            retval |= UA_UInt32_encodeBinary(&sb->tokenId, &pos, end);
+        }
+        sb->sequenceNumber++;
+        UA_SequenceHeader seqHeader;
+        seqHeader.sequenceNumber = sb->sequenceNumber;
+        seqHeader.requestId = sb->sequenceNumber;
+        retval |= UA_SequenceHeader_encodeBinary(&seqHeader, &pos, end);
+        UA_NodeId typeId = UA_NODEID_NUMERIC(0, requestType->binaryEncodingId);
+        retval |= UA_NodeId_encodeBinary(&typeId, &pos, end);
+        retval |= UA_encodeBinary(request, requestType, &pos, &end, NULL, NULL);
+    }
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Set the message size */
+    header.messageSize = (UA_UInt32)(pos - sb->buf.data);
+    sb->chunk.data = sb->buf.data;
+    sb->chunk.length = header.messageSize;
+    pos = sb->buf.data;
+    return UA_TcpMessageHeader_encodeBinary(&header, &pos, end);
+}
+
+/* Decodes the service response in the last message sent by the server */
+static UA_StatusCode
+decodeResponse(void *response, const UA_DataType *responseType) {
+    UA_TcpMessageHeader header;
+    size_t offset = 0;
+    UA_StatusCode retval =
+        UA_TcpMessageHeader_decodeBinary(&lastResponse, &offset, &header);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    offset += 4; /* SecureChannelId */
+    if((header.messageTypeAndChunkType & 0x00ffffff) == UA_MESSAGETYPE_OPN) {
+        UA_AsymmetricAlgorithmSecurityHeader asymHeader;
+        retval = UA_AsymmetricAlgorithmSecurityHeader_decodeBinary(&lastResponse,
+                                                                   &offset, &asymHeader);
+        UA_AsymmetricAlgorithmSecurityHeader_deleteMembers(&asymHeader);
+    } else if((header.messageTypeAndChunkType & 0x00ffffff) == UA_MESSAGETYPE_MSG) {
+        offset += 4; /* TokenId */
+    } else {
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    }
+    offset += 8; /* SequenceHeader */
+    UA_NodeId typeId;
+    retval |= UA_NodeId_decodeBinary(&lastResponse, &offset, &typeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if(typeId.identifier.numeric != responseType->binaryEncodingId)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR; /* ServiceFault */
+    retval = UA_decodeBinary(&lastResponse, &offset, response, responseType, 0, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return ((const UA_ResponseHeader*)response)->serviceResult;
+}
+
+static UA_StatusCode
+processRequest(ServerBench *sb, const void *request, const UA_DataType *requestType,
+               void *response, const UA_DataType *responseType) {
+    UA_StatusCode retval = encodeChunk(sb, UA_MESSAGETYPE_MSG, request, requestType);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_ByteString msg = sb->chunk;
+    UA_Server_processBinaryMessage(sb->server, &sb->connection, &msg);
+    return decodeResponse(response, responseType);
+}
+
+/* HEL, OPN, CreateSession and ActivateSession */
+static UA_StatusCode
+openSession(ServerBench *sb) {
+    UA_TcpHelloMessage hello;
+    UA_TcpHelloMessage_init(&hello);
+    hello.receiveBufferSize = SEND_BUFFER_SIZE;
+    hello.sendBufferSize = SEND_BUFFER_SIZE;
+    hello.endpointUrl = UA_STRING("opc.tcp://localhost:4840");
+    UA_StatusCode retval = encodeChunk(sb, UA_MESSAGETYPE_HEL, &hello, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_ByteString msg = sb->chunk;
+    UA_Server_processBinaryMessage(sb->server, &sb->connection, &msg);
+    if(sb->connection.state != UA_CONNECTION_ESTABLISHED)
+        return UA_STATUSCODE_BADCONNECTIONREJECTED;
+
+    UA_OpenSecureChannelRequest opnReq;
+    UA_OpenSecureChannelRequest_init(&opnReq);
+    opnReq.requestType = UA_SECURITYTOKENREQUESTTYPE_ISSUE;
+    opnReq.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    opnReq.requestedLifetime = 600000;
+    retval = encodeChunk(sb, UA_MESSAGETYPE_OPN, &opnReq,
+                         &UA_TYPES[UA_TYPES_OPENSECURECHANNELREQUEST]);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    msg = sb->chunk;
+    UA_Server_processBinaryMessage(sb->server, &sb->connection, &msg);
+    UA_OpenSecureChannelResponse opnRes;
+    retval = decodeResponse(&opnRes, &UA_TYPES[UA_TYPES_OPENSECURECHANNELRESPONSE]);
+    sb->channelId = opnRes.securityToken.channelId;
+    sb->tokenId = opnRes.securityToken.tokenId;
+    UA_OpenSecureChannelResponse_deleteMembers(&opnRes);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    UA_CreateSessionRequest csReq;
+    UA_CreateSessionRequest_init(&csReq);
+    csReq.requestedSessionTimeout = 1200000;
+    csReq.endpointUrl = hello.endpointUrl;
+    UA_CreateSessionResponse csRes;
+    retval = processRequest(sb, &csReq, &UA_TYPES[UA_TYPES_CREATESESSIONREQUEST],
+                            &csRes, &UA_TYPES[UA_TYPES_CREATESESSIONRESPONSE]);
+    UA_NodeId_copy(&csRes.authenticationToken, &sb->authenticationToken);
+    UA_CreateSessionResponse_deleteMembers(&csRes);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    UA_AnonymousIdentityToken identityToken;
+    UA_AnonymousIdentityToken_init(&identityToken);
+    identityToken.policyId = UA_STRING("open62541-anonymous-policy");
+    UA_ActivateSessionRequest asReq;
+    UA_ActivateSessionRequest_init(&asReq);
+    asReq.requestHeader.authenticationToken = sb->authenticationToken;
+    asReq.userIdentityToken.encoding = UA_EXTENSIONOBJECT_DECODED;
+    asReq.userIdentityToken.content.decoded.type =
+        &UA_TYPES[UA_TYPES_ANONYMOUSIDENTITYTOKEN];
+    asReq.userIdentityToken.content.decoded.data = &identityToken;
+    UA_ActivateSessionResponse asRes;
+    retval = processRequest(sb, &asReq, &UA_TYPES[UA_TYPES_ACTIVATESESSIONREQUEST],
+                            &asRes, &UA_TYPES[UA_TYPES_ACTIVATESESSIONRESPONSE]);
+    UA_ActivateSessionResponse_deleteMembers(&asRes);
+    return retval;
+}
+
+typedef struct {
+    ServerBench *sb;
+    UA_ByteString msg; /* Encoded once, only the sequence header is updated */
+} RoundTrip;
+
+static UA_StatusCode
+benchRoundTrip(void *data) {
+    RoundTrip *rt = (RoundTrip*)data;
+    ServerBench *sb = rt->sb;
+    sb->sequenceNumber++;
+    UA_SequenceHeader seqHeader;
+    seqHeader.sequenceNumber = sb->sequenceNumber;
+    seqHeader.requestId = sb->sequenceNumber;
+    UA_Byte *pos = &rt->msg.data[16]; /* After the symmetric security header */
+    const UA_Byte *end = &rt->msg.data[rt->msg.length];
+    UA_StatusCode retval = UA_SequenceHeader_encodeBinary(&seqHeader, &pos, end);
+    UA_ByteString msg = rt->msg;
+    UA_Server_processBinaryMessage(sb->server, &sb->connection, &msg);
+    if(sb->connection.state != UA_CONNECTION_ESTABLISHED || lastResponse.length == 0)
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    lastResponse.length = 0;
+    return retval;
+}
+
+/* The request header of the request is adjusted. Takes ownership of the
+ * request. */
+static void
+benchRoundTripRequest(ServerBench *sb, const char *name, void *request,
+                      const UA_DataType *requestType,
+                      const UA_DataType *responseType) {
+    UA_RequestHeader *rh = (UA_RequestHeader*)request;
+    UA_NodeId_deleteMembers(&rh->authenticationToken);
+    UA_NodeId_copy(&sb->authenticationToken, &rh->authenticationToken);
+
+    /* Process once and check the response */
+    void *response = UA_new(responseType);
+    UA_StatusCode retval = processRequest(sb, request, requestType,
+                                          response, responseType);
+    UA_delete(response, responseType);
+    if(retval != UA_STATUSCODE_GOOD) {
+        printf("{\"name\":\"processMSG/%s\",\"error\":\"%s\"}\n",
+               name, UA_StatusCode_name(retval));
+        failed = true;
+        goto cleanup;
+    }
+
+    RoundTrip rt;
+    rt.sb = sb;
+    rt.msg = sb->chunk;
+    runBenchmark("processMSG", name, benchRoundTrip, &rt);
+
+ cleanup:
+    UA_delete(request, requestType);
+}
+
+static void
+discardLog(UA_LogLevel level, UA_LogCategory category,
+           const char *msg, va_list args) {}
+
+static void
+benchServer(void) {
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    config->logger = discardLog;
+    ServerBench sb;
+    memset(&sb, 0, sizeof(ServerBench));
+    sb.server = UA_Server_new(config);
+    UA_ByteString_allocBuffer(&sendBuffer, SEND_BUFFER_SIZE);
+    UA_ByteString_allocBuffer(&sb.buf, SEND_BUFFER_SIZE);
+
+    sb.connection.state = UA_CONNECTION_OPENING;
+    sb.connection.localConf = UA_ConnectionConfig_default;
+    sb.connection.remoteConf = UA_ConnectionConfig_default;
+    sb.connection.getSendBuffer = benchGetSendBuffer;
+    sb.connection.releaseSendBuffer = benchReleaseBuffer;
+    sb.connection.send = benchSend;
+    sb.connection.releaseRecvBuffer = benchReleaseBuffer;
+    sb.connection.close = benchClose;
+
+    UA_StatusCode retval = openSession(&sb);
+    if(retval != UA_STATUSCODE_GOOD) {
+        printf("{\"name\":\"processMSG\",\"error\":\"%s\"}\n",
+               UA_StatusCode_name(retval));
+        failed = true;
+        goto cleanup;
+    }
+
+    /* Service without session */
+    UA_GetEndpointsRequest *geReq = UA_GetEndpointsRequest_new();
+    geReq->endpointUrl = UA_STRING_ALLOC("opc.tcp://localhost:4840");
+    benchRoundTripRequest(&sb, "GetEndpoints", geReq,
+                          &UA_TYPES[UA_TYPES_GETENDPOINTSREQUEST],
+                          &UA_TYPES[UA_TYPES_GETENDPOINTSRESPONSE]);
+
+    benchRoundTripRequest(&sb, "Read", newReadRequest(),
+                          &UA_TYPES[UA_TYPES_READREQUEST],
+                          &UA_TYPES[UA_TYPES_READRESPONSE]);
+
+    UA_BrowseRequest *bReq = UA_BrowseRequest_new();
+    bReq->nodesToBrowse = UA_BrowseDescription_new();
+    bReq->nodesToBrowseSize = 1;
+    bReq->nodesToBrowse->nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+    bReq->nodesToBrowse->browseDirection = UA_BROWSEDIRECTION_BOTH;
+    bReq->nodesToBrowse->resultMask = UA_BROWSERESULTMASK_ALL;
+    benchRoundTripRequest(&sb, "Browse", bReq,
+                          &UA_TYPES[UA_TYPES_BROWSEREQUEST],
+                          &UA_TYPES[UA_TYPES_BROWSERESPONSE]);
+
+ cleanup:
+    UA_Connection_detachSecureChannel(&sb.connection);
+    UA_Server_delete(sb.server);
+    UA_ServerConfig_delete(config);
+    UA_ByteString_deleteMembers(&sb.connection.incompleteMessage);
+    UA_NodeId_deleteMembers(&sb.authenticationToken);
+    UA_ByteString_deleteMembers(&sb.buf);
+    UA_ByteString_deleteMembers(&sendBuffer);
+}
+
+#endif /* UA_ENABLE_MULTITHREADING */
+
+int main(int argc, char **argv) {
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            minDuration = atoi(argv[++i]) * UA_DATETIME_MSEC;
+            continue;
+        }
+        nameFilter = argv[i];
+    }
+
+    benchType("ReadRequest", newReadRequest(), &UA_TYPES[UA_TYPES_READREQUEST]);
+    benchType("ReadResponse", newReadResponse(), &UA_TYPES[UA_TYPES_READRESPONSE]);
+    benchType("WriteRequest", newWriteRequest(), &UA_TYPES[UA_TYPES_WRITEREQUEST]);
+    benchType("BrowseResponse", newBrowseResponse(),
+              &UA_TYPES[UA_TYPES_BROWSERESPONSE]);
+
+    benchOverlayableRuns("ServerDiagnosticsSummaryDataType",
+                         &UA_TYPES[UA_TYPES_SERVERDIAGNOSTICSSUMMARYDATATYPE]);
+    benchOverlayableRuns("ResponseHeader", &UA_TYPES[UA_TYPES_RESPONSEHEADER]);
+    benchOverlayableRuns("RequestHeader", &UA_TYPES[UA_TYPES_REQUESTHEADER]);
+    benchOverlayableRuns("ReadRequest", &UA_TYPES[UA_TYPES_READREQUEST]);
+#ifndef UA_ENABLE_MULTITHREADING
+    benchServer();
+#endif
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -454,6 +454,146 @@ START_TEST(SecureChannel_sendSymmetricMessage_modeSignAndEncrypt)
     }
 END_TEST
 
+static size_t batchCalls;
+static size_t batchedChunks;
+
+static UA_StatusCode
+allocSendBuffer(UA_Connection *connection, size_t length, UA_ByteString *buf) {
+    return UA_ByteString_allocBuffer(buf, length);
+}
+
+static void
+freeSendBuffer(UA_Connection *connection, UA_ByteString *buf) {
+    UA_ByteString_deleteMembers(buf);
+}
+
+static UA_StatusCode
+countingSendBatch(UA_Connection *connection, UA_ByteString *bufs, size_t bufsSize) {
+    batchCalls++;
+    batchedChunks += bufsSize;
+    for(size_t i = 0; i < bufsSize; i++)
+        UA_ByteString_deleteMembers(&bufs[i]);
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(SecureChannel_sendSymmetricMessage_batched)
+    {
+        batchCalls = 0;
+        batchedChunks = 0;
+        testingConnection.getSendBuffer = allocSendBuffer;
+        testingConnection.releaseSendBuffer = freeSendBuffer;
+        testingConnection.sendBatch = countingSendBatch;
+        testingConnection.localConf.sendBufferSize = 1024;
+
+        // A message that needs several chunks
+        UA_ReadValueId rvi[100];
+        for(size_t i = 0; i < 100; i++) {
+            UA_ReadValueId_init(&rvi[i]);
+            rvi[i].nodeId = UA_NODEID_STRING(1, "a rather long string nodeid to fill the chunks");
+            rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        }
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = rvi;
+        request.nodesToReadSize = 100;
+
+        testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+        UA_StatusCode retval =
+            UA_SecureChannel_sendSymmetricMessage(&testChannel, 42, UA_MESSAGETYPE_MSG,
+                                                  &request, &UA_TYPES[UA_TYPES_READREQUEST]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_gt(batchedChunks, 1);
+        ck_assert_uint_eq(batchCalls, (batchedChunks + UA_MESSAGECONTEXT_MAXPENDINGCHUNKS - 1) /
+                          UA_MESSAGECONTEXT_MAXPENDINGCHUNKS);
+    }
+END_TEST
+
+#define MAXCAPTUREDCHUNKS 32
+static UA_ByteString capturedChunks[MAXCAPTUREDCHUNKS];
+static size_t capturedChunksSize;
+
+static UA_StatusCode
+capturingSendBatch(UA_Connection *connection, UA_ByteString *bufs, size_t bufsSize) {
+    for(size_t i = 0; i < bufsSize; i++) {
+        ck_assert_uint_lt(capturedChunksSize, MAXCAPTUREDCHUNKS);
+        capturedChunks[capturedChunksSize++] = bufs[i];
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static size_t reassembledMessages;
+
+static UA_StatusCode
+checkReassembledMessage(void *application, UA_SecureChannel *channel,
+                        UA_MessageType messageType, UA_UInt32 requestId,
+                        const UA_ByteString *message) {
+    ck_assert_uint_eq(messageType, UA_MESSAGETYPE_MSG);
+    ck_assert_uint_eq(requestId, 42);
+
+    size_t offset = 0;
+    UA_NodeId typeId;
+    UA_StatusCode retval = UA_NodeId_decodeBinary(message, &offset, &typeId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(typeId.identifier.numeric, UA_TYPES[UA_TYPES_READREQUEST].binaryEncodingId);
+
+    UA_ReadRequest request;
+    retval = UA_ReadRequest_decodeBinary(message, &offset, &request);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(offset, message->length);
+    ck_assert_uint_eq(request.nodesToReadSize, 100);
+    UA_ReadRequest_deleteMembers(&request);
+    reassembledMessages++;
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(SecureChannel_processChunk_reassemble)
+    {
+        capturedChunksSize = 0;
+        reassembledMessages = 0;
+        testingConnection.getSendBuffer = allocSendBuffer;
+        testingConnection.releaseSendBuffer = freeSendBuffer;
+        testingConnection.sendBatch = capturingSendBatch;
+        testingConnection.localConf.sendBufferSize = 1024;
+
+        UA_ReadValueId rvi[100];
+        for(size_t i = 0; i < 100; i++) {
+            UA_ReadValueId_init(&rvi[i]);
+            rvi[i].nodeId = UA_NODEID_STRING(1, "a rather long string nodeid to fill the chunks");
+            rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        }
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = rvi;
+        request.nodesToReadSize = 100;
+
+        testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+        UA_StatusCode retval =
+            UA_SecureChannel_sendSymmetricMessage(&testChannel, 42, UA_MESSAGETYPE_MSG,
+                                                  &request, &UA_TYPES[UA_TYPES_READREQUEST]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_gt(capturedChunksSize, 1);
+
+        /* Feed the chunks back. The message is processed with the final chunk.
+         * The reassembly buffer grows with the message and is not preallocated
+         * to the (large) maximum message size. */
+        testingConnection.localConf.maxMessageSize = 1 << 26;
+        for(size_t i = 0; i < capturedChunksSize; i++) {
+            ck_assert_uint_eq(reassembledMessages, 0);
+            retval = UA_SecureChannel_processChunk(&testChannel, &capturedChunks[i],
+                                                   checkReassembledMessage, NULL);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            if(i + 1 < capturedChunksSize) {
+                struct MessageEntry *me = LIST_FIRST(&testChannel.chunks);
+                ck_assert_ptr_ne(me, NULL);
+                ck_assert_uint_le(me->messageBuffer.length, 4 * me->messageSize);
+            }
+            UA_ByteString_deleteMembers(&capturedChunks[i]);
+        }
+        ck_assert_uint_eq(reassembledMessages, 1);
+        ck_assert(LIST_EMPTY(&testChannel.chunks));
+    }
+END_TEST
+
 START_TEST(SecureChannel_sendSymmetricMessage_invalidParameters)
     {
         // initialize dummy message
@@ -533,6 +673,8 @@ testSuite_SecureChannel(void) {
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeNone);
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeSign);
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeSignAndEncrypt);
+    tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_batched);
+    tcase_add_test(tc_sendSymmetricMessage, SecureChannel_processChunk_reassemble);
     suite_add_tcase(s, tc_sendSymmetricMessage);
 
     return s;
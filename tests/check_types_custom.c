@@ -41,19 +41,20 @@ static UA_DataTypeMember members[3] = {
                             .namespaceZero is true */
         0,               /* .padding */
         true,            /* .namespaceZero, see .memberTypeIndex */
-        false            /* .isArray */
+        false,           /* .isArray */
+        0                /* .overlayableRun */
     },
 
     /* y */
     {
         UA_TYPENAME("y")
-        UA_TYPES_FLOAT, padding_y, true, false
+        UA_TYPES_FLOAT, padding_y, true, false, 0
     },
 
     /* z */
     {
         UA_TYPENAME("y")
-        UA_TYPES_FLOAT, padding_z, true, false
+        UA_TYPES_FLOAT, padding_z, true, false, 0
     }
 };
 
@@ -0,0 +1,107 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Checks that structures where runs of overlayable members are copied with a
+ * single memcpy are en-/decoded like with the member-wise processing. The
+ * timing comparison is in the bench_types benchmark. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ua_types.h"
+#include "ua_types_generated.h"
+#include "ua_types_generated_handling.h"
+#include "ua_types_encoding_binary.h"
+#include "check.h"
+
+#define RANDOM_TESTS 100
+
+/* Copy of the type description without overlayable runs. Only the top-level
+ * members are processed member-wise. */
+static UA_DataType
+memberwiseType(const UA_DataType *type, UA_DataTypeMember *members) {
+    UA_DataType mw = *type;
+    mw.typeIndex = 0; /* Only members from namespace zero */
+    memcpy(members, type->members, sizeof(UA_DataTypeMember) * type->membersSize);
+    for(size_t i = 0; i < type->membersSize; i++)
+        members[i].overlayableRun = 0;
+    mw.members = members;
+    return mw;
+}
+
+static UA_Boolean
+hasOverlayableRun(const UA_DataType *type) {
+    for(size_t i = 0; i < type->membersSize; i++) {
+        if(type->members[i].overlayableRun > 1)
+            return true;
+    }
+    return false;
+}
+
+START_TEST(overlayableRunsShallEncodeLikeMembers) {
+    const UA_DataType *type = &UA_TYPES[_i];
+    if(type->builtin || !hasOverlayableRun(type))
+        return;
+    UA_DataTypeMember members[256];
+    UA_DataType mw = memberwiseType(type, members);
+
+    UA_ByteString msg, buf1, buf2;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&msg, 256);
+    retval |= UA_ByteString_allocBuffer(&buf1, 1024);
+    retval |= UA_ByteString_allocBuffer(&buf2, 1024);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_random_seed(42);
+
+    void *obj1 = UA_new(type);
+    void *obj2 = UA_new(type);
+    for(int n = 0; n < RANDOM_TESTS; n++) {
+        for(size_t i = 0; i < msg.length; i++)
+            msg.data[i] = (UA_Byte)UA_UInt32_random();
+
+        /* Decode with and without runs */
+        size_t offset1 = 0, offset2 = 0;
+        UA_StatusCode ret1 = UA_decodeBinary(&msg, &offset1, obj1, type, 0, NULL);
+        UA_StatusCode ret2 = UA_decodeBinary(&msg, &offset2, obj2, &mw, 0, NULL);
+        ck_assert_int_eq(ret1, ret2);
+        ck_assert_int_eq(offset1, offset2);
+        if(ret1 != UA_STATUSCODE_GOOD)
+            continue;
+
+        /* Encode with and without runs */
+        ck_assert_int_eq(UA_calcSizeBinary(obj1, type), UA_calcSizeBinary(obj1, &mw));
+        UA_Byte *pos1 = buf1.data;
+        const UA_Byte *end1 = &buf1.data[buf1.length];
+        ret1 = UA_encodeBinary(obj1, type, &pos1, &end1, NULL, NULL);
+        UA_Byte *pos2 = buf2.data;
+        const UA_Byte *end2 = &buf2.data[buf2.length];
+        ret2 = UA_encodeBinary(obj2, &mw, &pos2, &end2, NULL, NULL);
+        ck_assert_int_eq(ret1, ret2);
+        ck_assert_int_eq(pos1 - buf1.data, pos2 - buf2.data);
+        ck_assert(memcmp(buf1.data, buf2.data, (size_t)(pos1 - buf1.data)) == 0);
+
+        UA_deleteMembers(obj1, type);
+        UA_deleteMembers(obj2, type);
+    }
+
+    UA_delete(obj1, type);
+    UA_delete(obj2, type);
+    UA_ByteString_deleteMembers(&msg);
+    UA_ByteString_deleteMembers(&buf1);
+    UA_ByteString_deleteMembers(&buf2);
+}
+END_TEST
+
+int main(void) {
+    Suite *s = suite_create("Overlayable Runs");
+    TCase *tc = tcase_create("Encoding");
+    tcase_add_loop_test(tc, overlayableRunsShallEncodeLikeMembers,
+                        UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
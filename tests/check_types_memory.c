@@ -103,6 +103,61 @@ START_TEST(arrayCopyShallMakeADeepCopy) {
 }
 END_TEST
 
+START_TEST(copyShallBeEqual) {
+    // given
+    void *obj1 = UA_new(&UA_TYPES[_i]);
+    void *obj2 = UA_new(&UA_TYPES[_i]);
+    // when
+    UA_StatusCode retval = UA_copy(obj1, obj2, &UA_TYPES[_i]);
+    // then
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_msg(UA_equal(obj1, obj2, &UA_TYPES[_i]), "copy differs idx=%d", _i);
+    // finally
+    UA_delete(obj1, &UA_TYPES[_i]);
+    UA_delete(obj2, &UA_TYPES[_i]);
+}
+END_TEST
+
+START_TEST(equalShallCompareContent) {
+    // given
+    UA_Int32 a1[3] = {1, 2, 3};
+    UA_Int32 a2[3] = {1, 2, 3};
+    UA_Variant v1, v2;
+    UA_Variant_setArray(&v1, a1, 3, &UA_TYPES[UA_TYPES_INT32]);
+    UA_Variant_setArray(&v2, a2, 3, &UA_TYPES[UA_TYPES_INT32]);
+    UA_DataValue d1, d2;
+    UA_DataValue_init(&d1);
+    UA_DataValue_init(&d2);
+    d1.value = v1;
+    d1.hasValue = true;
+    d2.value = v2;
+    d2.hasValue = true;
+    // then
+    ck_assert(UA_equal(&d1, &d2, &UA_TYPES[UA_TYPES_DATAVALUE]));
+    a2[2] = 4;
+    ck_assert(!UA_equal(&d1, &d2, &UA_TYPES[UA_TYPES_DATAVALUE]));
+    a2[2] = 3;
+    d2.hasStatus = true;
+    ck_assert(!UA_equal(&d1, &d2, &UA_TYPES[UA_TYPES_DATAVALUE]));
+    d2.hasStatus = false;
+    d2.value.arrayLength = 2;
+    ck_assert(!UA_equal(&d1, &d2, &UA_TYPES[UA_TYPES_DATAVALUE]));
+
+    UA_String s1[2] = {UA_STRING_STATIC("a"), UA_STRING_STATIC("bb")};
+    UA_String s2[2] = {UA_STRING_STATIC("a"), UA_STRING_STATIC("bc")};
+    UA_Variant_setArray(&v1, s1, 2, &UA_TYPES[UA_TYPES_STRING]);
+    UA_Variant_setArray(&v2, s2, 2, &UA_TYPES[UA_TYPES_STRING]);
+    ck_assert(!UA_equal(&v1, &v2, &UA_TYPES[UA_TYPES_VARIANT]));
+    s2[1] = UA_STRING("bb");
+    ck_assert(UA_equal(&v1, &v2, &UA_TYPES[UA_TYPES_VARIANT]));
+
+    /* The null string differs from the empty string */
+    UA_String empty = {0, (UA_Byte*)UA_EMPTY_ARRAY_SENTINEL};
+    UA_String null = UA_STRING_NULL;
+    ck_assert(!UA_equal(&empty, &null, &UA_TYPES[UA_TYPES_STRING]));
+}
+END_TEST
+
 START_TEST(encodeShallYieldDecode) {
     /* floating point types may change the representaton due to several possible NaN values. */
     if(_i != UA_TYPES_FLOAT || _i != UA_TYPES_DOUBLE ||
@@ -277,6 +332,163 @@ START_TEST(decodeComplexTypeFromRandomBufferShallSurvive) {
 }
 END_TEST
 
+START_TEST(decodeComplexTypeFromRandomBufferIntoArenaShallSurvive) {
+    // given
+    UA_ByteString msg1;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&msg1, 256); // fixed size
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+#ifdef _WIN32
+    srand(42);
+#else
+    srandom(42);
+#endif
+    // when
+    UA_DecodeArena arena;
+    UA_DecodeArena_init(&arena, 64);
+    for(int n = 0;n < RANDOM_TESTS;n++) {
+        for(size_t i = 0;i < msg1.length;i++) {
+#ifdef _WIN32
+            msg1.data[i] = (UA_Byte)rand();
+#else
+            msg1.data[i] = (UA_Byte)random();
+#endif
+        }
+        size_t pos = 0;
+        UA_STACKARRAY(UA_Byte, obj1, UA_TYPES[_i].memSize);
+        retval |= UA_decodeBinaryArena(&msg1, &pos, obj1, &UA_TYPES[_i], 0, NULL, &arena);
+    }
+
+    // finally
+    UA_DecodeArena_clear(&arena);
+    UA_ByteString_deleteMembers(&msg1);
+}
+END_TEST
+
+START_TEST(decodeIntoArenaShallYieldEncoding) {
+    // given
+    UA_ReadValueId rvi[50];
+    char name[32];
+    for(size_t i = 0; i < 50; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        snprintf(name, sizeof(name), "node.%u", (unsigned)i);
+        rvi[i].nodeId = UA_NODEID_STRING_ALLOC(1, name);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 50;
+
+    UA_ByteString msg1, msg2;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&msg1, 65000);
+    retval |= UA_ByteString_allocBuffer(&msg2, 65000);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Byte *pos = msg1.data;
+    const UA_Byte *end = &msg1.data[msg1.length];
+    retval = UA_encodeBinary(&request, &UA_TYPES[UA_TYPES_READREQUEST],
+                             &pos, &end, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    msg1.length = (size_t)(pos - msg1.data);
+
+    // when (a small block size forces several blocks)
+    UA_DecodeArena arena;
+    UA_DecodeArena_init(&arena, 64);
+    UA_ReadRequest decoded;
+    size_t offset = 0;
+    retval = UA_decodeBinaryArena(&msg1, &offset, &decoded,
+                                  &UA_TYPES[UA_TYPES_READREQUEST], 0, NULL, &arena);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(offset, msg1.length);
+    ck_assert_int_eq(decoded.nodesToReadSize, 50);
+    ck_assert(UA_NodeId_equal(&decoded.nodesToRead[49].nodeId, &rvi[49].nodeId));
+
+    // then
+    pos = msg2.data;
+    end = &msg2.data[msg2.length];
+    retval = UA_encodeBinary(&decoded, &UA_TYPES[UA_TYPES_READREQUEST],
+                             &pos, &end, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    msg2.length = (size_t)(pos - msg2.data);
+    ck_assert(UA_ByteString_equal(&msg1, &msg2));
+
+    // finally
+    UA_DecodeArena_clear(&arena);
+    for(size_t i = 0; i < 50; i++)
+        UA_ReadValueId_deleteMembers(&rvi[i]);
+    UA_ByteString_deleteMembers(&msg1);
+    UA_ByteString_deleteMembers(&msg2);
+}
+END_TEST
+
+START_TEST(decodeIntoArenaShallAliasBuffer) {
+    // given
+    UA_Byte payload[1000];
+    memset(payload, 42, sizeof(payload));
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = UA_NODEID_STRING(1, "firmware");
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ByteString bs = {sizeof(payload), payload};
+    UA_Variant_setScalar(&wv.value.value, &bs, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    wv.value.hasValue = true;
+
+    UA_ByteString msg;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&msg, 2000);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Byte *pos = msg.data;
+    const UA_Byte *end = &msg.data[msg.length];
+    retval = UA_encodeBinary(&wv, &UA_TYPES[UA_TYPES_WRITEVALUE],
+                             &pos, &end, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    msg.length = (size_t)(pos - msg.data);
+
+    // when
+    UA_DecodeArena arena;
+    UA_DecodeArena_init(&arena, 64);
+    arena.aliasBuffer = true;
+    UA_WriteValue decoded;
+    size_t offset = 0;
+    retval = UA_decodeBinaryArena(&msg, &offset, &decoded,
+                                  &UA_TYPES[UA_TYPES_WRITEVALUE], 0, NULL, &arena);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    // then
+    const UA_ByteString *out = (const UA_ByteString*)decoded.value.value.data;
+    ck_assert(UA_ByteString_equal(out, &bs));
+    ck_assert(out->data > msg.data && out->data < &msg.data[msg.length]);
+    ck_assert(UA_NodeId_equal(&decoded.nodeId, &wv.nodeId));
+    ck_assert(decoded.nodeId.identifier.string.data > msg.data &&
+              decoded.nodeId.identifier.string.data < &msg.data[msg.length]);
+
+    // finally
+    UA_DecodeArena_clear(&arena);
+    UA_ByteString_deleteMembers(&msg);
+}
+END_TEST
+
+START_TEST(arenaShallKeepBlockForLargeAllocations) {
+    // given
+    UA_DecodeArena arena;
+    UA_DecodeArena_init(&arena, 64);
+
+    // when
+    UA_Byte *p1 = (UA_Byte*)UA_DecodeArena_alloc(&arena, 16);
+    UA_Byte *p2 = (UA_Byte*)UA_DecodeArena_alloc(&arena, 1000);
+    UA_Byte *p3 = (UA_Byte*)UA_DecodeArena_alloc(&arena, 16);
+
+    // then (the large allocation has a block of its own, the small allocations
+    // continue in the first block, which doubled the next block size once)
+    ck_assert(p1 && p2 && p3);
+    ck_assert(p3 == p1 + 16);
+    ck_assert_uint_eq(arena.blockSize, 128);
+    memset(p2, 0xff, 1000);
+    ck_assert_uint_eq(p3[0], 0);
+
+    // finally
+    UA_DecodeArena_clear(&arena);
+}
+END_TEST
+
 START_TEST(calcSizeBinaryShallBeCorrect) {
     /* Empty variants (with no type defined) cannot be encoded. This is
      * intentional. Discovery configuration is just a base class and void * */
@@ -330,6 +542,8 @@ int main(void) {
     TCase *tc = tcase_create("Empty Objects");
     tcase_add_loop_test(tc, newAndEmptyObjectShallBeDeleted, UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
     tcase_add_test(tc, arrayCopyShallMakeADeepCopy);
+    tcase_add_loop_test(tc, copyShallBeEqual, UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
+    tcase_add_test(tc, equalShallCompareContent);
     tcase_add_loop_test(tc, encodeShallYieldDecode, UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
     suite_add_tcase(s, tc);
     tc = tcase_create("Truncated Buffers");
@@ -342,6 +556,14 @@ int main(void) {
                         UA_TYPES_BOOLEAN, UA_TYPES_DOUBLE);
     tcase_add_loop_test(tc, decodeComplexTypeFromRandomBufferShallSurvive,
                         UA_TYPES_NODEID, UA_TYPES_COUNT - 1);
+    tcase_add_loop_test(tc, decodeComplexTypeFromRandomBufferIntoArenaShallSurvive,
+                        UA_TYPES_NODEID, UA_TYPES_COUNT - 1);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("Decode Arena");
+    tcase_add_test(tc, decodeIntoArenaShallYieldEncoding);
+    tcase_add_test(tc, decodeIntoArenaShallAliasBuffer);
+    tcase_add_test(tc, arenaShallKeepBlockForLargeAllocations);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Test calcSizeBinary");
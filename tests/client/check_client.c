@@ -163,6 +163,67 @@ START_TEST(Client_read) {
 }
 END_TEST
 
+START_TEST(Client_read_registeredNode) {
+    UA_Client *client = UA_Client_new(UA_ClientConfig_default);
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "my.variable");
+    UA_RegisterNodesRequest req;
+    UA_RegisterNodesRequest_init(&req);
+    req.nodesToRegister = &nodeId;
+    req.nodesToRegisterSize = 1;
+    UA_RegisterNodesResponse res = UA_Client_Service_registerNodes(client, req);
+    ck_assert_uint_eq(res.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(res.registeredNodeIdsSize, 1);
+
+    /* Read with the registered NodeId */
+    UA_Variant val;
+    retval = UA_Client_readValueAttribute(client, res.registeredNodeIds[0], &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_deleteMembers(&val);
+
+    /* Unknown after unregistering */
+    UA_UnregisterNodesRequest reqUn;
+    UA_UnregisterNodesRequest_init(&reqUn);
+    reqUn.nodesToUnregister = res.registeredNodeIds;
+    reqUn.nodesToUnregisterSize = 1;
+    UA_UnregisterNodesResponse resUn = UA_Client_Service_unregisterNodes(client, reqUn);
+    ck_assert_uint_eq(resUn.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UnregisterNodesResponse_deleteMembers(&resUn);
+    retval = UA_Client_readValueAttribute(client, res.registeredNodeIds[0], &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    UA_RegisterNodesResponse_deleteMembers(&res);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+START_TEST(Client_read_bufferPool) {
+    UA_Client *client = UA_Client_new(UA_ClientConfig_default);
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "my.variable");
+    for(size_t i = 0; i < 10; i++) {
+        UA_Variant val;
+        retval = UA_Client_readValueAttribute(client, nodeId, &val);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_Variant_deleteMembers(&val);
+    }
+
+    /* The buffers for the repeated reads are reused from the pool */
+    UA_BufferPoolStatistics stats;
+    UA_ServerNetworkLayerTCP_getBufferPoolStatistics(&config->networkLayers[0], &stats);
+    ck_assert_uint_gt(stats.hits, 10);
+    ck_assert_uint_gt(stats.pooled, 0);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_renewSecureChannel) {
     UA_Client *client = UA_Client_new(UA_ClientConfig_default);
     UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
@@ -318,6 +379,8 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_endpoints);
     tcase_add_test(tc_client, Client_endpoints_empty);
     tcase_add_test(tc_client, Client_read);
+    tcase_add_test(tc_client, Client_read_registeredNode);
+    tcase_add_test(tc_client, Client_read_bufferPool);
     suite_add_tcase(s,tc_client);
     TCase *tc_client_reconnect = tcase_create("Client Reconnect");
     tcase_add_checked_fixture(tc_client_reconnect, setup, teardown);
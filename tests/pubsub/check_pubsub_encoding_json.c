@@ -90,9 +90,11 @@ START_TEST(UA_PubSub_EnDecode) {
     
     dataSetMessageFields[1] = dataSetMessageFieldNames;
     rv = UA_NetworkMessage_encodeJson(&m, &bufPos, bufEnd, UA_TRUE, dataSetMessageFields, 0);
-    *bufPos = 0;
     // then
     ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(UA_NetworkMessage_calcSizeJson(&m, UA_TRUE, dataSetMessageFields, 0),
+                      (size_t)(bufPos - buffer.data));
+    *bufPos = 0;
     //char* result = "{\"MessageId\":\"D4195B44-2E0A-8D5B-46F4-BF9B1CB1BB0B\",\"MessageType\":\"ua-data\",\"Messages\":[{\"DataSetWriterId\":\"4\",\"Payload\":[{\"Type\":8,\"Body\":27}]},{\"DataSetWriterId\":\"7\",\"Payload\":[{\"Value\":{\"Type\":13,\"Body\":\"B7E9851D-2E4D-E71F-7107-A02AF23F5375\"}},{\"Value\":{\"Type\":7,\"Body\":152478978534}}]}]}";
     //ck_assert_str_eq(result, (char*)buffer.data);
     //"{\"MessageId\":\"D4195B44-2E0A-8D5B-46F4-BF9B1CB1BB0B\",\"MessageType\":\"ua-data\",\"Messages\":[{\"DataSetWriterId\":\"0\",\"Payload\":{\"a\":{\"Type\":7,\"Body\":27}}},{\"DataSetWriterId\":\"0\",\"Payload\":{\"a\":{\"Value\":{\"Type\":13,\"Body\":\"B7E9851D-2E4D-E71F-7107-A02AF23F5375\"}},\"b\":{\"Value\":{\"Type\":7,\"Body\":152478978534}}}}]}"
@@ -324,6 +326,68 @@ START_TEST(UA_Networkmessage_json_decode) {
 }   
 END_TEST
 
+START_TEST(UA_NetworkMessage_calcSizeJson_exact) {
+    UA_NetworkMessage m;
+    memset(&m, 0, sizeof(UA_NetworkMessage));
+    m.version = 1;
+    m.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    m.publisherIdEnabled = true;
+    m.publisherIdType = UA_PUBLISHERDATATYPE_STRING;
+    m.publisherId.publisherIdString = UA_STRING("MQTT-Localhost");
+    m.payloadHeaderEnabled = true;
+    m.payloadHeader.dataSetPayloadHeader.count = 1;
+    UA_UInt16 dsWriterId = 12345;
+    m.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &dsWriterId;
+
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    dsm.header.dataSetMessageValid = true;
+    dsm.header.dataSetMessageSequenceNrEnabled = true;
+    dsm.header.dataSetMessageSequenceNr = 4711;
+    dsm.header.timestampEnabled = true;
+    dsm.header.timestamp = UA_DateTime_now();
+    dsm.header.fieldEncoding = UA_FIELDENCODING_DATAVALUE;
+    dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    m.payload.dataSetPayload.dataSetMessages = &dsm;
+
+    /* Many fields exceed the 2000 bytes formerly reserved for the encoding */
+    UA_DataValue fields[100];
+    UA_String names[100];
+    UA_String *fieldNames[100];
+    char nameBuf[100][16];
+    UA_Double d = 3.1415;
+    for(size_t i = 0; i < 100; i++) {
+        UA_DataValue_init(&fields[i]);
+        UA_Variant_setScalar(&fields[i].value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+        fields[i].hasValue = true;
+        snprintf(nameBuf[i], 16, "field%u", (unsigned)i);
+        names[i] = UA_STRING(nameBuf[i]);
+        fieldNames[i] = &names[i];
+    }
+    dsm.data.keyFrameData.fieldCount = 100;
+    dsm.data.keyFrameData.dataSetFields = fields;
+    UA_String **dataSetMessageFields[1] = {fieldNames};
+
+    size_t size = UA_NetworkMessage_calcSizeJson(&m, UA_TRUE, dataSetMessageFields, 0);
+    ck_assert_uint_gt(size, 2000);
+
+    UA_ByteString buffer;
+    UA_StatusCode rv = UA_ByteString_allocBuffer(&buffer, size);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = buffer.data;
+    const UA_Byte *bufEnd = &buffer.data[buffer.length];
+    rv = UA_NetworkMessage_encodeJson(&m, &bufPos, bufEnd, UA_TRUE, dataSetMessageFields, 0);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(bufPos, bufEnd);
+
+    /* One byte less is not enough */
+    bufPos = buffer.data;
+    rv = UA_NetworkMessage_encodeJson(&m, &bufPos, bufEnd - 1, UA_TRUE, dataSetMessageFields, 0);
+    ck_assert_int_ne(rv, UA_STATUSCODE_GOOD);
+    UA_ByteString_deleteMembers(&buffer);
+}
+END_TEST
+
 
 static Suite *testSuite_networkmessage(void) {
     Suite *s = suite_create("Built-in Data Types 62541-6 Json");
@@ -334,6 +398,7 @@ static Suite *testSuite_networkmessage(void) {
 
     tcase_add_test(tc_json_networkmessage, UA_PubSub_EnDecode);
     tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_MetaDataVersion_json_decode);
+    tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_calcSizeJson_exact);
     
     //tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_test_json_decode);
     suite_add_tcase(s, tc_json_networkmessage);
@@ -9,6 +9,8 @@
 #include "ua_types.h"
 #include "ua_plugin_nodestore.h"
 #include "ua_nodestore_default.h"
+#include "ua_nodestore_epoch.h"
+#include "ua_nodestore_snapshot.h"
 #include "ua_util.h"
 #include "check.h"
 
@@ -24,7 +26,7 @@
  * released */
 typedef struct UA_NodeMapEntry {
     struct UA_NodeMapEntry *orig; /* the version this is a copy from (or NULL) */
-    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_UInt32 refCount; /* How many consumers have a reference to the node? */
     UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
     UA_Node node;
 } UA_NodeMapEntry;
@@ -35,16 +37,30 @@ static void checkAllReleased(void *context, const UA_Node* node) {
 }
 
 UA_Nodestore ns;
+static UA_Boolean checkReleased;
 
 static void setup(void) {
     UA_Nodestore_default_new(&ns);
+    checkReleased = true;
 }
 
 static void teardown(void) {
-    ns.iterate(ns.context, NULL, checkAllReleased);
+    if(checkReleased)
+        ns.iterate(ns.context, NULL, checkAllReleased);
     ns.deleteNodestore(ns.context);
 }
 
+static void setupSharded(void) {
+    UA_Nodestore_default_newSharded(&ns, 4);
+    checkReleased = true;
+}
+
+/* The epoch nodestore frees nodes with a delay. No reference counts to check. */
+static void setupEpoch(void) {
+    UA_Nodestore_epoch_new(&ns);
+    checkReleased = false;
+}
+
 static int zeroCnt = 0;
 static int visitCnt = 0;
 static void checkZeroVisitor(void *context, const UA_Node* node) {
@@ -200,6 +216,228 @@ START_TEST(failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries) {
 }
 END_TEST
 
+START_TEST(resizeKeepsNodesFindable) {
+    /* Numeric and string NodeIds in several namespaces. The hashmap is resized
+     * while the nodes are inserted and removed. */
+    char name[16];
+    UA_NodeId id;
+    for(UA_UInt32 i = 0; i < 5000; i++) {
+        UA_Node *n = ns.newNode(ns.context, UA_NODECLASS_OBJECT);
+        if(i % 2 == 0) {
+            n->nodeId = UA_NODEID_NUMERIC((UA_UInt16)(i % 3), i+1);
+        } else {
+            snprintf(name, sizeof(name), "node%u", (unsigned)i);
+            n->nodeId = UA_NODEID_STRING_ALLOC((UA_UInt16)(i % 3), name);
+        }
+        UA_NodeId_copy(&n->nodeId, &id);
+        ck_assert_int_eq(ns.insertNode(ns.context, n, NULL), UA_STATUSCODE_GOOD);
+        const UA_Node *nr = ns.getNode(ns.context, &id);
+        ck_assert(nr != NULL);
+        ck_assert(UA_NodeId_equal(&nr->nodeId, &id));
+        ns.releaseNode(ns.context, nr);
+        UA_NodeId_deleteMembers(&id);
+    }
+
+    for(UA_UInt32 i = 0; i < 5000; i++) {
+        if(i % 10 == 0)
+            continue;
+        if(i % 2 == 0) {
+            id = UA_NODEID_NUMERIC((UA_UInt16)(i % 3), i+1);
+        } else {
+            snprintf(name, sizeof(name), "node%u", (unsigned)i);
+            id = UA_NODEID_STRING((UA_UInt16)(i % 3), name);
+        }
+        ck_assert_int_eq(ns.removeNode(ns.context, &id), UA_STATUSCODE_GOOD);
+    }
+
+    /* The same numeric identifier in another namespace is a different node */
+    id = UA_NODEID_NUMERIC(1, 1);
+    ck_assert(ns.getNode(ns.context, &id) == NULL);
+
+    visitCnt = 0;
+    ns.iterate(ns.context, NULL, checkZeroVisitor);
+    ck_assert_int_eq(visitCnt, 500);
+    for(UA_UInt32 i = 0; i < 5000; i += 10) {
+        id = UA_NODEID_NUMERIC((UA_UInt16)(i % 3), i+1);
+        const UA_Node *nr = ns.getNode(ns.context, &id);
+        ck_assert(nr != NULL);
+        ns.releaseNode(ns.context, nr);
+    }
+}
+END_TEST
+
+#ifdef UA_ENABLE_NODESTORE_SLABS
+START_TEST(slabEntryIsReused) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0, 2253);
+    ck_assert_int_eq(ns.removeNode(ns.context, &in1), UA_STATUSCODE_GOOD);
+
+    /* The freed entry is reused for the next node of the same node class */
+    UA_Node* n2 = createNode(0,2254);
+    ck_assert_ptr_eq(n1, n2);
+    ck_assert_int_eq(n2->browseName.name.length, 0);
+    ns.insertNode(ns.context, n2, NULL);
+
+    /* Another node class uses another slab */
+    UA_Node *o = ns.newNode(ns.context, UA_NODECLASS_OBJECT);
+    ck_assert(o != NULL);
+    ck_assert(o != n2);
+    ns.deleteNode(ns.context, o);
+}
+END_TEST
+#endif
+
+/* Enough targets of one reference kind to build and grow the index */
+#define REFERENCETARGETS 100
+
+START_TEST(indexedReferenceTargets) {
+    UA_Node *n = createNode(1, 1);
+    UA_AddReferencesItem item;
+    UA_AddReferencesItem_init(&item);
+    item.isForward = true;
+    item.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+    for(UA_UInt32 i = 0; i < REFERENCETARGETS; i++) {
+        item.targetNodeId = UA_EXPANDEDNODEID_NUMERIC(1, 1000 + i);
+        ck_assert_int_eq(UA_Node_addReference(n, &item), UA_STATUSCODE_GOOD);
+    }
+    ck_assert_int_eq(n->referencesSize, 1);
+    ck_assert_uint_eq(n->references[0].targetIdsSize, REFERENCETARGETS);
+
+    /* Duplicates are detected */
+    item.targetNodeId = UA_EXPANDEDNODEID_NUMERIC(1, 1042);
+    ck_assert_int_eq(UA_Node_addReference(n, &item),
+                     UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED);
+
+    /* Delete every other target */
+    UA_DeleteReferencesItem del;
+    UA_DeleteReferencesItem_init(&del);
+    del.isForward = true;
+    del.referenceTypeId = item.referenceTypeId;
+    for(UA_UInt32 i = 0; i < REFERENCETARGETS; i += 2) {
+        del.targetNodeId = UA_EXPANDEDNODEID_NUMERIC(1, 1000 + i);
+        ck_assert_int_eq(UA_Node_deleteReference(n, &del), UA_STATUSCODE_GOOD);
+    }
+    ck_assert_int_eq(UA_Node_deleteReference(n, &del),
+                     UA_STATUSCODE_UNCERTAINREFERENCENOTDELETED);
+
+    /* The remaining targets are found, also in a copy of the node */
+    UA_Node *copy = UA_Node_copy_alloc(n);
+    ck_assert_ptr_ne(copy, NULL);
+    for(UA_UInt32 i = 0; i < REFERENCETARGETS; i++) {
+        UA_NodeId target = UA_NODEID_NUMERIC(1, 1000 + i);
+        const UA_ExpandedNodeId *found =
+            UA_NodeReferenceKind_findTarget(&n->references[0], &target);
+        const UA_ExpandedNodeId *foundCopy =
+            UA_NodeReferenceKind_findTarget(&copy->references[0], &target);
+        if(i % 2 == 0) {
+            ck_assert_ptr_eq(found, NULL);
+            ck_assert_ptr_eq(foundCopy, NULL);
+        } else {
+            ck_assert_ptr_ne(found, NULL);
+            ck_assert(UA_NodeId_equal(&found->nodeId, &target));
+            ck_assert_ptr_ne(foundCopy, NULL);
+        }
+    }
+
+    /* Added targets are appended after the copied ones */
+    item.targetNodeId = UA_EXPANDEDNODEID_NUMERIC(1, 1000);
+    ck_assert_int_eq(UA_Node_addReference(copy, &item), UA_STATUSCODE_GOOD);
+    ck_assert_ptr_ne(UA_NodeReferenceKind_findTarget(&copy->references[0],
+                                                     &item.targetNodeId.nodeId), NULL);
+
+    UA_Node_deleteMembers(copy);
+    UA_free(copy);
+    ns.deleteNode(ns.context, n);
+}
+END_TEST
+
+START_TEST(snapshotServesNodes) {
+    /* A variable with a string NodeId, a value and a reference */
+    UA_VariableNode *vn = (UA_VariableNode*)ns.newNode(ns.context, UA_NODECLASS_VARIABLE);
+    vn->nodeId = UA_NODEID_STRING_ALLOC(1, "snapshot.variable");
+    vn->browseName = UA_QUALIFIEDNAME_ALLOC(1, "variable");
+    UA_Int32 v = 42;
+    UA_Variant_setScalarCopy(&vn->value.data.value.value, &v, &UA_TYPES[UA_TYPES_INT32]);
+    vn->value.data.value.hasValue = true;
+    UA_AddReferencesItem item;
+    UA_AddReferencesItem_init(&item);
+    item.isForward = true;
+    item.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+    item.targetNodeId = UA_EXPANDEDNODEID_NUMERIC(1, 1);
+    ck_assert_int_eq(UA_Node_addReference((UA_Node*)vn, &item), UA_STATUSCODE_GOOD);
+    ns.insertNode(ns.context, (UA_Node*)vn, NULL);
+    for(UA_Int32 i = 1; i <= 100; i++)
+        ns.insertNode(ns.context, createNode(1, i), NULL);
+    ns.insertNode(ns.context, createNode(1, 50000), NULL);
+
+    UA_ByteString snapshot;
+    ck_assert_int_eq(UA_Nodestore_snapshot_encode(&ns, &snapshot), UA_STATUSCODE_GOOD);
+
+    UA_Nodestore overlay;
+    UA_Nodestore_default_new(&overlay);
+    UA_Nodestore sns;
+    ck_assert_int_eq(UA_Nodestore_snapshot_new(&sns, &snapshot, &overlay),
+                     UA_STATUSCODE_GOOD);
+
+    /* The node is decoded on access */
+    UA_NodeId varId = UA_NODEID_STRING(1, "snapshot.variable");
+    const UA_VariableNode *svn = (const UA_VariableNode*)sns.getNode(sns.context, &varId);
+    ck_assert_ptr_ne(svn, NULL);
+    ck_assert_int_eq(svn->nodeClass, UA_NODECLASS_VARIABLE);
+    UA_QualifiedName browseName = UA_QUALIFIEDNAME(1, "variable");
+    ck_assert(UA_QualifiedName_equal(&svn->browseName, &browseName));
+    ck_assert(svn->value.data.value.hasValue);
+    ck_assert_int_eq(*(UA_Int32*)svn->value.data.value.value.data, 42);
+    ck_assert_uint_eq(svn->referencesSize, 1);
+    ck_assert_ptr_ne(UA_NodeReferenceKind_findTarget(&svn->references[0],
+                                                     &item.targetNodeId.nodeId), NULL);
+    sns.releaseNode(sns.context, (const UA_Node*)svn);
+
+    /* NodeIds from the snapshot cannot be inserted again */
+    UA_Node *n = sns.newNode(sns.context, UA_NODECLASS_VARIABLE);
+    n->nodeId = UA_NODEID_NUMERIC(1, 50);
+    ck_assert_int_eq(sns.insertNode(sns.context, n, NULL), UA_STATUSCODE_BADNODEIDEXISTS);
+
+    /* Fresh NodeIds do not collide with the snapshot */
+    UA_NodeId freshId;
+    n = sns.newNode(sns.context, UA_NODECLASS_VARIABLE);
+    n->nodeId = UA_NODEID_NUMERIC(1, 0);
+    ck_assert_int_eq(sns.insertNode(sns.context, n, &freshId), UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(freshId.identifier.numeric, 50000);
+
+    /* Removed nodes are not served from the snapshot again */
+    UA_NodeId removeId = UA_NODEID_NUMERIC(1, 7);
+    ck_assert_int_eq(sns.removeNode(sns.context, &removeId), UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(sns.getNode(sns.context, &removeId), NULL);
+    ck_assert_int_eq(sns.insertNode(sns.context, createNode(1, 7), NULL), UA_STATUSCODE_GOOD);
+
+    /* Edit with copy and replace */
+    UA_NodeId editId = UA_NODEID_NUMERIC(1, 8);
+    ck_assert_int_eq(sns.getNodeCopy(sns.context, &editId, &n), UA_STATUSCODE_GOOD);
+    n->writeMask = 5;
+    ck_assert_int_eq(sns.replaceNode(sns.context, n), UA_STATUSCODE_GOOD);
+    const UA_Node *edited = sns.getNode(sns.context, &editId);
+    ck_assert_uint_eq(edited->writeMask, 5);
+    sns.releaseNode(sns.context, edited);
+
+    /* All nodes are visited */
+    visitCnt = 0;
+    sns.iterate(sns.context, NULL, checkZeroVisitor);
+    ck_assert_int_eq(visitCnt, 103);
+
+    sns.deleteNodestore(sns.context);
+    UA_ByteString_deleteMembers(&snapshot);
+
+    /* Reject other buffers */
+    UA_Nodestore_default_new(&overlay);
+    UA_ByteString invalid = UA_BYTESTRING("not a snapshot");
+    ck_assert_int_eq(UA_Nodestore_snapshot_new(&sns, &invalid, &overlay),
+                     UA_STATUSCODE_BADDECODINGERROR);
+    overlay.deleteNodestore(overlay.context);
+}
+END_TEST
+
 /************************************/
 /* Performance Profiling Test Cases */
 /************************************/
@@ -264,6 +502,96 @@ START_TEST(profileGetDelete) {
 }
 END_TEST
 
+/***************************/
+/* Epoch-Based Reclamation */
+/***************************/
+
+START_TEST(epochRemovedNodeStaysReadable) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0, 2253);
+    const UA_Node *nr = ns.getNode(ns.context, &in1);
+    ck_assert_ptr_eq(nr, n1);
+
+    /* Replace and remove while the node is checked out */
+    UA_Node* n2;
+    ns.getNodeCopy(ns.context, &in1, &n2);
+    UA_StatusCode retval = ns.replaceNode(ns.context, n2);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = ns.removeNode(ns.context, &in1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(ns.getNode(ns.context, &in1) == NULL);
+
+    /* The old version is not freed until released */
+    ck_assert(UA_NodeId_equal(&nr->nodeId, &in1));
+    ns.releaseNode(ns.context, nr);
+}
+END_TEST
+
+#ifdef UA_ENABLE_MULTITHREADING
+static volatile UA_Boolean epochRunning;
+
+static void *epochReadThread(void *arg) {
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+    size_t *reads = (size_t*)arg;
+    while(epochRunning) {
+        for(UA_UInt32 i = 0; i < N; i++) {
+            id.identifier.numeric = i+1;
+            const UA_Node *n = ns.getNode(ns.context, &id);
+            ck_assert(n != NULL);
+            ck_assert_uint_eq(n->nodeId.identifier.numeric, i+1);
+            ns.releaseNode(ns.context, n);
+            (*reads)++;
+        }
+    }
+    return NULL;
+}
+
+START_TEST(epochConcurrentReplace) {
+    for(UA_UInt32 i = 0; i < N; i++) {
+        UA_Node *n = createNode(0,i+1);
+        ns.insertNode(ns.context, n, NULL);
+    }
+
+    epochRunning = true;
+    pthread_t t[THREADS];
+    size_t reads[THREADS];
+    for(int i = 0; i < THREADS; i++) {
+        reads[i] = 0;
+        pthread_create(&t[i], NULL, epochReadThread, &reads[i]);
+    }
+
+    /* Replace the nodes while they are read. Insert and remove nodes to
+     * resize the hashmap. */
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+    for(UA_UInt32 round = 0; round < 5; round++) {
+        for(UA_UInt32 i = 0; i < N; i++) {
+            id.identifier.numeric = i+1;
+            UA_Node *copy;
+            UA_StatusCode retval = ns.getNodeCopy(ns.context, &id, &copy);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+            retval = ns.replaceNode(ns.context, copy);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        for(UA_UInt32 i = N; i < 3*N; i++) {
+            UA_Node *n = createNode(0,i+1);
+            ns.insertNode(ns.context, n, NULL);
+        }
+        for(UA_UInt32 i = N; i < 3*N; i++) {
+            id.identifier.numeric = i+1;
+            ns.removeNode(ns.context, &id);
+        }
+    }
+
+    epochRunning = false;
+    for(int i = 0; i < THREADS; i++) {
+        pthread_join(t[i], NULL);
+        ck_assert_uint_gt(reads[i], 0);
+    }
+}
+END_TEST
+#endif
+
 static Suite * namespace_suite (void) {
     Suite *s = suite_create ("UA_NodeStore");
 
@@ -288,11 +616,55 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_iterate, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
     suite_add_tcase (s, tc_iterate);
     
+    TCase* tc_references = tcase_create ("References");
+    tcase_add_checked_fixture(tc_references, setup, teardown);
+    tcase_add_test (tc_references, indexedReferenceTargets);
+    suite_add_tcase (s, tc_references);
+
+    TCase* tc_snapshot = tcase_create ("Snapshot");
+    tcase_add_checked_fixture(tc_snapshot, setup, teardown);
+    tcase_add_test (tc_snapshot, snapshotServesNodes);
+    suite_add_tcase (s, tc_snapshot);
+
     TCase* tc_profile = tcase_create ("Profile");
     tcase_add_checked_fixture(tc_profile, setup, teardown);
     tcase_add_test (tc_profile, profileGetDelete);
     suite_add_tcase (s, tc_profile);
 
+    TCase* tc_resize = tcase_create ("Resize");
+    tcase_add_checked_fixture(tc_resize, setup, teardown);
+    tcase_add_test (tc_resize, resizeKeepsNodesFindable);
+#ifdef UA_ENABLE_NODESTORE_SLABS
+    tcase_add_test (tc_resize, slabEntryIsReused);
+#endif
+    suite_add_tcase (s, tc_resize);
+
+    TCase* tc_sharded = tcase_create ("Sharded");
+    tcase_add_checked_fixture(tc_sharded, setupSharded, teardown);
+    tcase_add_test (tc_sharded, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_sharded, findNodeInExpandedNamespace);
+    tcase_add_test (tc_sharded, replaceOldNode);
+    tcase_add_test (tc_sharded, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    tcase_add_test (tc_sharded, resizeKeepsNodesFindable);
+    tcase_add_test (tc_sharded, profileGetDelete);
+    suite_add_tcase (s, tc_sharded);
+
+    TCase* tc_epoch = tcase_create ("Epoch");
+    tcase_add_checked_fixture(tc_epoch, setupEpoch, teardown);
+    tcase_add_test (tc_epoch, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_epoch, findNodeInExpandedNamespace);
+    tcase_add_test (tc_epoch, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_epoch, replaceExistingNode);
+    tcase_add_test (tc_epoch, replaceOldNode);
+    tcase_add_test (tc_epoch, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    tcase_add_test (tc_epoch, resizeKeepsNodesFindable);
+    tcase_add_test (tc_epoch, profileGetDelete);
+    tcase_add_test (tc_epoch, epochRemovedNodeStaysReadable);
+#ifdef UA_ENABLE_MULTITHREADING
+    tcase_add_test (tc_epoch, epochConcurrentReplace);
+#endif
+    suite_add_tcase (s, tc_epoch);
+
     return s;
 }
 
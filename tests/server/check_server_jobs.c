@@ -4,16 +4,20 @@
 
 #include "ua_server.h"
 #include "server/ua_server_internal.h"
+#include "server/ua_services.h"
 #include "ua_config_default.h"
 
 #include "check.h"
 #include "testing_clock.h"
+#include "testing_networklayers.h"
+#include "testing_policy.h"
 
 UA_Server *server = NULL;
 UA_ServerConfig *config = NULL;
 
 static void setup(void) {
     config = UA_ServerConfig_new_default();
+    config->nThreads = 4;
     server = UA_Server_new(config);
     UA_Server_run_startup(server);
 }
@@ -51,31 +55,534 @@ START_TEST(Server_addRemoveRepeatedCallback) {
 }
 END_TEST
 
-UA_UInt64 *cbId;
+/* Not freed by the test. The callback can still run on a worker. */
+static UA_UInt64 cbId;
 
 static void
 removeItselfCallback(UA_Server *serverPtr, void *data) {
-    UA_Server_removeRepeatedCallback(serverPtr, *cbId);
+    UA_Server_removeRepeatedCallback(serverPtr, cbId);
 }
 
 START_TEST(Server_repeatedCallbackRemoveItself) {
-    cbId = UA_UInt64_new();
-    UA_Server_addRepeatedCallback(server, removeItselfCallback, NULL, 10, cbId);
+    UA_Server_addRepeatedCallback(server, removeItselfCallback, NULL, 10, &cbId);
 
     UA_fakeSleep(15);
     UA_Server_run_iterate(server, false);
+}
+END_TEST
+
+#define MAXRECORDED 16
+static uintptr_t recorded[MAXRECORDED];
+static size_t recordedSize;
+
+static void
+recordingCallback(void *application, void *data) {
+    if(recordedSize < MAXRECORDED)
+        recorded[recordedSize] = (uintptr_t)data;
+    recordedSize++;
+}
+
+static void
+timerDispatch(void *application, UA_TimerCallback callback, void *data) {
+    callback(application, data);
+}
+
+START_TEST(Timer_blockOrder) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+
+    /* Callbacks with the same interval are grouped into a block and executed
+     * in reversed order */
+    UA_UInt64 ids[3];
+    for(uintptr_t i = 0; i < 3; i++)
+        UA_Timer_addRepeatedCallback(&timer, recordingCallback, (void*)(i + 1), 100, &ids[i]);
+
+    /* Execute twice. The order is kept after rescheduling. */
+    for(size_t cycle = 0; cycle < 2; cycle++) {
+        recordedSize = 0;
+        UA_fakeSleep(100);
+        UA_Timer_process(&timer, UA_DateTime_nowMonotonic(), timerDispatch, NULL);
+        ck_assert_uint_eq(recordedSize, 3);
+        ck_assert_uint_eq(recorded[0], 3);
+        ck_assert_uint_eq(recorded[1], 2);
+        ck_assert_uint_eq(recorded[2], 1);
+    }
+
+    /* Remove from the middle of the block */
+    UA_Timer_removeRepeatedCallback(&timer, ids[1]);
+    recordedSize = 0;
+    UA_fakeSleep(100);
+    UA_Timer_process(&timer, UA_DateTime_nowMonotonic(), timerDispatch, NULL);
+    ck_assert_uint_eq(recordedSize, 2);
+    ck_assert_uint_eq(recorded[0], 3);
+    ck_assert_uint_eq(recorded[1], 1);
+
+    /* Move to a longer interval */
+    UA_Timer_changeRepeatedCallbackInterval(&timer, ids[2], 300);
+    recordedSize = 0;
+    UA_fakeSleep(100);
+    UA_DateTime next = UA_Timer_process(&timer, UA_DateTime_nowMonotonic(), timerDispatch, NULL);
+    ck_assert_uint_eq(recordedSize, 1);
+    ck_assert_uint_eq(recorded[0], 1);
+    ck_assert_int_eq(next, UA_DateTime_nowMonotonic() + 100 * UA_DATETIME_MSEC);
+
+    UA_Timer_deleteMembers(&timer);
+}
+END_TEST
+
+START_TEST(Timer_subMillisecondInterval) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+
+    UA_UInt64 id;
+    ck_assert_uint_ne(UA_Timer_addRepeatedCallbackNsec(&timer, recordingCallback, NULL,
+                                                       UA_TIMER_MININTERVAL_NSEC - 1, &id),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(UA_Timer_addRepeatedCallbackNsec(&timer, recordingCallback, NULL,
+                                                       250000, &id), UA_STATUSCODE_GOOD);
+
+    /* The next execution is scheduled with 100ns resolution */
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_DateTime next = UA_Timer_process(&timer, start, timerDispatch, NULL);
+    ck_assert_int_eq(next, start + 250 * UA_DATETIME_USEC);
+
+    recordedSize = 0;
+    next = UA_Timer_process(&timer, next, timerDispatch, NULL);
+    ck_assert_uint_eq(recordedSize, 1);
+    ck_assert_int_eq(next, start + 500 * UA_DATETIME_USEC);
+
+    ck_assert_uint_eq(UA_Timer_changeRepeatedCallbackIntervalNsec(&timer, id, 500000),
+                      UA_STATUSCODE_GOOD);
+    next = UA_Timer_process(&timer, start + 250 * UA_DATETIME_USEC, timerDispatch, NULL);
+    ck_assert_int_eq(next, start + 500 * UA_DATETIME_USEC);
+
+    UA_Timer_deleteMembers(&timer);
+}
+END_TEST
+
+#define MANYCALLBACKS 10000
+
+START_TEST(Timer_manyCallbacks) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+
+    /* Intervals of 10ms to 100ms */
+    UA_UInt64 *ids = (UA_UInt64*)UA_malloc(sizeof(UA_UInt64) * MANYCALLBACKS);
+    for(size_t i = 0; i < MANYCALLBACKS; i++) {
+        UA_StatusCode retval =
+            UA_Timer_addRepeatedCallback(&timer, recordingCallback, NULL,
+                                         (UA_UInt32)(10 * ((i % 10) + 1)), &ids[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* Remove every second callback. Only the odd intervals remain. */
+    for(size_t i = 0; i < MANYCALLBACKS; i += 2)
+        UA_Timer_removeRepeatedCallback(&timer, ids[i]);
+
+    /* Advance by 1s in steps of 10ms */
+    recordedSize = 0;
+    for(size_t step = 0; step < 100; step++) {
+        UA_fakeSleep(10);
+        UA_Timer_process(&timer, UA_DateTime_nowMonotonic(), timerDispatch, NULL);
+    }
 
-    UA_UInt64_delete(cbId);
+    /* 20ms, 40ms, ..., 100ms intervals with MANYCALLBACKS/10 callbacks each */
+    size_t expected = 0;
+    for(size_t interval = 20; interval <= 100; interval += 20)
+        expected += (MANYCALLBACKS / 10) * (1000 / interval);
+    ck_assert_uint_eq(recordedSize, expected);
+
+    UA_free(ids);
+    UA_Timer_deleteMembers(&timer);
 }
 END_TEST
 
+#define DISPATCHED 10000
+
+static volatile UA_UInt32 parentsDone;
+static volatile UA_UInt32 childrenDone;
+static UA_UInt32 parentsDoneBeforeDelayed;
+static volatile UA_Boolean delayedDone;
+
+static void
+childCallback(UA_Server *serverPtr, void *data) {
+    UA_atomic_addUInt32(&childrenDone, 1);
+}
+
+/* Dispatches a child callback from the worker */
+static void
+parentCallback(UA_Server *serverPtr, void *data) {
+    UA_Server_workerCallback(serverPtr, childCallback, NULL);
+    UA_atomic_addUInt32(&parentsDone, 1);
+}
+
+static void
+delayedCallback(UA_Server *serverPtr, void *data) {
+    parentsDoneBeforeDelayed = parentsDone;
+    delayedDone = true;
+}
+
+START_TEST(Server_dispatchAndDelay) {
+    parentsDone = 0;
+    childrenDone = 0;
+    delayedDone = false;
+    for(size_t i = 0; i < DISPATCHED; i++)
+        UA_Server_workerCallback(server, parentCallback, NULL);
+    UA_StatusCode retval = UA_Server_delayedCallback(server, delayedCallback, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Wait until the workers have processed everything */
+    for(size_t i = 0; i < 500 && !delayedDone; i++) {
+        UA_Server_run_iterate(server, false);
+        UA_realSleep(10);
+    }
+    ck_assert(delayedDone);
+
+    /* The delayed callback waits for all callbacks dispatched before */
+    ck_assert_uint_eq(parentsDoneBeforeDelayed, DISPATCHED);
+
+    /* Remaining children are executed during the shutdown at the latest */
+    UA_Server_run_shutdown(server);
+    ck_assert_uint_eq(childrenDone, DISPATCHED);
+    UA_Server_run_startup(server);
+}
+END_TEST
+
+#define PARALLELITEMS 10000
+
+static UA_UInt32 *processedItems;
+static volatile UA_Boolean parallelDone;
+
+static void
+processItems(UA_Server *serverPtr, void *context, size_t begin, size_t end) {
+    for(size_t i = begin; i < end; i++)
+        UA_atomic_addUInt32(&processedItems[i], 1);
+}
+
+static void
+parallelCallback(UA_Server *serverPtr, void *data) {
+    UA_Server_processParallel(serverPtr, PARALLELITEMS, processItems, NULL);
+    parallelDone = true;
+}
+
+START_TEST(Server_processParallel) {
+    processedItems = (UA_UInt32*)UA_calloc(PARALLELITEMS, sizeof(UA_UInt32));
+    parallelDone = false;
+    UA_Server_workerCallback(server, parallelCallback, NULL);
+    for(size_t i = 0; i < 500 && !parallelDone; i++) {
+        UA_Server_run_iterate(server, false);
+        UA_realSleep(10);
+    }
+    ck_assert(parallelDone);
+
+    /* Every item was processed exactly once */
+    for(size_t i = 0; i < PARALLELITEMS; i++)
+        ck_assert_uint_eq(processedItems[i], 1);
+    UA_free(processedItems);
+}
+END_TEST
+
+#ifdef UA_ENABLE_MULTITHREADING
+
+/* The operations of large requests are processed in parallel only in a worker
+ * thread. The tests run the services in a worker with and without the
+ * threshold and compare the results. */
+
+#define PARALLELOPERATIONS 1000
+#define PARALLELVARIABLES 10
+
+static UA_ServerCallback serviceCallback;
+static volatile UA_Boolean serviceDone;
+
+static void
+serviceWorkerCallback(UA_Server *serverPtr, void *data) {
+    serviceCallback(serverPtr, data);
+    serviceDone = true;
+}
+
+static void
+runServiceInWorker(UA_ServerCallback callback, void *data, UA_Boolean parallel) {
+    server->config.parallelOperationsThreshold = parallel ? 2 : 0;
+    serviceCallback = callback;
+    serviceDone = false;
+    UA_Server_workerCallback(server, serviceWorkerCallback, data);
+    for(size_t i = 0; i < 500 && !serviceDone; i++) {
+        UA_Server_run_iterate(server, false);
+        UA_realSleep(10);
+    }
+    ck_assert(serviceDone);
+}
+
+static void
+addParallelVariables(void) {
+    for(UA_UInt32 i = 0; i < PARALLELVARIABLES; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        UA_Int32 value = 0;
+        UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+        attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+        attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 1000 + i),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "Parallel"),
+                                      UA_NODEID_NULL, attr, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+static UA_SecureChannel testChannel;
+static UA_SecurityPolicy dummyPolicy;
+static UA_Connection testingConnection;
+static funcs_called funcsCalled;
+static key_sizes keySizes;
+static UA_ByteString sentMessage;
+
+static void
+readService(UA_Server *serverPtr, void *data) {
+    UA_MessageContext mc;
+    UA_StatusCode retval =
+        UA_MessageContext_begin(&mc, &testChannel, 0, UA_MESSAGETYPE_MSG);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_ResponseHeader rh;
+    UA_ResponseHeader_init(&rh);
+    retval = Service_Read(serverPtr, &adminSession, &mc, (UA_ReadRequest*)data, &rh);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_MessageContext_finish(&mc);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+START_TEST(Server_parallelRead) {
+    addParallelVariables();
+
+    /* The response is sent in a single chunk */
+    TestingPolicy(&dummyPolicy, UA_BYTESTRING_NULL, &funcsCalled, &keySizes);
+    UA_SecureChannel_init(&testChannel, &dummyPolicy, &UA_BYTESTRING_NULL);
+    testingConnection = createDummyConnection(1 << 20, &sentMessage);
+    testingConnection.localConf.sendBufferSize = 1 << 20;
+    UA_Connection_attachSecureChannel(&testingConnection, &testChannel);
+    testChannel.connection = &testingConnection;
+
+    /* Read different attributes of existing and unknown nodes */
+    UA_ReadValueId *rvi = (UA_ReadValueId*)
+        UA_Array_new(PARALLELOPERATIONS, &UA_TYPES[UA_TYPES_READVALUEID]);
+    for(UA_UInt32 i = 0; i < PARALLELOPERATIONS; i++) {
+        rvi[i].nodeId = UA_NODEID_NUMERIC(1, 1000 + (i % (PARALLELVARIABLES + 1)));
+        rvi[i].attributeId = (i % 3 == 0) ? UA_ATTRIBUTEID_BROWSENAME : UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = PARALLELOPERATIONS;
+
+    /* The responses are identical after the sequence header */
+    runServiceInWorker(readService, &request, false);
+    UA_ByteString serial;
+    UA_ByteString_copy(&sentMessage, &serial);
+    runServiceInWorker(readService, &request, true);
+    ck_assert_uint_eq(sentMessage.length, serial.length);
+    ck_assert(memcmp(&sentMessage.data[UA_SECURE_MESSAGE_HEADER_LENGTH],
+                     &serial.data[UA_SECURE_MESSAGE_HEADER_LENGTH],
+                     serial.length - UA_SECURE_MESSAGE_HEADER_LENGTH) == 0);
+
+    UA_ByteString_deleteMembers(&serial);
+    UA_ReadRequest_deleteMembers(&request);
+    UA_SecureChannel_deleteMembersCleanup(&testChannel);
+    dummyPolicy.deleteMembers(&dummyPolicy);
+    testingConnection.close(&testingConnection);
+}
+END_TEST
+
+typedef struct {
+    const void *request;
+    void *response;
+} ServiceCall;
+
+static void
+writeService(UA_Server *serverPtr, void *data) {
+    ServiceCall *sc = (ServiceCall*)data;
+    Service_Write(serverPtr, &adminSession, (const UA_WriteRequest*)sc->request,
+                  (UA_WriteResponse*)sc->response);
+}
+
+static void
+runWrite(const UA_WriteRequest *request, UA_WriteResponse *response, UA_Int32 *values,
+         UA_Boolean parallel) {
+    /* Reset the values */
+    UA_Int32 zero = 0;
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &zero, &UA_TYPES[UA_TYPES_INT32]);
+    for(UA_UInt32 i = 0; i < PARALLELVARIABLES; i++)
+        UA_Server_writeValue(server, UA_NODEID_NUMERIC(1, 1000 + i), v);
+
+    UA_WriteResponse_init(response);
+    ServiceCall sc = {request, response};
+    runServiceInWorker(writeService, &sc, parallel);
+
+    for(UA_UInt32 i = 0; i < PARALLELVARIABLES; i++) {
+        UA_Variant_init(&v);
+        UA_Server_readValue(server, UA_NODEID_NUMERIC(1, 1000 + i), &v);
+        values[i] = *(UA_Int32*)v.data;
+        UA_Variant_deleteMembers(&v);
+    }
+}
+
+START_TEST(Server_parallelWrite) {
+    addParallelVariables();
+
+    /* Every variable is written with the same value by several operations.
+     * Some operations fail with a wrong type or an unknown node. */
+    UA_WriteValue *wv = (UA_WriteValue*)
+        UA_Array_new(PARALLELOPERATIONS, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+    for(UA_UInt32 i = 0; i < PARALLELOPERATIONS; i++) {
+        UA_UInt32 var = i % (PARALLELVARIABLES + 1);
+        wv[i].nodeId = UA_NODEID_NUMERIC(1, 1000 + var);
+        wv[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[i].value.hasValue = true;
+        if(i % 7 == 0) {
+            UA_Double d = 1.0;
+            UA_Variant_setScalarCopy(&wv[i].value.value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+        } else {
+            UA_Int32 value = (UA_Int32)var + 1;
+            UA_Variant_setScalarCopy(&wv[i].value.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+        }
+    }
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = wv;
+    request.nodesToWriteSize = PARALLELOPERATIONS;
+
+    UA_WriteResponse serial, parallel;
+    UA_Int32 serialValues[PARALLELVARIABLES], parallelValues[PARALLELVARIABLES];
+    runWrite(&request, &serial, serialValues, false);
+    runWrite(&request, &parallel, parallelValues, true);
+
+    ck_assert_uint_eq(serial.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(parallel.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(parallel.resultsSize, serial.resultsSize);
+    for(size_t i = 0; i < serial.resultsSize; i++)
+        ck_assert_uint_eq(parallel.results[i], serial.results[i]);
+    for(size_t i = 0; i < PARALLELVARIABLES; i++)
+        ck_assert_int_eq(parallelValues[i], serialValues[i]);
+    ck_assert_uint_eq(serial.results[0], UA_STATUSCODE_BADTYPEMISMATCH);
+    ck_assert_uint_eq(serial.results[PARALLELVARIABLES], UA_STATUSCODE_BADNODEIDUNKNOWN);
+    ck_assert_int_eq(serialValues[0], 1);
+
+    UA_WriteResponse_deleteMembers(&serial);
+    UA_WriteResponse_deleteMembers(&parallel);
+    UA_WriteRequest_deleteMembers(&request);
+}
+END_TEST
+
+#ifdef UA_ENABLE_METHODCALLS
+
+static UA_StatusCode
+doubleMethod(UA_Server *serverPtr,
+             const UA_NodeId *sessionId, void *sessionHandle,
+             const UA_NodeId *methodId, void *methodContext,
+             const UA_NodeId *objectId, void *objectContext,
+             size_t inputSize, const UA_Variant *input,
+             size_t outputSize, UA_Variant *output) {
+    UA_Int32 value = *(UA_Int32*)input->data * 2;
+    return UA_Variant_setScalarCopy(output, &value, &UA_TYPES[UA_TYPES_INT32]);
+}
+
+static void
+callService(UA_Server *serverPtr, void *data) {
+    ServiceCall *sc = (ServiceCall*)data;
+    Service_Call(serverPtr, &adminSession, (const UA_CallRequest*)sc->request,
+                 (UA_CallResponse*)sc->response);
+}
+
+static void
+runCall(const UA_CallRequest *request, UA_CallResponse *response, UA_Boolean parallel) {
+    UA_CallResponse_init(response);
+    ServiceCall sc = {request, response};
+    runServiceInWorker(callService, &sc, parallel);
+}
+
+START_TEST(Server_parallelCall) {
+    UA_Argument argument;
+    UA_Argument_init(&argument);
+    argument.name = UA_STRING("Value");
+    argument.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    argument.valueRank = -1; /* scalar */
+    UA_MethodAttributes attr = UA_MethodAttributes_default;
+    attr.executable = true;
+    attr.userExecutable = true;
+    UA_StatusCode retval =
+        UA_Server_addMethodNode(server, UA_NODEID_NUMERIC(1, 2000),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASORDEREDCOMPONENT),
+                                UA_QUALIFIEDNAME(1, "Double"), attr, doubleMethod,
+                                1, &argument, 1, &argument, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Every tenth call is for an unknown method */
+    UA_CallMethodRequest *cmr = (UA_CallMethodRequest*)
+        UA_Array_new(PARALLELOPERATIONS, &UA_TYPES[UA_TYPES_CALLMETHODREQUEST]);
+    for(UA_Int32 i = 0; i < PARALLELOPERATIONS; i++) {
+        cmr[i].objectId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        cmr[i].methodId = UA_NODEID_NUMERIC(1, (i % 10 == 0) ? 2001 : 2000);
+        cmr[i].inputArguments = UA_Variant_new();
+        cmr[i].inputArgumentsSize = 1;
+        UA_Variant_setScalarCopy(cmr[i].inputArguments, &i, &UA_TYPES[UA_TYPES_INT32]);
+    }
+    UA_CallRequest request;
+    UA_CallRequest_init(&request);
+    request.methodsToCall = cmr;
+    request.methodsToCallSize = PARALLELOPERATIONS;
+
+    UA_CallResponse serial, parallel;
+    runCall(&request, &serial, false);
+    runCall(&request, &parallel, true);
+
+    ck_assert_uint_eq(serial.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(parallel.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(parallel.resultsSize, serial.resultsSize);
+    for(size_t i = 0; i < serial.resultsSize; i++)
+        ck_assert(UA_equal(&parallel.results[i], &serial.results[i],
+                           &UA_TYPES[UA_TYPES_CALLMETHODRESULT]));
+    ck_assert_uint_eq(serial.results[1].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)serial.results[1].outputArguments[0].data, 2);
+
+    UA_CallResponse_deleteMembers(&serial);
+    UA_CallResponse_deleteMembers(&parallel);
+    UA_CallRequest_deleteMembers(&request);
+}
+END_TEST
+
+#endif /* UA_ENABLE_METHODCALLS */
+
+#endif /* UA_ENABLE_MULTITHREADING */
+
 static Suite* testSuite_Client(void) {
     Suite *s = suite_create("Server Callbacks");
     TCase *tc_server = tcase_create("Server Repeated Callbacks");
     tcase_add_checked_fixture(tc_server, setup, teardown);
     tcase_add_test(tc_server, Server_addRemoveRepeatedCallback);
     tcase_add_test(tc_server, Server_repeatedCallbackRemoveItself);
+    tcase_add_test(tc_server, Server_dispatchAndDelay);
+    tcase_add_test(tc_server, Server_processParallel);
     suite_add_tcase(s, tc_server);
+
+#ifdef UA_ENABLE_MULTITHREADING
+    TCase *tc_parallel = tcase_create("Parallel Operations");
+    tcase_add_checked_fixture(tc_parallel, setup, teardown);
+    tcase_add_test(tc_parallel, Server_parallelRead);
+    tcase_add_test(tc_parallel, Server_parallelWrite);
+#ifdef UA_ENABLE_METHODCALLS
+    tcase_add_test(tc_parallel, Server_parallelCall);
+#endif
+    suite_add_tcase(s, tc_parallel);
+#endif
+
+    TCase *tc_timer = tcase_create("Timer");
+    tcase_add_test(tc_timer, Timer_blockOrder);
+    tcase_add_test(tc_timer, Timer_subMillisecondInterval);
+    tcase_add_test(tc_timer, Timer_manyCallbacks);
+    suite_add_tcase(s, tc_timer);
     return s;
 }
 
@@ -7,6 +7,7 @@
 
 #include "ua_types.h"
 #include "ua_config_default.h"
+#include "ua_nodestore_snapshot.h"
 #include "check.h"
 
 #ifdef __clang__
@@ -165,6 +166,70 @@ START_TEST(Server_set_customHostname) {
 END_TEST
 
 
+static void
+countNode(size_t *count, const UA_Node *node) {
+    (*count)++;
+}
+
+START_TEST(Server_startFromSnapshot) {
+    /* Take a snapshot of the address space of a fresh server */
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    UA_Server *server = UA_Server_new(config);
+    UA_ByteString snapshot;
+    UA_StatusCode retval = UA_Nodestore_snapshot_encode(&config->nodestore, &snapshot);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    size_t snapshotSize = 0;
+    config->nodestore.iterate(config->nodestore.context, &snapshotSize,
+                              (UA_NodestoreVisitor)countNode);
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+
+    /* Start a server with the snapshot. Namespace 0 is not created again. */
+    config = UA_ServerConfig_new_default();
+    UA_Nodestore overlay = config->nodestore;
+    retval = UA_Nodestore_snapshot_new(&config->nodestore, &snapshot, &overlay);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    server = UA_Server_new(config);
+    ck_assert_ptr_ne(server, NULL);
+
+    /* The DataSources are set up again */
+    UA_Variant value;
+    retval = UA_Server_readValue(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME),
+                                 &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(value.type, &UA_TYPES[UA_TYPES_DATETIME]);
+    UA_Variant_deleteMembers(&value);
+
+    retval = UA_Server_readValue(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_NAMESPACEARRAY),
+                                 &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(value.arrayLength, 2);
+    UA_Variant_deleteMembers(&value);
+
+    /* Nodes are added below the nodes from the snapshot. The type checks
+     * (re)build the type cache along the way. */
+    UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+    for(size_t i = 0; i < 20; ++i) {
+        retval = UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                         UA_QUALIFIEDNAME(1, "object"),
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                         attr, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* Only the accessed nodes are decoded from the snapshot */
+    size_t decodedSize = 0;
+    overlay.iterate(overlay.context, &decodedSize, (UA_NodestoreVisitor)countNode);
+    ck_assert_uint_lt(decodedSize - 20, snapshotSize);
+
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+    UA_ByteString_deleteMembers(&snapshot);
+}
+END_TEST
+
 static Suite* testSuite_ServerUserspace(void) {
     Suite *s = suite_create("ServerUserspace");
     TCase *tc_core = tcase_create("Core");
@@ -172,6 +237,7 @@ static Suite* testSuite_ServerUserspace(void) {
     tcase_add_test(tc_core, Server_addNamespace_writeService);
     tcase_add_test(tc_core, Server_forEachChildNodeCall);
     tcase_add_test(tc_core, Server_set_customHostname);
+    tcase_add_test(tc_core, Server_startFromSnapshot);
 
     suite_add_tcase(s,tc_core);
     return s;
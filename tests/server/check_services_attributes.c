@@ -738,6 +738,188 @@ START_TEST(WriteSingleAttributeValue) {
     UA_DataValue_deleteMembers(&resp);
 } END_TEST
 
+static UA_Boolean
+isInlineValue(const UA_NodeId nodeId) {
+    const UA_VariableNode *node = (const UA_VariableNode*)
+        UA_Nodestore_get(server, &nodeId);
+    ck_assert(node != NULL);
+    UA_Boolean isInline = (node->value.data.value.value.data ==
+                           node->value.data.inlineValue);
+    UA_Nodestore_release(server, (const UA_Node*)node);
+    return isInline;
+}
+
+START_TEST(WriteSingleAttributeValueInline) {
+    /* Small scalars are stored inside the node */
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "the.answer");
+    ck_assert(isInlineValue(nodeId));
+
+    UA_Guid guid = UA_Guid_random();
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &guid, &UA_TYPES[UA_TYPES_GUID]);
+    UA_StatusCode retval = UA_Server_writeValue(server, nodeId, value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(isInlineValue(nodeId));
+
+    UA_Variant out;
+    retval = UA_Server_readValue(server, nodeId, &out);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(out.type == &UA_TYPES[UA_TYPES_GUID]);
+    ck_assert(UA_Guid_equal(&guid, (UA_Guid*)out.data));
+    UA_Variant_deleteMembers(&out);
+
+    /* Strings remain on the heap */
+    UA_String str = UA_STRING("no inline storage");
+    UA_Variant_setScalar(&value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    retval = UA_Server_writeValue(server, nodeId, value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(!isInlineValue(nodeId));
+
+    retval = UA_Server_readValue(server, nodeId, &out);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_String_equal(&str, (UA_String*)out.data));
+    UA_Variant_deleteMembers(&out);
+
+    UA_Double d = 42.5;
+    UA_Variant_setScalar(&value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    retval = UA_Server_writeValue(server, nodeId, value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(isInlineValue(nodeId));
+
+    retval = UA_Server_readValue(server, nodeId, &out);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(*(UA_Double*)out.data == 42.5);
+    UA_Variant_deleteMembers(&out);
+} END_TEST
+
+static UA_NodeId
+registerNode(UA_Session *session, UA_NodeId nodeId) {
+    UA_RegisterNodesRequest request;
+    UA_RegisterNodesRequest_init(&request);
+    request.nodesToRegister = &nodeId;
+    request.nodesToRegisterSize = 1;
+    UA_RegisterNodesResponse response;
+    UA_RegisterNodesResponse_init(&response);
+    Service_RegisterNodes(server, session, &request, &response);
+    ck_assert_int_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.registeredNodeIdsSize, 1);
+    UA_NodeId handle = response.registeredNodeIds[0];
+    UA_free(response.registeredNodeIds); /* The handle has no heap members */
+    return handle;
+}
+
+static UA_StatusCode
+readRegistered(UA_Session *session, UA_NodeId nodeId, UA_Int32 *out) {
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = nodeId;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_DataValue dv = UA_Server_readWithSession(server, session, &rvi,
+                                                UA_TIMESTAMPSTORETURN_NEITHER);
+    UA_StatusCode retval = dv.hasStatus ? dv.status : UA_STATUSCODE_GOOD;
+    if(retval == UA_STATUSCODE_GOOD)
+        *out = *(UA_Int32*)dv.value.data;
+    UA_DataValue_deleteMembers(&dv);
+    return retval;
+}
+
+START_TEST(ReadWriteRegisteredNode) {
+    UA_CreateSessionRequest createRequest;
+    UA_CreateSessionRequest_init(&createRequest);
+    UA_Session *session, *otherSession;
+    UA_StatusCode retval =
+        UA_SessionManager_createSession(&server->sessionManager, NULL,
+                                        &createRequest, &session);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_SessionManager_createSession(&server->sessionManager, NULL,
+                                             &createRequest, &otherSession);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The registered NodeId is a numeric handle */
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "the.answer");
+    UA_NodeId handle = registerNode(session, nodeId);
+    ck_assert_int_eq(handle.identifierType, UA_NODEIDTYPE_NUMERIC);
+    ck_assert_uint_eq(handle.namespaceIndex, 0);
+    ck_assert(handle.identifier.numeric & 0x80000000);
+
+    /* Read and write with the handle */
+    UA_Int32 value = 0;
+    retval = readRegistered(session, handle, &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(value, 42);
+
+    retval = UA_Server_writeAccessLevel(server, nodeId, UA_ACCESSLEVELMASK_READ |
+                                        UA_ACCESSLEVELMASK_WRITE);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Int32 newValue = 43;
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = handle;
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value.hasValue = true;
+    UA_Variant_setScalar(&wv.value.value, &newValue, &UA_TYPES[UA_TYPES_INT32]);
+    retval = UA_Server_writeWithSession(server, session, &wv);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = readRegistered(&adminSession, nodeId, &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(value, 43);
+
+    /* A node replaced in the nodestore is taken again */
+    newValue = 44;
+    retval = UA_Server_writeValue(server, nodeId, wv.value.value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = readRegistered(session, handle, &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(value, 44);
+
+    /* The handle is replaced in the requests of the other services */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = handle;
+    UA_BrowseRequest browseRequest;
+    UA_BrowseRequest_init(&browseRequest);
+    browseRequest.nodesToBrowse = &bd;
+    browseRequest.nodesToBrowseSize = 1;
+    UA_Server_resolveRegisteredNodes(server, session, &UA_TYPES[UA_TYPES_BROWSEREQUEST],
+                                     &browseRequest);
+    ck_assert(UA_NodeId_equal(&bd.nodeId, &nodeId));
+
+    /* Not for another session */
+    retval = readRegistered(otherSession, handle, &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    bd.nodeId = handle;
+    UA_Server_resolveRegisteredNodes(server, otherSession, &UA_TYPES[UA_TYPES_BROWSEREQUEST],
+                                     &browseRequest);
+    ck_assert(UA_NodeId_equal(&bd.nodeId, &handle));
+
+    /* The handle does not resolve after unregistering, also when the entry is
+     * reused */
+    UA_UnregisterNodesRequest unregisterRequest;
+    UA_UnregisterNodesRequest_init(&unregisterRequest);
+    unregisterRequest.nodesToUnregister = &handle;
+    unregisterRequest.nodesToUnregisterSize = 1;
+    UA_UnregisterNodesResponse unregisterResponse;
+    UA_UnregisterNodesResponse_init(&unregisterResponse);
+    Service_UnregisterNodes(server, session, &unregisterRequest, &unregisterResponse);
+    ck_assert_int_eq(unregisterResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_NodeId newHandle = registerNode(session, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER));
+    ck_assert(!UA_NodeId_equal(&newHandle, &handle));
+    retval = readRegistered(session, handle, &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    /* A removed node is no longer read with the handle */
+    handle = registerNode(session, nodeId);
+    retval = UA_Server_deleteNode(server, nodeId, true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = readRegistered(session, handle, &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    UA_NodeId token = session->header.authenticationToken;
+    UA_SessionManager_removeSession(&server->sessionManager, &token);
+    token = otherSession->header.authenticationToken;
+    UA_SessionManager_removeSession(&server->sessionManager, &token);
+} END_TEST
+
 START_TEST(WriteSingleAttributeValueRangeFromScalar) {
     UA_WriteValue wValue;
     UA_WriteValue_init(&wValue);
@@ -912,6 +1094,8 @@ static Suite * testSuite_services_attributes(void) {
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeContainsNoLoops);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeEventNotifier);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeValue);
+    tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeValueInline);
+    tcase_add_test(tc_writeSingleAttributes, ReadWriteRegisteredNode);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeDataType);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeValueRangeFromScalar);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeValueRangeFromArray);
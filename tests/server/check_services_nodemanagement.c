@@ -403,6 +403,160 @@ START_TEST(InstantiateObjectType) {
     ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
 } END_TEST
 
+static void
+setBulkItem(UA_AddNodesItem *item, UA_NodeClass nodeClass, UA_UInt32 id,
+            UA_NodeId parentId, UA_UInt32 referenceType, UA_NodeId typeDefinition,
+            const void *attr, const UA_DataType *attributeType) {
+    UA_AddNodesItem_init(item);
+    item->nodeClass = nodeClass;
+    item->requestedNewNodeId.nodeId = UA_NODEID_NUMERIC(1, id);
+    item->parentNodeId.nodeId = parentId;
+    item->referenceTypeId = UA_NODEID_NUMERIC(0, referenceType);
+    item->browseName = UA_QUALIFIEDNAME(1, "bulk");
+    item->typeDefinition.nodeId = typeDefinition;
+    item->nodeAttributes.encoding = UA_EXTENSIONOBJECT_DECODED_NODELETE;
+    item->nodeAttributes.content.decoded.type = attributeType;
+    item->nodeAttributes.content.decoded.data = (void*)(uintptr_t)attr;
+}
+
+static UA_Boolean
+hasForwardReference(const UA_NodeId source, const UA_NodeId target) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = source;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.includeSubtypes = true;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    UA_Boolean found = false;
+    for(size_t i = 0; i < br.referencesSize; i++) {
+        if(UA_NodeId_equal(&br.references[i].nodeId.nodeId, &target))
+            found = true;
+    }
+    UA_BrowseResult_deleteMembers(&br);
+    return found;
+}
+
+START_TEST(AddNodesBulk) {
+    UA_ObjectTypeAttributes otAttr = UA_ObjectTypeAttributes_default;
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&vAttr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+
+    /* Parents and types come first. The last item has an unknown parent. */
+    UA_AddNodesItem items[4];
+    setBulkItem(&items[0], UA_NODECLASS_OBJECTTYPE, 2000,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE), UA_NS0ID_HASSUBTYPE,
+                UA_NODEID_NULL, &otAttr, &UA_TYPES[UA_TYPES_OBJECTTYPEATTRIBUTES]);
+    setBulkItem(&items[1], UA_NODECLASS_OBJECT, 2001,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+                UA_NODEID_NUMERIC(1, 2000), &oAttr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+    setBulkItem(&items[2], UA_NODECLASS_VARIABLE, 2002,
+                UA_NODEID_NUMERIC(1, 2001), UA_NS0ID_HASCOMPONENT,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                &vAttr, &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES]);
+    setBulkItem(&items[3], UA_NODECLASS_OBJECT, 2003,
+                UA_NODEID_NUMERIC(1, 9999), UA_NS0ID_ORGANIZES,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                &oAttr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+
+    UA_AddNodesResult results[4];
+    UA_StatusCode retval = UA_Server_addNodes_bulk(server, 4, items, true, results);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    for(size_t i = 0; i < 3; i++) {
+        ck_assert_int_eq(results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert(UA_NodeId_equal(&results[i].addedNodeId,
+                                  &items[i].requestedNewNodeId.nodeId));
+    }
+    ck_assert_int_eq(results[3].statusCode, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    ck_assert(UA_NodeId_isNull(&results[3].addedNodeId));
+    for(size_t i = 0; i < 4; i++)
+        UA_AddNodesResult_deleteMembers(&results[i]);
+
+    /* The back-links were added */
+    ck_assert(hasForwardReference(UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  UA_NODEID_NUMERIC(1, 2000)));
+    ck_assert(hasForwardReference(UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(1, 2001)));
+    ck_assert(hasForwardReference(UA_NODEID_NUMERIC(1, 2001),
+                                  UA_NODEID_NUMERIC(1, 2002)));
+    ck_assert(hasForwardReference(UA_NODEID_NUMERIC(1, 2001),
+                                  UA_NODEID_NUMERIC(1, 2000)));
+
+    /* The type cache knows the new subtype */
+    UA_NodeId baseObjectType = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    UA_NodeId newType = UA_NODEID_NUMERIC(1, 2000);
+    ck_assert(isSubtypeOf(server, &newType, &baseObjectType));
+
+    UA_Variant out;
+    retval = UA_Server_readValue(server, UA_NODEID_NUMERIC(1, 2002), &out);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)out.data, 42);
+    UA_Variant_deleteMembers(&out);
+
+    /* The failed node was removed */
+    UA_NodeClass nc;
+    retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, 2003), &nc);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+} END_TEST
+
+START_TEST(AddNodesBulkUntrusted) {
+    /* HierarchicalReferences is abstract */
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_AddNodesItem item;
+    setBulkItem(&item, UA_NODECLASS_OBJECT, 2010,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_HIERARCHICALREFERENCES,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                &oAttr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+    UA_StatusCode retval = UA_Server_addNodes_bulk(server, 1, &item, false, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADREFERENCENOTALLOWED);
+    ck_assert(!hasForwardReference(UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                   UA_NODEID_NUMERIC(1, 2010)));
+    UA_NodeClass nc;
+    retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, 2010), &nc);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    /* Trusted sources skip the check */
+    retval = UA_Server_addNodes_bulk(server, 1, &item, true, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(AddNodesBulkUntrustedChildren) {
+    /* The first node fails the check. Its children and grandchildren in the
+     * batch are removed with it. */
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_AddNodesItem items[3];
+    setBulkItem(&items[0], UA_NODECLASS_OBJECT, 2020,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_HIERARCHICALREFERENCES,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                &oAttr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+    setBulkItem(&items[1], UA_NODECLASS_OBJECT, 2021,
+                UA_NODEID_NUMERIC(1, 2020), UA_NS0ID_ORGANIZES,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                &oAttr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+    setBulkItem(&items[2], UA_NODECLASS_OBJECT, 2022,
+                UA_NODEID_NUMERIC(1, 2021), UA_NS0ID_ORGANIZES,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                &oAttr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+
+    UA_AddNodesResult results[3];
+    UA_StatusCode retval = UA_Server_addNodes_bulk(server, 3, items, false, results);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADREFERENCENOTALLOWED);
+    ck_assert_int_eq(results[0].statusCode, UA_STATUSCODE_BADREFERENCENOTALLOWED);
+    ck_assert_int_eq(results[1].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    ck_assert_int_eq(results[2].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    for(size_t i = 0; i < 3; i++) {
+        ck_assert(UA_NodeId_isNull(&results[i].addedNodeId));
+        UA_AddNodesResult_deleteMembers(&results[i]);
+    }
+
+    UA_NodeClass nc;
+    for(UA_UInt32 id = 2020; id <= 2022; id++) {
+        retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, id), &nc);
+        ck_assert_int_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    }
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("services_nodemanagement");
 
@@ -414,6 +568,9 @@ int main(void) {
     tcase_add_test(tc_addnodes, AddNodeTwiceGivesError);
     tcase_add_test(tc_addnodes, AddObjectWithConstructor);
     tcase_add_test(tc_addnodes, InstantiateObjectType);
+    tcase_add_test(tc_addnodes, AddNodesBulk);
+    tcase_add_test(tc_addnodes, AddNodesBulkUntrusted);
+    tcase_add_test(tc_addnodes, AddNodesBulkUntrustedChildren);
     suite_add_tcase(s, tc_addnodes);
 
     TCase *tc_deletenodes = tcase_create("deletenodes");
@@ -125,6 +125,145 @@ START_TEST(Service_Browse_WithBrowseName) {
 }
 END_TEST
 
+static UA_Boolean
+browseFindsNode(UA_Server *server, UA_NodeId nodeId, UA_NodeId target) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = nodeId;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_int_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    UA_Boolean found = false;
+    for(size_t i = 0; i < br.referencesSize; ++i) {
+        if(UA_NodeId_equal(&br.references[i].nodeId.nodeId, &target))
+            found = true;
+    }
+    UA_BrowseResult_deleteMembers(&br);
+    return found;
+}
+
+START_TEST(Service_Browse_SubtypeCache) {
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    UA_Server *server = UA_Server_new(config);
+
+    /* A new subtype of Organizes */
+    UA_NodeId refTypeId = UA_NODEID_NUMERIC(1, 5000);
+    UA_ReferenceTypeAttributes rattr = UA_ReferenceTypeAttributes_default;
+    rattr.displayName = UA_LOCALIZEDTEXT("en-US", "MyOrganizes");
+    UA_StatusCode retval =
+        UA_Server_addReferenceTypeNode(server, refTypeId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                       UA_QUALIFIEDNAME(1, "MyOrganizes"),
+                                       rattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* An object referenced with the new reference type */
+    UA_NodeId objectId = UA_NODEID_NUMERIC(1, 5001);
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("en-US", "MyObject");
+    retval = UA_Server_addObjectNode(server, objectId,
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), refTypeId,
+                                     UA_QUALIFIEDNAME(1, "MyObject"),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                     oattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Repeated browsing builds the cache */
+    UA_NodeId objectsId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    for(size_t i = 0; i < 32; ++i)
+        ck_assert(browseFindsNode(server, objectsId, objectId));
+    ck_assert_ptr_ne(server->typeCache, NULL);
+
+    /* Remove the reference type from the hierarchy */
+    retval = UA_Server_deleteReference(server, UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE), true,
+                                       UA_EXPANDEDNODEID_NUMERIC(1, 5000), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(server->typeCache, NULL);
+    for(size_t i = 0; i < 32; ++i)
+        ck_assert(!browseFindsNode(server, objectsId, objectId));
+    ck_assert_ptr_ne(server->typeCache, NULL);
+
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+}
+END_TEST
+
+START_TEST(Service_TranslateBrowsePath_Cache) {
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    UA_Server *server = UA_Server_new(config);
+
+    UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+    UA_NodeId lineId = UA_NODEID_NUMERIC(1, 5000);
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, lineId, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Line1"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE), attr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The second lookup is answered from the cache */
+    size_t hits, misses;
+    UA_QualifiedName line1 = UA_QUALIFIEDNAME(1, "Line1");
+    for(size_t i = 0; i < 2; i++) {
+        UA_BrowsePathResult bpr =
+            UA_Server_browseSimplifiedBrowsePath(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                                 1, &line1);
+        ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(bpr.targetsSize, 1);
+        ck_assert(UA_NodeId_equal(&bpr.targets[0].targetId.nodeId, &lineId));
+        UA_BrowsePathResult_deleteMembers(&bpr);
+    }
+    UA_Server_getPathCacheStatistics(server, &hits, &misses);
+    ck_assert_uint_eq(hits, 1);
+    ck_assert_uint_eq(misses, 1);
+
+    /* A path without a match is also answered from the cache */
+    UA_QualifiedName missing = UA_QUALIFIEDNAME(1, "Missing");
+    for(size_t i = 0; i < 2; i++) {
+        UA_BrowsePathResult bpr =
+            UA_Server_browseSimplifiedBrowsePath(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                                 1, &missing);
+        ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_BADNOMATCH);
+        ck_assert_int_eq(bpr.targetsSize, 0);
+        UA_BrowsePathResult_deleteMembers(&bpr);
+    }
+    UA_Server_getPathCacheStatistics(server, &hits, &misses);
+    ck_assert_uint_eq(hits, 2);
+    ck_assert_uint_eq(misses, 2);
+
+    /* Renaming the node outdates the cached path */
+    retval = UA_Server_writeBrowseName(server, lineId, UA_QUALIFIEDNAME(1, "Line2"));
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                             1, &line1);
+    ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_BADNOMATCH);
+    UA_BrowsePathResult_deleteMembers(&bpr);
+
+    /* Cache the new path */
+    UA_QualifiedName line2 = UA_QUALIFIEDNAME(1, "Line2");
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                               1, &line2);
+    ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    UA_BrowsePathResult_deleteMembers(&bpr);
+
+    /* And removing the node */
+    retval = UA_Server_deleteNode(server, lineId, true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                               1, &line2);
+    ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_BADNOMATCH);
+    UA_BrowsePathResult_deleteMembers(&bpr);
+
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+}
+END_TEST
+
 START_TEST(Service_TranslateBrowsePathsToNodeIds) {
     UA_Client *client = UA_Client_new(UA_ClientConfig_default);
 
@@ -191,6 +330,8 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     TCase *tc_browse = tcase_create("Browse Service");
     tcase_add_test(tc_browse, Service_Browse_WithBrowseName);
     tcase_add_test(tc_browse, Service_Browse_WithMaxResults);
+    tcase_add_test(tc_browse, Service_Browse_SubtypeCache);
+    tcase_add_test(tc_browse, Service_TranslateBrowsePath_Cache);
     suite_add_tcase(s, tc_browse);
 
     TCase *tc_translate = tcase_create("TranslateBrowsePathsToNodeIds");
@@ -6,7 +6,9 @@
 #include <stdlib.h>
 
 #include "ua_types.h"
+#include "ua_config_default.h"
 #include "server/ua_services.h"
+#include "server/ua_server_internal.h"
 #include "check.h"
 
 START_TEST(Session_init_ShallWork) {
@@ -46,11 +48,59 @@ START_TEST(Session_updateLifetime_ShallWork) {
 }
 END_TEST
 
+#define MANYSESSIONS 500
+
+START_TEST(SessionManager_lookupManySessions) {
+    UA_ServerConfig *config = UA_ServerConfig_new_default();
+    config->maxSessions = MANYSESSIONS;
+    UA_Server *server = UA_Server_new(config);
+    UA_SessionManager *sm = &server->sessionManager;
+
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    UA_Session *sessions[MANYSESSIONS];
+    for(size_t i = 0; i < MANYSESSIONS; i++) {
+        UA_StatusCode retval = UA_SessionManager_createSession(sm, NULL, &request, &sessions[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    UA_Session *tooMany;
+    ck_assert_uint_eq(UA_SessionManager_createSession(sm, NULL, &request, &tooMany),
+                      UA_STATUSCODE_BADTOOMANYSESSIONS);
+
+    for(size_t i = 0; i < MANYSESSIONS; i++) {
+        ck_assert_ptr_eq(UA_SessionManager_getSessionByToken(sm, &sessions[i]->header.authenticationToken),
+                         sessions[i]);
+        ck_assert_ptr_eq(UA_SessionManager_getSessionById(sm, &sessions[i]->sessionId),
+                         sessions[i]);
+    }
+
+    /* Remove every other session */
+    for(size_t i = 0; i < MANYSESSIONS; i += 2) {
+        UA_NodeId token = sessions[i]->header.authenticationToken;
+        ck_assert_uint_eq(UA_SessionManager_removeSession(sm, &token), UA_STATUSCODE_GOOD);
+        ck_assert_ptr_eq(UA_SessionManager_getSessionByToken(sm, &token), NULL);
+        ck_assert_uint_eq(UA_SessionManager_removeSession(sm, &token),
+                          UA_STATUSCODE_BADSESSIONIDINVALID);
+    }
+    for(size_t i = 1; i < MANYSESSIONS; i += 2) {
+        ck_assert_ptr_eq(UA_SessionManager_getSessionByToken(sm, &sessions[i]->header.authenticationToken),
+                         sessions[i]);
+        ck_assert_ptr_eq(UA_SessionManager_getSessionById(sm, &sessions[i]->sessionId),
+                         sessions[i]);
+    }
+    ck_assert_uint_eq(sm->currentSessionCount, MANYSESSIONS / 2);
+
+    UA_Server_delete(server);
+    UA_ServerConfig_delete(config);
+}
+END_TEST
+
 static Suite* testSuite_Session(void) {
     Suite *s = suite_create("Session");
     TCase *tc_core = tcase_create("Core");
     tcase_add_test(tc_core, Session_init_ShallWork);
     tcase_add_test(tc_core, Session_updateLifetime_ShallWork);
+    tcase_add_test(tc_core, SessionManager_lookupManySessions);
 
     suite_add_tcase(s,tc_core);
     return s;
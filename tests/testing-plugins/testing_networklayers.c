@@ -65,6 +65,7 @@ UA_Connection createDummyConnection(size_t sendBufferSize,
     c.getSendBuffer = dummyGetSendBuffer;
     c.releaseSendBuffer = dummyReleaseSendBuffer;
     c.send = dummySend;
+    c.sendBatch = NULL;
     c.recv = NULL;
     c.releaseRecvBuffer = dummyReleaseRecvBuffer;
     c.close = dummyClose;
@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+
+# coding: UTF-8
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# This script compares two result files of the bench_types benchmark (one JSON
+# object per line) and fails if a case got slower than the threshold or
+# allocates more memory per operation than before.
+
+from __future__ import print_function
+import sys
+import json
+import argparse
+
+parser = argparse.ArgumentParser()
+parser.add_argument('baseline', help='results of the reference build')
+parser.add_argument('current', help='results of the build under test')
+parser.add_argument('--threshold', type=float, default=10.0,
+                    help='maximum slowdown in percent (default: 10)')
+args = parser.parse_args()
+
+def load(filename):
+    results = {}
+    with open(filename) as f:
+        for line in f:
+            # Skip log output that ended up in the file
+            if not line.startswith('{'):
+                continue
+            entry = json.loads(line)
+            if 'ns_per_op' in entry:
+                results[entry['name']] = entry
+    return results
+
+baseline = load(args.baseline)
+current = load(args.current)
+
+regressions = 0
+print("%-36s %12s %12s %8s %12s %12s" %
+      ("name", "base ns/op", "ns/op", "change", "base B/op", "B/op"))
+for name in sorted(current):
+    cur = current[name]
+    if name not in baseline:
+        print("%-36s %12s %12.1f %8s" % (name, "-", cur['ns_per_op'], "new"))
+        continue
+    base = baseline[name]
+    change = (cur['ns_per_op'] - base['ns_per_op']) * 100.0 / base['ns_per_op']
+    flag = ""
+    if change > args.threshold:
+        flag = " SLOWER"
+    if cur['bytes_per_op'] is not None and base['bytes_per_op'] is not None and \
+       cur['bytes_per_op'] > base['bytes_per_op']:
+        flag += " MORE MEMORY"
+    if flag:
+        regressions += 1
+    print("%-36s %12.1f %12.1f %+7.1f%% %12s %12s%s" %
+          (name, base['ns_per_op'], cur['ns_per_op'], change,
+           base['bytes_per_op'], cur['bytes_per_op'], flag))
+
+for name in sorted(set(baseline) - set(current)):
+    print("%-36s %12.1f %12s %8s" % (name, baseline[name]['ns_per_op'], "-", "missing"))
+
+if regressions > 0:
+    print("%d regression(s) found" % regressions)
+    sys.exit(1)
@@ -104,6 +104,40 @@ class Type(object):
             "    " + binaryEncodingId + ", /* .binaryEncodingId */\n" + \
             "    %s_members" % self.name + " /* .members */\n}"
 
+    def runnable(self):
+        """Returns the C-statement that must be true for the type to be part of
+        a run of members that is en-/decoded with a single memcpy. Booleans are
+        normalized during decoding and never part of a run."""
+        if self.name == "Boolean" or self.overlayable == "false":
+            return None
+        for m in self.members:
+            if m.memberType != self and not m.memberType.runnable():
+                return None
+        return self.overlayable
+
+    def overlayableRun(self, index):
+        """Returns the C-expression for the number of members starting at index
+        that are runnable and follow each other without padding in memory."""
+        member = self.members[index]
+        if member.isArray or member.memberType == self or not member.memberType.runnable():
+            return "0"
+        last = index
+        while last + 1 < len(self.members):
+            m = self.members[last + 1]
+            if m.isArray or not m.memberType.runnable():
+                break
+            last += 1
+        if last == index:
+            return "0"
+        run = "0"
+        for k in range(last, index, -1):
+            m = self.members[k]
+            before = self.members[k-1]
+            run = "((%s && offsetof(UA_%s, %s) == offsetof(UA_%s, %s) + sizeof(UA_%s)) ? 1 + %s : 0)" % \
+                  (m.memberType.runnable(), self.name, m.name, self.name, before.name,
+                   before.memberType.name, run)
+        return "(%s ? 1 + %s : 0)" % (member.memberType.runnable(), run)
+
     def members_c(self):
         if len(self.members)==0:
             return "#define %s_members NULL" % (self.name)
@@ -133,7 +167,8 @@ class Type(object):
                     m += " - sizeof(UA_%s)," % before.memberType.name
             m += " /* .padding */\n"
             m += "    %s, /* .namespaceZero */\n" % member.memberType.ns0
-            m += ("    true" if member.isArray else "    false") + " /* .isArray */\n}"
+            m += ("    true" if member.isArray else "    false") + ", /* .isArray */\n"
+            m += "    %s /* .overlayableRun */\n}" % self.overlayableRun(index)
             if i != size:
                 m += ","
             members += m